@@ -29,6 +29,6 @@ private:                                                                       \
   SharedImpl __pImpl;                                                          \
                                                                                \
 public:                                                                        \
-  SharedImpl __getImpl() { return __pImpl; }
+  const SharedImpl &__getImpl() { return __pImpl; }
 
 #endif /* __SVEL_CONFIG_H__ */
\ No newline at end of file
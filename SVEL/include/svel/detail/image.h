@@ -57,6 +57,14 @@ private:
    */
   bool _loadedFromFile = false;
 
+  /**
+   * @brief Validates the result of stb and sets the internal values.
+   *
+   * @param width   Width reported by stb.
+   * @param height  Height reported by stb.
+   */
+  void _handleLoad(int width, int height);
+
 public:
   /**
    * @brief Construct an image manually.
@@ -78,6 +86,15 @@ public:
    */
   Image(const std::string &path);
 
+  /**
+   * @brief Decode an image that resides in memory, like an image embedded in
+   * a model file.
+   *
+   * @param encoded     The encoded image file.
+   * @param encodedSize Size of the encoded image in bytes.
+   */
+  Image(const unsigned char *encoded, size_t encodedSize);
+
   /**
    * @brief Destroys the image.
    */
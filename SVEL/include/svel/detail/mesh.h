@@ -1,7 +1,7 @@
 /**
  * @file mesh.h
  * @author René Pascal Becker (rene.becker2@gmx.de)
- * @brief Forward declaration of the mesh.
+ * @brief Forward declaration of the mesh and mesh import options.
  * @date 2023-03-25
  *
  * @copyright Copyright (c) 2023
@@ -13,9 +13,15 @@
 
 // SVEL
 #include <svel/config.h>
+#include <svel/detail/image.h>
+#include <svel/detail/pipeline.h>
 
 // STL
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace SVEL_NAMESPACE {
 
@@ -25,6 +31,359 @@ namespace SVEL_NAMESPACE {
 class Mesh;
 SVEL_CLASS(Mesh)
 
+/**
+ * @brief Data that an imported vertex can provide.
+ */
+enum class VertexSemantic {
+  ePosition, // Position, w is 1
+  eColor,    // Vertex color, white if the source has none
+  eTexCoord, // Texture coordinate
+  eNormal,   // Normal, two components select octahedral encoding
+  eTangent   // Tangent, w is the handedness of the bitangent
+};
+
+/**
+ * @brief How normals are generated for imported models that have none.
+ */
+enum class NormalGeneration {
+  eNone,          // Models without normals are skipped
+  eAreaWeighted,  // Faces contribute in proportion to their area
+  eAngleWeighted  // Faces contribute in proportion to their corner angle
+};
+
+/**
+ * @brief A single attribute of an imported vertex.
+ */
+struct VertexAttribute {
+  /**
+   * @brief Which data the attribute holds.
+   */
+  VertexSemantic semantic;
+
+  /**
+   * @brief How the data is stored. Normalized types clamp values to their
+   * range, values are not rescaled.
+   */
+  AttributeType type;
+
+  /**
+   * @brief How many components are stored.
+   */
+  unsigned int count;
+};
+
+/**
+ * @brief Layout of imported vertices. Attributes are tightly packed in the
+ * given order. Semantics that are not listed are dropped.
+ */
+typedef std::vector<VertexAttribute> VertexLayout;
+
+/**
+ * @brief Creates the vertex description of a pipeline that consumes vertices
+ * with the given layout.
+ *
+ * @param layout              Layout of the vertices.
+ * @return VertexDescription  Description for the pipeline.
+ */
+inline VertexDescription GetVertexDescription(const VertexLayout &layout) {
+  VertexDescription description{};
+  for (const auto &attribute : layout)
+    description.emplace_back(attribute.type, attribute.count);
+  return description;
+}
+
+/**
+ * @brief Describes how well a mesh uses the post-transform vertex cache.
+ */
+struct VertexCacheStatistics {
+  /**
+   * @brief Average cache miss ratio. Vertex shader invocations per triangle.
+   * Ranges from about 0.5 for well ordered regular grids to 3.
+   */
+  float acmr = 0.0f;
+
+  /**
+   * @brief Average transform to vertex ratio. Vertex shader invocations per
+   * vertex. 1 is optimal.
+   */
+  float atvr = 0.0f;
+};
+
+/**
+ * @brief Describes how often pixels are shaded when a mesh is rendered with
+ * depth testing. Estimated on the cpu from several view directions.
+ */
+struct OverdrawStatistics {
+  /**
+   * @brief Pixels covered by the mesh over all sampled views.
+   */
+  uint64_t pixelsCovered = 0;
+
+  /**
+   * @brief Fragments that passed the depth test over all sampled views.
+   */
+  uint64_t pixelsShaded = 0;
+
+  /**
+   * @brief Shaded fragments per covered pixel. 1 is optimal.
+   */
+  float overdraw = 0.0f;
+};
+
+/**
+ * @brief Effect of the mesh optimization.
+ */
+struct MeshOptimizationStatistics {
+  /**
+   * @brief Vertex cache efficiency of the mesh as provided.
+   */
+  VertexCacheStatistics before;
+
+  /**
+   * @brief Vertex cache efficiency of the mesh that was uploaded.
+   */
+  VertexCacheStatistics after;
+
+  /**
+   * @brief Overdraw of the mesh as provided. Only estimated if the overdraw
+   * optimization is enabled.
+   */
+  OverdrawStatistics overdrawBefore;
+
+  /**
+   * @brief Overdraw of the mesh that was uploaded. Only estimated if the
+   * overdraw optimization is enabled.
+   */
+  OverdrawStatistics overdrawAfter;
+};
+
+/**
+ * @brief Optimizations that are applied to mesh data before it is uploaded.
+ * Only triangle lists are supported.
+ */
+struct MeshOptimizationOptions {
+  /**
+   * @brief Reorder triangles so that the post-transform vertex cache is hit
+   * more often.
+   */
+  bool optimizeVertexCache = false;
+
+  /**
+   * @brief Reorder clusters of triangles so that triangles which are likely
+   * to occlude others are drawn first. Independent of the view. Runs after the
+   * vertex cache optimization and keeps most of its benefit.
+   */
+  bool optimizeOverdraw = false;
+
+  /**
+   * @brief How much the vertex cache efficiency may degrade in exchange for
+   * less overdraw. 1 keeps the vertex cache efficiency, larger values create
+   * smaller clusters that can be sorted more freely.
+   */
+  float overdrawThreshold = 1.05f;
+
+  /**
+   * @brief Offset in bytes of the vertex position within a vertex. The
+   * position has to consist of three floats. Only used by the overdraw
+   * optimization.
+   */
+  uint32_t positionOffset = 0;
+
+  /**
+   * @brief Reorder vertices in order of first use and remap the indices, so
+   * that vertex fetches access memory linearly. Unused vertices are removed.
+   */
+  bool optimizeVertexFetch = false;
+
+  /**
+   * @brief Amount of vertices the simulated post-transform cache holds.
+   */
+  uint32_t vertexCacheSize = 16;
+
+  /**
+   * @brief If set, receives the vertex cache efficiency before and after the
+   * optimization. Combined over all meshes if several are created at once.
+   */
+  MeshOptimizationStatistics *statistics = nullptr;
+};
+
+/**
+ * @brief Controls the generation of simplified levels of detail. All levels of
+ * a mesh share its vertex and index buffer.
+ */
+struct MeshLodOptions {
+  /**
+   * @brief Amount of simplified levels generated in addition to the full
+   * detail mesh. Generation stops early once a level cannot be simplified
+   * further within maxError.
+   */
+  uint32_t levelCount = 0;
+
+  /**
+   * @brief Fraction of the triangles of the previous level that each level
+   * keeps.
+   */
+  float reduction = 0.5f;
+
+  /**
+   * @brief Largest error of a level relative to the extent of the mesh.
+   * Differences in texture coordinates and normals count towards the error.
+   */
+  float maxError = 0.1f;
+
+  /**
+   * @brief Largest error in pixels that is accepted when a level is selected
+   * by its size on screen.
+   */
+  float pixelError = 1.0f;
+};
+
+/**
+ * @brief Information gathered while importing meshes from a file.
+ */
+struct MeshImportStatistics {
+  /**
+   * @brief Signals that the mesh data was loaded from the binary mesh cache.
+   */
+  bool cacheHit = false;
+
+  /**
+   * @brief Time in milliseconds that was spent producing the vertex and index
+   * data. Either parsing and processing the source or reading the cache.
+   */
+  double loadTime = 0.0;
+
+  /**
+   * @brief Time in milliseconds that was spent creating and uploading the
+   * meshes. Imports without blocking only include the creation, the upload
+   * happens during later frames.
+   */
+  double uploadTime = 0.0;
+
+  /**
+   * @brief Size of all vertex data in bytes.
+   */
+  size_t vertexBytes = 0;
+
+  /**
+   * @brief Size of all index data in bytes.
+   */
+  size_t indexBytes = 0;
+
+  /**
+   * @brief Index bytes saved by using 16 bit instead of 32 bit indices.
+   */
+  size_t indexBytesSaved = 0;
+
+  /**
+   * @brief Vertex bytes added by duplicating vertices that are shared between
+   * 16 bit index ranges. Already subtracted from indexBytesSaved, which does
+   * not count meshes whose duplicates cost more than their indices saved.
+   */
+  size_t duplicatedVertexBytes = 0;
+
+  /**
+   * @brief Bytes that the device copied straight from the mapped cache file
+   * instead of staging memory. Requires VK_EXT_external_memory_host.
+   */
+  size_t importedBytes = 0;
+};
+
+/**
+ * @brief Options that control how meshes are imported from files.
+ */
+struct MeshImportOptions {
+  /**
+   * @brief Store the final vertex and index data in a binary cache and reuse
+   * it on later imports as long as the source file did not change. Off by
+   * default, as this writes a .svelmesh file to disk on the first import.
+   */
+  bool useCache = false;
+
+  /**
+   * @brief Directory in which cache files are stored. If empty, the cache is
+   * written next to the source file, which fails for read-only assets and
+   * adds files to directories under version control.
+   */
+  std::string cacheDirectory;
+
+  /**
+   * @brief Compress the vertex and index data of new cache files. Typical
+   * meshes shrink to a third to a half, decoding runs at about 1 GB/s per
+   * thread directly into the staging memory. Existing cache files are read
+   * whether they are compressed or not.
+   */
+  bool compressCache = false;
+
+  /**
+   * @brief Lets the device copy uncompressed cache data straight from the
+   * mapped cache file instead of staging it. Only takes effect with
+   * VK_EXT_external_memory_host.
+   */
+  bool importCache = true;
+
+  /**
+   * @brief Layout of the imported vertices. Defaults to full precision
+   * position, color, texture coordinate and normal (44 bytes). A compact
+   * alternative with 20 bytes per vertex would be a SIGNED_FLOAT position,
+   * HALF_FLOAT texture coordinates and an octahedral SIGNED_NORM_16 normal
+   * with two components, which the vertex shader has to decode. Tangents are
+   * generated for OBJ files if the layout contains them, other formats get
+   * (1, 0, 0, 1).
+   */
+  VertexLayout vertexLayout = {
+      {VertexSemantic::ePosition, AttributeType::SIGNED_FLOAT, 3},
+      {VertexSemantic::eColor, AttributeType::SIGNED_FLOAT, 3},
+      {VertexSemantic::eTexCoord, AttributeType::SIGNED_FLOAT, 2},
+      {VertexSemantic::eNormal, AttributeType::SIGNED_FLOAT, 3}};
+
+  /**
+   * @brief Meshes with more than 65536 vertices are split into ranges that can
+   * be drawn with 16 bit indices, if that saves memory. Vertices shared between
+   * ranges are duplicated.
+   */
+  bool splitIndexRanges = true;
+
+  /**
+   * @brief Generates smooth normals for OBJ models that have none instead of
+   * skipping them. Faces that share a position share its normal. Models
+   * without texture coordinates get (0, 0).
+   */
+  NormalGeneration normalGeneration = NormalGeneration::eNone;
+
+  /**
+   * @brief Packs all objects of a file into one vertex and index buffer and
+   * returns one mesh per group, in file order. Groups are started by 'g' and
+   * 'usemtl' lines. Every group is optimized and simplified on its own but
+   * only draws a range of the shared buffers, which are bound once for
+   * consecutive draws.
+   */
+  bool packGroups = false;
+
+  /**
+   * @brief Optimizations applied to every imported mesh. Optimized data is
+   * cached, so the cost is only paid once.
+   */
+  MeshOptimizationOptions optimization;
+
+  /**
+   * @brief Levels of detail generated for every imported mesh. Generated
+   * levels are cached, so the cost is only paid once.
+   */
+  MeshLodOptions lod;
+
+  /**
+   * @brief If set, receives the base color texture of every imported mesh, or
+   * null for meshes without one. Only formats with materials provide them.
+   */
+  std::vector<SharedImage> *baseColorTextures = nullptr;
+
+  /**
+   * @brief If set, receives statistics about the import.
+   */
+  MeshImportStatistics *statistics = nullptr;
+};
+
 } // namespace SVEL_NAMESPACE
 
 #endif /* __SVEL_DETAIL_MESH_H__ */
\ No newline at end of file
@@ -22,10 +22,18 @@
 namespace SVEL_NAMESPACE {
 
 /**
- * @brief Attribute Type for vertex descriptions.
+ * @brief Attribute Type for vertex descriptions. Normalized types are converted
+ * to floats in [-1, 1] (signed) or [0, 1] (unsigned) by the device.
  */
 enum class AttributeType {
   SIGNED_FLOAT,
+  HALF_FLOAT,
+  SIGNED_NORM_8,
+  SIGNED_NORM_16,
+  UNSIGNED_NORM_8,
+  UNSIGNED_NORM_16,
+  SIGNED_NORM_10_10_10_2,  // Packed into 32 bit, count has to be 4
+  UNSIGNED_NORM_10_10_10_2 // Packed into 32 bit, count has to be 4
 };
 
 /**
@@ -22,7 +22,10 @@
 #include <svel/util/array_proxy.hpp>
 
 // STL
+#include <future>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace SVEL_NAMESPACE {
 
@@ -113,10 +116,13 @@ public:
    * @param nodes       The vertex data. Must be valid with the pipeline vertex
    *                    layout.
    * @param indices     The indices data.
+   * @param options     Optimizations to apply before the upload. The provided
+   *                    data is not modified.
    * @return SharedMesh The created Mesh.
    */
-  virtual SharedMesh CreateMesh(const ArrayProxy &nodes,
-                                const std::vector<uint16_t> &indices) = 0;
+  virtual SharedMesh
+  CreateMesh(const ArrayProxy &nodes, const std::vector<uint16_t> &indices,
+             const MeshOptimizationOptions &options = {}) = 0;
 
   /**
    * @brief Create a Mesh with large indice count.
@@ -124,20 +130,121 @@ public:
    * @param nodes       The vertex data. Must be valid with the pipeline vertex
    *                    layout.
    * @param indices     The indices data.
+   * @param options     Optimizations to apply before the upload. The provided
+   *                    data is not modified.
    * @return SharedMesh The created Mesh.
    */
-  virtual SharedMesh CreateMesh(const ArrayProxy &nodes,
-                                const std::vector<uint32_t> &indices) = 0;
+  virtual SharedMesh
+  CreateMesh(const ArrayProxy &nodes, const std::vector<uint32_t> &indices,
+             const MeshOptimizationOptions &options = {}) = 0;
 
   /**
    * @brief EXPERIMENTAL: Load OBJ file and creat meshes from it. Currently
    * limited support.
    *
    * @param objFile                   The OBJ-File to load.
+   * @param options                   Options for the import.
    * @return std::vector<SharedMesh>  All of the meshes contained within the
    *                                  OBJ-File.
    */
-  virtual std::vector<SharedMesh> LoadObjFile(const std::string &objFile) = 0;
+  virtual std::vector<SharedMesh>
+  LoadObjFile(const std::string &objFile,
+              const MeshImportOptions &options = {}) = 0;
+
+  /**
+   * @brief Load a binary glTF 2.0 file and create a mesh for every triangle
+   * list in it. Vertex and index data is read straight from the mapped file
+   * into the upload, so the data is used as stored. Only the vertex layout,
+   * the base color textures and the statistics of the options apply.
+   *
+   * @param glbFile                   The .glb file to load.
+   * @param options                   Options for the import.
+   * @return std::vector<SharedMesh>  All of the meshes contained within the
+   *                                  file.
+   */
+  virtual std::vector<SharedMesh>
+  LoadGlbFile(const std::string &glbFile,
+              const MeshImportOptions &options = {}) = 0;
+
+  /**
+   * @brief Create a Mesh with small indice count without blocking. The data
+   * is copied before the call returns. Optimizing and staging run on a worker
+   * thread, the upload is submitted by the render loop.
+   *
+   * @param nodes                     The vertex data. Must be valid with the
+   *                                  pipeline vertex layout.
+   * @param indices                   The indices data.
+   * @param options                   Optimizations to apply before the
+   *                                  upload. The statistics are written by
+   *                                  the worker thread.
+   * @return std::future<SharedMesh>  The Mesh once it is staged. Draws are
+   *                                  skipped until IsMeshReady. Discarding the
+   *                                  future waits for the staging.
+   */
+  virtual std::future<SharedMesh>
+  CreateMeshAsync(const ArrayProxy &nodes, const std::vector<uint16_t> &indices,
+                  const MeshOptimizationOptions &options = {}) = 0;
+
+  /**
+   * @brief Create a Mesh with large indice count without blocking. The data
+   * is copied before the call returns. Optimizing and staging run on a worker
+   * thread, the upload is submitted by the render loop.
+   *
+   * @param nodes                     The vertex data. Must be valid with the
+   *                                  pipeline vertex layout.
+   * @param indices                   The indices data.
+   * @param options                   Optimizations to apply before the
+   *                                  upload. The statistics are written by
+   *                                  the worker thread.
+   * @return std::future<SharedMesh>  The Mesh once it is staged. Draws are
+   *                                  skipped until IsMeshReady. Discarding the
+   *                                  future waits for the staging.
+   */
+  virtual std::future<SharedMesh>
+  CreateMeshAsync(const ArrayProxy &nodes, const std::vector<uint32_t> &indices,
+                  const MeshOptimizationOptions &options = {}) = 0;
+
+  /**
+   * @brief EXPERIMENTAL: Load OBJ file without blocking. Parsing and staging
+   * run on a worker thread, the upload is submitted by the render loop.
+   *
+   * @param objFile                                 The OBJ-File to load.
+   * @param options                                 Options for the import.
+   *                                                The statistics are written
+   *                                                by the worker thread.
+   * @return std::future<std::vector<SharedMesh>>  The meshes once they are
+   *                                                staged. Draws are skipped
+   *                                                until IsMeshReady.
+   *                                                Discarding the future waits
+   *                                                for the staging.
+   */
+  virtual std::future<std::vector<SharedMesh>>
+  LoadObjFileAsync(const std::string &objFile,
+                   const MeshImportOptions &options = {}) = 0;
+
+  /**
+   * @brief EXPERIMENTAL: Load several OBJ files concurrently without
+   * blocking. Statistics are not gathered, the statistic pointers of the
+   * options are ignored.
+   *
+   * @param objFiles  The OBJ-Files to load.
+   * @param options   Options for every import.
+   * @return std::vector<std::future<std::vector<SharedMesh>>> The meshes of
+   *                  every file once they are staged, in order of the files.
+   */
+  virtual std::vector<std::future<std::vector<SharedMesh>>>
+  LoadObjFilesAsync(const std::vector<std::string> &objFiles,
+                    const MeshImportOptions &options = {}) = 0;
+
+  /**
+   * @brief Checks if the data of a mesh was uploaded. Meshes that are created
+   * without blocking become ready during a later frame.
+   *
+   * @param mesh    The mesh to check.
+   * @return true   The mesh is drawn.
+   * @return false  The mesh is still uploading and draws are skipped.
+   */
+  virtual bool IsMeshReady(SharedMesh mesh) = 0;
 
   /**
    * @brief Setter for Scene Material. This material will be used once per frame
@@ -154,7 +261,7 @@ public:
    *
    * @param mesh Mesh to draw.
    */
-  virtual void Draw(SharedMesh mesh) = 0;
+  virtual void Draw(const SharedMesh &mesh) = 0;
 
   /**
    * @brief Draw the provided mesh with the material. This assumes that the
@@ -163,7 +270,35 @@ public:
    * @param mesh      Mesh to draw.
    * @param material  The material to use for the mesh.
    */
-  virtual void Draw(SharedMesh mesh, SharedIMaterial material) = 0;
+  virtual void Draw(const SharedMesh &mesh,
+                    const SharedIMaterial &material) = 0;
+
+  /**
+   * @brief Draw the coarsest level of detail of the mesh that looks the same
+   * at the given size on screen. This assumes that no material is required
+   * for drawing.
+   *
+   * @param mesh          Mesh to draw.
+   * @param projectedSize Size of the mesh extent on screen in pixels. For
+   *                      example the projected diameter of its bounding
+   *                      sphere.
+   */
+  virtual void Draw(const SharedMesh &mesh, float projectedSize) = 0;
+
+  /**
+   * @brief Draw the coarsest level of detail of the mesh that looks the same
+   * at the given size on screen with the material. This assumes that the
+   * correct pipeline has been bound.
+   *
+   * @param mesh          Mesh to draw.
+   * @param material      The material to use for the mesh.
+   * @param projectedSize Size of the mesh extent on screen in pixels. For
+   *                      example the projected diameter of its bounding
+   *                      sphere.
+   */
+  virtual void Draw(const SharedMesh &mesh,
+                    const SharedIMaterial &material,
+                    float projectedSize) = 0;
 };
 SVEL_CLASS(Renderer)
 
@@ -66,6 +66,12 @@ public:
    */
   void StartRenderLoop();
 
+  /**
+   * @brief Asks the window to close. The render loop returns after the
+   * current frame.
+   */
+  void Close();
+
   /**
    * @brief Draw method to be implemented by the user.
    */
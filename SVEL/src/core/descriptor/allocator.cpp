@@ -73,20 +73,24 @@ vk::DescriptorSet Allocator::AllocateSet(vk::DescriptorSetLayout &layout) {
 
   vk::DescriptorSetAllocateInfo allocateInfo(pool, layout);
 
-  // Try to allocate the descriptor set
+  // Try to allocate the descriptor set. Sets are allocated while recording,
+  // the single set overload does not allocate a vector for the result.
   vk::DescriptorSet set;
-  try {
-    set = _device->AsVulkanObj().allocateDescriptorSets(allocateInfo).front();
-  } catch (vk::SystemError &err) {
-    // Try allocating new pool - If this fails -> escalates exception
-    // This error is usually caused by the pool being full
-    _usedPools.push_back(pool);
-    _availablePools.pop();
-    if (_availablePools.empty())
-      _allocatePool();
-    allocateInfo.setDescriptorPool(_availablePools.top());
-    set = _device->AsVulkanObj().allocateDescriptorSets(allocateInfo).front();
-  }
+  auto vulkanDevice = _device->AsVulkanObj();
+  if (vulkanDevice.allocateDescriptorSets(&allocateInfo, &set) ==
+      vk::Result::eSuccess)
+    return set;
+
+  // Try allocating new pool - If this fails -> escalates exception
+  // This error is usually caused by the pool being full
+  _usedPools.push_back(pool);
+  _availablePools.pop();
+  if (_availablePools.empty())
+    _allocatePool();
+  allocateInfo.setDescriptorPool(_availablePools.top());
+  if (vulkanDevice.allocateDescriptorSets(&allocateInfo, &set) !=
+      vk::Result::eSuccess)
+    throw std::runtime_error("Failed to allocate descriptor set.");
   return set;
 }
 
@@ -31,21 +31,16 @@ DynamicBuffer::DynamicBuffer(std::shared_ptr<core::Device> device,
   _allocateBuffer();
 }
 
-DynamicBuffer::~DynamicBuffer() {
-  for (const auto &buffer : _buffers)
-    _device->AsVulkanObj().unmapMemory(buffer.second->GetMemory());
-}
-
 void DynamicBuffer::_allocateBuffer() {
   // Create buffer
   auto buffer = std::make_unique<core::Buffer>(
       _device, _bufferSize, _usage,
       vk::MemoryPropertyFlagBits::eHostVisible |
-          vk::MemoryPropertyFlagBits::eHostCoherent);
+          vk::MemoryPropertyFlagBits::eHostCoherent,
+      vk::MemoryPropertyFlagBits::eDeviceLocal);
 
   // Get memory pointer from the buffer
-  void *memoryPointer = _device->AsVulkanObj().mapMemory(
-      buffer->GetMemory(), 0, _bufferSize, vk::MemoryMapFlagBits());
+  void *memoryPointer = buffer->GetMappedData();
 
   // Update buffers and the info
   _buffers.push_back({memoryPointer, std::move(buffer)});
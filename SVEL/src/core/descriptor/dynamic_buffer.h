@@ -114,11 +114,6 @@ public:
   DynamicBuffer(std::shared_ptr<core::Device> device, size_t elementSize,
                 vk::DescriptorType type);
 
-  /**
-   * @brief Destroys the dynamic buffer.
-   */
-  ~DynamicBuffer();
-
   /**
    * @brief Getter for the buffer type.
    *
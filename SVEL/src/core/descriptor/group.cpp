@@ -98,6 +98,7 @@ SetGroup::SetGroup(std::shared_ptr<core::Device> device,
         Set::BindingDetails{detail.bindingId, detail.type, detail.elementSize});
   }
   _createQueue(device, maxFramesInFlight, layoutBindings, bindingDetails);
+  _boundSets.reserve(_queueDetails.size());
   _grabSets();
 }
 
@@ -114,17 +115,15 @@ void SetGroup::NotifyNewFrame() {
 
 void SetGroup::Bind(vk::CommandBuffer &commandBuffer,
                     const vk::PipelineLayout &layout) {
-  std::vector<vk::DescriptorSet> sets;
-  std::vector<uint32_t> offsets;
-
-  // Fill structures
-  sets.reserve(_queueDetails.size());
+  // Fill structures, clearing keeps the storage of earlier binds
+  _boundSets.clear();
+  _boundOffsets.clear();
   for (const auto &detail : _queueDetails)
-    sets.emplace_back(detail.currentSet->Get(offsets));
+    _boundSets.emplace_back(detail.currentSet->Get(_boundOffsets));
 
   // Record to buffer
   commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, layout, 0,
-                                   sets, offsets);
+                                   _boundSets, _boundOffsets);
 }
 
 const std::vector<vk::DescriptorSetLayout> &SetGroup::GetLayouts() {
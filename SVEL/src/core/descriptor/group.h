@@ -28,6 +28,7 @@
 
 // STL
 #include <unordered_map>
+#include <vector>
 
 namespace core::descriptor {
 
@@ -88,6 +89,18 @@ private:
    */
   std::unordered_map<uint64_t, std::shared_ptr<WriteHandler>> _writeHandlers;
 
+  /**
+   * @brief Descriptor sets of the last bind. Kept between binds so that their
+   * storage is reused by every draw.
+   */
+  std::vector<vk::DescriptorSet> _boundSets;
+
+  /**
+   * @brief Dynamic offsets of the last bind. Kept between binds so that their
+   * storage is reused by every draw.
+   */
+  std::vector<uint32_t> _boundOffsets;
+
   /**
    * @brief Create a new queue and fills it with copies of a set that will be
    * created as well.
@@ -13,6 +13,9 @@
 #include "dynamic_buffer.h"
 #include "static_buffer.h"
 
+// STL
+#include <iterator>
+
 using namespace core::descriptor;
 
 uint32_t Set::VectorHasher::operator()(const std::vector<uint32_t> &V) const {
@@ -91,31 +94,38 @@ SharedIBuffer Set::GetBuffer(uint32_t binding) { return _buffers[binding]; }
 vk::DescriptorSet Set::Get(std::vector<uint32_t> &out_offsets) {
   // Append Offsets
   if (_dynamicBuffers.size() > 0)
-    for (auto dynBuffer : _dynamicBuffers)
+    for (const auto &dynBuffer : _dynamicBuffers)
       out_offsets.push_back(dynBuffer->GetBufferOffset());
 
   // Check if we actually are required to look into the cache
   if (!_isBaseDescriptorSetOutdated)
     return _baseDescriptorSet;
 
-  // Check Cache
+  // Check Cache, entries of earlier uses keep their key but not their set
   auto it = _descriptorSetCache.find(_setIdentifiers);
-  if (it == _descriptorSetCache.end()) {
-    // We need to allocate a new descriptorSet
-    auto set = _dynamicAllocator->AllocateSet(_layout);
-    for (auto &writeSet : _writeSets)
-      writeSet.setDstSet(set);
-    _device->AsVulkanObj().updateDescriptorSets(_writeSets, {});
-    _descriptorSetCache[_setIdentifiers] = set;
-    return set;
-  }
-  return it->second;
+  if (it != _descriptorSetCache.end() && it->second.use == _useCount)
+    return it->second.set;
+
+  // We need to allocate a new descriptorSet
+  auto set = _dynamicAllocator->AllocateSet(_layout);
+  for (auto &writeSet : _writeSets)
+    writeSet.setDstSet(set);
+  _device->AsVulkanObj().updateDescriptorSets(_writeSets, {});
+  if (it != _descriptorSetCache.end())
+    it->second = {set, _useCount};
+  else
+    _descriptorSetCache[_setIdentifiers] = {set, _useCount};
+  return set;
 }
 
 void Set::Reset() {
-  // Clear Pool and Descriptor Sets
+  // Clear Pool and Descriptor Sets. Keys that were not used since the last
+  // reset are dropped, the others are likely needed again.
   _dynamicAllocator->ResetPools();
-  _descriptorSetCache.clear();
+  for (auto it = _descriptorSetCache.begin(); it != _descriptorSetCache.end();)
+    it = it->second.use == _useCount ? std::next(it)
+                                     : _descriptorSetCache.erase(it);
+  _useCount++;
 
   // Reset Dynamic Buffers
   for (auto &buffer : _dynamicBuffers)
@@ -142,7 +152,7 @@ void Set::Reset() {
 void Set::NotifyBufferChange(uint32_t binding) {
   // Get index of this binding
   uint32_t index = _bindingToWriteSetMapping[binding];
-  auto buffer = _buffers[binding];
+  const auto &buffer = _buffers[binding];
 
   // Update Indices and writeSet
   _setIdentifiers[index] = buffer->GetBufferIndex();
@@ -95,15 +95,37 @@ private:
    */
   vk::DescriptorSet _baseDescriptorSet;
 
+  /**
+   * @brief Descriptor set of the cache and the use of the set that wrote it.
+   */
+  struct CachedSet {
+    /**
+     * @brief The descriptor set.
+     */
+    vk::DescriptorSet set;
+
+    /**
+     * @brief Value of _useCount when the set was allocated. Sets of earlier
+     * uses were freed by Reset.
+     */
+    uint64_t use;
+  };
+
   /**
    * @brief Cache for all the descriptor sets that were allocated. Key is a
    * vector of identifiers that uniquely represent the buffer status of the set.
    * Every change that requires a write set change has to conclude in a new set.
-   * To allow reuse of sets, use the cache.
+   * To allow reuse of sets, use the cache. Entries outlive Reset as long as
+   * their key is used every time, so that steady frames do not allocate keys.
    */
-  std::unordered_map<std::vector<uint32_t>, vk::DescriptorSet, VectorHasher>
+  std::unordered_map<std::vector<uint32_t>, CachedSet, VectorHasher>
       _descriptorSetCache;
 
+  /**
+   * @brief Counts the Resets of the set.
+   */
+  uint64_t _useCount = 0;
+
   /**
    * @brief All static buffers that the set refers to.
    */
@@ -189,7 +211,8 @@ public:
   /**
    * @brief Getter for the currently used descriptor set. Will also return all
    * offsets of the set. Sets may get allocated here internally. TODO: Sets
-   * should probably be allocated somewhere else.
+   * should probably be allocated somewhere else. Does not allocate host
+   * memory once the same sets were used in the previous frame.
    *
    * @param out_offsets         Offsets of the set.
    * @return vk::DescriptorSet  The current descriptor set.
@@ -20,21 +20,17 @@ StaticBuffer::StaticBuffer(core::SharedDevice device,
   _buffer = std::make_unique<core::Buffer>(
       _device, size, _getUsage(_descriptorType),
       vk::MemoryPropertyFlagBits::eHostVisible |
-          vk::MemoryPropertyFlagBits::eHostCoherent);
+          vk::MemoryPropertyFlagBits::eHostCoherent,
+      vk::MemoryPropertyFlagBits::eDeviceLocal);
 
   // Get the memory pointer from the buffer.
-  _memoryPointer = device->AsVulkanObj().mapMemory(
-      _buffer->GetMemory(), 0, size, vk::MemoryMapFlagBits());
+  _memoryPointer = _buffer->GetMappedData();
 
   // Update the buffer info of the base class
   _bufferInfo =
       vk::DescriptorBufferInfo(_buffer->AsVulkanObj(), vk::DeviceSize(0), size);
 }
 
-StaticBuffer::~StaticBuffer() {
-  _device->AsVulkanObj().unmapMemory(_buffer->GetMemory());
-}
-
 vk::DescriptorType StaticBuffer::GetType() const { return _descriptorType; }
 
 StaticBuffer::WriteResult StaticBuffer::Write(void *_data) {
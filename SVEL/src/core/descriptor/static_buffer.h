@@ -62,11 +62,6 @@ public:
   StaticBuffer(core::SharedDevice device, vk::DescriptorType descriptorType,
                size_t size);
 
-  /**
-   * @brief Destroy the Static Buffer
-   */
-  ~StaticBuffer();
-
   /**
    * @brief Getter for the type of the buffer.
    *
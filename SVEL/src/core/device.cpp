@@ -107,6 +107,37 @@ core::Device::findQueueFamilies(vk::PhysicalDevice device,
   return {};
 }
 
+unsigned int core::Device::findTransferQueueFamily(vk::PhysicalDevice device) {
+  auto props = device.getQueueFamilyProperties();
+  unsigned int transferFamily = _queueFamilyGraphics;
+  bool transferOnly = false;
+  for (unsigned int i = 0; i < props.size(); i++) {
+    auto flags = props.at(i).queueFlags;
+    if (props.at(i).queueCount == 0 || (flags & vk::QueueFlagBits::eGraphics))
+      continue;
+
+    // Compute families always support transfers, even if they do not say so
+    if (flags & vk::QueueFlagBits::eCompute) {
+      if (transferFamily == _queueFamilyGraphics)
+        transferFamily = i;
+    } else if ((flags & vk::QueueFlagBits::eTransfer) && !transferOnly) {
+      transferFamily = i;
+      transferOnly = true;
+    }
+  }
+  return transferFamily;
+}
+
+bool core::Device::enableOptionalExtension(const char *name) {
+  for (const auto &extension :
+       _selectedPhysicalDevice.enumerateDeviceExtensionProperties())
+    if (std::strcmp(extension.extensionName, name) == 0) {
+      _extensions.push_back(name);
+      return true;
+    }
+  return false;
+}
+
 core::Device::Device(core::SharedInstance instance, core::SharedSurface surface)
     : _instance(instance), _surface(surface) {
   // Append Extensions
@@ -136,6 +167,25 @@ core::Device::Device(core::SharedInstance instance, core::SharedSurface surface)
   }
   if (!physicalDeviceFound)
     throw std::runtime_error("No Physical Device fits Queue constraints.");
+  _queueFamilyTransfer = findTransferQueueFamily(_selectedPhysicalDevice);
+
+  // Budgets let the allocator react to the memory use of other processes
+  const bool memoryBudget =
+      _selectedPhysicalDevice.getProperties().apiVersion >=
+          VK_API_VERSION_1_1 &&
+      enableOptionalExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+  // Mapped files can be imported as transfer sources instead of staged
+  if (_selectedPhysicalDevice.getProperties().apiVersion >=
+          VK_API_VERSION_1_1 &&
+      enableOptionalExtension(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME)) {
+    const auto properties = _selectedPhysicalDevice.getProperties2<
+        vk::PhysicalDeviceProperties2,
+        vk::PhysicalDeviceExternalMemoryHostPropertiesEXT>();
+    _hostPointerAlignment =
+        properties.get<vk::PhysicalDeviceExternalMemoryHostPropertiesEXT>()
+            .minImportedHostPointerAlignment;
+  }
 
   // Setup Logical Device
   _queuePriorities = std::vector<float>(_queueCount, 1.0f);
@@ -143,9 +193,22 @@ core::Device::Device(core::SharedInstance instance, core::SharedSurface surface)
                                             _queueFamilyGraphics, _queueCount,
                                             &_queuePriorities[0]);
   std::vector<vk::DeviceQueueCreateInfo> deviceQueueInfos = {deviceQueueInfo};
+  if (_queueFamilyTransfer != _queueFamilyGraphics)
+    deviceQueueInfos.emplace_back(vk::DeviceQueueCreateFlagBits(),
+                                  _queueFamilyTransfer, 1,
+                                  &_queuePriorities[0]);
   vk::DeviceCreateInfo deviceInfo(vk::DeviceCreateFlagBits(), deviceQueueInfos,
                                   {}, _extensions, &_features);
   _vulkanObj = _selectedPhysicalDevice.createDevice(deviceInfo);
+  _memoryAllocator = std::make_unique<MemoryAllocator>(
+      _vulkanObj, _selectedPhysicalDevice, memoryBudget);
+  _stagingRing = std::make_unique<StagingRing>(
+      _vulkanObj, *_memoryAllocator,
+      SVEL_STAGING_RING_FRAME_SIZE * SVEL_MAX_FRAMES_IN_FLIGHT);
 }
 
-core::Device::~Device() { _vulkanObj.destroy(); }
\ No newline at end of file
+core::Device::~Device() {
+  _stagingRing.reset();
+  _memoryAllocator.reset();
+  _vulkanObj.destroy();
+}
\ No newline at end of file
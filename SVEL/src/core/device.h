@@ -15,8 +15,13 @@
 #include "surface.h"
 
 // Internal
+#include <core/memory/memory_allocator.h>
+#include <core/memory/staging_ring.h>
 #include <util/vulkan_object.hpp>
 
+// STL
+#include <memory>
+
 namespace core {
 
 /**
@@ -60,6 +65,12 @@ private:
    */
   unsigned int _queueFamilyPresent;
 
+  /**
+   * @brief The Queue family responsible for uploads. Equals the graphics
+   * family if the device has no separate transfer or compute family.
+   */
+  unsigned int _queueFamilyTransfer;
+
   /**
    * @brief How many queues are available.
    */
@@ -70,6 +81,22 @@ private:
    */
   vk::PhysicalDevice _selectedPhysicalDevice;
 
+  /**
+   * @brief Required alignment of imported host pointers, 0 if host memory
+   * cannot be imported.
+   */
+  vk::DeviceSize _hostPointerAlignment = 0;
+
+  /**
+   * @brief Sub-allocates the memory of all resources of the device.
+   */
+  std::unique_ptr<MemoryAllocator> _memoryAllocator;
+
+  /**
+   * @brief Staging memory shared by all uploads.
+   */
+  std::unique_ptr<StagingRing> _stagingRing;
+
   /**
    * @brief Prioritize all the Physical Devices.
    *
@@ -89,6 +116,26 @@ private:
   std::pair<unsigned int, unsigned int>
   findQueueFamilies(vk::PhysicalDevice device, uint32_t &constraintQueueCount);
 
+  /**
+   * @brief Find a Queue Family without graphics support that can transfer.
+   * Transfer only families are preferred over compute families, as they
+   * usually map to the dedicated copy engines.
+   *
+   * @param device        Physical Device to use.
+   * @return unsigned int The transfer family, or the graphics family if there
+   *                      is no other family.
+   */
+  unsigned int findTransferQueueFamily(vk::PhysicalDevice device);
+
+  /**
+   * @brief Enables an extension if the selected physical device supports it.
+   *
+   * @param name    Name of the extension.
+   * @return true   The extension is enabled.
+   * @return false  The extension is not supported.
+   */
+  bool enableOptionalExtension(const char *name);
+
 public:
   /**
    * @brief Construct a Device with the provided instance and surface.
@@ -135,6 +182,36 @@ public:
    * @return uint32_t The PresentQueueFamily to use.
    */
   uint32_t GetPresentQueueFamily() { return _queueFamilyPresent; }
+
+  /**
+   * @brief Getter for Transfer Queue Family. Uploads are submitted to the
+   * first queue of this family.
+   *
+   * @return uint32_t The TransferQueueFamily to use.
+   */
+  uint32_t GetTransferQueueFamily() { return _queueFamilyTransfer; }
+
+  /**
+   * @brief Getter for the Memory Allocator.
+   *
+   * @return MemoryAllocator& The allocator of the device.
+   */
+  MemoryAllocator &GetMemoryAllocator() { return *_memoryAllocator; }
+
+  /**
+   * @brief Getter for the alignment of host pointers that are imported
+   * through VK_EXT_external_memory_host.
+   *
+   * @return vk::DeviceSize The alignment, 0 if the extension is unavailable.
+   */
+  vk::DeviceSize GetHostPointerAlignment() { return _hostPointerAlignment; }
+
+  /**
+   * @brief Getter for the Staging Ring.
+   *
+   * @return StagingRing& The staging ring of the device.
+   */
+  StagingRing &GetStagingRing() { return *_stagingRing; }
 };
 SVEL_CLASS(Device)
 
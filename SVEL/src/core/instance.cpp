@@ -56,9 +56,10 @@ core::Instance::Instance(const std::string &appName, uint32_t appVersion,
   _setupInstanceValidationLayers();
 #endif
 
-  // Setup instance
+  // Setup instance, 1.1 is needed to query memory budgets
   vk::ApplicationInfo appInfo(_appName.c_str(), _appVersion,
-                              _engineName.c_str(), _engineVersion);
+                              _engineName.c_str(), _engineVersion,
+                              VK_API_VERSION_1_1);
 
   vk::InstanceCreateInfo instanceInfo(vk::InstanceCreateFlagBits(), &appInfo,
                                       _layers, _extensions);
@@ -0,0 +1,130 @@
+/**
+ * @file buddy_block.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the BuddyBlock.
+ * @date 2023-09-30
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "buddy_block.h"
+
+// STL
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @brief Computes the log2 of a power of two.
+ *
+ * @param value     The power of two.
+ * @return uint32_t The exponent.
+ */
+static uint32_t _log2(uint64_t value) {
+  uint32_t exponent = 0;
+  while (((uint64_t)1 << exponent) < value)
+    exponent++;
+  return exponent;
+}
+
+/**
+ * @brief Checks for a power of two.
+ *
+ * @param value   Value to check.
+ * @return true   Value is a power of two.
+ * @return false  Otherwise.
+ */
+static bool _isPowerOfTwo(uint64_t value) {
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+uint32_t core::BuddyBlock::_getOrder(uint64_t size) const {
+  const uint32_t shift = _log2(size);
+  return shift > _minShift ? shift - _minShift : 0;
+}
+
+core::BuddyBlock::BuddyBlock(uint64_t size, uint64_t minSize) {
+  if (!_isPowerOfTwo(size) || !_isPowerOfTwo(minSize) || minSize > size)
+    throw std::invalid_argument("Buddy block sizes have to be powers of two.");
+  _minShift = _log2(minSize);
+  _maxOrder = _log2(size) - _minShift;
+  if (_maxOrder > 30)
+    throw std::invalid_argument("Buddy block has too many ranges.");
+
+  // Every node starts out completely free
+  _longest.resize(((size_t)2 << _maxOrder) - 1);
+  for (uint32_t depth = 0; depth <= _maxOrder; depth++) {
+    const size_t first = ((size_t)1 << depth) - 1;
+    std::fill(_longest.begin() + (ptrdiff_t)first,
+              _longest.begin() + (ptrdiff_t)(2 * first + 1),
+              (uint8_t)(_maxOrder - depth + 1));
+  }
+}
+
+uint64_t core::BuddyBlock::Allocate(uint64_t size, uint64_t alignment) {
+  if (size == 0 || !_isPowerOfTwo(alignment))
+    throw std::invalid_argument("Invalid buddy allocation.");
+
+  // Ranges are aligned to their own size
+  const uint32_t order = _getOrder(std::max(size, alignment));
+  if (order > _maxOrder || _longest[0] < order + 1)
+    return INVALID_OFFSET;
+
+  // Descend into the first subtree that fits
+  size_t node = 0;
+  for (uint32_t nodeOrder = _maxOrder; nodeOrder > order; nodeOrder--) {
+    const size_t left = 2 * node + 1;
+    node = _longest[left] >= order + 1 ? left : left + 1;
+  }
+  _longest[node] = 0;
+
+  const size_t first = ((size_t)1 << (_maxOrder - order)) - 1;
+  const uint64_t offset = (uint64_t)(node - first) << (order + _minShift);
+
+  // Ancestors offer the larger of their children, the update stops as soon
+  // as an ancestor does not change
+  while (node != 0) {
+    node = (node - 1) / 2;
+    const uint8_t longest =
+        std::max(_longest[2 * node + 1], _longest[2 * node + 2]);
+    if (_longest[node] == longest)
+      break;
+    _longest[node] = longest;
+  }
+
+  _usedSize += (uint64_t)1 << (order + _minShift);
+  _allocationCount++;
+  return offset;
+}
+
+void core::BuddyBlock::Free(uint64_t offset, uint64_t size,
+                            uint64_t alignment) {
+  const uint32_t order = _getOrder(std::max(size, alignment));
+  const size_t first = ((size_t)1 << (_maxOrder - order)) - 1;
+  size_t node = first + (size_t)(offset >> (order + _minShift));
+  if (order > _maxOrder || node >= _longest.size() || _longest[node] != 0)
+    throw std::invalid_argument("Range was not allocated from this block.");
+  _longest[node] = (uint8_t)(order + 1);
+
+  // Two free buddies merge into their parent
+  for (uint32_t nodeOrder = order + 1; node != 0; nodeOrder++) {
+    node = (node - 1) / 2;
+    const uint8_t left = _longest[2 * node + 1];
+    const uint8_t right = _longest[2 * node + 2];
+    const uint8_t longest = left == nodeOrder && right == nodeOrder
+                                ? (uint8_t)(nodeOrder + 1)
+                                : std::max(left, right);
+    if (_longest[node] == longest)
+      break;
+    _longest[node] = longest;
+  }
+
+  _usedSize -= (uint64_t)1 << (order + _minShift);
+  _allocationCount--;
+}
+
+uint64_t core::BuddyBlock::GetLargestFree() const {
+  return _longest[0] == 0 ? 0
+                          : (uint64_t)1 << (_longest[0] - 1 + _minShift);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file buddy_block.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declaration of BuddyBlock.
+ * @date 2023-09-30
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __CORE_MEMORY_BUDDY_BLOCK_H__
+#define __CORE_MEMORY_BUDDY_BLOCK_H__
+
+// STL
+#include <cstdint>
+#include <vector>
+
+namespace core {
+
+/**
+ * @brief Hands out ranges of a block with the buddy system. Ranges are powers
+ * of two that start at a multiple of their size, so every alignment up to the
+ * range size is met for free. The state is a binary tree over the block where
+ * every node knows the largest free range below it, which makes allocating and
+ * freeing O(log n). Only offsets are managed, the memory itself is owned by
+ * the caller.
+ */
+class BuddyBlock {
+private:
+  /**
+   * @brief Per node one more than the order of the largest free range in its
+   * subtree, 0 if nothing is free. Order 0 is the minimum range size.
+   */
+  std::vector<uint8_t> _longest;
+
+  /**
+   * @brief Order of the whole block.
+   */
+  uint32_t _maxOrder;
+
+  /**
+   * @brief Log2 of the minimum range size.
+   */
+  uint32_t _minShift;
+
+  /**
+   * @brief Bytes of all handed out ranges.
+   */
+  uint64_t _usedSize = 0;
+
+  /**
+   * @brief Amount of handed out ranges.
+   */
+  uint32_t _allocationCount = 0;
+
+  /**
+   * @brief Computes the order of the smallest range that fits.
+   *
+   * @param size      Size in bytes.
+   * @return uint32_t The order.
+   */
+  uint32_t _getOrder(uint64_t size) const;
+
+public:
+  /**
+   * @brief Returned if a request does not fit.
+   */
+  static constexpr uint64_t INVALID_OFFSET = UINT64_MAX;
+
+  /**
+   * @brief Construct a BuddyBlock.
+   *
+   * @param size    Size of the block, a power of two.
+   * @param minSize Smallest range that is handed out, a power of two. Requests
+   *                are rounded up to it.
+   */
+  BuddyBlock(uint64_t size, uint64_t minSize);
+
+  /**
+   * @brief Reserves a range.
+   *
+   * @param size      Size in bytes.
+   * @param alignment Required alignment of the offset, a power of two.
+   * @return uint64_t Offset of the range or INVALID_OFFSET if nothing fits.
+   */
+  uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+  /**
+   * @brief Releases a range, merging it with its free buddies.
+   *
+   * @param offset    Offset returned by Allocate.
+   * @param size      Size in bytes.
+   * @param alignment Alignment the range was allocated with.
+   */
+  void Free(uint64_t offset, uint64_t size, uint64_t alignment);
+
+  /**
+   * @brief Getter for the size of the block.
+   *
+   * @return uint64_t Size in bytes.
+   */
+  uint64_t GetSize() const { return (uint64_t)1 << (_maxOrder + _minShift); }
+
+  /**
+   * @brief Getter for the bytes of all handed out ranges, including the
+   * rounding to powers of two.
+   *
+   * @return uint64_t Size in bytes.
+   */
+  uint64_t GetUsedSize() const { return _usedSize; }
+
+  /**
+   * @brief Getter for the largest range that can currently be allocated.
+   *
+   * @return uint64_t Size in bytes, 0 if the block is full.
+   */
+  uint64_t GetLargestFree() const;
+
+  /**
+   * @brief Getter for the amount of handed out ranges.
+   *
+   * @return uint32_t The amount.
+   */
+  uint32_t GetAllocationCount() const { return _allocationCount; }
+
+  /**
+   * @brief Checks whether no range is handed out.
+   *
+   * @return true   The block is unused.
+   * @return false  Otherwise.
+   */
+  bool IsEmpty() const { return _allocationCount == 0; }
+};
+
+} // namespace core
+
+#endif /* __CORE_MEMORY_BUDDY_BLOCK_H__ */
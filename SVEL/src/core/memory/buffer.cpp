@@ -24,7 +24,8 @@
 
 core::Buffer::Buffer(core::SharedDevice device, size_t size,
                      vk::BufferUsageFlags usage,
-                     vk::MemoryPropertyFlags memFlags)
+                     vk::MemoryPropertyFlags memFlags,
+                     vk::MemoryPropertyFlags preferredMem)
     : _device(device), _size(size) {
   auto vulkanDevice = device->AsVulkanObj();
 
@@ -37,12 +38,11 @@ core::Buffer::Buffer(core::SharedDevice device, size_t size,
   auto memoryRequirements =
       vulkanDevice.getBufferMemoryRequirements(_vulkanObj);
   _memory = std::make_unique<core::DeviceMemory>(device, memoryRequirements,
-                                                 memFlags);
-  vulkanDevice.bindBufferMemory(_vulkanObj, _memory->AsVulkanObj(), 0);
+                                                 memFlags, preferredMem);
+  vulkanDevice.bindBufferMemory(_vulkanObj, _memory->AsVulkanObj(),
+                               _memory->GetOffset());
 }
 
 core::Buffer::~Buffer() { _device->AsVulkanObj().destroyBuffer(_vulkanObj); }
 
-const vk::DeviceMemory &core::Buffer::GetMemory() {
-  return _memory->AsVulkanObj();
-}
+void *core::Buffer::GetMappedData() { return _memory->GetMappedData(); }
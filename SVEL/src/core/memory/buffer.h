@@ -48,13 +48,15 @@ public:
   /**
    * @brief Construct a Buffer
    *
-   * @param device    Device to use.
-   * @param size      Size of the Buffer.
-   * @param usage     Usage of the Buffer.
-   * @param memFlags  What memory to use.
+   * @param device        Device to use.
+   * @param size          Size of the Buffer.
+   * @param usage         Usage of the Buffer.
+   * @param memFlags      Properties the memory must have.
+   * @param preferredMem  Properties the memory should have.
    */
   Buffer(SharedDevice device, size_t size, vk::BufferUsageFlags usage,
-         vk::MemoryPropertyFlags memFlags);
+         vk::MemoryPropertyFlags memFlags,
+         vk::MemoryPropertyFlags preferredMem = {});
 
   Buffer(const Buffer &) = delete;
 
@@ -64,11 +66,12 @@ public:
   ~Buffer();
 
   /**
-   * @brief Getter for Memory.
+   * @brief Getter for the mapped memory of host visible buffers. The memory
+   * stays mapped for the lifetime of the buffer.
    *
-   * @return const vk::DeviceMemory& The memory reference.
+   * @return void* Start of the buffer or nullptr if not host visible.
    */
-  const vk::DeviceMemory &GetMemory();
+  void *GetMappedData();
 };
 SVEL_CLASS(Buffer)
 
@@ -11,32 +11,31 @@
 // Local
 #include "device_memory.h"
 
-uint32_t
-core::DeviceMemory::_findMemoryType(vk::MemoryPropertyFlags memoryFlags,
-                                    uint32_t memoryTypeBits) {
-  // Fetch memory properties
-  auto memoryProps = _device->GetPhysicalDevice().getMemoryProperties();
+core::DeviceMemory::DeviceMemory(core::SharedDevice device,
+                                 const vk::MemoryRequirements &requirements,
+                                 vk::MemoryPropertyFlags properties,
+                                 vk::MemoryPropertyFlags preferred,
+                                 bool linear)
+    : _device(device) {
+  _allocation = device->GetMemoryAllocator().Allocate(
+      requirements, properties, preferred, linear);
+  _vulkanObj = _allocation.memory;
+}
 
-  // Iterate through memory properties to find valid memory type
-  for (unsigned int i = 0; i < memoryProps.memoryTypeCount; i++)
-    if ((memoryTypeBits & (1 << i)) &&
-        (memoryProps.memoryTypes[i].propertyFlags & memoryFlags))
-      return i;
-  throw std::runtime_error("Could not find proper memory type.");
+core::DeviceMemory::DeviceMemory(
+    core::SharedDevice device, const MemoryAllocator::Allocation &allocation)
+    : _device(device), _allocation(allocation) {
+  _vulkanObj = _allocation.memory;
 }
 
-core::DeviceMemory::DeviceMemory(core::SharedDevice device,
-                                 vk::MemoryRequirements &requirements,
-                                 vk::MemoryPropertyFlags properties)
-    : _device(device) {
-  // Allocate vulkan memory
-  auto vulkanDevice = device->AsVulkanObj();
-  vk::MemoryAllocateInfo allocateInfo(
-      requirements.size,
-      _findMemoryType(properties, requirements.memoryTypeBits));
-  _vulkanObj = vulkanDevice.allocateMemory(allocateInfo);
+std::unique_ptr<core::DeviceMemory>
+core::DeviceMemory::AllocateMoveTarget() const {
+  auto target = _device->GetMemoryAllocator().AllocateMove(_allocation);
+  if (!target.memory)
+    return nullptr;
+  return std::unique_ptr<DeviceMemory>(new DeviceMemory(_device, target));
 }
 
 core::DeviceMemory::~DeviceMemory() {
-  _device->AsVulkanObj().freeMemory(_vulkanObj);
-}
\ No newline at end of file
+  _device->GetMemoryAllocator().Free(_allocation);
+}
@@ -18,10 +18,15 @@
 // Vulkan
 #include <vulkan/vulkan.hpp>
 
+// STL
+#include <memory>
+
 namespace core {
 
 /**
- * @brief Basic Wrapper around vulkan memory.
+ * @brief Range of vulkan memory that is sub-allocated by the memory allocator
+ * of the device. Resources have to be bound at GetOffset() within the wrapped
+ * memory, which is shared with other resources.
  */
 class DeviceMemory : public util::VulkanAdapter<vk::DeviceMemory> {
 private:
@@ -31,14 +36,18 @@ private:
   SharedDevice _device;
 
   /**
-   * @brief Finds an appropriate memory type for the given flags and type bits.
+   * @brief The allocated range.
+   */
+  MemoryAllocator::Allocation _allocation;
+
+  /**
+   * @brief Construct Memory that takes over an allocation.
    *
-   * @param memoryFlags     Memory Flags to search for.
-   * @param memoryTypeBits  Memory Type Bits to search for.
-   * @return uint32_t       Found memory type
+   * @param device      Device to use.
+   * @param allocation  The allocation.
    */
-  uint32_t _findMemoryType(vk::MemoryPropertyFlags memoryFlags,
-                           uint32_t memoryTypeBits);
+  DeviceMemory(SharedDevice device,
+               const MemoryAllocator::Allocation &allocation);
 
 public:
   /**
@@ -46,10 +55,15 @@ public:
    *
    * @param device        Device to use.
    * @param requirements  Requirements put on the memory.
-   * @param properties    Properties of the memory.
+   * @param properties    Properties the memory must have.
+   * @param preferred     Properties the memory should have, see
+   *                      MemoryAllocator::Allocate.
+   * @param linear        Whether the memory is used by a buffer or a linear
+   *                      image, which matters for bufferImageGranularity.
    */
-  DeviceMemory(SharedDevice device, vk::MemoryRequirements &requirements,
-               vk::MemoryPropertyFlags properties);
+  DeviceMemory(SharedDevice device, const vk::MemoryRequirements &requirements,
+               vk::MemoryPropertyFlags properties,
+               vk::MemoryPropertyFlags preferred = {}, bool linear = true);
 
   DeviceMemory(const DeviceMemory &) = delete;
 
@@ -57,6 +71,37 @@ public:
    * @brief Destroy the Memory.
    */
   ~DeviceMemory();
+
+  /**
+   * @brief Getter for the offset at which the resource has to be bound.
+   *
+   * @return vk::DeviceSize Offset within the memory.
+   */
+  vk::DeviceSize GetOffset() const { return _allocation.offset; }
+
+  /**
+   * @brief Getter for the size of the resource.
+   *
+   * @return vk::DeviceSize Size in bytes.
+   */
+  vk::DeviceSize GetSize() const { return _allocation.size; }
+
+  /**
+   * @brief Getter for the mapped memory. Host visible memory stays mapped for
+   * its whole lifetime.
+   *
+   * @return void* The mapped range or nullptr if not host visible.
+   */
+  void *GetMappedData() const { return _allocation.mappedData; }
+
+  /**
+   * @brief Allocates memory to move the resource to, so that fragmented
+   * memory can be released. See MemoryAllocator::AllocateMove.
+   *
+   * @return std::unique_ptr<DeviceMemory> The new memory or nullptr if the
+   *                                       resource should stay.
+   */
+  std::unique_ptr<DeviceMemory> AllocateMoveTarget() const;
 };
 SVEL_CLASS(DeviceMemory)
 
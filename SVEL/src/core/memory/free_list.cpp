@@ -0,0 +1,95 @@
+/**
+ * @file free_list.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the FreeList.
+ * @date 2023-10-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "free_list.h"
+
+// STL
+#include <iterator>
+#include <stdexcept>
+
+void core::FreeList::_insertFree(uint64_t offset, uint64_t size) {
+  _freeByOffset.emplace(offset, size);
+  _freeBySize.emplace(size, offset);
+}
+
+void core::FreeList::_eraseFree(std::map<uint64_t, uint64_t>::iterator range) {
+  _freeBySize.erase({range->second, range->first});
+  _freeByOffset.erase(range);
+}
+
+core::FreeList::FreeList(uint64_t size) : _size(size) {
+  if (size == 0)
+    throw std::invalid_argument("Free list requires a size.");
+  _insertFree(0, size);
+}
+
+uint64_t core::FreeList::Allocate(uint64_t size, uint64_t alignment) {
+  if (size == 0 || alignment == 0)
+    throw std::invalid_argument("Invalid free list allocation.");
+
+  // Smallest free range that still fits after aligning its offset
+  for (auto it = _freeBySize.lower_bound({size, 0}); it != _freeBySize.end();
+       ++it) {
+    const uint64_t rangeOffset = it->second;
+    const uint64_t rangeSize = it->first;
+    const uint64_t offset =
+        (rangeOffset + alignment - 1) / alignment * alignment;
+    if (offset + size > rangeOffset + rangeSize)
+      continue;
+
+    // Split off the padding in front and the remainder behind
+    _eraseFree(_freeByOffset.find(rangeOffset));
+    if (offset > rangeOffset)
+      _insertFree(rangeOffset, offset - rangeOffset);
+    if (offset + size < rangeOffset + rangeSize)
+      _insertFree(offset + size, rangeOffset + rangeSize - offset - size);
+
+    _usedSize += size;
+    _allocationCount++;
+    return offset;
+  }
+  return INVALID_OFFSET;
+}
+
+void core::FreeList::Free(uint64_t offset, uint64_t size) {
+  if (size == 0 || offset + size > _size)
+    throw std::invalid_argument("Range was not allocated from this block.");
+
+  // The range may neither overlap the previous nor the next free range
+  auto next = _freeByOffset.lower_bound(offset);
+  auto previous = next == _freeByOffset.begin() ? _freeByOffset.end()
+                                                : std::prev(next);
+  if ((next != _freeByOffset.end() && next->first < offset + size) ||
+      (previous != _freeByOffset.end() &&
+       previous->first + previous->second > offset))
+    throw std::invalid_argument("Range was not allocated from this block.");
+
+  _usedSize -= size;
+  _allocationCount--;
+
+  // Merge with free neighbours
+  uint64_t first = offset;
+  uint64_t last = offset + size;
+  if (next != _freeByOffset.end() && next->first == last) {
+    last += next->second;
+    _eraseFree(next);
+  }
+  if (previous != _freeByOffset.end() &&
+      previous->first + previous->second == first) {
+    first = previous->first;
+    _eraseFree(previous);
+  }
+  _insertFree(first, last - first);
+}
+
+uint64_t core::FreeList::GetLargestFree() const {
+  return _freeBySize.empty() ? 0 : _freeBySize.rbegin()->first;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file free_list.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declaration of FreeList.
+ * @date 2023-10-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __CORE_MEMORY_FREE_LIST_H__
+#define __CORE_MEMORY_FREE_LIST_H__
+
+// STL
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+
+namespace core {
+
+/**
+ * @brief Hands out ranges of a block from a list of free ranges. Unlike the
+ * BuddyBlock, ranges are not rounded up and alignments do not have to be
+ * powers of two, which suits vertex data of any stride. The best fitting free
+ * range is found through an index by size and freed ranges are merged with
+ * their free neighbours through an index by offset, so allocating and freeing
+ * are O(log n). Only offsets are managed, the memory itself is owned by the
+ * caller.
+ */
+class FreeList {
+private:
+  /**
+   * @brief Free ranges by their offset, mapped to their size.
+   */
+  std::map<uint64_t, uint64_t> _freeByOffset;
+
+  /**
+   * @brief Free ranges ordered by their size and then by their offset.
+   */
+  std::set<std::pair<uint64_t, uint64_t>> _freeBySize;
+
+  /**
+   * @brief Size of the block.
+   */
+  uint64_t _size;
+
+  /**
+   * @brief Bytes of all handed out ranges.
+   */
+  uint64_t _usedSize = 0;
+
+  /**
+   * @brief Amount of handed out ranges.
+   */
+  uint32_t _allocationCount = 0;
+
+  /**
+   * @brief Adds a free range to both indices.
+   *
+   * @param offset  Offset of the range.
+   * @param size    Size of the range.
+   */
+  void _insertFree(uint64_t offset, uint64_t size);
+
+  /**
+   * @brief Removes a free range from both indices.
+   *
+   * @param range Iterator into the offset index.
+   */
+  void _eraseFree(std::map<uint64_t, uint64_t>::iterator range);
+
+public:
+  /**
+   * @brief Returned if a request does not fit.
+   */
+  static constexpr uint64_t INVALID_OFFSET = UINT64_MAX;
+
+  /**
+   * @brief Construct a FreeList whose whole block is free.
+   *
+   * @param size Size of the block.
+   */
+  FreeList(uint64_t size);
+
+  /**
+   * @brief Reserves a range. Padding in front of the aligned offset stays
+   * free.
+   *
+   * @param size      Size in bytes.
+   * @param alignment Required alignment of the offset, any positive value.
+   * @return uint64_t Offset of the range or INVALID_OFFSET if nothing fits.
+   */
+  uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+  /**
+   * @brief Releases a range, merging it with its free neighbours.
+   *
+   * @param offset  Offset returned by Allocate.
+   * @param size    Size in bytes.
+   */
+  void Free(uint64_t offset, uint64_t size);
+
+  /**
+   * @brief Getter for the size of the block.
+   *
+   * @return uint64_t Size in bytes.
+   */
+  uint64_t GetSize() const { return _size; }
+
+  /**
+   * @brief Getter for the bytes of all handed out ranges.
+   *
+   * @return uint64_t Size in bytes.
+   */
+  uint64_t GetUsedSize() const { return _usedSize; }
+
+  /**
+   * @brief Getter for the largest free range. Alignment padding may make
+   * slightly smaller requests fail.
+   *
+   * @return uint64_t Size in bytes, 0 if the block is full.
+   */
+  uint64_t GetLargestFree() const;
+
+  /**
+   * @brief Getter for the amount of handed out ranges.
+   *
+   * @return uint32_t The amount.
+   */
+  uint32_t GetAllocationCount() const { return _allocationCount; }
+
+  /**
+   * @brief Checks whether no range is handed out.
+   *
+   * @return true   The block is unused.
+   * @return false  Otherwise.
+   */
+  bool IsEmpty() const { return _allocationCount == 0; }
+};
+
+} // namespace core
+
+#endif /* __CORE_MEMORY_FREE_LIST_H__ */
@@ -0,0 +1,100 @@
+/**
+ * @file host_import.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the HostImport.
+ * @date 2023-10-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "host_import.h"
+
+// STL
+#include <cstdint>
+
+using namespace core;
+
+/**
+ * @brief Smallest page size of the supported platforms. Rounding the data to
+ * a larger alignment could reach pages that are not mapped.
+ */
+static const vk::DeviceSize HOST_PAGE_SIZE = 4096;
+
+HostImport::HostImport(SharedDevice device, vk::Buffer buffer,
+                       vk::DeviceMemory memory, vk::DeviceSize offset,
+                       std::shared_ptr<const void> owner)
+    : _device(device), _memory(memory), _offset(offset),
+      _owner(std::move(owner)) {
+  _vulkanObj = buffer;
+}
+
+std::unique_ptr<HostImport>
+HostImport::Import(SharedDevice device, const void *data, size_t size,
+                   std::shared_ptr<const void> owner) {
+  const vk::DeviceSize alignment = device->GetHostPointerAlignment();
+  if (alignment == 0 || alignment > HOST_PAGE_SIZE || data == nullptr ||
+      size < SVEL_HOST_IMPORT_MIN_SIZE)
+    return nullptr;
+
+  // The import covers whole aligned pages around the data
+  const uintptr_t address = (uintptr_t)data;
+  const uintptr_t start = address & ~(uintptr_t)(alignment - 1);
+  const vk::DeviceSize offset = address - start;
+  const vk::DeviceSize importSize =
+      (offset + size + alignment - 1) & ~(alignment - 1);
+
+  // Extension functions are not exported by the loader
+  auto vulkanDevice = device->AsVulkanObj();
+  auto getHostPointerProperties =
+      (PFN_vkGetMemoryHostPointerPropertiesEXT)vulkanDevice.getProcAddr(
+          "vkGetMemoryHostPointerPropertiesEXT");
+  VkMemoryHostPointerPropertiesEXT hostProperties{};
+  hostProperties.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+  if (getHostPointerProperties == nullptr ||
+      getHostPointerProperties(
+          vulkanDevice, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+          (const void *)start, &hostProperties) != VK_SUCCESS)
+    return nullptr;
+
+  // Create the buffer that the transfers read from
+  vk::ExternalMemoryBufferCreateInfo externalInfo(
+      vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT);
+  vk::BufferCreateInfo bufferInfo(vk::BufferCreateFlags(), importSize,
+                                  vk::BufferUsageFlagBits::eTransferSrc,
+                                  vk::SharingMode::eExclusive, 0, nullptr,
+                                  &externalInfo);
+  auto buffer = vulkanDevice.createBuffer(bufferInfo);
+  const uint32_t memoryTypeBits =
+      vulkanDevice.getBufferMemoryRequirements(buffer).memoryTypeBits &
+      hostProperties.memoryTypeBits;
+  if (memoryTypeBits == 0) {
+    vulkanDevice.destroyBuffer(buffer);
+    return nullptr;
+  }
+  uint32_t memoryType = 0;
+  while (!(memoryTypeBits & (1u << memoryType)))
+    memoryType++;
+
+  // Drivers may still refuse the memory, which leaves the staging path
+  vk::ImportMemoryHostPointerInfoEXT importInfo(
+      vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT,
+      (void *)start);
+  vk::MemoryAllocateInfo allocateInfo(importSize, memoryType, &importInfo);
+  vk::DeviceMemory memory;
+  if (vulkanDevice.allocateMemory(&allocateInfo, nullptr, &memory) !=
+      vk::Result::eSuccess) {
+    vulkanDevice.destroyBuffer(buffer);
+    return nullptr;
+  }
+  vulkanDevice.bindBufferMemory(buffer, memory, 0);
+  return std::unique_ptr<HostImport>(
+      new HostImport(device, buffer, memory, offset, std::move(owner)));
+}
+
+HostImport::~HostImport() {
+  auto vulkanDevice = _device->AsVulkanObj();
+  vulkanDevice.destroyBuffer(_vulkanObj);
+  vulkanDevice.freeMemory(_memory);
+}
@@ -0,0 +1,122 @@
+/**
+ * @file host_import.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declaration of HostImport.
+ * @date 2023-10-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __CORE_MEMORY_HOST_IMPORT_H__
+#define __CORE_MEMORY_HOST_IMPORT_H__
+
+// Internal
+#include <core/device.h>
+#include <svel/config.h>
+#include <util/vulkan_object.hpp>
+
+// Vulkan
+#include <vulkan/vulkan.hpp>
+
+// STL
+#include <memory>
+
+#ifndef SVEL_HOST_IMPORT_MIN_SIZE
+/**
+ * @brief Smaller data is staged, importing costs a device allocation of its
+ * own.
+ */
+#define SVEL_HOST_IMPORT_MIN_SIZE (256ull * 1024)
+#endif /* SVEL_HOST_IMPORT_MIN_SIZE */
+
+namespace core {
+
+/**
+ * @brief Host memory of the process, e.g. a mapped file, imported through
+ * VK_EXT_external_memory_host as a buffer that transfers are copied from. The
+ * data is read by the device in place, so uploads skip the staging copy. The
+ * owner of the memory is kept alive until the import is destroyed, which has
+ * to wait for the transfers that read it.
+ */
+class HostImport : public util::VulkanAdapter<vk::Buffer> {
+private:
+  /**
+   * @brief Device to use.
+   */
+  SharedDevice _device;
+
+  /**
+   * @brief The imported memory.
+   */
+  vk::DeviceMemory _memory;
+
+  /**
+   * @brief Offset of the data inside the buffer. The import starts at the
+   * aligned address in front of the data.
+   */
+  vk::DeviceSize _offset;
+
+  /**
+   * @brief Keeps the host memory alive.
+   */
+  std::shared_ptr<const void> _owner;
+
+  /**
+   * @brief Construct a Host Import from its created objects.
+   *
+   * @param device  Device to use.
+   * @param buffer  Buffer bound to the memory.
+   * @param memory  The imported memory.
+   * @param offset  Offset of the data inside the buffer.
+   * @param owner   Keeps the host memory alive.
+   */
+  HostImport(SharedDevice device, vk::Buffer buffer, vk::DeviceMemory memory,
+             vk::DeviceSize offset, std::shared_ptr<const void> owner);
+
+public:
+  /**
+   * @brief Imports host memory if the device supports it. Fails if the
+   * extension is unavailable, the data is too small, the alignment exceeds a
+   * page or the driver refuses the memory, e.g. read-only mappings.
+   *
+   * @param device                      Device to use.
+   * @param data                        Start of the data.
+   * @param size                        Size of the data in bytes.
+   * @param owner                       Keeps the data alive.
+   * @return std::unique_ptr<HostImport> The import or nullptr if the data has
+   *                                    to be staged.
+   */
+  static std::unique_ptr<HostImport> Import(SharedDevice device,
+                                            const void *data, size_t size,
+                                            std::shared_ptr<const void> owner);
+
+  /**
+   * @brief Cannot be copied.
+   */
+  HostImport(const HostImport &) = delete;
+
+  /**
+   * @brief Cannot be copied.
+   *
+   * @return HostImport& ~unused~
+   */
+  HostImport &operator=(const HostImport &) = delete;
+
+  /**
+   * @brief Destroy the Host Import.
+   */
+  ~HostImport();
+
+  /**
+   * @brief Getter for the offset of the data inside the buffer.
+   *
+   * @return vk::DeviceSize The offset.
+   */
+  vk::DeviceSize GetOffset() const { return _offset; }
+};
+SVEL_CLASS(HostImport)
+
+} // namespace core
+
+#endif /* __CORE_MEMORY_HOST_IMPORT_H__ */
@@ -15,7 +15,8 @@ using namespace core;
 
 Image::Image(core::SharedDevice device, vk::Extent2D imageSize,
              vk::Format format, vk::ImageUsageFlags imageUsage,
-             vk::ImageAspectFlags aspectFlags)
+             vk::ImageAspectFlags aspectFlags,
+             vk::MemoryPropertyFlags preferred)
     : _device(device), _format(format) {
   auto vulkanDevice = _device->AsVulkanObj();
 
@@ -30,8 +31,9 @@ Image::Image(core::SharedDevice device, vk::Extent2D imageSize,
   // Allocate Image Memory
   auto memRequirements = vulkanDevice.getImageMemoryRequirements(_vulkanObj);
   _memory = std::make_unique<core::DeviceMemory>(
-      _device, memRequirements, vk::MemoryPropertyFlagBits::eDeviceLocal);
-  vulkanDevice.bindImageMemory(_vulkanObj, _memory->AsVulkanObj(), 0);
+      _device, memRequirements, vk::MemoryPropertyFlags(), preferred, false);
+  vulkanDevice.bindImageMemory(_vulkanObj, _memory->AsVulkanObj(),
+                               _memory->GetOffset());
 
   // Create Image View
   auto imageViewInfo = vk::ImageViewCreateInfo(
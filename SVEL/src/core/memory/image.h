@@ -58,10 +58,13 @@ public:
    * @param format      Format of the image.
    * @param imageUsage  Usage of the image.
    * @param aspectFlags Aspect Flags.
+   * @param preferred   Preferred properties of the memory.
    */
   Image(core::SharedDevice device, vk::Extent2D imageSize, vk::Format format,
         vk::ImageUsageFlags imageUsage,
-        vk::ImageAspectFlags aspectFlags = vk::ImageAspectFlagBits::eColor);
+        vk::ImageAspectFlags aspectFlags = vk::ImageAspectFlagBits::eColor,
+        vk::MemoryPropertyFlags preferred =
+            vk::MemoryPropertyFlagBits::eDeviceLocal);
 
   /**
    * @brief Destroy the Image.
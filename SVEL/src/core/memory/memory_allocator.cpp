@@ -0,0 +1,424 @@
+/**
+ * @file memory_allocator.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the MemoryAllocator.
+ * @date 2023-09-30
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "memory_allocator.h"
+
+// STL
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @brief Smallest range that is handed out from a block.
+ */
+static constexpr vk::DeviceSize MIN_RANGE_SIZE = 256;
+
+/**
+ * @brief Rounds down to a power of two.
+ *
+ * @param value           The value, at least 1.
+ * @return vk::DeviceSize The power of two.
+ */
+static vk::DeviceSize _floorPowerOfTwo(vk::DeviceSize value) {
+  vk::DeviceSize power = 1;
+  while (power <= value / 2)
+    power *= 2;
+  return power;
+}
+
+/**
+ * @brief Counts the set bits of memory properties.
+ *
+ * @param flags     The properties.
+ * @return uint32_t Amount of set bits.
+ */
+static uint32_t _countFlags(vk::MemoryPropertyFlags flags) {
+  uint32_t bits = (uint32_t)flags, count = 0;
+  for (; bits != 0; bits &= bits - 1)
+    count++;
+  return count;
+}
+
+std::vector<uint32_t> core::MemoryAllocator::_getMemoryTypes(
+    uint32_t memoryTypeBits, vk::MemoryPropertyFlags required,
+    vk::MemoryPropertyFlags preferred) const {
+  // Lazily allocated and protected memory only work for special resources
+  const auto requested = required | preferred;
+  const vk::MemoryPropertyFlags special =
+      vk::MemoryPropertyFlagBits::eLazilyAllocated |
+      vk::MemoryPropertyFlagBits::eProtected;
+
+  std::vector<std::pair<int, uint32_t>> candidates{};
+  for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++) {
+    const auto flags = _memoryProperties.memoryTypes[i].propertyFlags;
+    if (!(memoryTypeBits & (1u << i)) || (flags & required) != required ||
+        (flags & special & ~requested))
+      continue;
+    const int score = 2 * (int)_countFlags(flags & preferred) -
+                      (int)_countFlags(flags & ~requested);
+    candidates.push_back({score, i});
+  }
+
+  // Drivers list faster types first, so ties keep their order
+  std::stable_sort(
+      candidates.begin(), candidates.end(),
+      [](const auto &a, const auto &b) { return a.first > b.first; });
+  std::vector<uint32_t> memoryTypes{};
+  for (const auto &candidate : candidates)
+    memoryTypes.push_back(candidate.second);
+  return memoryTypes;
+}
+
+core::MemoryAllocator::HeapBudget
+core::MemoryAllocator::_getHeapBudget(uint32_t heap) const {
+  HeapBudget heapBudget;
+  if (_memoryBudget) {
+    const auto properties = _physicalDevice.getMemoryProperties2<
+        vk::PhysicalDeviceMemoryProperties2,
+        vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+    const auto &budget =
+        properties.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+    heapBudget.usage = budget.heapUsage[heap];
+    heapBudget.budget = budget.heapBudget[heap];
+  } else {
+    heapBudget.usage = _heapUsage[heap];
+    heapBudget.budget = _memoryProperties.memoryHeaps[heap].size / 10 * 8;
+  }
+  return heapBudget;
+}
+
+vk::DeviceSize core::MemoryAllocator::_evictUnusedBlocks(uint32_t heap) {
+  vk::DeviceSize freed = 0;
+  for (uint32_t pool = 0; pool < _pools.size(); pool++) {
+    const auto memoryType = pool / 2;
+    if (_memoryProperties.memoryTypes[memoryType].heapIndex != heap)
+      continue;
+
+    auto &blocks = _pools[pool];
+    for (auto block = blocks.begin(); block != blocks.end();) {
+      if (!(*block)->ranges.IsEmpty()) {
+        block++;
+        continue;
+      }
+      freed += (*block)->ranges.GetSize();
+      _freeDeviceMemory((*block)->memory, (*block)->ranges.GetSize(),
+                        memoryType);
+      block = blocks.erase(block);
+      _statistics.blockCount--;
+    }
+  }
+  return freed;
+}
+
+vk::DeviceMemory
+core::MemoryAllocator::_allocateDeviceMemory(vk::DeviceSize size,
+                                             uint32_t memoryType,
+                                             bool ignoreBudget,
+                                             void *&out_mappedData) {
+  const auto heap = _memoryProperties.memoryTypes[memoryType].heapIndex;
+  if (_statistics.deviceAllocationCount >= _maxAllocationCount)
+    throw std::runtime_error("Exceeded maxMemoryAllocationCount.");
+
+  // Unused blocks are given up before leaving the budget
+  auto heapBudget = _getHeapBudget(heap);
+  if (heapBudget.usage + size > heapBudget.budget &&
+      _evictUnusedBlocks(heap) > 0)
+    heapBudget = _getHeapBudget(heap);
+  if (heapBudget.usage + size > heapBudget.budget && !ignoreBudget)
+    return nullptr;
+
+  vk::DeviceMemory memory;
+  try {
+    memory = _device.allocateMemory(vk::MemoryAllocateInfo(size, memoryType));
+  } catch (const vk::OutOfDeviceMemoryError &) {
+    // The budget was wrong, e.g. because of other processes
+    if (_evictUnusedBlocks(heap) == 0)
+      return nullptr;
+    try {
+      memory =
+          _device.allocateMemory(vk::MemoryAllocateInfo(size, memoryType));
+    } catch (const vk::OutOfDeviceMemoryError &) {
+      return nullptr;
+    }
+  }
+
+  out_mappedData = nullptr;
+  if (_memoryProperties.memoryTypes[memoryType].propertyFlags &
+      vk::MemoryPropertyFlagBits::eHostVisible) {
+    try {
+      out_mappedData =
+          _device.mapMemory(memory, 0, VK_WHOLE_SIZE, vk::MemoryMapFlags());
+    } catch (...) {
+      _device.freeMemory(memory);
+      throw;
+    }
+  }
+
+  _statistics.deviceAllocationCount++;
+  _statistics.allocatedSize += size;
+  _heapUsage[heap] += size;
+  return memory;
+}
+
+void core::MemoryAllocator::_freeDeviceMemory(vk::DeviceMemory memory,
+                                              vk::DeviceSize size,
+                                              uint32_t memoryType) {
+  // Freeing implicitly unmaps
+  _device.freeMemory(memory);
+  _statistics.deviceAllocationCount--;
+  _statistics.allocatedSize -= size;
+  _heapUsage[_memoryProperties.memoryTypes[memoryType].heapIndex] -= size;
+}
+
+bool core::MemoryAllocator::_tryAllocate(uint32_t memoryType, bool linear,
+                                         bool ignoreBudget,
+                                         Allocation &allocation) {
+  const vk::DeviceSize blockSize = _blockSizes[memoryType];
+  allocation.memoryType = memoryType;
+
+  // Large resources would waste most of a block
+  if (std::max(allocation.size, allocation.alignment) > blockSize / 2) {
+    allocation.memory = _allocateDeviceMemory(
+        allocation.size, memoryType, ignoreBudget, allocation.mappedData);
+    if (!allocation.memory)
+      return false;
+    allocation.pool = memoryType * 2;
+    allocation.block = nullptr;
+    allocation.offset = 0;
+    _statistics.dedicatedCount++;
+    _statistics.requestedSize += allocation.size;
+    return true;
+  }
+
+  allocation.pool = memoryType * 2 + (_separateImages && !linear ? 1 : 0);
+  auto &pool = _pools[allocation.pool];
+  allocation.block = nullptr;
+  for (auto &block : pool) {
+    allocation.offset =
+        block->ranges.Allocate(allocation.size, allocation.alignment);
+    if (allocation.offset != BuddyBlock::INVALID_OFFSET) {
+      allocation.block = block.get();
+      break;
+    }
+  }
+
+  // Every block is full
+  if (allocation.block == nullptr) {
+    void *mappedData = nullptr;
+    auto memory = _allocateDeviceMemory(blockSize, memoryType, ignoreBudget,
+                                        mappedData);
+    if (!memory)
+      return false;
+    pool.push_back(std::unique_ptr<Block>(
+        new Block{memory, (uint8_t *)mappedData,
+                  BuddyBlock(blockSize, MIN_RANGE_SIZE)}));
+    allocation.block = pool.back().get();
+    allocation.offset = allocation.block->ranges.Allocate(
+        allocation.size, allocation.alignment);
+    _statistics.blockCount++;
+  }
+
+  allocation.memory = allocation.block->memory;
+  allocation.mappedData = nullptr;
+  if (allocation.block->mappedData != nullptr)
+    allocation.mappedData = allocation.block->mappedData + allocation.offset;
+  _statistics.subAllocationCount++;
+  _statistics.requestedSize += allocation.size;
+  return true;
+}
+
+core::MemoryAllocator::MemoryAllocator(vk::Device device,
+                                       vk::PhysicalDevice physicalDevice,
+                                       bool memoryBudget)
+    : _device(device), _physicalDevice(physicalDevice),
+      _memoryProperties(physicalDevice.getMemoryProperties()),
+      _memoryBudget(memoryBudget),
+      _heapUsage(_memoryProperties.memoryHeapCount, 0) {
+  const auto limits = physicalDevice.getProperties().limits;
+  _separateImages = limits.bufferImageGranularity > MIN_RANGE_SIZE;
+  _maxAllocationCount = limits.maxMemoryAllocationCount;
+  _pools.resize(_memoryProperties.memoryTypeCount * 2);
+
+  // Small heaps would be taken up by a few blocks
+  for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++) {
+    const auto heapIndex = _memoryProperties.memoryTypes[i].heapIndex;
+    const auto heapSize = _memoryProperties.memoryHeaps[heapIndex].size;
+    _blockSizes.push_back(
+        std::max(MIN_RANGE_SIZE,
+                 std::min((vk::DeviceSize)SVEL_MEMORY_BLOCK_SIZE,
+                          _floorPowerOfTwo(std::max(heapSize / 8,
+                                                    (vk::DeviceSize)1)))));
+  }
+}
+
+core::MemoryAllocator::~MemoryAllocator() {
+  // Resources keep the device alive, so only unused blocks remain
+  for (auto &pool : _pools)
+    for (auto &block : pool)
+      _device.freeMemory(block->memory);
+}
+
+core::MemoryAllocator::Allocation
+core::MemoryAllocator::Allocate(const vk::MemoryRequirements &requirements,
+                                vk::MemoryPropertyFlags required,
+                                vk::MemoryPropertyFlags preferred,
+                                bool linear) {
+  const auto memoryTypes =
+      _getMemoryTypes(requirements.memoryTypeBits, required, preferred);
+  if (memoryTypes.empty())
+    throw std::runtime_error("Could not find proper memory type.");
+
+  Allocation allocation;
+  allocation.size = requirements.size;
+  allocation.alignment = std::max(requirements.alignment, (vk::DeviceSize)1);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (const auto memoryType : memoryTypes)
+    if (_tryAllocate(memoryType, linear, false, allocation))
+      return allocation;
+
+  // Every heap is out of budget, which is still better than failing
+  for (const auto memoryType : memoryTypes)
+    if (_tryAllocate(memoryType, linear, true, allocation))
+      return allocation;
+  throw std::runtime_error("Out of device memory.");
+}
+
+core::MemoryAllocator::Allocation
+core::MemoryAllocator::AllocateMove(const Allocation &allocation) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  Allocation target = allocation;
+  target.memory = nullptr;
+  target.block = nullptr;
+  target.mappedData = nullptr;
+  if (allocation.block == nullptr)
+    return target;
+
+  // Only the least used block is drained, moving out of fuller blocks would
+  // just shuffle ranges around
+  auto &pool = _pools[allocation.pool];
+  const uint64_t usedSize = allocation.block->ranges.GetUsedSize();
+  std::vector<Block *> candidates{};
+  for (const auto &block : pool) {
+    if (block.get() == allocation.block || block->ranges.IsEmpty())
+      continue;
+    if (block->ranges.GetUsedSize() < usedSize)
+      return target;
+    candidates.push_back(block.get());
+  }
+
+  // Filling the fullest blocks first keeps the others draining
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Block *a, const Block *b) {
+              return a->ranges.GetUsedSize() > b->ranges.GetUsedSize();
+            });
+  for (auto *block : candidates) {
+    const uint64_t offset =
+        block->ranges.Allocate(allocation.size, allocation.alignment);
+    if (offset == BuddyBlock::INVALID_OFFSET)
+      continue;
+
+    target.memory = block->memory;
+    target.block = block;
+    target.offset = offset;
+    if (block->mappedData != nullptr)
+      target.mappedData = block->mappedData + offset;
+    _statistics.subAllocationCount++;
+    _statistics.requestedSize += allocation.size;
+    return target;
+  }
+  return target;
+}
+
+void core::MemoryAllocator::Free(const Allocation &allocation) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _statistics.requestedSize -= allocation.size;
+  if (allocation.block == nullptr) {
+    _freeDeviceMemory(allocation.memory, allocation.size,
+                      allocation.memoryType);
+    _statistics.dedicatedCount--;
+    return;
+  }
+
+  auto *block = allocation.block;
+  block->ranges.Free(allocation.offset, allocation.size, allocation.alignment);
+  _statistics.subAllocationCount--;
+  if (!block->ranges.IsEmpty())
+    return;
+
+  // Keep a single empty block per pool
+  auto &pool = _pools[allocation.pool];
+  const auto emptyBlocks =
+      std::count_if(pool.begin(), pool.end(),
+                    [](const auto &other) { return other->ranges.IsEmpty(); });
+  if (emptyBlocks < 2)
+    return;
+  auto entry =
+      std::find_if(pool.begin(), pool.end(), [block](const auto &other) {
+        return other.get() == block;
+      });
+  _freeDeviceMemory(block->memory, block->ranges.GetSize(),
+                    allocation.memoryType);
+  pool.erase(entry);
+  _statistics.blockCount--;
+}
+
+core::MemoryAllocator::Statistics core::MemoryAllocator::GetStatistics() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto statistics = _statistics;
+  for (const auto &pool : _pools)
+    for (const auto &block : pool) {
+      statistics.freeSize +=
+          block->ranges.GetSize() - block->ranges.GetUsedSize();
+      statistics.largestFreeRange =
+          std::max(statistics.largestFreeRange,
+                   (vk::DeviceSize)block->ranges.GetLargestFree());
+    }
+  if (statistics.freeSize > 0)
+    statistics.fragmentation =
+        1.0f - (float)statistics.largestFreeRange / (float)statistics.freeSize;
+  return statistics;
+}
+
+std::vector<core::MemoryAllocator::HeapBudget>
+core::MemoryAllocator::GetHeapBudgets() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<HeapBudget> budgets{};
+  for (uint32_t heap = 0; heap < _memoryProperties.memoryHeapCount; heap++)
+    budgets.push_back(_getHeapBudget(heap));
+  return budgets;
+}
+
+bool core::MemoryAllocator::CanWriteDirectly(vk::DeviceSize size,
+                                             uint32_t memoryTypeBits) {
+  const vk::MemoryPropertyFlags direct =
+      vk::MemoryPropertyFlagBits::eDeviceLocal |
+      vk::MemoryPropertyFlagBits::eHostVisible |
+      vk::MemoryPropertyFlagBits::eHostCoherent;
+  const vk::MemoryPropertyFlags special =
+      vk::MemoryPropertyFlagBits::eLazilyAllocated |
+      vk::MemoryPropertyFlagBits::eProtected;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++) {
+    const auto &memoryType = _memoryProperties.memoryTypes[i];
+    if (!(memoryTypeBits & (1u << i)) ||
+        (memoryType.propertyFlags & direct) != direct ||
+        (memoryType.propertyFlags & special))
+      continue;
+
+    // A small BAR window is better left to uniform data
+    const auto heapBudget = _getHeapBudget(memoryType.heapIndex);
+    if (heapBudget.usage + size * SVEL_DIRECT_WRITE_HEADROOM <=
+        heapBudget.budget)
+      return true;
+  }
+  return false;
+}
@@ -0,0 +1,414 @@
+/**
+ * @file memory_allocator.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declaration of the MemoryAllocator.
+ * @date 2023-09-30
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __CORE_MEMORY_MEMORY_ALLOCATOR_H__
+#define __CORE_MEMORY_MEMORY_ALLOCATOR_H__
+
+// Local
+#include "buddy_block.h"
+
+// Vulkan
+#include <vulkan/vulkan.hpp>
+
+// STL
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifndef SVEL_MEMORY_BLOCK_SIZE
+/**
+ * @brief Size of the blocks that are allocated from vulkan and shared by many
+ * resources. Has to be a power of two. Smaller heaps use an eighth of their
+ * size.
+ */
+#define SVEL_MEMORY_BLOCK_SIZE (64ull * 1024 * 1024)
+#endif /* SVEL_MEMORY_BLOCK_SIZE */
+
+#ifndef SVEL_DIRECT_WRITE_HEADROOM
+/**
+ * @brief Resources are only written directly into host visible device local
+ * memory if its heap has room for this many times their size. This keeps the
+ * small BAR window of systems without resizable BAR for uniform data.
+ */
+#define SVEL_DIRECT_WRITE_HEADROOM 4
+#endif /* SVEL_DIRECT_WRITE_HEADROOM */
+
+namespace core {
+
+/**
+ * @brief Sub-allocates device memory, so that resources do not need a
+ * vkAllocateMemory each. Every memory type gets its own list of blocks that
+ * are split with the buddy system. Resources larger than half a block get a
+ * dedicated allocation. Host visible blocks are mapped once for their whole
+ * lifetime, as a memory object can only be mapped once at a time.
+ *
+ * Memory types are scored by the required and preferred properties and the
+ * budget of their heap. If a heap runs out, unused blocks are evicted and the
+ * next best memory type is used, so that running out of device local memory
+ * degrades performance instead of failing.
+ */
+class MemoryAllocator {
+public:
+  /**
+   * @brief A block that is shared by many resources.
+   */
+  struct Block {
+    /**
+     * @brief The vulkan memory.
+     */
+    vk::DeviceMemory memory;
+
+    /**
+     * @brief Start of the mapped memory, nullptr if not host visible.
+     */
+    uint8_t *mappedData;
+
+    /**
+     * @brief Manages the ranges of the block.
+     */
+    BuddyBlock ranges;
+  };
+
+  /**
+   * @brief A range of memory that can be bound to a resource.
+   */
+  struct Allocation {
+    /**
+     * @brief Memory that contains the range.
+     */
+    vk::DeviceMemory memory;
+
+    /**
+     * @brief Offset of the range within the memory.
+     */
+    vk::DeviceSize offset = 0;
+
+    /**
+     * @brief Requested size of the range.
+     */
+    vk::DeviceSize size = 0;
+
+    /**
+     * @brief Requested alignment of the range.
+     */
+    vk::DeviceSize alignment = 1;
+
+    /**
+     * @brief Mapped range, nullptr if not host visible.
+     */
+    void *mappedData = nullptr;
+
+    /**
+     * @brief Block the range belongs to, nullptr for dedicated allocations.
+     */
+    Block *block = nullptr;
+
+    /**
+     * @brief Memory type of the range.
+     */
+    uint32_t memoryType = 0;
+
+    /**
+     * @brief Pool of the block.
+     */
+    uint32_t pool = 0;
+  };
+
+  /**
+   * @brief Usage and budget of a memory heap.
+   */
+  struct HeapBudget {
+    /**
+     * @brief Bytes in use. Includes other processes if VK_EXT_memory_budget
+     * is available, otherwise only the allocations of this allocator.
+     */
+    vk::DeviceSize usage = 0;
+
+    /**
+     * @brief Bytes that can be used without hurting performance or stability.
+     * Without VK_EXT_memory_budget this is 80% of the heap.
+     */
+    vk::DeviceSize budget = 0;
+  };
+
+  /**
+   * @brief Describes the current use of device memory.
+   */
+  struct Statistics {
+    /**
+     * @brief Amount of live vkAllocateMemory allocations.
+     */
+    uint32_t deviceAllocationCount = 0;
+
+    /**
+     * @brief Amount of blocks.
+     */
+    uint32_t blockCount = 0;
+
+    /**
+     * @brief Amount of dedicated allocations.
+     */
+    uint32_t dedicatedCount = 0;
+
+    /**
+     * @brief Amount of ranges handed out from blocks.
+     */
+    uint32_t subAllocationCount = 0;
+
+    /**
+     * @brief Bytes allocated from vulkan.
+     */
+    vk::DeviceSize allocatedSize = 0;
+
+    /**
+     * @brief Bytes requested by the resources.
+     */
+    vk::DeviceSize requestedSize = 0;
+
+    /**
+     * @brief Bytes of blocks that no range covers.
+     */
+    vk::DeviceSize freeSize = 0;
+
+    /**
+     * @brief Largest range that can be allocated without a new block.
+     */
+    vk::DeviceSize largestFreeRange = 0;
+
+    /**
+     * @brief Share of the free bytes that are not part of the largest free
+     * range, from 0 for a single free range to almost 1 for scattered ones.
+     */
+    float fragmentation = 0.0f;
+  };
+
+private:
+  /**
+   * @brief Device to allocate from.
+   */
+  vk::Device _device;
+
+  /**
+   * @brief Physical device of the device, queried for budgets.
+   */
+  vk::PhysicalDevice _physicalDevice;
+
+  /**
+   * @brief Properties of the memory types and heaps.
+   */
+  vk::PhysicalDeviceMemoryProperties _memoryProperties;
+
+  /**
+   * @brief Whether VK_EXT_memory_budget is enabled.
+   */
+  bool _memoryBudget;
+
+  /**
+   * @brief Bytes allocated from every heap.
+   */
+  std::vector<vk::DeviceSize> _heapUsage;
+
+  /**
+   * @brief Linear and optimal resources in one block have to be
+   * bufferImageGranularity apart. If that is larger than the smallest range
+   * they use separate pools.
+   */
+  bool _separateImages;
+
+  /**
+   * @brief Limit of simultaneous vkAllocateMemory allocations.
+   */
+  uint32_t _maxAllocationCount;
+
+  /**
+   * @brief Blocks per pool. A pool is a memory type and, if required, whether
+   * the resources are linear.
+   */
+  std::vector<std::vector<std::unique_ptr<Block>>> _pools;
+
+  /**
+   * @brief Block size per memory type.
+   */
+  std::vector<vk::DeviceSize> _blockSizes;
+
+  /**
+   * @brief Current statistics.
+   */
+  Statistics _statistics;
+
+  /**
+   * @brief Guards the pools, resources are created from several threads.
+   */
+  std::mutex _mutex;
+
+  /**
+   * @brief Finds the memory types that can be used, best first. Types have to
+   * have every required property. They are ranked by the preferred properties
+   * they have and lose rank for properties that were not asked for, e.g. host
+   * visible device local memory, which is scarce, for a device local
+   * resource.
+   *
+   * @param memoryTypeBits        Memory types the resource supports.
+   * @param required              Properties the memory must have.
+   * @param preferred             Properties the memory should have.
+   * @return std::vector<uint32_t> Usable memory types, best first.
+   */
+  std::vector<uint32_t>
+  _getMemoryTypes(uint32_t memoryTypeBits, vk::MemoryPropertyFlags required,
+                  vk::MemoryPropertyFlags preferred) const;
+
+  /**
+   * @brief Gets the usage and budget of a heap without locking.
+   *
+   * @param heap        Index of the heap.
+   * @return HeapBudget Its usage and budget.
+   */
+  HeapBudget _getHeapBudget(uint32_t heap) const;
+
+  /**
+   * @brief Frees the unused blocks of a heap.
+   *
+   * @param heap            Index of the heap.
+   * @return vk::DeviceSize Bytes that were freed.
+   */
+  vk::DeviceSize _evictUnusedBlocks(uint32_t heap);
+
+  /**
+   * @brief Allocates vulkan memory and maps it if it is host visible. Unused
+   * blocks of the heap are evicted if it is out of budget or memory.
+   *
+   * @param size              Size in bytes.
+   * @param memoryType        Memory type to use.
+   * @param ignoreBudget      Allocate even if the heap is out of budget.
+   * @param out_mappedData    Receives the mapping or nullptr.
+   * @return vk::DeviceMemory The memory or a null handle if the heap is full.
+   */
+  vk::DeviceMemory _allocateDeviceMemory(vk::DeviceSize size,
+                                         uint32_t memoryType,
+                                         bool ignoreBudget,
+                                         void *&out_mappedData);
+
+  /**
+   * @brief Frees vulkan memory.
+   *
+   * @param memory      The memory.
+   * @param size        Size in bytes.
+   * @param memoryType  Memory type of the memory.
+   */
+  void _freeDeviceMemory(vk::DeviceMemory memory, vk::DeviceSize size,
+                         uint32_t memoryType);
+
+  /**
+   * @brief Tries to allocate from a single memory type.
+   *
+   * @param memoryType    Memory type to use.
+   * @param linear        Whether the resource is a buffer or linear image.
+   * @param ignoreBudget  Allocate even if the heap is out of budget.
+   * @param allocation    Size and alignment are read, the rest is filled in.
+   * @return true         Allocation succeeded.
+   * @return false        The heap is full.
+   */
+  bool _tryAllocate(uint32_t memoryType, bool linear, bool ignoreBudget,
+                    Allocation &allocation);
+
+public:
+  /**
+   * @brief Construct a MemoryAllocator.
+   *
+   * @param device          Device to allocate from.
+   * @param physicalDevice  Physical device of the device.
+   * @param memoryBudget    Whether VK_EXT_memory_budget is enabled.
+   */
+  MemoryAllocator(vk::Device device, vk::PhysicalDevice physicalDevice,
+                  bool memoryBudget);
+
+  MemoryAllocator(const MemoryAllocator &) = delete;
+
+  /**
+   * @brief Destroy the MemoryAllocator and all of its blocks.
+   */
+  ~MemoryAllocator();
+
+  /**
+   * @brief Allocates memory for a resource. Heaps are kept within their
+   * budget as long as any usable heap has room, only if every heap is out of
+   * budget the budget is exceeded.
+   *
+   * @param requirements  Requirements of the resource.
+   * @param required      Properties the memory must have.
+   * @param preferred     Properties the memory should have. Device local
+   *                      resources should prefer eDeviceLocal instead of
+   *                      requiring it, so they can fall back to system memory.
+   *                      Memory that is read back should prefer eHostCached.
+   * @param linear        Whether the resource is a buffer or linear image.
+   * @return Allocation   The allocated range.
+   */
+  Allocation Allocate(const vk::MemoryRequirements &requirements,
+                      vk::MemoryPropertyFlags required,
+                      vk::MemoryPropertyFlags preferred, bool linear);
+
+  /**
+   * @brief Allocates a range to move a resource to, so that the least used
+   * block of its pool drains and can be freed. The range is taken from the
+   * fullest other block with room, no block is allocated for it.
+   *
+   * @param allocation  The current allocation of the resource.
+   * @return Allocation The new range, with a null memory if the resource
+   *                    should stay where it is.
+   */
+  Allocation AllocateMove(const Allocation &allocation);
+
+  /**
+   * @brief Releases an allocation. Empty blocks are freed except for one per
+   * pool, so that a resource that is recreated does not allocate again.
+   *
+   * @param allocation  The allocation.
+   */
+  void Free(const Allocation &allocation);
+
+  /**
+   * @brief Getter for the statistics.
+   *
+   * @return Statistics The current statistics.
+   */
+  Statistics GetStatistics();
+
+  /**
+   * @brief Getter for the usage and budget of every heap.
+   *
+   * @return std::vector<HeapBudget> Usage and budget per heap.
+   */
+  std::vector<HeapBudget> GetHeapBudgets();
+
+  /**
+   * @brief Checks whether a resource can be placed in device local memory that
+   * is also host visible and coherent, as on integrated GPUs or with
+   * resizable BAR. Such resources are written by the host without staging.
+   *
+   * @param size            Size of the resource.
+   * @param memoryTypeBits  Memory types the resource accepts.
+   * @return true           A heap with such memory has room for the resource.
+   * @return false          Staging has to be used.
+   */
+  bool CanWriteDirectly(vk::DeviceSize size, uint32_t memoryTypeBits);
+
+  /**
+   * @brief Getter for the memory properties.
+   *
+   * @return const vk::PhysicalDeviceMemoryProperties& The properties.
+   */
+  const vk::PhysicalDeviceMemoryProperties &GetMemoryProperties() const {
+    return _memoryProperties;
+  }
+};
+
+} // namespace core
+
+#endif /* __CORE_MEMORY_MEMORY_ALLOCATOR_H__ */
@@ -0,0 +1,34 @@
+/**
+ * @file staging_memory.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of StagingMemory.
+ * @date 2023-10-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "staging_memory.h"
+
+core::StagingMemory::StagingMemory(SharedDevice device, vk::DeviceSize size,
+                                   vk::DeviceSize alignment)
+    : _device(device) {
+  // Large uploads would block the ring for the smaller ones
+  if (size <= SVEL_STAGING_RING_FRAME_SIZE &&
+      _device->GetStagingRing().Allocate(size, alignment, _region))
+    return;
+
+  _buffer = std::make_unique<Buffer>(
+      _device, size, vk::BufferUsageFlagBits::eTransferSrc,
+      vk::MemoryPropertyFlagBits::eHostVisible |
+          vk::MemoryPropertyFlagBits::eHostCoherent);
+  _region.buffer = _buffer->AsVulkanObj();
+  _region.size = size;
+  _region.data = _buffer->GetMappedData();
+}
+
+core::StagingMemory::~StagingMemory() {
+  if (_buffer == nullptr)
+    _device->GetStagingRing().Release(_region);
+}
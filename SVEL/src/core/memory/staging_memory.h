@@ -0,0 +1,91 @@
+/**
+ * @file staging_memory.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declaration of StagingMemory.
+ * @date 2023-10-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __CORE_MEMORY_STAGING_MEMORY_H__
+#define __CORE_MEMORY_STAGING_MEMORY_H__
+
+// Local
+#include "buffer.h"
+#include "staging_ring.h"
+
+// Internal
+#include <core/device.h>
+
+// Vulkan
+#include <vulkan/vulkan.hpp>
+
+namespace core {
+
+/**
+ * @brief Mapped host memory an upload is copied from. Taken from the staging
+ * ring of the device, uploads that are too large or do not fit the ring get a
+ * staging buffer of their own. Has to stay alive until the transfer completed.
+ */
+class StagingMemory {
+private:
+  /**
+   * @brief Device to use.
+   */
+  SharedDevice _device;
+
+  /**
+   * @brief The staging memory.
+   */
+  StagingRing::Region _region;
+
+  /**
+   * @brief Staging buffer if the ring was not used.
+   */
+  UniqueBuffer _buffer;
+
+public:
+  /**
+   * @brief Construct StagingMemory.
+   *
+   * @param device    Device to use.
+   * @param size      Size in bytes.
+   * @param alignment Alignment of the offset, a power of two.
+   */
+  StagingMemory(SharedDevice device, vk::DeviceSize size,
+                vk::DeviceSize alignment = 16);
+
+  StagingMemory(const StagingMemory &) = delete;
+
+  /**
+   * @brief Returns the memory to the ring.
+   */
+  ~StagingMemory();
+
+  /**
+   * @brief Getter for the buffer to copy from.
+   *
+   * @return vk::Buffer The buffer.
+   */
+  vk::Buffer GetBuffer() const { return _region.buffer; }
+
+  /**
+   * @brief Getter for the offset of the data within the buffer.
+   *
+   * @return vk::DeviceSize The offset.
+   */
+  vk::DeviceSize GetOffset() const { return _region.offset; }
+
+  /**
+   * @brief Getter for the mapped memory.
+   *
+   * @return void* The memory to write the data to.
+   */
+  void *GetData() const { return _region.data; }
+};
+SVEL_CLASS(StagingMemory)
+
+} // namespace core
+
+#endif /* __CORE_MEMORY_STAGING_MEMORY_H__ */
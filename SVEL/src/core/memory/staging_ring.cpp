@@ -0,0 +1,93 @@
+/**
+ * @file staging_ring.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the StagingRing.
+ * @date 2023-10-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "staging_ring.h"
+
+// STL
+#include <algorithm>
+#include <stdexcept>
+
+core::StagingRing::StagingRing(vk::Device device, MemoryAllocator &allocator,
+                               vk::DeviceSize size)
+    : _device(device), _allocator(allocator), _size(size) {
+  if (size == 0 || (size & (size - 1)) != 0)
+    throw std::invalid_argument("Staging ring size has to be a power of two.");
+
+  vk::BufferCreateInfo createInfo(vk::BufferCreateFlags(), size,
+                                  vk::BufferUsageFlagBits::eTransferSrc,
+                                  vk::SharingMode::eExclusive, 0, nullptr);
+  _buffer = _device.createBuffer(createInfo);
+  try {
+    _memory = _allocator.Allocate(
+        _device.getBufferMemoryRequirements(_buffer),
+        vk::MemoryPropertyFlagBits::eHostVisible |
+            vk::MemoryPropertyFlagBits::eHostCoherent,
+        vk::MemoryPropertyFlags(), true);
+    _device.bindBufferMemory(_buffer, _memory.memory, _memory.offset);
+  } catch (...) {
+    if (_memory.memory)
+      _allocator.Free(_memory);
+    _device.destroyBuffer(_buffer);
+    throw;
+  }
+}
+
+core::StagingRing::~StagingRing() {
+  _device.destroyBuffer(_buffer);
+  _allocator.Free(_memory);
+}
+
+bool core::StagingRing::Allocate(vk::DeviceSize size,
+                                 vk::DeviceSize alignment,
+                                 Region &out_region) {
+  if (size == 0 || size > _size)
+    return false;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  // An empty ring starts over at its beginning
+  if (_regions.empty())
+    _tail = _head = (_head + _size - 1) / _size * _size;
+
+  // Regions never wrap, the rest of the lap is skipped instead
+  alignment = std::max(alignment, (vk::DeviceSize)1);
+  vk::DeviceSize begin = (_head + alignment - 1) & ~(alignment - 1);
+  if (begin % _size + size > _size)
+    begin = (begin / _size + 1) * _size;
+  const vk::DeviceSize end = begin + size;
+  if (end - _tail > _size)
+    return false;
+
+  _regions.push_back({end, false});
+  _head = end;
+  out_region.buffer = _buffer;
+  out_region.offset = begin % _size;
+  out_region.size = size;
+  out_region.data = (uint8_t *)_memory.mappedData + out_region.offset;
+  out_region.end = end;
+  return true;
+}
+
+void core::StagingRing::Release(const Region &region) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto entry = std::lower_bound(
+      _regions.begin(), _regions.end(), region.end,
+      [](const auto &other, vk::DeviceSize end) { return other.first < end; });
+  if (entry == _regions.end() || entry->first != region.end || entry->second)
+    throw std::invalid_argument("Region was not allocated from this ring.");
+  entry->second = true;
+
+  // The space is reused once all older regions are released
+  while (!_regions.empty() && _regions.front().second) {
+    _tail = _regions.front().first;
+    _regions.pop_front();
+  }
+}
@@ -0,0 +1,176 @@
+/**
+ * @file staging_ring.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declaration of the StagingRing.
+ * @date 2023-10-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __CORE_MEMORY_STAGING_RING_H__
+#define __CORE_MEMORY_STAGING_RING_H__
+
+// Local
+#include "memory_allocator.h"
+
+// Vulkan
+#include <vulkan/vulkan.hpp>
+
+// STL
+#include <deque>
+#include <mutex>
+
+#ifndef SVEL_MAX_FRAMES_IN_FLIGHT
+/**
+ * @brief How many frames are recorded while the gpu still works on previous
+ * ones.
+ */
+#define SVEL_MAX_FRAMES_IN_FLIGHT 2
+#endif /* SVEL_MAX_FRAMES_IN_FLIGHT */
+
+#ifndef SVEL_STAGING_RING_FRAME_SIZE
+/**
+ * @brief Staging memory per frame in flight. Larger uploads use a staging
+ * buffer of their own.
+ */
+#define SVEL_STAGING_RING_FRAME_SIZE (16ull * 1024 * 1024)
+#endif /* SVEL_STAGING_RING_FRAME_SIZE */
+
+namespace core {
+
+/**
+ * @brief A persistently mapped host visible buffer that uploads take their
+ * staging memory from. Regions are handed out in order and are reclaimed once
+ * the transfers that read them completed. Regions may be released in any
+ * order, the space is reused once every older region was released as well.
+ */
+class StagingRing {
+public:
+  /**
+   * @brief Staging memory of a single upload.
+   */
+  struct Region {
+    /**
+     * @brief Buffer that contains the region.
+     */
+    vk::Buffer buffer;
+
+    /**
+     * @brief Offset of the region within the buffer.
+     */
+    vk::DeviceSize offset = 0;
+
+    /**
+     * @brief Size of the region.
+     */
+    vk::DeviceSize size = 0;
+
+    /**
+     * @brief Mapped memory of the region.
+     */
+    void *data = nullptr;
+
+    /**
+     * @brief Position behind the region in bytes ever allocated, identifies
+     * the region within the ring.
+     */
+    vk::DeviceSize end = 0;
+  };
+
+private:
+  /**
+   * @brief Device to use.
+   */
+  vk::Device _device;
+
+  /**
+   * @brief Allocator of the ring memory.
+   */
+  MemoryAllocator &_allocator;
+
+  /**
+   * @brief The ring buffer.
+   */
+  vk::Buffer _buffer;
+
+  /**
+   * @brief Memory of the ring buffer.
+   */
+  MemoryAllocator::Allocation _memory;
+
+  /**
+   * @brief Size of the ring in bytes.
+   */
+  vk::DeviceSize _size;
+
+  /**
+   * @brief Bytes ever allocated, including padding.
+   */
+  vk::DeviceSize _head = 0;
+
+  /**
+   * @brief Bytes ever reclaimed.
+   */
+  vk::DeviceSize _tail = 0;
+
+  /**
+   * @brief Regions in allocation order that are not reclaimed yet, with
+   * whether they were released.
+   */
+  std::deque<std::pair<vk::DeviceSize, bool>> _regions;
+
+  /**
+   * @brief Guards the ring, uploads are staged from several threads.
+   */
+  std::mutex _mutex;
+
+public:
+  /**
+   * @brief Construct a StagingRing.
+   *
+   * @param device    Device to use.
+   * @param allocator Allocator of the ring memory.
+   * @param size      Size of the ring, a power of two.
+   */
+  StagingRing(vk::Device device, MemoryAllocator &allocator,
+              vk::DeviceSize size);
+
+  StagingRing(const StagingRing &) = delete;
+
+  /**
+   * @brief Destroy the StagingRing. Every region has to be released.
+   */
+  ~StagingRing();
+
+  /**
+   * @brief Takes a region from the ring.
+   *
+   * @param size        Size in bytes.
+   * @param alignment   Alignment of the offset, a power of two.
+   * @param out_region  Receives the region.
+   * @return true       The region was allocated.
+   * @return false      The ring is too full, the caller has to stage
+   *                    elsewhere.
+   */
+  bool Allocate(vk::DeviceSize size, vk::DeviceSize alignment,
+                Region &out_region);
+
+  /**
+   * @brief Releases a region once the gpu no longer reads it.
+   *
+   * @param region  The region.
+   */
+  void Release(const Region &region);
+
+  /**
+   * @brief Getter for the size of the ring.
+   *
+   * @return vk::DeviceSize Size in bytes.
+   */
+  vk::DeviceSize GetSize() const { return _size; }
+};
+
+} // namespace core
+
+#endif /* __CORE_MEMORY_STAGING_RING_H__ */
@@ -19,67 +19,68 @@
 #include <memory>
 
 void core::TransferBuffer::onTransferCompleted() {
-  // Free resources and run callback
-  _device->AsVulkanObj().freeCommandBuffers(_commandPool, _commandBuffer);
+  // Free resources and run callback, the staging memory can be reused
+  _staging.reset();
+  _import.reset();
   _completionCallback(_transferredBuffer);
 }
 
 core::TransferBuffer::TransferBuffer(
-    SharedDevice device, vk::CommandPool commandPool,
-    const SVEL_NAMESPACE::ArrayProxy &data, vk::BufferUsageFlags _usage,
-    TransferCompletionHandler completionCallback)
-    : _device(device), _commandPool(commandPool), _bufferSize(data.dataSize),
-      _completionCallback(completionCallback) {
-  auto vulkanDevice = device->AsVulkanObj();
+    SharedDevice device, const SVEL_NAMESPACE::ArrayProxy &data,
+    vk::BufferUsageFlags _usage, TransferCompletionHandler completionCallback)
+    : TransferBuffer(
+          device, data.dataSize,
+          [&data](void *destination) {
+            std::memcpy(destination, data.data, data.dataSize);
+          },
+          _usage, completionCallback) {}
 
-  // Create staging buffer
-  _stagingBuffer = std::make_unique<Buffer>(
-      device, _bufferSize, vk::BufferUsageFlagBits::eTransferSrc,
-      vk::MemoryPropertyFlagBits::eHostVisible |
-          vk::MemoryPropertyFlagBits::eHostCoherent);
+core::TransferBuffer::TransferBuffer(
+    SharedDevice device, size_t dataSize, const DataWriter &writer,
+    vk::BufferUsageFlags _usage, TransferCompletionHandler completionCallback)
+    : _device(device), _bufferSize(dataSize),
+      _completionCallback(completionCallback) {
+  // Take staging memory from the ring of the device
+  _staging = std::make_unique<StagingMemory>(device, _bufferSize);
 
-  // Create Buffer
+  // Create Buffer, it falls back to system memory if video memory is full
   _transferredBuffer = std::make_shared<Buffer>(
       device, _bufferSize, vk::BufferUsageFlagBits::eTransferDst | _usage,
-      vk::MemoryPropertyFlagBits::eDeviceLocal);
+      vk::MemoryPropertyFlags(), vk::MemoryPropertyFlagBits::eDeviceLocal);
 
-  // Write to staging Buffer
-  auto rawPointer = vulkanDevice.mapMemory(
-      _stagingBuffer->GetMemory(), 0, _bufferSize, vk::MemoryMapFlagBits());
-  std::memcpy(rawPointer, data.data, _bufferSize);
-  vulkanDevice.unmapMemory(_stagingBuffer->GetMemory());
+  // Write to staging memory, it stays mapped for its whole lifetime
+  writer(_staging->GetData());
 }
 
-void core::TransferBuffer::TransferData(Barrier *barrier) {
-  auto fence = std::make_shared<core::Fence>(_device);
-
-  // Transfer Data
-  vk::CommandBufferAllocateInfo commandBufferInfo(
-      _commandPool, vk::CommandBufferLevel::ePrimary, 1);
-  _commandBuffer =
-      _device->AsVulkanObj().allocateCommandBuffers(commandBufferInfo)[0];
-
-  // Record to buffer
-  vk::CommandBufferBeginInfo beginInfo(
-      vk::CommandBufferUsageFlagBits::eOneTimeSubmit, nullptr);
-
-  _commandBuffer.begin(beginInfo);
-  _commandBuffer.copyBuffer(_stagingBuffer->AsVulkanObj(),
-                            _transferredBuffer->AsVulkanObj(),
-                            vk::BufferCopy(0, 0, _bufferSize));
-  _commandBuffer.end();
+core::TransferBuffer::TransferBuffer(
+    SharedDevice device, size_t dataSize, const DataWriter &writer,
+    SharedBuffer destination, vk::DeviceSize destinationOffset,
+    TransferCompletionHandler completionCallback, const HostSource &source)
+    : _device(device), _transferredBuffer(destination),
+      _bufferOffset(destinationOffset), _bufferSize(dataSize),
+      _completionCallback(completionCallback) {
+  // Data that outlives the transfer is read in place if possible
+  _import = HostImport::Import(device, source.data, _bufferSize, source.owner);
+  if (_import != nullptr)
+    return;
 
-  // Submit to graphics queue
-  vk::SubmitInfo submitInfo(0, nullptr, nullptr, 1, &_commandBuffer, 0,
-                            nullptr);
+  _staging = std::make_unique<StagingMemory>(device, _bufferSize);
+  writer(_staging->GetData());
+}
 
-  auto queue =
-      _device->AsVulkanObj().getQueue(_device->GetGraphicsQueueFamily(), 0);
-  auto result = queue.submit(1, &submitInfo, fence->AsVulkanObj());
-  if (result != vk::Result::eSuccess)
-    throw std::runtime_error(vk::to_string(result));
+void core::TransferBuffer::Record(UploadBatch &batch) {
+  if (_import != nullptr)
+    batch.GetCommandBuffer().copyBuffer(
+        _import->AsVulkanObj(), _transferredBuffer->AsVulkanObj(),
+        vk::BufferCopy(_import->GetOffset(), _bufferOffset, _bufferSize));
+  else
+    batch.GetCommandBuffer().copyBuffer(
+        _staging->GetBuffer(), _transferredBuffer->AsVulkanObj(),
+        vk::BufferCopy(_staging->GetOffset(), _bufferOffset, _bufferSize));
+  batch.HandOver(_transferredBuffer->AsVulkanObj(), _bufferOffset,
+                 _bufferSize);
 
-  // Create Notifier
-  barrier->AddResource(fence, std::bind(&TransferBuffer::onTransferCompleted,
-                                        this->shared_from_this()));
+  // The batch keeps the transfer alive until it completed
+  batch.AddNotifier(std::bind(&TransferBuffer::onTransferCompleted,
+                              this->shared_from_this()));
 }
\ No newline at end of file
@@ -12,6 +12,9 @@
 
 // Local
 #include "buffer.h"
+#include "host_import.h"
+#include "staging_memory.h"
+#include "upload_batch.h"
 
 // Internal
 #include <core/barrier.h>
@@ -23,6 +26,7 @@
 // STL
 #include <atomic>
 #include <functional>
+#include <memory>
 
 namespace core {
 
@@ -37,6 +41,29 @@ public:
    */
   using TransferCompletionHandler = std::function<void(SharedBuffer)>;
 
+  /**
+   * @brief Description for a callback that writes the data directly into the
+   * mapped staging memory.
+   */
+  using DataWriter = std::function<void(void *)>;
+
+  /**
+   * @brief Host data that stays valid until its transfer completed, e.g. a
+   * region of a mapped file. It may be imported as the transfer source
+   * instead of being written to staging memory.
+   */
+  struct HostSource {
+    /**
+     * @brief Start of the data, nullptr if the writer has to be used.
+     */
+    const void *data = nullptr;
+
+    /**
+     * @brief Keeps the data alive.
+     */
+    std::shared_ptr<const void> owner;
+  };
+
 private:
   /**
    * @brief Device to use.
@@ -44,24 +71,25 @@ private:
   SharedDevice _device;
 
   /**
-   * @brief Command Pool in use.
+   * @brief Memory from which to send the data.
    */
-  vk::CommandPool _commandPool;
+  UniqueStagingMemory _staging;
 
   /**
-   * @brief Command Buffer in use.
+   * @brief Imported host memory from which to send the data. Replaces the
+   * staging memory if set.
    */
-  vk::CommandBuffer _commandBuffer;
+  UniqueHostImport _import;
 
   /**
-   * @brief Buffer from which to send the data.
+   * @brief Buffer which should receive the data.
    */
-  UniqueBuffer _stagingBuffer;
+  SharedBuffer _transferredBuffer;
 
   /**
-   * @brief Buffer which should receive the data.
+   * @brief Offset inside the buffer at which the data is placed.
    */
-  SharedBuffer _transferredBuffer;
+  vk::DeviceSize _bufferOffset = 0;
 
   /**
    * @brief Size of the buffer.
@@ -83,25 +111,63 @@ public:
    * @brief Construct a Transfer Buffer.
    *
    * @param device              Device to use
-   * @param commandPool         Command Pool from which to allocate a command
-   *                            buffer
    * @param data                Data to send to the GPU
    * @param dataLength          Length of the Data
    * @param usage               Buffer Usage Flags to pass
    * @param completionCallback  Callback to use when transfer is completed
    */
-  TransferBuffer(SharedDevice device, vk::CommandPool commandPool,
-                 const SVEL_NAMESPACE::ArrayProxy &data,
+  TransferBuffer(SharedDevice device, const SVEL_NAMESPACE::ArrayProxy &data,
                  vk::BufferUsageFlags usage,
                  TransferCompletionHandler completionCallback);
 
   /**
-   * @brief Transfer the buffer.
+   * @brief Construct a Transfer Buffer whose data is written directly into the
+   * staging memory, without an intermediate copy.
+   *
+   * @param device              Device to use
+   * @param dataSize            Size of the data in bytes
+   * @param writer              Writes exactly dataSize bytes to the pointer
+   * @param usage               Buffer Usage Flags to pass
+   * @param completionCallback  Callback to use when transfer is completed
+   */
+  TransferBuffer(SharedDevice device, size_t dataSize, const DataWriter &writer,
+                 vk::BufferUsageFlags usage,
+                 TransferCompletionHandler completionCallback);
+
+  /**
+   * @brief Construct a Transfer Buffer that places the data inside an
+   * existing buffer, which has to allow transfer destination usage.
+   *
+   * @param device              Device to use
+   * @param dataSize            Size of the data in bytes
+   * @param writer              Writes exactly dataSize bytes to the pointer
+   * @param destination         Buffer which receives the data
+   * @param destinationOffset   Offset of the data inside the buffer
+   * @param completionCallback  Callback to use when transfer is completed
+   * @param source              Data that is imported instead of staged if
+   *                            the device allows it, the writer is not used
+   *                            then
+   */
+  TransferBuffer(SharedDevice device, size_t dataSize, const DataWriter &writer,
+                 SharedBuffer destination, vk::DeviceSize destinationOffset,
+                 TransferCompletionHandler completionCallback,
+                 const HostSource &source = {});
+
+  /**
+   * @brief Records the transfer of the buffer into the batch. The transfer
+   * completes once the batch was flushed and its barrier was waited on.
+   *
+   * @param batch Batch to record into.
+   */
+  void Record(UploadBatch &batch);
+
+  /**
+   * @brief Checks whether the data is copied from imported host memory.
    *
-   * @param _barrier  Barrier on which to add the fence. This barrier has to be
-   *                  waited on to complete transfer!
+   * @return true   The staging copy was skipped.
+   * @return false  The data was written to staging memory.
    */
-  void TransferData(Barrier *barrier);
+  bool IsImported() const { return _import != nullptr; }
 };
 
 } // namespace core
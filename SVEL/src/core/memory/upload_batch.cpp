@@ -0,0 +1,202 @@
+/**
+ * @file upload_batch.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the UploadBatch.
+ * @date 2023-10-01
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "upload_batch.h"
+
+// STL
+#include <stdexcept>
+
+using namespace core;
+
+/**
+ * @brief Every way in which uploaded data is read by the graphics queue.
+ */
+static const vk::AccessFlags UPLOAD_READ_ACCESS =
+    vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead |
+    vk::AccessFlagBits::eUniformRead | vk::AccessFlagBits::eShaderRead;
+
+void UploadBatch::_recordRelease() {
+  if (!_handOver) {
+    // A single queue only has to make the copies visible
+    vk::MemoryBarrier memoryBarrier(vk::AccessFlagBits::eTransferWrite,
+                                    UPLOAD_READ_ACCESS);
+    _commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                   vk::PipelineStageFlagBits::eAllCommands,
+                                   vk::DependencyFlags(), memoryBarrier, {},
+                                   _imageBarriers);
+    return;
+  }
+
+  // The destination access of a release is ignored
+  auto bufferBarriers = _bufferBarriers;
+  for (auto &barrier : bufferBarriers)
+    barrier.setDstAccessMask({});
+  auto imageBarriers = _imageBarriers;
+  for (auto &barrier : imageBarriers)
+    barrier.setDstAccessMask({});
+  _commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                 vk::PipelineStageFlagBits::eBottomOfPipe,
+                                 vk::DependencyFlags(), {}, bufferBarriers,
+                                 imageBarriers);
+}
+
+vk::CommandBuffer UploadBatch::_recordAcquire() {
+  vk::CommandBufferAllocateInfo commandBufferInfo(
+      _graphicsCommandPool, vk::CommandBufferLevel::ePrimary, 1);
+  auto commandBuffer =
+      _device->AsVulkanObj().allocateCommandBuffers(commandBufferInfo)[0];
+
+  vk::CommandBufferBeginInfo beginInfo(
+      vk::CommandBufferUsageFlagBits::eOneTimeSubmit, nullptr);
+  commandBuffer.begin(beginInfo);
+
+  // The source access of an acquire is ignored, the semaphore orders it
+  auto bufferBarriers = _bufferBarriers;
+  for (auto &barrier : bufferBarriers)
+    barrier.setSrcAccessMask({});
+  auto imageBarriers = _imageBarriers;
+  for (auto &barrier : imageBarriers)
+    barrier.setSrcAccessMask({});
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands,
+                                vk::PipelineStageFlagBits::eAllCommands,
+                                vk::DependencyFlags(), {}, bufferBarriers,
+                                imageBarriers);
+  commandBuffer.end();
+  return commandBuffer;
+}
+
+UploadBatch::UploadBatch(SharedDevice device,
+                         vk::CommandPool transferCommandPool,
+                         vk::CommandPool graphicsCommandPool)
+    : _device(device), _transferCommandPool(transferCommandPool),
+      _graphicsCommandPool(graphicsCommandPool),
+      _queueFamily(device->GetTransferQueueFamily()),
+      _handOver(device->GetTransferQueueFamily() !=
+                device->GetGraphicsQueueFamily()) {}
+
+UploadBatch::UploadBatch(SharedDevice device,
+                         vk::CommandPool graphicsCommandPool)
+    : _device(device), _transferCommandPool(graphicsCommandPool),
+      _graphicsCommandPool(graphicsCommandPool),
+      _queueFamily(device->GetGraphicsQueueFamily()), _handOver(false) {}
+
+UploadBatch::~UploadBatch() {
+  if (_commandBuffer)
+    _device->AsVulkanObj().freeCommandBuffers(_transferCommandPool,
+                                              _commandBuffer);
+}
+
+vk::CommandBuffer UploadBatch::GetCommandBuffer() {
+  if (_commandBuffer)
+    return _commandBuffer;
+
+  vk::CommandBufferAllocateInfo commandBufferInfo(
+      _transferCommandPool, vk::CommandBufferLevel::ePrimary, 1);
+  _commandBuffer =
+      _device->AsVulkanObj().allocateCommandBuffers(commandBufferInfo)[0];
+
+  vk::CommandBufferBeginInfo beginInfo(
+      vk::CommandBufferUsageFlagBits::eOneTimeSubmit, nullptr);
+  _commandBuffer.begin(beginInfo);
+  return _commandBuffer;
+}
+
+void UploadBatch::HandOver(vk::Buffer buffer, vk::DeviceSize offset,
+                           vk::DeviceSize size) {
+  // On a single queue the memory barrier covers all buffers
+  if (!_handOver)
+    return;
+
+  _bufferBarriers.emplace_back(
+      vk::AccessFlagBits::eTransferWrite, UPLOAD_READ_ACCESS,
+      _device->GetTransferQueueFamily(), _device->GetGraphicsQueueFamily(),
+      buffer, offset, size);
+}
+
+void UploadBatch::HandOver(vk::ImageMemoryBarrier barrier) {
+  if (_handOver) {
+    barrier.setSrcQueueFamilyIndex(_device->GetTransferQueueFamily());
+    barrier.setDstQueueFamilyIndex(_device->GetGraphicsQueueFamily());
+  } else {
+    barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+  }
+  _imageBarriers.push_back(barrier);
+}
+
+void UploadBatch::AddNotifier(Barrier::Notifier notifier) {
+  _notifiers.push_back(std::move(notifier));
+}
+
+bool UploadBatch::IsEmpty() const { return !_commandBuffer; }
+
+void UploadBatch::Flush(Barrier *barrier) {
+  if (IsEmpty())
+    return;
+
+  _recordRelease();
+  _commandBuffer.end();
+
+  auto device = _device;
+  auto vulkanDevice = _device->AsVulkanObj();
+  auto fence = std::make_shared<Fence>(_device);
+  auto transferQueue = vulkanDevice.getQueue(_queueFamily, 0);
+
+  // The command buffers are freed together with the uploads
+  auto transferCommandPool = _transferCommandPool;
+  auto transferCommandBuffer = _commandBuffer;
+  _notifiers.push_back([device, transferCommandPool, transferCommandBuffer]() {
+    device->AsVulkanObj().freeCommandBuffers(transferCommandPool,
+                                             transferCommandBuffer);
+  });
+  _commandBuffer = nullptr;
+
+  if (!_handOver) {
+    // One submit and one fence for the whole batch
+    vk::SubmitInfo submitInfo(0, nullptr, nullptr, 1, &transferCommandBuffer,
+                              0, nullptr);
+    auto result = transferQueue.submit(1, &submitInfo, fence->AsVulkanObj());
+    if (result != vk::Result::eSuccess)
+      throw std::runtime_error(vk::to_string(result));
+  } else {
+    // The copies signal the graphics queue, which acquires the resources
+    auto semaphore = vulkanDevice.createSemaphore(vk::SemaphoreCreateInfo());
+    auto graphicsCommandPool = _graphicsCommandPool;
+    auto acquireCommandBuffer = _recordAcquire();
+    _notifiers.push_back(
+        [device, graphicsCommandPool, acquireCommandBuffer, semaphore]() {
+          device->AsVulkanObj().freeCommandBuffers(graphicsCommandPool,
+                                                   acquireCommandBuffer);
+          device->AsVulkanObj().destroySemaphore(semaphore);
+        });
+
+    vk::SubmitInfo transferInfo(0, nullptr, nullptr, 1, &transferCommandBuffer,
+                                1, &semaphore);
+    auto result = transferQueue.submit(1, &transferInfo, nullptr);
+    if (result != vk::Result::eSuccess)
+      throw std::runtime_error(vk::to_string(result));
+
+    const vk::PipelineStageFlags waitStage =
+        vk::PipelineStageFlagBits::eAllCommands;
+    vk::SubmitInfo acquireInfo(1, &semaphore, &waitStage, 1,
+                               &acquireCommandBuffer, 0, nullptr);
+    auto graphicsQueue =
+        vulkanDevice.getQueue(_device->GetGraphicsQueueFamily(), 0);
+    result = graphicsQueue.submit(1, &acquireInfo, fence->AsVulkanObj());
+    if (result != vk::Result::eSuccess)
+      throw std::runtime_error(vk::to_string(result));
+  }
+
+  barrier->AddResource(fence, std::move(_notifiers));
+  _notifiers.clear();
+  _bufferBarriers.clear();
+  _imageBarriers.clear();
+}
@@ -0,0 +1,200 @@
+/**
+ * @file upload_batch.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Records many uploads into one command buffer.
+ * @date 2023-10-01
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __CORE_MEMORY_UPLOAD_BATCH_H__
+#define __CORE_MEMORY_UPLOAD_BATCH_H__
+
+// Internal
+#include <core/barrier.h>
+#include <core/device.h>
+
+// Vulkan
+#include <vulkan/vulkan.hpp>
+
+// STL
+#include <cstdint>
+#include <vector>
+
+namespace core {
+
+/**
+ * @brief Collects the copies of several uploads in a single command buffer,
+ * which is submitted once per flush and guarded by a single fence. Every
+ * upload adds a notifier that is run when that fence is signaled.
+ *
+ * The copies run on the transfer queue of the device. If that queue belongs to
+ * another family than the graphics queue, the uploaded resources are released
+ * by the transfer queue and acquired by a second submit to the graphics queue,
+ * which waits on a semaphore signaled by the copies. A batch is not thread
+ * safe, it has to be used by the thread that owns the command pools and the
+ * queues.
+ */
+class UploadBatch {
+private:
+  /**
+   * @brief Device to use.
+   */
+  SharedDevice _device;
+
+  /**
+   * @brief Command pool of the transfer family from which the command buffer
+   * with the copies is allocated.
+   */
+  vk::CommandPool _transferCommandPool;
+
+  /**
+   * @brief Command pool of the graphics family from which the command buffer
+   * that acquires the resources is allocated.
+   */
+  vk::CommandPool _graphicsCommandPool;
+
+  /**
+   * @brief Queue family to whose first queue the copies are submitted.
+   */
+  uint32_t _queueFamily;
+
+  /**
+   * @brief Do the resources change their queue family?
+   */
+  bool _handOver;
+
+  /**
+   * @brief Command buffer that is being recorded. Null until the first upload
+   * is recorded.
+   */
+  vk::CommandBuffer _commandBuffer;
+
+  /**
+   * @brief Buffers that are handed over to the graphics family.
+   */
+  std::vector<vk::BufferMemoryBarrier> _bufferBarriers;
+
+  /**
+   * @brief Image barriers that follow the copies.
+   */
+  std::vector<vk::ImageMemoryBarrier> _imageBarriers;
+
+  /**
+   * @brief Notifiers of the recorded uploads.
+   */
+  std::vector<Barrier::Notifier> _notifiers;
+
+  /**
+   * @brief Records the barriers that end the copies into the command buffer.
+   * These make the uploads visible, or release them to the graphics family.
+   */
+  void _recordRelease();
+
+  /**
+   * @brief Records a command buffer that acquires the released resources on
+   * the graphics family.
+   *
+   * @return vk::CommandBuffer The recorded command buffer.
+   */
+  vk::CommandBuffer _recordAcquire();
+
+public:
+  /**
+   * @brief Construct an empty Upload Batch.
+   *
+   * @param device              Device to use.
+   * @param transferCommandPool Command pool of the transfer family.
+   * @param graphicsCommandPool Command pool of the graphics family.
+   */
+  UploadBatch(SharedDevice device, vk::CommandPool transferCommandPool,
+              vk::CommandPool graphicsCommandPool);
+
+  /**
+   * @brief Construct an empty Upload Batch that records into the graphics
+   * queue, for copies between resources that the graphics family already
+   * owns. Nothing is handed over.
+   *
+   * @param device              Device to use.
+   * @param graphicsCommandPool Command pool of the graphics family.
+   */
+  UploadBatch(SharedDevice device, vk::CommandPool graphicsCommandPool);
+
+  /**
+   * @brief Destroy the Upload Batch. Uploads that were recorded but not
+   * flushed are discarded and their notifiers are never run.
+   */
+  ~UploadBatch();
+
+  /**
+   * @brief Cannot be copied.
+   */
+  UploadBatch(const UploadBatch &) = delete;
+
+  /**
+   * @brief Cannot be copied.
+   *
+   * @return UploadBatch& ~unused~
+   */
+  UploadBatch &operator=(const UploadBatch &) = delete;
+
+  /**
+   * @brief Getter for the command buffer into which copies are recorded.
+   * Begins the recording on first use. Unless the batch records into the
+   * graphics queue, the command buffer belongs to the transfer family and only
+   * transfer commands may be recorded.
+   *
+   * @return vk::CommandBuffer The command buffer.
+   */
+  vk::CommandBuffer GetCommandBuffer();
+
+  /**
+   * @brief Hands a range of a buffer over to the graphics family once its
+   * copy is done. Has to be called for every range that was copied to.
+   *
+   * @param buffer  The buffer.
+   * @param offset  Offset of the range.
+   * @param size    Size of the range.
+   */
+  void HandOver(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize size);
+
+  /**
+   * @brief Hands an image over to the graphics family once its copy is done.
+   * Has to be called for every image that was copied to.
+   *
+   * @param barrier The barrier that would follow the copy on a single queue,
+   *                with transfer write as source access. Its layout
+   *                transition is done as part of the hand over.
+   */
+  void HandOver(vk::ImageMemoryBarrier barrier);
+
+  /**
+   * @brief Adds a notifier that is run once the batch completed.
+   *
+   * @param notifier The notifier.
+   */
+  void AddNotifier(Barrier::Notifier notifier);
+
+  /**
+   * @brief Checks whether nothing was recorded since the last flush.
+   *
+   * @return true   Flushing would not submit anything.
+   * @return false  There are recorded uploads.
+   */
+  bool IsEmpty() const;
+
+  /**
+   * @brief Submits all recorded uploads at once and adds the fence together
+   * with every notifier to the barrier. Does nothing if the batch is empty.
+   * The batch may be reused afterwards.
+   *
+   * @param barrier The barrier onto which can be waited for completion.
+   */
+  void Flush(Barrier *barrier);
+};
+SVEL_CLASS(UploadBatch)
+
+} // namespace core
+
+#endif /* __CORE_MEMORY_UPLOAD_BATCH_H__ */
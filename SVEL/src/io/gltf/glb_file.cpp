@@ -0,0 +1,392 @@
+/**
+ * @file glb_file.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the GlbFile.
+ * @date 2023-09-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "glb_file.h"
+
+// STL
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+using namespace io::gltf;
+
+namespace {
+
+/**
+ * @brief Magic of a binary glTF file, "glTF" in little endian.
+ */
+constexpr uint32_t GLB_MAGIC = 0x46546C67;
+
+/**
+ * @brief Type of the chunk that holds the JSON document.
+ */
+constexpr uint32_t CHUNK_JSON = 0x4E4F534A;
+
+/**
+ * @brief Type of the chunk that holds the binary buffer.
+ */
+constexpr uint32_t CHUNK_BIN = 0x004E4942;
+
+/**
+ * @brief Primitive mode of triangle lists.
+ */
+constexpr uint64_t MODE_TRIANGLES = 4;
+
+/**
+ * @brief Reads a little endian 32 bit value.
+ *
+ * @param data      Data to read from.
+ * @return uint32_t The value.
+ */
+uint32_t _readWord(const char *data) {
+  const auto *bytes = (const unsigned char *)data;
+  return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 |
+         (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+/**
+ * @brief Size of a component in bytes.
+ *
+ * @param type    Type of the component.
+ * @return size_t The size, 0 if the type is unknown.
+ */
+size_t _getComponentSize(ComponentType type) {
+  switch (type) {
+  case ComponentType::eByte:
+  case ComponentType::eUnsignedByte:
+    return 1;
+  case ComponentType::eShort:
+  case ComponentType::eUnsignedShort:
+    return 2;
+  case ComponentType::eUnsignedInt:
+  case ComponentType::eFloat:
+    return 4;
+  }
+  return 0;
+}
+
+/**
+ * @brief Amount of components of an accessor type.
+ *
+ * @param type      The accessor type, like "VEC3".
+ * @return uint32_t Amount of components, 0 if the type is not supported.
+ */
+uint32_t _getComponentCount(const std::string &type) {
+  if (type == "SCALAR")
+    return 1;
+  if (type == "VEC2")
+    return 2;
+  if (type == "VEC3")
+    return 3;
+  if (type == "VEC4")
+    return 4;
+  return 0;
+}
+
+/**
+ * @brief Resolves a relative URI against the directory of the file. Percent
+ * encoded characters are decoded.
+ *
+ * @param directory               Directory of the glTF file.
+ * @param uri                     The URI.
+ * @return std::filesystem::path  Path of the referenced file.
+ */
+std::filesystem::path _resolveUri(const std::filesystem::path &directory,
+                                  const std::string &uri) {
+  std::string decoded{};
+  for (size_t i = 0; i < uri.size(); i++) {
+    uint8_t character = 0;
+    if (uri[i] == '%' && i + 2 < uri.size() &&
+        std::from_chars(uri.data() + i + 1, uri.data() + i + 3, character, 16)
+                .ptr == uri.data() + i + 3) {
+      decoded.push_back((char)character);
+      i += 2;
+    } else
+      decoded.push_back(uri[i]);
+  }
+  return directory / std::filesystem::u8path(decoded);
+}
+
+} // namespace
+
+size_t AccessorView::GetElementSize() const {
+  return _getComponentSize(componentType) * componentCount;
+}
+
+glm::vec4 AccessorView::Get(size_t index) const {
+  glm::vec4 value{0.0f, 0.0f, 0.0f, 0.0f};
+  const char *element = data + index * stride;
+  for (uint32_t i = 0; i < componentCount && i < 4; i++) {
+    switch (componentType) {
+    case ComponentType::eByte: {
+      int8_t component;
+      std::memcpy(&component, element + i, sizeof(component));
+      value[(int)i] = normalized
+                          ? std::max((float)component / 127.0f, -1.0f)
+                          : (float)component;
+      break;
+    }
+    case ComponentType::eUnsignedByte: {
+      uint8_t component;
+      std::memcpy(&component, element + i, sizeof(component));
+      value[(int)i] =
+          normalized ? (float)component / 255.0f : (float)component;
+      break;
+    }
+    case ComponentType::eShort: {
+      int16_t component;
+      std::memcpy(&component, element + i * 2, sizeof(component));
+      value[(int)i] = normalized
+                          ? std::max((float)component / 32767.0f, -1.0f)
+                          : (float)component;
+      break;
+    }
+    case ComponentType::eUnsignedShort: {
+      uint16_t component;
+      std::memcpy(&component, element + i * 2, sizeof(component));
+      value[(int)i] =
+          normalized ? (float)component / 65535.0f : (float)component;
+      break;
+    }
+    case ComponentType::eUnsignedInt: {
+      uint32_t component;
+      std::memcpy(&component, element + i * 4, sizeof(component));
+      value[(int)i] = (float)component;
+      break;
+    }
+    case ComponentType::eFloat:
+      std::memcpy(&value[(int)i], element + i * 4, sizeof(float));
+      break;
+    }
+  }
+  return value;
+}
+
+uint32_t AccessorView::GetIndex(size_t index) const {
+  const char *element = data + index * stride;
+  switch (componentType) {
+  case ComponentType::eUnsignedByte:
+    return (uint8_t)*element;
+  case ComponentType::eUnsignedShort: {
+    uint16_t value;
+    std::memcpy(&value, element, sizeof(value));
+    return value;
+  }
+  case ComponentType::eUnsignedInt: {
+    uint32_t value;
+    std::memcpy(&value, element, sizeof(value));
+    return value;
+  }
+  default:
+    throw std::runtime_error("Invalid index component type.");
+  }
+}
+
+std::string_view
+GlbFile::_resolveBufferView(const JsonValue &document,
+                            const std::vector<std::string_view> &buffers,
+                            const JsonValue &bufferView, size_t &out_stride) {
+  const auto &view = document["bufferViews"][bufferView.AsUnsigned(SIZE_MAX)];
+  const auto bufferIndex = view["buffer"].AsUnsigned(SIZE_MAX);
+  const auto offset = view["byteOffset"].AsUnsigned(0);
+  const auto length = view["byteLength"].AsUnsigned(UINT64_MAX);
+  if (view.IsNull() || bufferIndex >= buffers.size() ||
+      offset > buffers[bufferIndex].size() ||
+      length > buffers[bufferIndex].size() - offset)
+    throw std::runtime_error("Invalid glTF buffer view.");
+
+  out_stride = (size_t)view["byteStride"].AsUnsigned(0);
+  return buffers[bufferIndex].substr((size_t)offset, (size_t)length);
+}
+
+AccessorView
+GlbFile::_resolveAccessor(const JsonValue &document,
+                          const std::vector<std::string_view> &buffers,
+                          const JsonValue &accessor) {
+  AccessorView result{};
+  if (accessor.IsNull())
+    return result;
+
+  const auto &description =
+      document["accessors"][accessor.AsUnsigned(SIZE_MAX)];
+  if (description.IsNull())
+    throw std::runtime_error("Invalid glTF accessor.");
+  if (!description["sparse"].IsNull() ||
+      description["bufferView"].IsNull())
+    throw std::runtime_error("Sparse glTF accessors are not supported.");
+
+  result.componentType =
+      (ComponentType)description["componentType"].AsUnsigned(0);
+  result.componentCount =
+      _getComponentCount(description["type"].AsString());
+  result.normalized = description["normalized"].AsBool();
+  result.count = (size_t)description["count"].AsUnsigned(0);
+  const size_t elementSize = result.GetElementSize();
+  if (elementSize == 0)
+    throw std::runtime_error("Unsupported glTF accessor type.");
+
+  auto view = _resolveBufferView(document, buffers, description["bufferView"],
+                                 result.stride);
+  if (result.stride == 0)
+    result.stride = elementSize;
+  const auto offset = description["byteOffset"].AsUnsigned(0);
+
+  // The last element has to end inside of the buffer view
+  if (result.count > 0) {
+    const uint64_t span = (uint64_t)(result.count - 1) * result.stride;
+    if (result.count > view.size() || offset > view.size() ||
+        span + elementSize > view.size() - offset)
+      throw std::runtime_error("glTF accessor exceeds its buffer view.");
+  }
+  result.data = view.data() + offset;
+  return result;
+}
+
+GlbFile::GlbFile(const std::filesystem::path &file)
+    : _file(std::make_shared<MappedFile>(file)) {
+  const auto data = _file->GetView();
+  if (data.size() < 20 || _readWord(data.data()) != GLB_MAGIC)
+    throw std::runtime_error("Not a binary glTF file.");
+  if (_readWord(data.data() + 4) != 2)
+    throw std::runtime_error("Only glTF 2.0 is supported.");
+  if (_readWord(data.data() + 8) > data.size())
+    throw std::runtime_error("Binary glTF file is truncated.");
+
+  // The JSON chunk comes first, an optional binary chunk follows
+  std::string_view json{}, binary{};
+  size_t offset = 12;
+  while (data.size() - offset >= 8) {
+    const size_t length = _readWord(data.data() + offset);
+    const uint32_t type = _readWord(data.data() + offset + 4);
+    offset += 8;
+    if (length > data.size() - offset)
+      throw std::runtime_error("Binary glTF chunk is truncated.");
+    if (type == CHUNK_JSON && json.empty())
+      json = data.substr(offset, length);
+    else if (type == CHUNK_BIN && binary.empty())
+      binary = data.substr(offset, length);
+    offset += length;
+  }
+  if (json.empty())
+    throw std::runtime_error("Binary glTF file has no JSON chunk.");
+  const auto document = JsonValue::Parse(json);
+
+  // Buffer 0 without URI is the binary chunk, others live next to the file
+  const auto directory = file.parent_path();
+  std::vector<std::string_view> buffers{};
+  const auto &bufferDescriptions = document["buffers"];
+  for (size_t i = 0; i < bufferDescriptions.GetSize(); i++) {
+    const auto &buffer = bufferDescriptions[i];
+    const auto &uri = buffer["uri"].AsString();
+    std::string_view bufferData = binary;
+    if (!uri.empty()) {
+      if (uri.compare(0, 5, "data:") == 0)
+        throw std::runtime_error("Embedded glTF buffers are not supported.");
+      _externalBuffers.push_back(
+          std::make_shared<MappedFile>(_resolveUri(directory, uri)));
+      bufferData = _externalBuffers.back()->GetView();
+    } else if (i != 0)
+      throw std::runtime_error("glTF buffer without data.");
+
+    const auto length = buffer["byteLength"].AsUnsigned(UINT64_MAX);
+    if (length > bufferData.size())
+      throw std::runtime_error("glTF buffer is truncated.");
+    buffers.push_back(bufferData.substr(0, (size_t)length));
+  }
+
+  const auto &images = document["images"];
+  for (size_t i = 0; i < images.GetSize(); i++) {
+    Image image{};
+    const auto &uri = images[i]["uri"].AsString();
+    if (!images[i]["bufferView"].IsNull()) {
+      size_t stride;
+      auto view = _resolveBufferView(document, buffers,
+                                     images[i]["bufferView"], stride);
+      image.data = view.data();
+      image.size = view.size();
+    } else if (!uri.empty() && uri.compare(0, 5, "data:") != 0)
+      image.path = _resolveUri(directory, uri);
+    _images.push_back(image);
+  }
+
+  const auto &textures = document["textures"];
+  const auto &materials = document["materials"];
+  for (size_t i = 0; i < materials.GetSize(); i++) {
+    Material material{};
+    const auto &pbr = materials[i]["pbrMetallicRoughness"];
+    const auto &texture =
+        textures[pbr["baseColorTexture"]["index"].AsUnsigned(SIZE_MAX)];
+    const auto image = texture["source"].AsUnsigned(SIZE_MAX);
+    if (image < _images.size())
+      material.baseColorImage = (int64_t)image;
+    const auto &factor = pbr["baseColorFactor"];
+    for (size_t c = 0; c < 4 && c < factor.GetSize(); c++)
+      material.baseColorFactor[(int)c] = (float)factor[c].AsNumber(1.0);
+    _materials.push_back(material);
+  }
+
+  const auto &meshes = document["meshes"];
+  for (size_t i = 0; i < meshes.GetSize(); i++) {
+    const auto &primitives = meshes[i]["primitives"];
+    for (size_t j = 0; j < primitives.GetSize(); j++) {
+      const auto &description = primitives[j];
+      const auto &attributes = description["attributes"];
+      if (description["mode"].AsUnsigned(MODE_TRIANGLES) != MODE_TRIANGLES ||
+          attributes["POSITION"].IsNull())
+        continue; // Only triangle lists can be drawn
+
+      Primitive primitive{};
+      primitive.meshName = meshes[i]["name"].AsString();
+      primitive.positions =
+          _resolveAccessor(document, buffers, attributes["POSITION"]);
+      primitive.normals =
+          _resolveAccessor(document, buffers, attributes["NORMAL"]);
+      primitive.texCoords =
+          _resolveAccessor(document, buffers, attributes["TEXCOORD_0"]);
+      primitive.colors =
+          _resolveAccessor(document, buffers, attributes["COLOR_0"]);
+      primitive.indices =
+          _resolveAccessor(document, buffers, description["indices"]);
+      const auto material = description["material"].AsUnsigned(SIZE_MAX);
+      if (material < _materials.size())
+        primitive.material = (int64_t)material;
+
+      // Attributes have to describe the same vertices
+      const auto &positions = primitive.positions;
+      if (positions.componentType != ComponentType::eFloat ||
+          positions.componentCount != 3)
+        throw std::runtime_error("glTF positions have to be float vectors.");
+      for (const auto *attribute :
+           {&primitive.normals, &primitive.texCoords, &primitive.colors})
+        if (attribute->data != nullptr && attribute->count != positions.count)
+          throw std::runtime_error("glTF attributes differ in size.");
+
+      // Indices must not read outside of the vertices
+      const auto &indices = primitive.indices;
+      if (indices.data != nullptr) {
+        if (indices.componentCount != 1 ||
+            indices.componentType == ComponentType::eByte ||
+            indices.componentType == ComponentType::eShort ||
+            indices.componentType == ComponentType::eFloat)
+          throw std::runtime_error("Invalid glTF index accessor.");
+        for (size_t k = 0; k < indices.count; k++)
+          if (indices.GetIndex(k) >= positions.count)
+            throw std::runtime_error("glTF index out of range.");
+      }
+      const size_t cornerCount =
+          indices.data != nullptr ? indices.count : positions.count;
+      if (cornerCount == 0 || cornerCount % 3 != 0)
+        continue; // Nothing that forms triangles
+      _primitives.push_back(primitive);
+    }
+  }
+}
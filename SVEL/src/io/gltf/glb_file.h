@@ -0,0 +1,282 @@
+/**
+ * @file glb_file.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declares the reader of binary glTF 2.0 files.
+ * @date 2023-09-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __IO_GLTF_GLB_FILE_H__
+#define __IO_GLTF_GLB_FILE_H__
+
+// Local
+#include "json.h"
+
+// Internal
+#include <io/mapped_file.h>
+#include <svel/config.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace io::gltf {
+
+/**
+ * @brief Component types of accessors, values as defined by glTF.
+ */
+enum class ComponentType : uint32_t {
+  eByte = 5120,
+  eUnsignedByte = 5121,
+  eShort = 5122,
+  eUnsignedShort = 5123,
+  eUnsignedInt = 5125,
+  eFloat = 5126
+};
+
+/**
+ * @brief Elements of an accessor. Points into the mapped file, nothing is
+ * copied.
+ */
+struct AccessorView {
+  /**
+   * @brief First element. Null if the accessor does not exist.
+   */
+  const char *data = nullptr;
+
+  /**
+   * @brief Amount of elements.
+   */
+  size_t count = 0;
+
+  /**
+   * @brief Distance between two elements in bytes.
+   */
+  size_t stride = 0;
+
+  /**
+   * @brief Type of every component.
+   */
+  ComponentType componentType = ComponentType::eFloat;
+
+  /**
+   * @brief Amount of components of every element.
+   */
+  uint32_t componentCount = 0;
+
+  /**
+   * @brief Integer components are mapped to [0, 1] or [-1, 1].
+   */
+  bool normalized = false;
+
+  /**
+   * @brief Size of a single element in bytes.
+   *
+   * @return size_t The size.
+   */
+  size_t GetElementSize() const;
+
+  /**
+   * @brief Checks if the elements directly follow each other.
+   *
+   * @return true   The data can be copied at once.
+   * @return false  The data is interleaved with other data.
+   */
+  bool IsTight() const { return stride == GetElementSize(); }
+
+  /**
+   * @brief Reads an element. Missing components are 0.
+   *
+   * @param index       Index of the element.
+   * @return glm::vec4  The element converted to float.
+   */
+  glm::vec4 Get(size_t index) const;
+
+  /**
+   * @brief Reads an element as an index.
+   *
+   * @param index     Index of the element.
+   * @return uint32_t The first component of the element.
+   */
+  uint32_t GetIndex(size_t index) const;
+};
+
+/**
+ * @brief A triangle list of a glTF mesh.
+ */
+struct Primitive {
+  /**
+   * @brief Name of the mesh the primitive belongs to.
+   */
+  std::string meshName;
+
+  /**
+   * @brief Positions, always present.
+   */
+  AccessorView positions;
+
+  /**
+   * @brief Normals, if present.
+   */
+  AccessorView normals;
+
+  /**
+   * @brief First set of texture coordinates, if present.
+   */
+  AccessorView texCoords;
+
+  /**
+   * @brief First set of vertex colors, if present.
+   */
+  AccessorView colors;
+
+  /**
+   * @brief Indices, if present. Otherwise every vertex is used once in order.
+   */
+  AccessorView indices;
+
+  /**
+   * @brief Index of the material, -1 for the default material.
+   */
+  int64_t material = -1;
+};
+
+/**
+ * @brief The parts of a glTF material that are used by the pipelines.
+ */
+struct Material {
+  /**
+   * @brief Index of the image of the base color texture, -1 if there is none.
+   */
+  int64_t baseColorImage = -1;
+
+  /**
+   * @brief Factor of the base color.
+   */
+  glm::vec4 baseColorFactor{1.0f, 1.0f, 1.0f, 1.0f};
+};
+
+/**
+ * @brief An image referenced by a texture.
+ */
+struct Image {
+  /**
+   * @brief Path of the image file. Empty if the image is embedded.
+   */
+  std::filesystem::path path;
+
+  /**
+   * @brief Encoded data of an embedded image. Points into the mapped file.
+   */
+  const char *data = nullptr;
+
+  /**
+   * @brief Size of the encoded data in bytes.
+   */
+  size_t size = 0;
+};
+
+/**
+ * @brief Maps a binary glTF 2.0 file and resolves the meshes, materials and
+ * images of the document. All buffer data stays in the mapping, so views into
+ * it are only valid as long as the GlbFile lives. Buffers that are stored next
+ * to the file are mapped as well. Sparse accessors and embedded base64 buffers
+ * are not supported.
+ */
+class GlbFile {
+private:
+  /**
+   * @brief The mapped file.
+   */
+  SharedMappedFile _file;
+
+  /**
+   * @brief Buffers stored in separate files.
+   */
+  std::vector<SharedMappedFile> _externalBuffers;
+
+  /**
+   * @brief All triangle list primitives of all meshes.
+   */
+  std::vector<Primitive> _primitives;
+
+  /**
+   * @brief All materials.
+   */
+  std::vector<Material> _materials;
+
+  /**
+   * @brief All images.
+   */
+  std::vector<Image> _images;
+
+  /**
+   * @brief Resolves an accessor into a view.
+   *
+   * @param document      The glTF document.
+   * @param buffers       Data of every buffer.
+   * @param accessor      Index of the accessor, may be null.
+   * @return AccessorView The view, empty if the accessor is null.
+   */
+  static AccessorView
+  _resolveAccessor(const JsonValue &document,
+                   const std::vector<std::string_view> &buffers,
+                   const JsonValue &accessor);
+
+  /**
+   * @brief Resolves a buffer view.
+   *
+   * @param document          The glTF document.
+   * @param buffers           Data of every buffer.
+   * @param bufferView        Index of the buffer view.
+   * @param out_stride        Stride of the buffer view, 0 if not set.
+   * @return std::string_view The data of the buffer view.
+   */
+  static std::string_view
+  _resolveBufferView(const JsonValue &document,
+                     const std::vector<std::string_view> &buffers,
+                     const JsonValue &bufferView, size_t &out_stride);
+
+public:
+  /**
+   * @brief Maps and parses the file. Throws a std::runtime_error if the file
+   * is not a valid binary glTF 2.0 file.
+   *
+   * @param file Path to the .glb file.
+   */
+  GlbFile(const std::filesystem::path &file);
+
+  /**
+   * @brief Getter for the primitives.
+   *
+   * @return const std::vector<Primitive>& All triangle list primitives.
+   */
+  const std::vector<Primitive> &GetPrimitives() const { return _primitives; }
+
+  /**
+   * @brief Getter for the materials.
+   *
+   * @return const std::vector<Material>& All materials.
+   */
+  const std::vector<Material> &GetMaterials() const { return _materials; }
+
+  /**
+   * @brief Getter for the images.
+   *
+   * @return const std::vector<Image>& All images.
+   */
+  const std::vector<Image> &GetImages() const { return _images; }
+};
+SVEL_CLASS(GlbFile)
+
+} // namespace io::gltf
+
+#endif /* __IO_GLTF_GLB_FILE_H__ */
@@ -0,0 +1,268 @@
+/**
+ * @file json.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the JSON reader.
+ * @date 2023-09-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "json.h"
+
+// STL
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+using namespace io::gltf;
+
+const JsonValue &JsonValue::_null() {
+  static const JsonValue value{};
+  return value;
+}
+
+void JsonValue::_skipWhitespace(std::string_view &text) {
+  size_t count = 0;
+  while (count < text.size() && (text[count] == ' ' || text[count] == '\t' ||
+                                 text[count] == '\n' || text[count] == '\r'))
+    count++;
+  text.remove_prefix(count);
+}
+
+std::string JsonValue::_parseString(std::string_view &text) {
+  // Skip the opening quote
+  text.remove_prefix(1);
+
+  std::string result{};
+  while (true) {
+    if (text.empty())
+      throw std::runtime_error("Unterminated JSON string.");
+
+    // Copy everything up to the next quote or escape at once
+    size_t plain = 0;
+    while (plain < text.size() && text[plain] != '"' && text[plain] != '\\')
+      plain++;
+    result.append(text.data(), plain);
+    text.remove_prefix(plain);
+    if (text.empty())
+      continue;
+    if (text.front() == '"') {
+      text.remove_prefix(1);
+      return result;
+    }
+
+    if (text.size() < 2)
+      throw std::runtime_error("Unterminated JSON escape.");
+    const char escaped = text[1];
+    text.remove_prefix(2);
+    switch (escaped) {
+    case '"':
+    case '\\':
+    case '/':
+      result.push_back(escaped);
+      break;
+    case 'b':
+      result.push_back('\b');
+      break;
+    case 'f':
+      result.push_back('\f');
+      break;
+    case 'n':
+      result.push_back('\n');
+      break;
+    case 'r':
+      result.push_back('\r');
+      break;
+    case 't':
+      result.push_back('\t');
+      break;
+    case 'u': {
+      auto parseCodeUnit = [&text]() {
+        uint32_t unit = 0;
+        if (text.size() < 4 ||
+            std::from_chars(text.data(), text.data() + 4, unit, 16).ptr !=
+                text.data() + 4)
+          throw std::runtime_error("Invalid JSON unicode escape.");
+        text.remove_prefix(4);
+        return unit;
+      };
+
+      // Characters outside of the basic plane are split into two escapes
+      uint32_t codePoint = parseCodeUnit();
+      if (codePoint >= 0xD800 && codePoint < 0xDC00 && text.size() >= 2 &&
+          text[0] == '\\' && text[1] == 'u') {
+        text.remove_prefix(2);
+        const uint32_t low = parseCodeUnit();
+        if (low < 0xDC00 || low >= 0xE000)
+          throw std::runtime_error("Invalid JSON surrogate pair.");
+        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+      }
+
+      // Encode as UTF-8
+      if (codePoint < 0x80)
+        result.push_back((char)codePoint);
+      else if (codePoint < 0x800) {
+        result.push_back((char)(0xC0 | (codePoint >> 6)));
+        result.push_back((char)(0x80 | (codePoint & 0x3F)));
+      } else if (codePoint < 0x10000) {
+        result.push_back((char)(0xE0 | (codePoint >> 12)));
+        result.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+        result.push_back((char)(0x80 | (codePoint & 0x3F)));
+      } else {
+        result.push_back((char)(0xF0 | (codePoint >> 18)));
+        result.push_back((char)(0x80 | ((codePoint >> 12) & 0x3F)));
+        result.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+        result.push_back((char)(0x80 | (codePoint & 0x3F)));
+      }
+      break;
+    }
+    default:
+      throw std::runtime_error("Invalid JSON escape.");
+    }
+  }
+}
+
+double JsonValue::_parseNumber(std::string_view &text) {
+  // from_chars does not accept an explicit plus sign, neither does JSON
+  double value = 0.0;
+  auto [ptr, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  if (ec != std::errc() || !std::isfinite(value))
+    throw std::runtime_error("Invalid JSON number.");
+  text.remove_prefix((size_t)(ptr - text.data()));
+  return value;
+}
+
+JsonValue JsonValue::_parseValue(std::string_view &text, unsigned int depth) {
+  if (depth > MAX_DEPTH)
+    throw std::runtime_error("JSON document is nested too deeply.");
+
+  _skipWhitespace(text);
+  if (text.empty())
+    throw std::runtime_error("Unexpected end of JSON document.");
+
+  JsonValue value{};
+  auto consumeLiteral = [&text](std::string_view literal) {
+    if (text.substr(0, literal.size()) != literal)
+      throw std::runtime_error("Invalid JSON literal.");
+    text.remove_prefix(literal.size());
+  };
+
+  switch (text.front()) {
+  case 'n':
+    consumeLiteral("null");
+    break;
+  case 't':
+    consumeLiteral("true");
+    value._type = Type::eBool;
+    value._bool = true;
+    break;
+  case 'f':
+    consumeLiteral("false");
+    value._type = Type::eBool;
+    break;
+  case '"':
+    value._type = Type::eString;
+    value._string = _parseString(text);
+    break;
+  case '[':
+    value._type = Type::eArray;
+    text.remove_prefix(1);
+    _skipWhitespace(text);
+    if (!text.empty() && text.front() == ']') {
+      text.remove_prefix(1);
+      break;
+    }
+    while (true) {
+      value._elements.push_back(_parseValue(text, depth + 1));
+      _skipWhitespace(text);
+      if (text.empty())
+        throw std::runtime_error("Unterminated JSON array.");
+      const char delimiter = text.front();
+      text.remove_prefix(1);
+      if (delimiter == ']')
+        break;
+      if (delimiter != ',')
+        throw std::runtime_error("Expected ',' in JSON array.");
+    }
+    break;
+  case '{':
+    value._type = Type::eObject;
+    text.remove_prefix(1);
+    _skipWhitespace(text);
+    if (!text.empty() && text.front() == '}') {
+      text.remove_prefix(1);
+      break;
+    }
+    while (true) {
+      _skipWhitespace(text);
+      if (text.empty() || text.front() != '"')
+        throw std::runtime_error("Expected key in JSON object.");
+      value._keys.push_back(_parseString(text));
+      _skipWhitespace(text);
+      if (text.empty() || text.front() != ':')
+        throw std::runtime_error("Expected ':' in JSON object.");
+      text.remove_prefix(1);
+      value._elements.push_back(_parseValue(text, depth + 1));
+      _skipWhitespace(text);
+      if (text.empty())
+        throw std::runtime_error("Unterminated JSON object.");
+      const char delimiter = text.front();
+      text.remove_prefix(1);
+      if (delimiter == '}')
+        break;
+      if (delimiter != ',')
+        throw std::runtime_error("Expected ',' in JSON object.");
+    }
+    break;
+  default:
+    if (text.front() != '-' && (text.front() < '0' || text.front() > '9'))
+      throw std::runtime_error("Unexpected character in JSON document.");
+    value._type = Type::eNumber;
+    value._number = _parseNumber(text);
+    break;
+  }
+  return value;
+}
+
+JsonValue JsonValue::Parse(std::string_view text) {
+  auto value = _parseValue(text, 0);
+  _skipWhitespace(text);
+  if (!text.empty())
+    throw std::runtime_error("Unexpected data behind JSON document.");
+  return value;
+}
+
+const JsonValue &JsonValue::operator[](std::string_view key) const {
+  if (_type != Type::eObject)
+    return _null();
+  for (size_t i = 0; i < _keys.size(); i++)
+    if (_keys[i] == key)
+      return _elements[i];
+  return _null();
+}
+
+const JsonValue &JsonValue::operator[](size_t index) const {
+  if (_type != Type::eArray || index >= _elements.size())
+    return _null();
+  return _elements[index];
+}
+
+bool JsonValue::AsBool(bool fallback) const {
+  return _type == Type::eBool ? _bool : fallback;
+}
+
+double JsonValue::AsNumber(double fallback) const {
+  return _type == Type::eNumber ? _number : fallback;
+}
+
+uint64_t JsonValue::AsUnsigned(uint64_t fallback) const {
+  // Doubles represent every integer up to 2^53 exactly
+  constexpr double limit = 9007199254740992.0;
+  if (_type != Type::eNumber || _number < 0.0 || _number > limit ||
+      std::floor(_number) != _number)
+    return fallback;
+  return (uint64_t)_number;
+}
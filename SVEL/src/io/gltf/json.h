@@ -0,0 +1,193 @@
+/**
+ * @file json.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declares a minimal JSON reader for glTF documents.
+ * @date 2023-09-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __IO_GLTF_JSON_H__
+#define __IO_GLTF_JSON_H__
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace io::gltf {
+
+/**
+ * @brief A parsed JSON value. Lookups of missing members or elements return a
+ * null value instead of throwing, so optional glTF properties can be read
+ * with a fallback.
+ */
+class JsonValue {
+public:
+  /**
+   * @brief Kinds of JSON values.
+   */
+  enum class Type { eNull, eBool, eNumber, eString, eArray, eObject };
+
+private:
+  /**
+   * @brief Kind of the value.
+   */
+  Type _type = Type::eNull;
+
+  /**
+   * @brief Value of a bool.
+   */
+  bool _bool = false;
+
+  /**
+   * @brief Value of a number.
+   */
+  double _number = 0.0;
+
+  /**
+   * @brief Value of a string.
+   */
+  std::string _string;
+
+  /**
+   * @brief Elements of an array or values of an object.
+   */
+  std::vector<JsonValue> _elements;
+
+  /**
+   * @brief Keys of an object, in the same order as the values.
+   */
+  std::vector<std::string> _keys;
+
+  /**
+   * @brief Deepest nesting that is accepted, protects the stack from
+   * malicious documents.
+   */
+  static constexpr unsigned int MAX_DEPTH = 128;
+
+  /**
+   * @brief Returns the shared null value.
+   *
+   * @return const JsonValue& The null value.
+   */
+  static const JsonValue &_null();
+
+  /**
+   * @brief Skips whitespace at the front of the text.
+   *
+   * @param text The remaining text.
+   */
+  static void _skipWhitespace(std::string_view &text);
+
+  /**
+   * @brief Parses the value at the front of the text.
+   *
+   * @param text        The remaining text. The value is removed.
+   * @param depth       Nesting depth of the value.
+   * @return JsonValue  The parsed value.
+   */
+  static JsonValue _parseValue(std::string_view &text, unsigned int depth);
+
+  /**
+   * @brief Parses the string at the front of the text.
+   *
+   * @param text          The remaining text. The string is removed.
+   * @return std::string  The unescaped string.
+   */
+  static std::string _parseString(std::string_view &text);
+
+  /**
+   * @brief Parses the number at the front of the text.
+   *
+   * @param text    The remaining text. The number is removed.
+   * @return double The number.
+   */
+  static double _parseNumber(std::string_view &text);
+
+public:
+  /**
+   * @brief Parses a JSON document. Throws a std::runtime_error if the text is
+   * not valid JSON.
+   *
+   * @param text        The document.
+   * @return JsonValue  The root value.
+   */
+  static JsonValue Parse(std::string_view text);
+
+  /**
+   * @brief Getter for the type.
+   *
+   * @return Type The kind of the value.
+   */
+  Type GetType() const { return _type; }
+
+  /**
+   * @brief Checks if the value is null or missing.
+   *
+   * @return true   The value is null.
+   * @return false  The value holds data.
+   */
+  bool IsNull() const { return _type == Type::eNull; }
+
+  /**
+   * @brief Amount of elements of an array or members of an object.
+   *
+   * @return size_t The size, 0 for all other values.
+   */
+  size_t GetSize() const { return _elements.size(); }
+
+  /**
+   * @brief Looks up a member of an object.
+   *
+   * @param key               Key of the member.
+   * @return const JsonValue& The member or null if it does not exist.
+   */
+  const JsonValue &operator[](std::string_view key) const;
+
+  /**
+   * @brief Looks up an element of an array.
+   *
+   * @param index             Index of the element.
+   * @return const JsonValue& The element or null if it does not exist.
+   */
+  const JsonValue &operator[](size_t index) const;
+
+  /**
+   * @brief Reads a bool.
+   *
+   * @param fallback  Returned if the value is not a bool.
+   * @return bool     The value.
+   */
+  bool AsBool(bool fallback = false) const;
+
+  /**
+   * @brief Reads a number.
+   *
+   * @param fallback  Returned if the value is not a number.
+   * @return double   The value.
+   */
+  double AsNumber(double fallback = 0.0) const;
+
+  /**
+   * @brief Reads a non negative integer, as used for indices and sizes.
+   *
+   * @param fallback  Returned if the value is not a non negative integer.
+   * @return uint64_t The value.
+   */
+  uint64_t AsUnsigned(uint64_t fallback = 0) const;
+
+  /**
+   * @brief Reads a string.
+   *
+   * @return const std::string& The value, empty if it is not a string.
+   */
+  const std::string &AsString() const { return _string; }
+};
+
+} // namespace io::gltf
+
+#endif /* __IO_GLTF_JSON_H__ */
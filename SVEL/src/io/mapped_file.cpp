@@ -0,0 +1,113 @@
+/**
+ * @file mapped_file.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the MappedFile.
+ * @date 2023-09-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "mapped_file.h"
+
+// OS
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// STL
+#include <stdexcept>
+
+using namespace io;
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path &file) {
+  _fileHandle = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (_fileHandle == INVALID_HANDLE_VALUE)
+    throw std::runtime_error("Could not open file for mapping.");
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(_fileHandle, &fileSize)) {
+    CloseHandle(_fileHandle);
+    throw std::runtime_error("Could not query size of mapped file.");
+  }
+  _size = (size_t)fileSize.QuadPart;
+
+  // Empty files cannot be mapped
+  if (_size == 0) {
+    _data = "";
+    return;
+  }
+
+  _mappingHandle =
+      CreateFileMappingW(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (_mappingHandle == nullptr) {
+    CloseHandle(_fileHandle);
+    throw std::runtime_error("Could not create file mapping.");
+  }
+
+  _data = (const char *)MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+  if (_data == nullptr) {
+    CloseHandle(_mappingHandle);
+    CloseHandle(_fileHandle);
+    throw std::runtime_error("Could not map file.");
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (_mappingHandle != nullptr) {
+    UnmapViewOfFile(_data);
+    CloseHandle(_mappingHandle);
+  }
+  CloseHandle(_fileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path &file) {
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Could not open file for mapping.");
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0) {
+    close(fd);
+    throw std::runtime_error("Could not query size of mapped file.");
+  }
+  _size = (size_t)fileStat.st_size;
+
+  // Empty files cannot be mapped
+  if (_size == 0) {
+    close(fd);
+    _data = "";
+    return;
+  }
+
+  // The mapping keeps its own reference to the file
+  void *mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED)
+    throw std::runtime_error("Could not map file.");
+
+  // We are going to walk the file front to back
+  madvise(mapping, _size, MADV_SEQUENTIAL);
+  _data = (const char *)mapping;
+}
+
+MappedFile::~MappedFile() {
+  if (_size > 0)
+    munmap((void *)_data, _size);
+}
+
+#endif
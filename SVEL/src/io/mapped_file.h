@@ -0,0 +1,104 @@
+/**
+ * @file mapped_file.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declaration of the MappedFile.
+ * @date 2023-09-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __IO_MAPPED_FILE_H__
+#define __IO_MAPPED_FILE_H__
+
+// Internal
+#include <svel/config.h>
+
+// STL
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+namespace io {
+
+/**
+ * @brief Read-only memory mapping of a complete file. The mapping stays valid
+ * for the lifetime of the object.
+ */
+class MappedFile {
+private:
+  /**
+   * @brief Start of the mapped file contents.
+   */
+  const char *_data = nullptr;
+
+  /**
+   * @brief Size of the mapped file in bytes.
+   */
+  size_t _size = 0;
+
+#ifdef _WIN32
+  /**
+   * @brief Handle of the opened file.
+   */
+  void *_fileHandle = nullptr;
+
+  /**
+   * @brief Handle of the file mapping object.
+   */
+  void *_mappingHandle = nullptr;
+#endif
+
+public:
+  /**
+   * @brief Maps the file into the address space of the process. Will throw if
+   * the file cannot be opened or mapped.
+   *
+   * @param file File to map.
+   */
+  MappedFile(const std::filesystem::path &file);
+
+  /**
+   * @brief The mapping cannot be copied.
+   */
+  MappedFile(const MappedFile &) = delete;
+
+  /**
+   * @brief The mapping cannot be copied.
+   *
+   * @return MappedFile& ~unused~
+   */
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /**
+   * @brief Unmaps the file.
+   */
+  ~MappedFile();
+
+  /**
+   * @brief Getter for the mapped data.
+   *
+   * @return const char* Pointer to the first byte of the file.
+   */
+  const char *GetData() const { return _data; }
+
+  /**
+   * @brief Getter for the size of the mapping.
+   *
+   * @return size_t Size of the file in bytes.
+   */
+  size_t GetSize() const { return _size; }
+
+  /**
+   * @brief Getter for the file contents as a string view.
+   *
+   * @return std::string_view View of the complete file.
+   */
+  std::string_view GetView() const { return {_data, _size}; }
+};
+SVEL_CLASS(MappedFile)
+
+} // namespace io
+
+#endif /* __IO_MAPPED_FILE_H__ */
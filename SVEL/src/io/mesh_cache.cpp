@@ -0,0 +1,403 @@
+/**
+ * @file mesh_cache.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the binary MeshCache.
+ * @date 2023-09-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "mesh_cache.h"
+#include "mesh_codec.h"
+
+// STL
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+using namespace io;
+
+namespace {
+
+/**
+ * @brief Identifies a cache file.
+ */
+constexpr char MAGIC[4] = {'S', 'V', 'M', 'C'};
+
+/**
+ * @brief Version of the format. Has to be increased whenever the layout of the
+ * file changes.
+ */
+constexpr uint32_t VERSION = 4;
+
+/**
+ * @brief Alignment of the data blocks within the file.
+ */
+constexpr uint64_t ALIGNMENT = 16;
+
+/**
+ * @brief Start of a cache file.
+ */
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint64_t sourceSize;
+  int64_t sourceTime;
+  uint64_t sourceHash;
+  uint64_t layoutKey;
+  uint32_t meshCount;
+  uint32_t reserved;
+};
+
+/**
+ * @brief Describes where the data of a mesh is stored in a cache file.
+ */
+struct Record {
+  uint64_t vertexOffset;
+  uint64_t indexOffset;
+  uint32_t vertexStride;
+  uint32_t vertexCount;
+  uint32_t indexSize;
+  uint32_t indexCount;
+  uint64_t rangeOffset;
+  uint32_t rangeCount;
+  uint32_t uniqueVertexCount;
+  uint64_t lodOffset;
+  uint32_t lodCount;
+  uint32_t reserved;
+  uint64_t encodedVertexSize;
+  uint64_t encodedIndexSize;
+};
+
+uint64_t _align(uint64_t value) {
+  return (value + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+/**
+ * @brief Size of the stored vertex data of an entry.
+ *
+ * @param entry     The entry.
+ * @return uint64_t Size in bytes, compressed if the entry is compressed.
+ */
+uint64_t _getVertexBytes(const MeshCache::Entry &entry) {
+  return entry.encodedVertexSize > 0
+             ? entry.encodedVertexSize
+             : (uint64_t)entry.vertexStride * entry.vertexCount;
+}
+
+/**
+ * @brief Size of the stored index data of an entry.
+ *
+ * @param entry     The entry.
+ * @return uint64_t Size in bytes, compressed if the entry is compressed.
+ */
+uint64_t _getIndexBytes(const MeshCache::Entry &entry) {
+  return entry.encodedIndexSize > 0
+             ? entry.encodedIndexSize
+             : (uint64_t)entry.indexSize * entry.indexCount;
+}
+
+int64_t _getWriteTime(const std::filesystem::path &file) {
+  return (int64_t)std::filesystem::last_write_time(file)
+      .time_since_epoch()
+      .count();
+}
+
+} // namespace
+
+MeshCache::MeshCache(SharedMappedFile file, std::vector<Entry> &&entries)
+    : _file(file), _entries(std::move(entries)) {}
+
+std::filesystem::path
+MeshCache::GetCachePath(const std::filesystem::path &source,
+                        const std::string &cacheDirectory) {
+  if (cacheDirectory.empty()) {
+    auto cacheFile = source;
+    cacheFile += ".svelmesh";
+    return cacheFile;
+  }
+
+  // Sources with the same name may live in different directories
+  std::error_code error;
+  auto absolute = std::filesystem::absolute(source, error).u8string();
+  auto pathHash = Hash(absolute.data(), absolute.size());
+  auto fileName = source.filename().u8string() + "." +
+                  std::to_string(pathHash) + ".svelmesh";
+  return std::filesystem::path(cacheDirectory) / fileName;
+}
+
+SharedMeshCache MeshCache::Load(const std::filesystem::path &source,
+                                const std::filesystem::path &cacheFile,
+                                uint64_t layoutKey) {
+  std::error_code error;
+  if (!std::filesystem::is_regular_file(cacheFile, error))
+    return nullptr;
+
+  try {
+    auto file = std::make_shared<MappedFile>(cacheFile);
+    const auto *data = file->GetData();
+    const auto size = (uint64_t)file->GetSize();
+    if (size < sizeof(Header))
+      return nullptr;
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != VERSION || header.layoutKey != layoutKey)
+      return nullptr;
+
+    // Cheap checks first, only hash the source if it was touched
+    if (header.sourceSize != (uint64_t)std::filesystem::file_size(source))
+      return nullptr;
+    if (header.sourceTime != _getWriteTime(source)) {
+      MappedFile sourceFile(source);
+      if (Hash(sourceFile.GetData(), sourceFile.GetSize()) != header.sourceHash)
+        return nullptr;
+    }
+
+    const uint64_t recordsEnd =
+        sizeof(Header) + (uint64_t)header.meshCount * sizeof(Record);
+    if (size < recordsEnd)
+      return nullptr;
+
+    std::vector<Entry> entries{};
+    entries.reserve(header.meshCount);
+    for (uint32_t i = 0; i < header.meshCount; i++) {
+      Record record;
+      std::memcpy(&record, data + sizeof(Header) + i * sizeof(Record),
+                  sizeof(Record));
+
+      // Compressed blocks are only as large as their encoding
+      const uint64_t vertexBytes =
+          record.encodedVertexSize > 0
+              ? record.encodedVertexSize
+              : (uint64_t)record.vertexStride * record.vertexCount;
+      const uint64_t indexBytes =
+          record.encodedIndexSize > 0
+              ? record.encodedIndexSize
+              : (uint64_t)record.indexSize * record.indexCount;
+      const uint64_t rangeBytes =
+          (uint64_t)record.rangeCount * sizeof(renderer::DrawRange);
+      const uint64_t lodBytes =
+          (uint64_t)record.lodCount * sizeof(renderer::LodLevel);
+      auto fits = [&](uint64_t blockOffset, uint64_t blockSize) {
+        return blockOffset >= recordsEnd && blockOffset <= size &&
+               size - blockOffset >= blockSize;
+      };
+      if ((record.indexSize != 2 && record.indexSize != 4) ||
+          (record.encodedVertexSize > 0 &&
+           record.vertexStride > MAX_ENCODED_VERTEX_STRIDE) ||
+          record.uniqueVertexCount > record.vertexCount ||
+          !fits(record.vertexOffset, vertexBytes) ||
+          !fits(record.indexOffset, indexBytes) ||
+          !fits(record.rangeOffset, rangeBytes) ||
+          !fits(record.lodOffset, lodBytes))
+        return nullptr;
+
+      Entry entry;
+      entry.vertices = data + record.vertexOffset;
+      entry.encodedVertexSize = record.encodedVertexSize;
+      entry.vertexStride = record.vertexStride;
+      entry.vertexCount = record.vertexCount;
+      entry.indices = data + record.indexOffset;
+      entry.encodedIndexSize = record.encodedIndexSize;
+      entry.indexSize = record.indexSize;
+      entry.indexCount = record.indexCount;
+      if (record.rangeCount > 0) {
+        entry.ranges =
+            (const renderer::DrawRange *)(data + record.rangeOffset);
+        entry.rangeCount = record.rangeCount;
+      }
+      entry.uniqueVertexCount = record.uniqueVertexCount;
+      if (record.lodCount > 0) {
+        entry.lods = (const renderer::LodLevel *)(data + record.lodOffset);
+        entry.lodCount = record.lodCount;
+      }
+
+      // Levels have to consist of existing ranges
+      for (uint32_t j = 0; j < entry.lodCount; j++)
+        if ((uint64_t)entry.lods[j].firstRange + entry.lods[j].rangeCount >
+            entry.rangeCount)
+          return nullptr;
+      entries.push_back(entry);
+    }
+    return std::make_shared<MeshCache>(file, std::move(entries));
+  } catch (const std::exception &) {
+    // An unreadable cache is the same as no cache
+    return nullptr;
+  }
+}
+
+bool MeshCache::Write(const std::filesystem::path &source,
+                      const std::filesystem::path &cacheFile,
+                      uint64_t layoutKey, const std::vector<Entry> &entries,
+                      bool compress) {
+  try {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.layoutKey = layoutKey;
+    header.meshCount = (uint32_t)entries.size();
+    {
+      MappedFile sourceFile(source);
+      header.sourceSize = sourceFile.GetSize();
+      header.sourceHash = Hash(sourceFile.GetData(), sourceFile.GetSize());
+    }
+    header.sourceTime = _getWriteTime(source);
+
+    // Compress up front, the layout depends on the encoded sizes
+    std::vector<std::vector<uint8_t>> encodedVertices(entries.size());
+    std::vector<std::vector<uint8_t>> encodedIndices(entries.size());
+    std::vector<Entry> blocks = entries;
+    for (size_t i = 0; compress && i < entries.size(); i++) {
+      const auto &entry = entries[i];
+      if (entry.vertexStride > MAX_ENCODED_VERTEX_STRIDE)
+        continue;
+      encodedVertices[i] = EncodeVertexBuffer(
+          entry.vertices, entry.vertexCount, entry.vertexStride);
+      encodedIndices[i] =
+          EncodeIndexBuffer(entry.indices, entry.indexCount, entry.indexSize);
+      blocks[i].vertices = encodedVertices[i].data();
+      blocks[i].encodedVertexSize = encodedVertices[i].size();
+      blocks[i].indices = encodedIndices[i].data();
+      blocks[i].encodedIndexSize = encodedIndices[i].size();
+    }
+
+    // Lay out the data blocks behind the records
+    std::vector<Record> records{};
+    records.reserve(entries.size());
+    uint64_t offset = sizeof(Header) + entries.size() * sizeof(Record);
+    for (const auto &entry : blocks) {
+      Record record{};
+      record.vertexStride = entry.vertexStride;
+      record.vertexCount = entry.vertexCount;
+      record.indexSize = entry.indexSize;
+      record.indexCount = entry.indexCount;
+      record.encodedVertexSize = entry.encodedVertexSize;
+      record.encodedIndexSize = entry.encodedIndexSize;
+      record.vertexOffset = offset = _align(offset);
+      offset += _getVertexBytes(entry);
+      record.indexOffset = offset = _align(offset);
+      offset += _getIndexBytes(entry);
+      record.rangeCount = entry.rangeCount;
+      record.uniqueVertexCount = entry.uniqueVertexCount;
+      record.rangeOffset = offset = _align(offset);
+      offset += (uint64_t)entry.rangeCount * sizeof(renderer::DrawRange);
+      record.lodCount = entry.lodCount;
+      record.lodOffset = offset = _align(offset);
+      offset += (uint64_t)entry.lodCount * sizeof(renderer::LodLevel);
+      records.push_back(record);
+    }
+
+    auto parent = cacheFile.parent_path();
+    if (!parent.empty())
+      std::filesystem::create_directories(parent);
+
+    // Write to a temporary file first, readers never see partial caches.
+    // Concurrent writers of the same cache use their own temporary file.
+    auto tempFile = cacheFile;
+    tempFile += ".tmp" + std::to_string(std::hash<std::thread::id>{}(
+                             std::this_thread::get_id()));
+    {
+      std::ofstream stream(tempFile, std::ios::binary | std::ios::trunc);
+      if (!stream.is_open())
+        return false;
+
+      stream.write((const char *)&header, sizeof(Header));
+      stream.write((const char *)records.data(),
+                   (std::streamsize)(records.size() * sizeof(Record)));
+
+      const char padding[ALIGNMENT] = {};
+      uint64_t position = sizeof(Header) + records.size() * sizeof(Record);
+      auto writeBlock = [&](uint64_t blockOffset, const void *blockData,
+                            uint64_t blockSize) {
+        stream.write(padding, (std::streamsize)(blockOffset - position));
+        stream.write((const char *)blockData, (std::streamsize)blockSize);
+        position = blockOffset + blockSize;
+      };
+      for (size_t i = 0; i < blocks.size(); i++) {
+        const auto &entry = blocks[i];
+        writeBlock(records[i].vertexOffset, entry.vertices,
+                   _getVertexBytes(entry));
+        writeBlock(records[i].indexOffset, entry.indices,
+                   _getIndexBytes(entry));
+        writeBlock(records[i].rangeOffset, entry.ranges,
+                   (uint64_t)entry.rangeCount * sizeof(renderer::DrawRange));
+        writeBlock(records[i].lodOffset, entry.lods,
+                   (uint64_t)entry.lodCount * sizeof(renderer::LodLevel));
+      }
+
+      if (!stream.good()) {
+        stream.close();
+        std::filesystem::remove(tempFile);
+        return false;
+      }
+    }
+    std::filesystem::rename(tempFile, cacheFile);
+    return true;
+  } catch (const std::exception &) {
+    // The cache is optional, failing to write it is not an error
+    return false;
+  }
+}
+
+MeshCache::Entry MeshCache::Decompress(const Entry &entry,
+                                       std::vector<uint8_t> &out_vertices,
+                                       std::vector<uint8_t> &out_indices) {
+  Entry result = entry;
+  if (entry.encodedVertexSize > 0) {
+    out_vertices.resize((size_t)entry.vertexStride * entry.vertexCount);
+    ReadVertices(entry, out_vertices.data());
+    result.vertices = out_vertices.data();
+    result.encodedVertexSize = 0;
+  }
+  if (entry.encodedIndexSize > 0) {
+    out_indices.resize((size_t)entry.indexSize * entry.indexCount);
+    ReadIndices(entry, out_indices.data());
+    result.indices = out_indices.data();
+    result.encodedIndexSize = 0;
+  }
+  return result;
+}
+
+void MeshCache::ReadVertices(const Entry &entry, void *destination) {
+  if (entry.encodedVertexSize == 0)
+    std::memcpy(destination, entry.vertices,
+                (size_t)entry.vertexStride * entry.vertexCount);
+  else if (!DecodeVertexBuffer(destination, entry.vertexCount,
+                               entry.vertexStride, entry.vertices,
+                               (size_t)entry.encodedVertexSize))
+    throw std::runtime_error("Corrupt compressed vertex data.");
+}
+
+void MeshCache::ReadIndices(const Entry &entry, void *destination) {
+  if (entry.encodedIndexSize == 0)
+    std::memcpy(destination, entry.indices,
+                (size_t)entry.indexSize * entry.indexCount);
+  else if (!DecodeIndexBuffer(destination, entry.indexCount, entry.indexSize,
+                              entry.indices, (size_t)entry.encodedIndexSize))
+    throw std::runtime_error("Corrupt compressed index data.");
+}
+
+uint64_t MeshCache::Hash(const void *data, size_t size, uint64_t seed) {
+  constexpr uint64_t prime = 0x100000001b3ull;
+  const auto *bytes = (const unsigned char *)data;
+  uint64_t hash = seed;
+
+  // Consume eight bytes per step, FNV-1a style
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(uint64_t));
+    hash = (hash ^ word) * prime;
+    hash ^= hash >> 29;
+  }
+  for (; i < size; i++)
+    hash = (hash ^ bytes[i]) * prime;
+  return hash;
+}
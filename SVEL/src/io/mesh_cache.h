@@ -0,0 +1,235 @@
+/**
+ * @file mesh_cache.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declaration of the binary MeshCache.
+ * @date 2023-09-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __IO_MESH_CACHE_H__
+#define __IO_MESH_CACHE_H__
+
+// Local
+#include "mapped_file.h"
+
+// Internal
+#include <renderer/mesh/draw_range.hpp>
+#include <svel/config.h>
+
+// STL
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace io {
+
+/**
+ * @brief Binary cache of final, ready to upload mesh data. The cache file is
+ * memory mapped and its entries point directly into the mapping, so they stay
+ * valid for the lifetime of the cache object.
+ *
+ * Layout: A header with the state of the source file, one record per mesh and
+ * then the 16 byte aligned vertex, index, draw range and level of detail data
+ * of all meshes. Vertex and index data is optionally compressed with the mesh
+ * codec.
+ */
+class MeshCache {
+public:
+  /**
+   * @brief Describes the data of a single mesh.
+   */
+  struct Entry {
+    /**
+     * @brief Interleaved vertex data. Compressed if encodedVertexSize is set.
+     */
+    const void *vertices = nullptr;
+
+    /**
+     * @brief Size of the compressed vertex data in bytes, 0 if the vertices
+     * are not compressed.
+     */
+    uint64_t encodedVertexSize = 0;
+
+    /**
+     * @brief Size of a single vertex in bytes.
+     */
+    uint32_t vertexStride = 0;
+
+    /**
+     * @brief Amount of vertices.
+     */
+    uint32_t vertexCount = 0;
+
+    /**
+     * @brief Index data. Compressed if encodedIndexSize is set.
+     */
+    const void *indices = nullptr;
+
+    /**
+     * @brief Size of the compressed index data in bytes, 0 if the indices are
+     * not compressed.
+     */
+    uint64_t encodedIndexSize = 0;
+
+    /**
+     * @brief Size of a single index in bytes. Either 2 or 4.
+     */
+    uint32_t indexSize = 0;
+
+    /**
+     * @brief Amount of indices.
+     */
+    uint32_t indexCount = 0;
+
+    /**
+     * @brief Ranges in which the mesh is drawn. May be null if the mesh is
+     * drawn at once.
+     */
+    const renderer::DrawRange *ranges = nullptr;
+
+    /**
+     * @brief Amount of ranges.
+     */
+    uint32_t rangeCount = 0;
+
+    /**
+     * @brief Amount of distinct vertices. Smaller than vertexCount if vertices
+     * were duplicated to split the mesh into ranges.
+     */
+    uint32_t uniqueVertexCount = 0;
+
+    /**
+     * @brief Levels of detail, made of the ranges. May be null if the mesh
+     * has a single level.
+     */
+    const renderer::LodLevel *lods = nullptr;
+
+    /**
+     * @brief Amount of levels of detail.
+     */
+    uint32_t lodCount = 0;
+  };
+
+private:
+  /**
+   * @brief The mapped cache file.
+   */
+  SharedMappedFile _file;
+
+  /**
+   * @brief Entries pointing into the mapped file.
+   */
+  std::vector<Entry> _entries;
+
+public:
+  /**
+   * @brief Construct a MeshCache from an already validated mapping. Use Load
+   * to open a cache file.
+   *
+   * @param file    The mapped cache file.
+   * @param entries Entries that point into the mapping.
+   */
+  MeshCache(SharedMappedFile file, std::vector<Entry> &&entries);
+
+  /**
+   * @brief Getter for the cached meshes.
+   *
+   * @return const std::vector<Entry>& The cached meshes.
+   */
+  const std::vector<Entry> &GetEntries() const { return _entries; }
+
+  /**
+   * @brief Determines where the cache of the source file is stored.
+   *
+   * @param source                The source file that is cached.
+   * @param cacheDirectory        Directory for cache files. If empty, the
+   *                              cache is placed next to the source file.
+   * @return std::filesystem::path Path of the cache file.
+   */
+  static std::filesystem::path
+  GetCachePath(const std::filesystem::path &source,
+               const std::string &cacheDirectory);
+
+  /**
+   * @brief Opens the cache file if it exists and still matches the source
+   * file and layout.
+   *
+   * @param source                      The source file that is cached.
+   * @param cacheFile                   The cache file to open.
+   * @param layoutKey                   Identifies the vertex layout and the
+   *                                    options the data was built with.
+   * @return std::shared_ptr<MeshCache> The cache or nullptr if the cache is
+   *                                    missing, corrupt or outdated.
+   */
+  static std::shared_ptr<MeshCache> Load(const std::filesystem::path &source,
+                                         const std::filesystem::path &cacheFile,
+                                         uint64_t layoutKey);
+
+  /**
+   * @brief Writes the meshes to the cache file. The file is replaced
+   * atomically, so concurrent readers never see partial data.
+   *
+   * @param source    The source file that is cached.
+   * @param cacheFile The cache file to write.
+   * @param layoutKey Identifies the vertex layout and the options the data was
+   *                  built with.
+   * @param entries   The meshes to store. Must not be compressed.
+   * @param compress  Compress the vertex and index data.
+   * @return true     The cache was written.
+   * @return false    The cache could not be written.
+   */
+  static bool Write(const std::filesystem::path &source,
+                    const std::filesystem::path &cacheFile, uint64_t layoutKey,
+                    const std::vector<Entry> &entries, bool compress = false);
+
+  /**
+   * @brief Decompresses the vertex and index data of an entry. Throws a
+   * std::runtime_error if the data is corrupt.
+   *
+   * @param entry         The entry. Returned as is if it is not compressed.
+   * @param out_vertices  Receives the vertex data.
+   * @param out_indices   Receives the index data.
+   * @return Entry        The entry pointing to the decompressed data.
+   */
+  static Entry Decompress(const Entry &entry,
+                          std::vector<uint8_t> &out_vertices,
+                          std::vector<uint8_t> &out_indices);
+
+  /**
+   * @brief Writes the vertex data of an entry, decompressing it on the way.
+   * Throws a std::runtime_error if the data is corrupt.
+   *
+   * @param entry       The entry.
+   * @param destination Receives vertexStride * vertexCount bytes.
+   */
+  static void ReadVertices(const Entry &entry, void *destination);
+
+  /**
+   * @brief Writes the index data of an entry, decompressing it on the way.
+   * Throws a std::runtime_error if the data is corrupt.
+   *
+   * @param entry       The entry.
+   * @param destination Receives indexSize * indexCount bytes.
+   */
+  static void ReadIndices(const Entry &entry, void *destination);
+
+  /**
+   * @brief Hashes arbitrary data. Not suited for cryptographic purposes.
+   *
+   * @param data      Data to hash.
+   * @param size      Size of the data in bytes.
+   * @param seed      Initial hash value, allows chaining of hashes.
+   * @return uint64_t The hash.
+   */
+  static uint64_t Hash(const void *data, size_t size,
+                       uint64_t seed = 0xcbf29ce484222325ull);
+};
+SVEL_CLASS(MeshCache)
+
+} // namespace io
+
+#endif /* __IO_MESH_CACHE_H__ */
@@ -0,0 +1,421 @@
+/**
+ * @file mesh_codec.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the vertex and index buffer compression.
+ * @date 2023-09-23
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "mesh_codec.h"
+
+// Internal
+#include <util/simd.hpp>
+
+// STL
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace io;
+
+namespace {
+
+/**
+ * @brief First byte of compressed vertices. Has to be changed whenever the
+ * format changes.
+ */
+constexpr uint8_t VERTEX_FORMAT = 0xA1;
+
+/**
+ * @brief First byte of compressed indices.
+ */
+constexpr uint8_t INDEX_FORMAT = 0xB1;
+
+/**
+ * @brief Amount of elements that are compressed together. Multiple of the
+ * group size.
+ */
+constexpr size_t BLOCK_SIZE = 256;
+
+/**
+ * @brief Amount of bytes that share a bit width.
+ */
+constexpr size_t GROUP_SIZE = 16;
+
+/**
+ * @brief Payload bytes of a group for every bit width code. The codes stand
+ * for 0, 2, 4 and 8 bits per byte.
+ */
+constexpr size_t PAYLOAD_SIZES[4] = {0, 4, 8, 16};
+
+/**
+ * @brief Maps small negative and positive differences to small values.
+ *
+ * @param delta     The difference.
+ * @return uint8_t  The zigzag encoded difference.
+ */
+uint8_t _zigzag(uint8_t delta) {
+  return (uint8_t)((uint8_t)(delta << 1) ^ (uint8_t)((int8_t)delta >> 7));
+}
+
+/**
+ * @brief Packs bytes in groups with the smallest bit width that holds them.
+ * Every plane starts with two bits per group that select the width, followed
+ * by the payload of all groups.
+ *
+ * @param values  The bytes.
+ * @param count   Amount of bytes.
+ * @param out     Receives the packed bytes.
+ */
+void _encodePlane(const uint8_t *values, size_t count,
+                  std::vector<uint8_t> &out) {
+  const size_t groupCount = (count + GROUP_SIZE - 1) / GROUP_SIZE;
+  const size_t headerStart = out.size();
+  out.resize(headerStart + (groupCount + 3) / 4, 0);
+
+  for (size_t g = 0; g < groupCount; g++) {
+    // The tail of the last group is padded with zeros
+    uint8_t group[GROUP_SIZE] = {};
+    const size_t groupStart = g * GROUP_SIZE;
+    std::memcpy(group, values + groupStart,
+                std::min(GROUP_SIZE, count - groupStart));
+    const uint8_t largest = *std::max_element(group, group + GROUP_SIZE);
+    const uint8_t code = largest == 0 ? 0 : largest < 4 ? 1 : largest < 16 ? 2
+                                                                           : 3;
+    out[headerStart + g / 4] |= (uint8_t)(code << (2 * (g % 4)));
+
+    // Byte i of the payload holds values i, i + 4, ... or i, i + 8, so that
+    // the decoder can unpack them with whole register shifts
+    uint8_t payload[GROUP_SIZE] = {};
+    for (size_t i = 0; i < GROUP_SIZE; i++) {
+      if (code == 1)
+        payload[i % 4] |= (uint8_t)(group[i] << (2 * (i / 4)));
+      else if (code == 2)
+        payload[i % 8] |= (uint8_t)(group[i] << (4 * (i / 8)));
+      else
+        payload[i] = group[i];
+    }
+    out.insert(out.end(), payload, payload + PAYLOAD_SIZES[code]);
+  }
+}
+
+#ifdef SVEL_SSE2
+/**
+ * @brief Unpacks a group into 16 bytes.
+ *
+ * @param code      Bit width code of the group.
+ * @param payload   Payload of the group.
+ * @return __m128i  The bytes.
+ */
+__m128i _unpackGroup(uint8_t code, const uint8_t *payload) {
+  switch (code) {
+  case 0:
+    return _mm_setzero_si128();
+  case 1: {
+    int32_t word;
+    std::memcpy(&word, payload, sizeof(word));
+    const __m128i packed = _mm_cvtsi32_si128(word);
+    const __m128i mask = _mm_set1_epi8(3);
+
+    // Shifting 16 bit lanes moves bits across bytes, the mask drops them
+    const __m128i v0 = _mm_and_si128(packed, mask);
+    const __m128i v1 = _mm_and_si128(_mm_srli_epi16(packed, 2), mask);
+    const __m128i v2 = _mm_and_si128(_mm_srli_epi16(packed, 4), mask);
+    const __m128i v3 = _mm_and_si128(_mm_srli_epi16(packed, 6), mask);
+    return _mm_unpacklo_epi64(_mm_unpacklo_epi32(v0, v1),
+                              _mm_unpacklo_epi32(v2, v3));
+  }
+  case 2: {
+    const __m128i packed = _mm_loadl_epi64((const __m128i *)payload);
+    const __m128i mask = _mm_set1_epi8(15);
+    return _mm_unpacklo_epi64(
+        _mm_and_si128(packed, mask),
+        _mm_and_si128(_mm_srli_epi16(packed, 4), mask));
+  }
+  default:
+    return _mm_loadu_si128((const __m128i *)payload);
+  }
+}
+
+/**
+ * @brief Restores the bytes of a group from their zigzag encoded differences.
+ *
+ * @param deltas    The encoded differences.
+ * @param previous  The byte in front of the group.
+ * @return __m128i  The bytes.
+ */
+__m128i _applyDeltas(__m128i deltas, uint8_t previous) {
+  const __m128i sign = _mm_sub_epi8(
+      _mm_setzero_si128(), _mm_and_si128(deltas, _mm_set1_epi8(1)));
+  const __m128i half =
+      _mm_and_si128(_mm_srli_epi16(deltas, 1), _mm_set1_epi8(0x7F));
+  __m128i values = _mm_xor_si128(half, sign);
+
+  // Prefix sum over the 16 bytes in four steps
+  values = _mm_add_epi8(values, _mm_slli_si128(values, 1));
+  values = _mm_add_epi8(values, _mm_slli_si128(values, 2));
+  values = _mm_add_epi8(values, _mm_slli_si128(values, 4));
+  values = _mm_add_epi8(values, _mm_slli_si128(values, 8));
+  return _mm_add_epi8(values, _mm_set1_epi8((char)previous));
+}
+#else
+/**
+ * @brief Unpacks a group into 16 bytes.
+ *
+ * @param code    Bit width code of the group.
+ * @param payload Payload of the group.
+ * @param out     Receives the bytes.
+ */
+void _unpackGroup(uint8_t code, const uint8_t *payload, uint8_t *out) {
+  for (size_t i = 0; i < GROUP_SIZE; i++) {
+    if (code == 0)
+      out[i] = 0;
+    else if (code == 1)
+      out[i] = (uint8_t)((payload[i % 4] >> (2 * (i / 4))) & 3);
+    else if (code == 2)
+      out[i] = (uint8_t)((payload[i % 8] >> (4 * (i / 8))) & 15);
+    else
+      out[i] = payload[i];
+  }
+}
+#endif
+
+/**
+ * @brief Unpacks a plane written by _encodePlane.
+ *
+ * @param data      Read position. Moved behind the plane.
+ * @param end       End of the compressed data.
+ * @param count     Amount of bytes in the plane.
+ * @param delta     Restore the bytes from their differences.
+ * @param previous  Byte in front of the plane. Receives the last byte.
+ * @param out       Receives the bytes. Has to hold count rounded up to the
+ *                  group size.
+ * @return true     The plane was unpacked.
+ * @return false    The data is malformed.
+ */
+bool _decodePlane(const uint8_t *&data, const uint8_t *end, size_t count,
+                  bool delta, uint8_t &previous, uint8_t *out) {
+  const size_t groupCount = (count + GROUP_SIZE - 1) / GROUP_SIZE;
+  const size_t headerSize = (groupCount + 3) / 4;
+  if ((size_t)(end - data) < headerSize)
+    return false;
+  const uint8_t *header = data;
+  const uint8_t *payload = data + headerSize;
+
+  // Validate once, so that the groups can be unpacked without checks
+  size_t payloadSize = 0;
+  for (size_t g = 0; g < groupCount; g++)
+    payloadSize += PAYLOAD_SIZES[(header[g / 4] >> (2 * (g % 4))) & 3];
+  if ((size_t)(end - payload) < payloadSize)
+    return false;
+
+  for (size_t g = 0; g < groupCount; g++) {
+    const auto code = (uint8_t)((header[g / 4] >> (2 * (g % 4))) & 3);
+    uint8_t *group = out + g * GROUP_SIZE;
+#ifdef SVEL_SSE2
+    __m128i values = _unpackGroup(code, payload);
+    if (delta)
+      values = _applyDeltas(values, previous);
+    _mm_storeu_si128((__m128i *)group, values);
+    previous = group[GROUP_SIZE - 1];
+#else
+    _unpackGroup(code, payload, group);
+    if (delta)
+      for (size_t i = 0; i < GROUP_SIZE; i++) {
+        const uint8_t value = group[i];
+        previous = group[i] = (uint8_t)(previous + ((value >> 1) ^
+                                                    (uint8_t)-(value & 1)));
+      }
+#endif
+    payload += PAYLOAD_SIZES[code];
+  }
+
+  if (count > 0)
+    previous = out[count - 1];
+  data = payload;
+  return true;
+}
+
+/**
+ * @brief Interleaves byte planes into vertices.
+ *
+ * @param planes        Plane k holds byte k of every vertex, BLOCK_SIZE apart.
+ * @param count         Amount of vertices.
+ * @param vertexStride  Size of a vertex in bytes.
+ * @param out           Receives the vertices. Has to hold BLOCK_SIZE vertices.
+ */
+void _interleave(const uint8_t *planes, size_t count, size_t vertexStride,
+                 uint8_t *out) {
+  size_t k = 0;
+#ifdef SVEL_SSE2
+  // Four planes at once become four bytes of 16 vertices
+  for (; k + 4 <= vertexStride; k += 4) {
+    for (size_t i = 0; i < count; i += GROUP_SIZE) {
+      const auto *plane = planes + k * BLOCK_SIZE + i;
+      const __m128i a = _mm_loadu_si128((const __m128i *)plane);
+      const __m128i b = _mm_loadu_si128((const __m128i *)(plane + BLOCK_SIZE));
+      const __m128i c =
+          _mm_loadu_si128((const __m128i *)(plane + 2 * BLOCK_SIZE));
+      const __m128i d =
+          _mm_loadu_si128((const __m128i *)(plane + 3 * BLOCK_SIZE));
+      const __m128i abLow = _mm_unpacklo_epi8(a, b);
+      const __m128i abHigh = _mm_unpackhi_epi8(a, b);
+      const __m128i cdLow = _mm_unpacklo_epi8(c, d);
+      const __m128i cdHigh = _mm_unpackhi_epi8(c, d);
+      __m128i quads[4] = {_mm_unpacklo_epi16(abLow, cdLow),
+                          _mm_unpackhi_epi16(abLow, cdLow),
+                          _mm_unpacklo_epi16(abHigh, cdHigh),
+                          _mm_unpackhi_epi16(abHigh, cdHigh)};
+      auto *vertex = out + i * vertexStride + k;
+      for (auto &quad : quads)
+        for (int j = 0; j < 4; j++) {
+          const int32_t word = _mm_cvtsi128_si32(quad);
+          std::memcpy(vertex, &word, sizeof(word));
+          quad = _mm_srli_si128(quad, 4);
+          vertex += vertexStride;
+        }
+    }
+  }
+#endif
+  for (; k < vertexStride; k++)
+    for (size_t i = 0; i < count; i++)
+      out[i * vertexStride + k] = planes[k * BLOCK_SIZE + i];
+}
+
+} // namespace
+
+std::vector<uint8_t> io::EncodeVertexBuffer(const void *vertices,
+                                            size_t vertexCount,
+                                            size_t vertexStride) {
+  if (vertexStride == 0 || vertexStride > MAX_ENCODED_VERTEX_STRIDE)
+    throw std::invalid_argument("Unsupported vertex stride.");
+
+  const auto *data = (const uint8_t *)vertices;
+  std::vector<uint8_t> result{VERTEX_FORMAT};
+  std::vector<uint8_t> previous(vertexStride, 0);
+  std::vector<uint8_t> plane(BLOCK_SIZE);
+  for (size_t start = 0; start < vertexCount; start += BLOCK_SIZE) {
+    const size_t count = std::min(BLOCK_SIZE, vertexCount - start);
+    for (size_t k = 0; k < vertexStride; k++) {
+      for (size_t i = 0; i < count; i++) {
+        const uint8_t value = data[(start + i) * vertexStride + k];
+        plane[i] = _zigzag((uint8_t)(value - previous[k]));
+        previous[k] = value;
+      }
+      _encodePlane(plane.data(), count, result);
+    }
+  }
+  return result;
+}
+
+bool io::DecodeVertexBuffer(void *destination, size_t vertexCount,
+                            size_t vertexStride, const void *encoded,
+                            size_t encodedSize) {
+  if (vertexStride == 0 || vertexStride > MAX_ENCODED_VERTEX_STRIDE)
+    return false;
+  const auto *data = (const uint8_t *)encoded;
+  const auto *end = data + encodedSize;
+  if (encodedSize == 0 || *data++ != VERTEX_FORMAT)
+    return false;
+
+  // Vertices are assembled in a block and written out at once
+  auto *out = (uint8_t *)destination;
+  std::vector<uint8_t> previous(vertexStride, 0);
+  std::vector<uint8_t> planes(vertexStride * BLOCK_SIZE);
+  std::vector<uint8_t> block(vertexStride * BLOCK_SIZE);
+  for (size_t start = 0; start < vertexCount; start += BLOCK_SIZE) {
+    const size_t count = std::min(BLOCK_SIZE, vertexCount - start);
+    for (size_t k = 0; k < vertexStride; k++)
+      if (!_decodePlane(data, end, count, true, previous[k],
+                        planes.data() + k * BLOCK_SIZE))
+        return false;
+    _interleave(planes.data(), count, vertexStride, block.data());
+    std::memcpy(out + start * vertexStride, block.data(),
+                count * vertexStride);
+  }
+  return data == end;
+}
+
+std::vector<uint8_t> io::EncodeIndexBuffer(const void *indices,
+                                           size_t indexCount,
+                                           size_t indexSize) {
+  if (indexSize != sizeof(uint16_t) && indexSize != sizeof(uint32_t))
+    throw std::invalid_argument("Unsupported index size.");
+
+  std::vector<uint8_t> result{INDEX_FORMAT};
+  std::vector<uint8_t> planes(sizeof(uint32_t) * BLOCK_SIZE);
+  uint32_t next = 0;
+  for (size_t start = 0; start < indexCount; start += BLOCK_SIZE) {
+    const size_t count = std::min(BLOCK_SIZE, indexCount - start);
+    for (size_t i = 0; i < count; i++) {
+      uint32_t index;
+      if (indexSize == sizeof(uint16_t)) {
+        uint16_t shortIndex;
+        std::memcpy(&shortIndex, (const uint8_t *)indices + (start + i) * 2,
+                    sizeof(shortIndex));
+        index = shortIndex;
+      } else
+        std::memcpy(&index, (const uint8_t *)indices + (start + i) * 4,
+                    sizeof(index));
+
+      // Differences to the next unused vertex, zigzag encoded
+      const uint32_t delta = index - next;
+      const uint32_t value =
+          (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+      if (index >= next)
+        next = index + 1;
+      for (size_t b = 0; b < sizeof(uint32_t); b++)
+        planes[b * BLOCK_SIZE + i] = (uint8_t)(value >> (8 * b));
+    }
+    for (size_t b = 0; b < sizeof(uint32_t); b++)
+      _encodePlane(planes.data() + b * BLOCK_SIZE, count, result);
+  }
+  return result;
+}
+
+bool io::DecodeIndexBuffer(void *destination, size_t indexCount,
+                           size_t indexSize, const void *encoded,
+                           size_t encodedSize) {
+  if (indexSize != sizeof(uint16_t) && indexSize != sizeof(uint32_t))
+    return false;
+  const auto *data = (const uint8_t *)encoded;
+  const auto *end = data + encodedSize;
+  if (encodedSize == 0 || *data++ != INDEX_FORMAT)
+    return false;
+
+  auto *out = (uint8_t *)destination;
+  std::vector<uint8_t> planes(sizeof(uint32_t) * BLOCK_SIZE);
+  std::vector<uint8_t> block(indexSize * BLOCK_SIZE);
+  uint32_t next = 0;
+  for (size_t start = 0; start < indexCount; start += BLOCK_SIZE) {
+    const size_t count = std::min(BLOCK_SIZE, indexCount - start);
+    for (size_t b = 0; b < sizeof(uint32_t); b++) {
+      uint8_t unused = 0;
+      if (!_decodePlane(data, end, count, false, unused,
+                        planes.data() + b * BLOCK_SIZE))
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      const uint32_t value = (uint32_t)planes[i] |
+                             (uint32_t)planes[BLOCK_SIZE + i] << 8 |
+                             (uint32_t)planes[2 * BLOCK_SIZE + i] << 16 |
+                             (uint32_t)planes[3 * BLOCK_SIZE + i] << 24;
+      const uint32_t index = next + ((value >> 1) ^ (0u - (value & 1)));
+      if (index >= next)
+        next = index + 1;
+      if (indexSize == sizeof(uint16_t)) {
+        if (index > UINT16_MAX)
+          return false;
+        const auto shortIndex = (uint16_t)index;
+        std::memcpy(block.data() + i * 2, &shortIndex, sizeof(shortIndex));
+      } else
+        std::memcpy(block.data() + i * 4, &index, sizeof(index));
+    }
+    std::memcpy(out + start * indexSize, block.data(), count * indexSize);
+  }
+  return data == end;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file mesh_codec.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declares the compression of vertex and index buffers.
+ * @date 2023-09-23
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __IO_MESH_CODEC_H__
+#define __IO_MESH_CODEC_H__
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace io {
+
+/**
+ * @brief Largest vertex stride the codec supports.
+ */
+constexpr size_t MAX_ENCODED_VERTEX_STRIDE = 256;
+
+/**
+ * @brief Compresses interleaved vertices. Every byte of a vertex is stored as
+ * the zigzag encoded difference to the same byte of the previous vertex. The
+ * differences of 16 vertices are packed with 0, 2, 4 or 8 bits each, so
+ * attributes that change smoothly between neighbouring vertices shrink the
+ * most. Works best on vertices in order of first use.
+ *
+ * @param vertices              Vertex data.
+ * @param vertexCount           Amount of vertices.
+ * @param vertexStride          Size of a vertex in bytes. At most
+ *                              MAX_ENCODED_VERTEX_STRIDE.
+ * @return std::vector<uint8_t> The compressed data.
+ */
+std::vector<uint8_t> EncodeVertexBuffer(const void *vertices,
+                                        size_t vertexCount,
+                                        size_t vertexStride);
+
+/**
+ * @brief Decompresses vertices produced by EncodeVertexBuffer. Uses SSE2 if
+ * available, unless SVEL_NO_SIMD is defined. The destination is written
+ * front to back in blocks, so it may be write combined memory.
+ *
+ * @param destination   Receives vertexCount * vertexStride bytes.
+ * @param vertexCount   Amount of vertices.
+ * @param vertexStride  Size of a vertex in bytes.
+ * @param encoded       The compressed data.
+ * @param encodedSize   Size of the compressed data in bytes.
+ * @return true         The data was decoded.
+ * @return false        The compressed data is malformed. The destination
+ *                      may be partially written.
+ */
+bool DecodeVertexBuffer(void *destination, size_t vertexCount,
+                        size_t vertexStride, const void *encoded,
+                        size_t encodedSize);
+
+/**
+ * @brief Compresses a triangle list. Every index is stored as the zigzag
+ * encoded difference to the next vertex that was not referenced yet, which is
+ * small for indices in order of first use. The differences are packed like
+ * vertex bytes.
+ *
+ * @param indices               Index data.
+ * @param indexCount            Amount of indices.
+ * @param indexSize             Size of an index in bytes. Either 2 or 4.
+ * @return std::vector<uint8_t> The compressed data.
+ */
+std::vector<uint8_t> EncodeIndexBuffer(const void *indices, size_t indexCount,
+                                       size_t indexSize);
+
+/**
+ * @brief Decompresses indices produced by EncodeIndexBuffer.
+ *
+ * @param destination Receives indexCount * indexSize bytes.
+ * @param indexCount  Amount of indices.
+ * @param indexSize   Size of an index in bytes. Either 2 or 4.
+ * @param encoded     The compressed data.
+ * @param encodedSize Size of the compressed data in bytes.
+ * @return true       The data was decoded.
+ * @return false      The compressed data is malformed. The destination may
+ *                    be partially written.
+ */
+bool DecodeIndexBuffer(void *destination, size_t indexCount, size_t indexSize,
+                       const void *encoded, size_t encodedSize);
+
+} // namespace io
+
+#endif /* __IO_MESH_CODEC_H__ */
@@ -0,0 +1,78 @@
+/**
+ * @file indice_table.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the IndiceTable.
+ * @date 2023-09-04
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "indice_table.h"
+
+using namespace io::obj;
+
+/**
+ * @brief Packs coordinate and texture coordinate id into one word.
+ *
+ * @param indice    Indice to pack.
+ * @return uint64_t Packed ids.
+ */
+static uint64_t _packKey(const Model::Indice &indice) {
+  return (uint64_t)indice.coordId | ((uint64_t)indice.texId << 32);
+}
+
+size_t IndiceTable::_hash(uint64_t key, uint32_t normalId) {
+  // Mix all 96 bits, finalizer of MurmurHash3
+  uint64_t hash = key ^ ((uint64_t)normalId * 0x9e3779b97f4a7c15ull);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 33;
+  return (size_t)hash;
+}
+
+IndiceTable::IndiceTable(size_t expectedSize) {
+  // Keep the load factor at or below one half
+  size_t capacity = 16;
+  while (capacity < expectedSize * 2)
+    capacity *= 2;
+  _slots.assign(capacity, Slot{0, 0, EMPTY});
+  _mask = capacity - 1;
+}
+
+void IndiceTable::_grow() {
+  std::vector<Slot> slots(_slots.size() * 2, Slot{0, 0, EMPTY});
+  _slots.swap(slots);
+  _mask = _slots.size() - 1;
+
+  for (const auto &slot : slots) {
+    if (slot.value == EMPTY)
+      continue;
+    size_t position = _hash(slot.key, slot.normalId) & _mask;
+    while (_slots[position].value != EMPTY)
+      position = (position + 1) & _mask;
+    _slots[position] = slot;
+  }
+}
+
+uint32_t IndiceTable::Insert(const Model::Indice &indice, uint32_t index) {
+  if ((_size + 1) * 2 > _slots.size())
+    _grow();
+
+  const uint64_t key = _packKey(indice);
+  size_t position = _hash(key, indice.normalId) & _mask;
+  while (true) {
+    auto &slot = _slots[position];
+    if (slot.value == EMPTY) {
+      slot = Slot{key, indice.normalId, index};
+      _size++;
+      return index;
+    }
+    if (slot.key == key && slot.normalId == indice.normalId)
+      return slot.value;
+    position = (position + 1) & _mask;
+  }
+}
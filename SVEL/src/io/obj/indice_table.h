@@ -0,0 +1,115 @@
+/**
+ * @file indice_table.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declaration of the IndiceTable.
+ * @date 2023-09-04
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __IO_OBJ_INDICE_TABLE_H__
+#define __IO_OBJ_INDICE_TABLE_H__
+
+// Local
+#include "model.hpp"
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace io::obj {
+
+/**
+ * @brief Maps face indices to unique vertex indices. Open addressing with
+ * linear probing over a flat array, so lookups touch a single cache line in
+ * the common case and inserts never allocate until the table grows.
+ */
+class IndiceTable {
+private:
+  /**
+   * @brief A slot of the table. Holds the packed index triple and the vertex
+   * index it maps to.
+   */
+  struct Slot {
+    /**
+     * @brief Coordinate and texture coordinate id packed into one word.
+     */
+    uint64_t key;
+
+    /**
+     * @brief Normal id.
+     */
+    uint32_t normalId;
+
+    /**
+     * @brief Vertex index of the triple. EMPTY if the slot is unused.
+     */
+    uint32_t value;
+  };
+
+  /**
+   * @brief Marks unused slots.
+   */
+  static constexpr uint32_t EMPTY = UINT32_MAX;
+
+  /**
+   * @brief The slots. Size is always a power of two.
+   */
+  std::vector<Slot> _slots;
+
+  /**
+   * @brief Slot count - 1. Used to wrap probe positions.
+   */
+  size_t _mask = 0;
+
+  /**
+   * @brief How many slots are in use.
+   */
+  size_t _size = 0;
+
+  /**
+   * @brief Computes the start slot for a triple.
+   *
+   * @param key       Packed coordinate and texture coordinate id.
+   * @param normalId  Normal id.
+   * @return size_t   Hash of the triple.
+   */
+  static size_t _hash(uint64_t key, uint32_t normalId);
+
+  /**
+   * @brief Doubles the slot count and reinserts all triples.
+   */
+  void _grow();
+
+public:
+  /**
+   * @brief Construct an IndiceTable.
+   *
+   * @param expectedSize How many unique triples are expected. Avoids growing
+   *                     the table during inserts.
+   */
+  IndiceTable(size_t expectedSize = 0);
+
+  /**
+   * @brief Looks up the indice and inserts it if it is not known yet.
+   *
+   * @param indice    Indice to look up.
+   * @param index     Vertex index to map the indice to, if it is new.
+   * @return uint32_t The vertex index of the indice. Equals index if the
+   *                  indice was inserted.
+   */
+  uint32_t Insert(const Model::Indice &indice, uint32_t index);
+
+  /**
+   * @brief Getter for the amount of unique indices.
+   *
+   * @return size_t Amount of unique indices.
+   */
+  size_t GetSize() const { return _size; }
+};
+
+} // namespace io::obj
+
+#endif /* __IO_OBJ_INDICE_TABLE_H__ */
@@ -17,7 +17,6 @@
 // STL
 #include <array>
 #include <string>
-#include <unordered_set>
 #include <vector>
 
 namespace io::obj {
@@ -43,17 +42,22 @@ struct Model {
     /**
      * @brief Which coordinate this indice uses.
      */
-    uint32_t coordId;
+    uint32_t coordId = 0;
 
     /**
      * @brief Which texture coordinate this indice uses.
      */
-    uint32_t texId;
+    uint32_t texId = 0;
 
     /**
      * @brief Which normal this indice uses.
      */
-    uint32_t normalId;
+    uint32_t normalId = 0;
+
+    /**
+     * @brief Construct an Indice that references nothing.
+     */
+    Indice() = default;
 
     /**
      * @brief Construct an Indice with the
@@ -75,34 +79,34 @@ struct Model {
     bool operator==(const Indice &i) const {
       return coordId == i.coordId && texId == i.texId && normalId == i.normalId;
     }
-
-    /**
-     * @brief Enables hashing of the Indices
-     */
-    struct HashFunction {
-      /**
-       * @brief Hash operator. Returns the hash for the given indice.
-       *
-       * @param i       Indice to hash.
-       * @return size_t The hash.
-       */
-      size_t operator()(const Indice &i) const {
-        size_t seed = 0;
-        seed ^= std::hash<uint32_t>()(i.coordId) + 0x9e3779b9 + (seed << 6) +
-                (seed >> 2);
-        seed ^= std::hash<uint32_t>()(i.texId) + 0x9e3779b9 + (seed << 6) +
-                (seed >> 2);
-        seed ^= std::hash<uint32_t>()(i.normalId) + 0x9e3779b9 + (seed << 6) +
-                (seed >> 2);
-        return seed;
-      }
-    };
   };
 
   /**
-   * @brief Primitive is the equivalent of a face.
+   * @brief Primitive is the equivalent of a face. Only triangles are
+   * supported, so faces are stored inline without a heap allocation each.
    */
-  using Primitive = std::vector<Indice>;
+  using Primitive = std::array<Indice, 3>;
+
+  /**
+   * @brief Consecutive faces that share a group name and material. Started by
+   * 'g' and 'usemtl' lines and ends where the next group starts.
+   */
+  struct Group {
+    /**
+     * @brief Name set by the last 'g' line.
+     */
+    std::string name;
+
+    /**
+     * @brief Material set by the last 'usemtl' line.
+     */
+    std::string material;
+
+    /**
+     * @brief First face of the group.
+     */
+    size_t firstFace;
+  };
 
   /**
    * @brief Name of the mesh.
@@ -124,6 +128,23 @@ struct Model {
    */
   std::vector<glm::vec3> normals;
 
+  /**
+   * @brief How many coordinates the file defines in front of this model. Face
+   * indices are global to the file and have to be rebased by this offset.
+   */
+  uint32_t coordinateOffset = 0;
+
+  /**
+   * @brief How many texture coordinates the file defines in front of this
+   * model.
+   */
+  uint32_t textureCoordOffset = 0;
+
+  /**
+   * @brief How many normals the file defines in front of this model.
+   */
+  uint32_t normalOffset = 0;
+
   /**
    * @brief Describes which data is available for every face.
    */
@@ -135,9 +156,10 @@ struct Model {
   std::vector<Primitive> faces;
 
   /**
-   * @brief All unique vertices in the model.
+   * @brief Groups of the faces in order. Faces in front of the first group
+   * belong to an unnamed group without material.
    */
-  std::unordered_set<Indice, Indice::HashFunction> vertices;
+  std::vector<Group> groups;
 };
 
 } // namespace io::obj
@@ -12,10 +12,19 @@
 #include "parser.h"
 #include "model.hpp"
 
+// Internal
+#include <io/mapped_file.h>
+
 // STL
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <fstream>
+#include <future>
+#include <iterator>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 
 using namespace io::obj;
 
@@ -78,14 +87,15 @@ void Parser::_handleFace(const std::string &str, std::shared_ptr<Model> model) {
 
   // Parse the indices out of the substrings
   Model::Primitive p{};
-  for (const auto &indices : substrings) {
+  for (size_t c = 0; c < p.size(); c++) {
     std::array<size_t, 3> data{0, 0, 0};
     std::stringstream ss;
 
-    // Get values and validate them
-    auto values = _splitBy('/', indices);
+    // Get values and validate them, a face without all of its corners would
+    // shift every following triangle
+    auto values = _splitBy('/', substrings.at(c));
     if (values.size() > 3)
-      continue;
+      return;
 
     // Parse values
     for (unsigned int i = 0; i < values.size(); i++) {
@@ -97,11 +107,9 @@ void Parser::_handleFace(const std::string &str, std::shared_ptr<Model> model) {
     }
 
     // Add to the primitive
-    p.emplace_back(data[0], data[1], data[2]);
-    model->vertices.emplace(data[0], data[1], data[2]);
+    p[c] = Model::Indice((uint32_t)data[0], (uint32_t)data[1],
+                         (uint32_t)data[2]);
   }
-  if (p.empty())
-    return;
   model->faces.push_back(p);
 }
 
@@ -138,7 +146,268 @@ Parser::Parser(const std::filesystem::path &file) : _file(file) {
     throw std::invalid_argument("File invalid for obj loader");
 }
 
-std::vector<std::shared_ptr<Model>> Parser::Parse() {
+std::string_view Parser::_nextToken(std::string_view &line) {
+  // Skip leading blanks
+  size_t start = 0;
+  while (start < line.size() && (line[start] == ' ' || line[start] == '\t'))
+    start++;
+
+  // Find end of token
+  size_t end = start;
+  while (end < line.size() && line[end] != ' ' && line[end] != '\t')
+    end++;
+
+  auto token = line.substr(start, end - start);
+  line.remove_prefix(end);
+  return token;
+}
+
+bool Parser::_parseFloat(std::string_view token, float &out) {
+  // from_chars does not accept an explicit plus sign
+  if (!token.empty() && token.front() == '+')
+    token.remove_prefix(1);
+
+  float value;
+  auto [ptr, ec] =
+      std::from_chars(token.data(), token.data() + token.size(), value);
+  if (ec != std::errc() || token.empty())
+    return false;
+  out = value;
+  return true;
+}
+
+uint32_t Parser::_parseIndex(std::string_view token, uint32_t count,
+                             bool &out_relative) {
+  out_relative = false;
+  if (token.empty())
+    return 0;
+
+  int64_t value = 0;
+  auto [ptr, ec] =
+      std::from_chars(token.data(), token.data() + token.size(), value);
+  if (ec != std::errc() || value == 0 || value > (int64_t)UINT32_MAX)
+    return 0;
+
+  // Negative indices are relative to the elements defined so far
+  if (value < 0) {
+    out_relative = true;
+    return (uint32_t)((int64_t)count + 1 + value);
+  }
+  return (uint32_t)value;
+}
+
+void Parser::_parseNode(std::string_view line, Model *model,
+                        ElementCounts &counts) {
+  auto keyword = _nextToken(line);
+
+  // Parse up to three components
+  glm::vec3 data{0.0f, 0.0f, 0.0f};
+  unsigned int components = 0;
+  for (; components < 3; components++) {
+    auto token = _nextToken(line);
+    if (!_parseFloat(token, data[(int)components]))
+      break;
+  }
+
+  // Push to correct array. Elements are counted even outside of objects as
+  // face indices are global to the file.
+  if (keyword == "v" && components == 3) {
+    counts[0]++;
+    if (model != nullptr)
+      model->coordinates.emplace_back(data);
+  } else if (keyword == "vt" && components >= 1) {
+    counts[1]++;
+    if (model != nullptr)
+      model->textureCoords.emplace_back(data.x, data.y);
+  } else if (keyword == "vn" && components == 3) {
+    counts[2]++;
+    if (model != nullptr)
+      model->normals.emplace_back(data);
+  }
+}
+
+void Parser::_parseFace(std::string_view line, Chunk &chunk) {
+  _nextToken(line); // Skip keyword
+
+  // Only triangles are supported for now
+  std::array<std::string_view, 3> corners;
+  for (auto &corner : corners)
+    if ((corner = _nextToken(line)).empty())
+      return;
+  if (!_nextToken(line).empty())
+    return;
+
+  auto &model = *chunk.models.back();
+  size_t faceIndex = model.faces.size();
+
+  // Split every corner into coordinate, texture coordinate and normal index.
+  // The face is written in place, faces only grow the vector of the model.
+  auto &p = model.faces.emplace_back();
+  for (uint8_t c = 0; c < corners.size(); c++) {
+    auto corner = corners[c];
+    std::array<uint32_t, 3> data{0, 0, 0};
+    for (uint8_t i = 0; i < data.size(); i++) {
+      auto delimiter = corner.find('/');
+      bool isRelative = false;
+      data[i] = _parseIndex(corner.substr(0, delimiter), chunk.counts[i],
+                            isRelative);
+      if (isRelative)
+        chunk.relativeIndices.push_back(
+            {chunk.models.size() - 1, faceIndex, c, i});
+      if (delimiter == std::string_view::npos)
+        break;
+      corner.remove_prefix(delimiter + 1);
+    }
+
+    p[c] = Model::Indice(data[0], data[1], data[2]);
+  }
+}
+
+void Parser::_parseGroup(std::string_view line, Model &model) {
+  const auto keyword = _nextToken(line);
+  if (keyword != "g" && keyword != "usemtl")
+    return;
+
+  Model::Group group{};
+  if (!model.groups.empty())
+    group = model.groups.back();
+  (keyword == "g" ? group.name : group.material) = _nextToken(line);
+  group.firstFace = model.faces.size();
+
+  // Groups without faces are replaced right away
+  if (!model.groups.empty() &&
+      model.groups.back().firstFace == group.firstFace)
+    model.groups.back() = std::move(group);
+  else
+    model.groups.push_back(std::move(group));
+}
+
+Parser::Chunk Parser::_parseChunk(std::string_view text, bool isFileStart) {
+  Chunk chunk;
+
+  // Anything in front of the first object belongs to the previous chunk
+  if (!isFileStart) {
+    chunk.models.push_back(std::make_shared<Model>());
+    chunk.continuation = true;
+  }
+
+  while (!text.empty()) {
+    // Cut the next line without copying it
+    auto lineEnd = (const char *)std::memchr(text.data(), '\n', text.size());
+    size_t lineLength = lineEnd == nullptr ? text.size()
+                                           : (size_t)(lineEnd - text.data());
+    auto line = text.substr(0, lineLength);
+    text.remove_prefix(std::min(lineLength + 1, text.size()));
+
+    // Support CRLF files
+    if (!line.empty() && line.back() == '\r')
+      line.remove_suffix(1);
+
+    if (line.size() < 2) // make sure there are at least two characters
+      continue;
+
+    switch (line.front()) {
+    case 'o': { // Need to create new object
+      auto model = std::make_shared<Model>();
+      model->coordinateOffset = chunk.counts[0];
+      model->textureCoordOffset = chunk.counts[1];
+      model->normalOffset = chunk.counts[2];
+      line.remove_prefix(1);
+      model->name = _nextToken(line);
+      chunk.models.push_back(model);
+      break;
+    }
+    case 'v': // A vertex information
+      _parseNode(line,
+                 chunk.models.empty() ? nullptr : chunk.models.back().get(),
+                 chunk.counts);
+      break;
+    case 'f': // A face
+      if (!chunk.models.empty()) // Don't handle anything until an object
+        _parseFace(line, chunk);
+      break;
+    case 'g': // A group or material
+    case 'u':
+      if (!chunk.models.empty())
+        _parseGroup(line, *chunk.models.back());
+      break;
+    default:
+      break; // Ignore anything else
+    }
+  }
+  return chunk;
+}
+
+std::vector<std::shared_ptr<Model>>
+Parser::_mergeChunks(std::vector<Chunk> &chunks) {
+  std::vector<std::shared_ptr<Model>> result;
+  ElementCounts base{0, 0, 0};
+  std::shared_ptr<Model> model = nullptr;
+
+  for (auto &chunk : chunks) {
+    // Relative indices only know the elements of their own chunk
+    for (const auto &relative : chunk.relativeIndices) {
+      auto &indice =
+          chunk.models.at(relative.model)->faces.at(relative.face).at(
+              relative.corner);
+      uint32_t *ids[] = {&indice.coordId, &indice.texId, &indice.normalId};
+      *ids[relative.element] += base[relative.element];
+    }
+
+    for (size_t i = 0; i < chunk.models.size(); i++) {
+      const auto &chunkModel = chunk.models[i];
+      if (i == 0 && chunk.continuation) {
+        // Nothing to continue if no object has been started yet
+        if (model == nullptr)
+          continue;
+
+        auto append = [](auto &dst, auto &src) {
+          dst.insert(dst.end(), std::make_move_iterator(src.begin()),
+                     std::make_move_iterator(src.end()));
+        };
+        // Groups of the chunk do not know the group they continue, missing
+        // properties are taken from it. Groups without faces are replaced.
+        auto &groups = model->groups;
+        const auto previous =
+            groups.empty() ? Model::Group{} : groups.back();
+        for (auto &group : chunkModel->groups) {
+          if (group.name.empty())
+            group.name = previous.name;
+          if (group.material.empty())
+            group.material = previous.material;
+          group.firstFace += model->faces.size();
+          if (!groups.empty() && groups.back().firstFace == group.firstFace)
+            groups.back() = std::move(group);
+          else
+            groups.push_back(std::move(group));
+        }
+
+        append(model->coordinates, chunkModel->coordinates);
+        append(model->textureCoords, chunkModel->textureCoords);
+        append(model->normals, chunkModel->normals);
+        append(model->faces, chunkModel->faces);
+        continue;
+      }
+
+      // A new object starts
+      if (model != nullptr && _handleModelFinalization(model))
+        result.push_back(model);
+      model = chunkModel;
+      model->coordinateOffset += base[0];
+      model->textureCoordOffset += base[1];
+      model->normalOffset += base[2];
+    }
+
+    for (unsigned int i = 0; i < base.size(); i++)
+      base[i] += chunk.counts[i];
+  }
+
+  if (model != nullptr && _handleModelFinalization(model))
+    result.push_back(model);
+  return result;
+}
+
+std::vector<std::shared_ptr<Model>> Parser::_parseStream() {
   std::vector<std::shared_ptr<Model>> result;
 
   // Open file
@@ -148,6 +417,7 @@ std::vector<std::shared_ptr<Model>> Parser::Parse() {
     throw std::runtime_error("Could not open file.");
 
   std::shared_ptr<Model> model = nullptr;
+  ElementCounts offsets{0, 0, 0};
   while (!in.eof()) {
     // Get line
     std::string line{};
@@ -166,8 +436,14 @@ std::vector<std::shared_ptr<Model>> Parser::Parse() {
       if (model != nullptr) {
         if (_handleModelFinalization(model))
           result.push_back(model);
+        offsets[0] += (uint32_t)model->coordinates.size();
+        offsets[1] += (uint32_t)model->textureCoords.size();
+        offsets[2] += (uint32_t)model->normals.size();
       }
       model = std::make_shared<Model>();
+      model->coordinateOffset = offsets[0];
+      model->textureCoordOffset = offsets[1];
+      model->normalOffset = offsets[2];
       break;
     case 'v': // A vertex information
       _handleNode(line, model);
@@ -175,6 +451,10 @@ std::vector<std::shared_ptr<Model>> Parser::Parse() {
     case 'f': // A face
       _handleFace(line, model);
       break;
+    case 'g': // A group or material
+    case 'u':
+      _parseGroup(line, *model);
+      break;
     default:
       break; // Ignore anything else
     }
@@ -183,4 +463,59 @@ std::vector<std::shared_ptr<Model>> Parser::Parse() {
   if (_handleModelFinalization(model))
     result.push_back(model);
   return result;
-}
\ No newline at end of file
+}
+
+std::vector<std::shared_ptr<Model>>
+Parser::_parseMapped(unsigned int threadCount) {
+  MappedFile file(_file);
+  auto text = file.GetView();
+
+  // Small chunks are not worth the thread
+  const size_t minChunkSize = 1 << 20;
+  size_t chunkCount =
+      std::max<size_t>(1, std::min<size_t>(threadCount, text.size() /
+                                                            minChunkSize));
+
+  // Split the file at line boundaries
+  std::vector<std::string_view> slices;
+  size_t sliceStart = 0;
+  for (size_t i = 1; i <= chunkCount && sliceStart < text.size(); i++) {
+    size_t sliceEnd = text.size();
+    if (i < chunkCount) {
+      sliceEnd = text.find('\n', std::max(sliceStart, i * text.size() /
+                                                           chunkCount));
+      sliceEnd =
+          sliceEnd == std::string_view::npos ? text.size() : sliceEnd + 1;
+    }
+    slices.push_back(text.substr(sliceStart, sliceEnd - sliceStart));
+    sliceStart = sliceEnd;
+  }
+
+  // Parse all chunks but the first on worker threads
+  std::vector<Chunk> chunks(slices.size());
+  std::vector<std::future<Chunk>> workers;
+  for (size_t i = 1; i < slices.size(); i++)
+    workers.push_back(std::async(std::launch::async, &Parser::_parseChunk,
+                                 this, slices[i], false));
+  if (!slices.empty())
+    chunks[0] = _parseChunk(slices[0], true);
+  for (size_t i = 0; i < workers.size(); i++)
+    chunks[i + 1] = workers[i].get();
+
+  return _mergeChunks(chunks);
+}
+
+std::vector<std::shared_ptr<Model>> Parser::Parse(Mode mode,
+                                                  unsigned int threadCount) {
+  switch (mode) {
+  case Mode::eStream:
+    return _parseStream();
+  case Mode::eMapped:
+    return _parseMapped(1);
+  case Mode::eParallel:
+    if (threadCount == 0)
+      threadCount = std::max(1u, std::thread::hardware_concurrency());
+    return _parseMapped(threadCount);
+  }
+  throw std::invalid_argument("Unknown obj parse mode.");
+}
@@ -15,7 +15,9 @@
 #include "model.hpp"
 
 // STL
+#include <array>
 #include <filesystem>
+#include <string_view>
 
 namespace io::obj {
 
@@ -26,7 +28,91 @@ namespace io::obj {
  *  - TexCoords and normals
  */
 class Parser {
+public:
+  /**
+   * @brief Ways in which the obj file can be processed.
+   */
+  enum class Mode {
+    /**
+     * @brief Reads the file line by line through a stream. Every token is
+     * copied and parsed via stringstreams.
+     */
+    eStream,
+
+    /**
+     * @brief Maps the file into memory and walks it in place. Does not perform
+     * any per-line allocations.
+     */
+    eMapped,
+
+    /**
+     * @brief Like eMapped, but splits the file at line boundaries into chunks
+     * that are parsed concurrently. The result is identical to eMapped.
+     */
+    eParallel
+  };
+
 private:
+  /**
+   * @brief Running element counts of the obj file. Required to resolve
+   * relative (negative) indices. Order: coordinates, texture coordinates,
+   * normals.
+   */
+  using ElementCounts = std::array<uint32_t, 3>;
+
+  /**
+   * @brief Locates a face index that was resolved relative to the start of a
+   * chunk and still has to be rebased onto the elements of previous chunks.
+   */
+  struct RelativeIndex {
+    /**
+     * @brief Index of the model inside of the chunk.
+     */
+    size_t model;
+
+    /**
+     * @brief Index of the face inside of the model.
+     */
+    size_t face;
+
+    /**
+     * @brief Corner of the face.
+     */
+    uint8_t corner;
+
+    /**
+     * @brief Which element the index refers to. Same order as ElementCounts.
+     */
+    uint8_t element;
+  };
+
+  /**
+   * @brief Result of parsing a line aligned slice of the file.
+   */
+  struct Chunk {
+    /**
+     * @brief Models in order of appearance. If the chunk does not start with
+     * an object, the first model collects everything up to the first object
+     * and continues the last model of the previous chunk.
+     */
+    std::vector<std::shared_ptr<Model>> models;
+
+    /**
+     * @brief Signals that the first model continues the previous chunk.
+     */
+    bool continuation = false;
+
+    /**
+     * @brief How many elements the chunk defines.
+     */
+    ElementCounts counts{0, 0, 0};
+
+    /**
+     * @brief Negative face indices that were resolved inside of the chunk.
+     */
+    std::vector<RelativeIndex> relativeIndices;
+  };
+
   /**
    * @brief Path to the obj file.
    */
@@ -67,6 +153,101 @@ private:
    */
   bool _handleModelFinalization(std::shared_ptr<Model> model);
 
+  /**
+   * @brief Cuts the next whitespace separated token from the front of the
+   * line.
+   *
+   * @param line              Line to consume. Will start after the token.
+   * @return std::string_view The token. Empty if the line has no more tokens.
+   */
+  static std::string_view _nextToken(std::string_view &line);
+
+  /**
+   * @brief Parses a float token without allocating.
+   *
+   * @param token   Token to parse.
+   * @param out     Parsed value.
+   * @return true   Token was a valid float.
+   * @return false  Token is not a float. out is untouched.
+   */
+  static bool _parseFloat(std::string_view token, float &out);
+
+  /**
+   * @brief Parses a single face index. Relative indices are resolved against
+   * the current element count.
+   *
+   * @param token         Token to parse. May be empty.
+   * @param count         How many elements of this kind have been defined so
+   *                      far.
+   * @param out_relative  Set if the index was relative.
+   * @return uint32_t     The one based index or 0 if the index is missing. A
+   *                      relative index may wrap around if it refers to
+   *                      elements in front of the current chunk.
+   */
+  static uint32_t _parseIndex(std::string_view token, uint32_t count,
+                              bool &out_relative);
+
+  /**
+   * @brief Handles any mapped line that starts with 'v'.
+   *
+   * @param line    Line that starts with 'v'.
+   * @param model   Model which to update. May be null if no object has been
+   *                started yet.
+   * @param counts  Element counts to update.
+   */
+  void _parseNode(std::string_view line, Model *model, ElementCounts &counts);
+
+  /**
+   * @brief Handles any mapped line that starts with 'f'.
+   *
+   * @param line  Line that starts with 'f'.
+   * @param chunk Chunk whose last model should be updated.
+   */
+  void _parseFace(std::string_view line, Chunk &chunk);
+
+  /**
+   * @brief Handles any line that starts a group with 'g' or 'usemtl'. The
+   * other property of the group is kept.
+   *
+   * @param line  The line.
+   * @param model Model that the group belongs to.
+   */
+  static void _parseGroup(std::string_view line, Model &model);
+
+  /**
+   * @brief Parses a line aligned slice of the mapped file.
+   *
+   * @param text        Text of the slice.
+   * @param isFileStart Whether the slice starts at the beginning of the file.
+   * @return Chunk      Everything defined within the slice.
+   */
+  Chunk _parseChunk(std::string_view text, bool isFileStart);
+
+  /**
+   * @brief Stitches chunks together in file order. Rebases chunk local
+   * indices and offsets and finalizes all models.
+   *
+   * @param chunks                                Chunks in file order.
+   * @return std::vector<std::shared_ptr<Model>> Models defined in the file.
+   */
+  std::vector<std::shared_ptr<Model>> _mergeChunks(std::vector<Chunk> &chunks);
+
+  /**
+   * @brief Parses the file through a stream.
+   *
+   * @return std::vector<std::shared_ptr<Model>> Models defined in the file.
+   */
+  std::vector<std::shared_ptr<Model>> _parseStream();
+
+  /**
+   * @brief Parses the file through a memory mapping.
+   *
+   * @param threadCount                           How many chunks to parse
+   *                                              concurrently.
+   * @return std::vector<std::shared_ptr<Model>> Models defined in the file.
+   */
+  std::vector<std::shared_ptr<Model>> _parseMapped(unsigned int threadCount);
+
 public:
   /**
    * @brief Construct a Parser for a an obj-file.
@@ -78,9 +259,14 @@ public:
   /**
    * @brief Parses the file and returns the models that the file contains.
    *
+   * @param mode                                  How to process the file.
+   * @param threadCount                           Threads to use for
+   *                                              eParallel. 0 uses all
+   *                                              hardware threads.
    * @return std::vector<std::shared_ptr<Model>> Models defined in the OBJ-File.
    */
-  std::vector<std::shared_ptr<Model>> Parse();
+  std::vector<std::shared_ptr<Model>> Parse(Mode mode = Mode::eMapped,
+                                            unsigned int threadCount = 0);
 };
 
 } // namespace io::obj
@@ -0,0 +1,125 @@
+/**
+ * @file defragmenter.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the Defragmenter.
+ * @date 2023-10-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "defragmenter.h"
+
+// Internal
+#include <core/memory/staging_ring.h>
+#include <renderer/mesh/buffer.h>
+
+// STL
+#include <algorithm>
+
+using namespace renderer;
+
+/**
+ * @brief Textures that are checked per step. Checking asks the allocator for
+ * a target, so all of them are only visited over several frames.
+ */
+static const size_t TEXTURES_PER_STEP = 64;
+
+void Defragmenter::_moveBuffers(SharedMeshArena arena,
+                                core::UploadBatch &batch, uint64_t &budget) {
+  for (auto &buffer : arena->GetMoveCandidates(budget)) {
+    const uint64_t size = buffer->GetSize();
+    if (!buffer->Move(batch))
+      continue;
+    budget -= std::min(budget, size);
+    _movedSize += size;
+    _moveCount++;
+  }
+}
+
+void Defragmenter::_moveTextures(core::UploadBatch &batch, uint64_t &budget) {
+  auto retire = [this](core::Barrier::Notifier deleter) {
+    _retired.push_back({std::move(deleter), _frame});
+  };
+
+  for (size_t checked = 0;
+       checked < TEXTURES_PER_STEP && budget > 0 && !_textures.empty();
+       checked++) {
+    if (_textureCursor >= _textures.size())
+      _textureCursor = 0;
+    auto texture = _textures[_textureCursor].lock();
+    if (!texture) {
+      _textures[_textureCursor] = _textures.back();
+      _textures.pop_back();
+      continue;
+    }
+    _textureCursor++;
+
+    // Large textures are only moved with the budget of a whole frame
+    const uint64_t size = texture->GetMemorySize();
+    if (size > budget && budget < _bytesPerFrame)
+      continue;
+    if (!texture->Move(batch, retire))
+      continue;
+    budget -= std::min(budget, size);
+    _movedSize += size;
+    _moveCount++;
+  }
+}
+
+Defragmenter::Defragmenter(core::SharedDevice device,
+                           vk::CommandPool commandPool,
+                           SharedMeshArena vertexArena,
+                           SharedMeshArena indexArena, uint64_t bytesPerFrame)
+    : _device(device), _commandPool(commandPool), _vertexArena(vertexArena),
+      _indexArena(indexArena), _bytesPerFrame(bytesPerFrame),
+      _barrier(std::make_unique<core::Barrier>(device)) {}
+
+Defragmenter::~Defragmenter() {
+  // Moves in flight retire the resources they replace
+  _barrier->WaitCompletion();
+  _device->AsVulkanObj().waitIdle();
+  for (auto &retired : _retired)
+    retired.deleter();
+}
+
+void Defragmenter::Register(SVEL_NAMESPACE::SharedTexture texture) {
+  if (_bytesPerFrame > 0)
+    _textures.push_back(texture);
+}
+
+void Defragmenter::Step() {
+  _frame++;
+  if (_bytesPerFrame == 0)
+    return;
+
+  // Frames that may have sampled the old textures have completed
+  while (!_retired.empty() &&
+         _retired.front().frame + SVEL_MAX_FRAMES_IN_FLIGHT <= _frame) {
+    _retired.front().deleter();
+    _retired.pop_front();
+  }
+
+  // Applies completed moves, which retire the old textures
+  if (!_barrier->IsCompleted())
+    return;
+
+  // The copies read resources the graphics family owns
+  core::UploadBatch batch(_device, _commandPool);
+  uint64_t budget = _bytesPerFrame;
+  _moveBuffers(_vertexArena, batch, budget);
+  _moveBuffers(_indexArena, batch, budget);
+  _moveTextures(batch, budget);
+  batch.Flush(_barrier.get());
+}
+
+Defragmenter::Statistics Defragmenter::GetStatistics() {
+  Statistics statistics{};
+  statistics.memory = _device->GetMemoryAllocator().GetStatistics();
+  statistics.vertices = _vertexArena->GetStatistics();
+  statistics.indices = _indexArena->GetStatistics();
+  statistics.movedSize = _movedSize;
+  statistics.moveCount = _moveCount;
+  return statistics;
+}
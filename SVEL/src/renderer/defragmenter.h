@@ -0,0 +1,239 @@
+/**
+ * @file defragmenter.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declares the incremental compaction of device memory.
+ * @date 2023-10-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __RENDERER_DEFRAGMENTER_H__
+#define __RENDERER_DEFRAGMENTER_H__
+
+// Internal
+#include <core/barrier.h>
+#include <core/device.h>
+#include <core/memory/memory_allocator.h>
+#include <core/memory/upload_batch.h>
+#include <renderer/mesh/mesh_arena.h>
+#include <texture/texture.h>
+
+// Vulkan
+#include <vulkan/vulkan.hpp>
+
+// STL
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#ifndef SVEL_DEFRAG_BYTES_PER_FRAME
+/**
+ * @brief Bytes that are copied per frame to compact device memory. A single
+ * resource that is larger is still moved on its own. 0 disables compaction.
+ */
+#define SVEL_DEFRAG_BYTES_PER_FRAME (8ull * 1024 * 1024)
+#endif /* SVEL_DEFRAG_BYTES_PER_FRAME */
+
+namespace renderer {
+
+/**
+ * @brief Compacts device memory of long running sessions a little every
+ * frame. Mesh buffers are moved out of the least used page of their arena and
+ * textures out of the least used block of their memory pool, until the page or
+ * block is empty and can be released. The copies are recorded into the
+ * graphics queue and bounded by a byte budget per frame, at most one batch of
+ * them is in flight. Moved resources switch to their new memory once the copy
+ * completed, which also updates the image infos that descriptor sets are
+ * written from. Old memory is released after the frames in flight completed.
+ */
+class Defragmenter {
+public:
+  /**
+   * @brief Fragmentation of the memory and the work done so far.
+   */
+  struct Statistics {
+    /**
+     * @brief Usage of the device memory, including textures.
+     */
+    core::MemoryAllocator::Statistics memory;
+
+    /**
+     * @brief Usage of the vertex arena.
+     */
+    MeshArena::Statistics vertices;
+
+    /**
+     * @brief Usage of the index arena.
+     */
+    MeshArena::Statistics indices;
+
+    /**
+     * @brief Bytes that were copied.
+     */
+    uint64_t movedSize = 0;
+
+    /**
+     * @brief Amount of resources that were moved.
+     */
+    uint32_t moveCount = 0;
+  };
+
+private:
+  /**
+   * @brief Deleter of an old resource that waits for the frames in flight.
+   */
+  struct Retired {
+    /**
+     * @brief Destroys the resource.
+     */
+    core::Barrier::Notifier deleter;
+
+    /**
+     * @brief Frame in which the resource was replaced.
+     */
+    uint64_t frame;
+  };
+
+  /**
+   * @brief Device to use.
+   */
+  core::SharedDevice _device;
+
+  /**
+   * @brief Command pool of the graphics family.
+   */
+  vk::CommandPool _commandPool;
+
+  /**
+   * @brief Holds the vertices of all meshes.
+   */
+  SharedMeshArena _vertexArena;
+
+  /**
+   * @brief Holds the indices of all meshes.
+   */
+  SharedMeshArena _indexArena;
+
+  /**
+   * @brief Bytes that may be copied per frame.
+   */
+  uint64_t _bytesPerFrame;
+
+  /**
+   * @brief Textures that may be moved. Expired ones are removed on the way.
+   */
+  std::vector<std::weak_ptr<SVEL_NAMESPACE::Texture>> _textures;
+
+  /**
+   * @brief Texture at which the next step continues.
+   */
+  size_t _textureCursor = 0;
+
+  /**
+   * @brief Deleters of replaced resources, oldest first.
+   */
+  std::deque<Retired> _retired;
+
+  /**
+   * @brief Counts the steps, one per frame.
+   */
+  uint64_t _frame = 0;
+
+  /**
+   * @brief Bytes that were copied.
+   */
+  uint64_t _movedSize = 0;
+
+  /**
+   * @brief Amount of resources that were moved.
+   */
+  uint32_t _moveCount = 0;
+
+  /**
+   * @brief Barrier of the copies in flight. Declared last, so that its
+   * completion still finds the other members.
+   */
+  core::UniqueBarrier _barrier;
+
+  /**
+   * @brief Records moves of mesh buffers out of the least used page.
+   *
+   * @param arena   The arena.
+   * @param batch   Batch to record into.
+   * @param budget  Bytes that may still be copied, reduced by the moves.
+   */
+  void _moveBuffers(SharedMeshArena arena, core::UploadBatch &batch,
+                    uint64_t &budget);
+
+  /**
+   * @brief Records moves of textures out of the least used block.
+   *
+   * @param batch   Batch to record into.
+   * @param budget  Bytes that may still be copied, reduced by the moves.
+   */
+  void _moveTextures(core::UploadBatch &batch, uint64_t &budget);
+
+public:
+  /**
+   * @brief Construct a Defragmenter.
+   *
+   * @param device        Device to use.
+   * @param commandPool   Command pool of the graphics family.
+   * @param vertexArena   Holds the vertices of all meshes.
+   * @param indexArena    Holds the indices of all meshes.
+   * @param bytesPerFrame Bytes that may be copied per frame.
+   */
+  Defragmenter(core::SharedDevice device, vk::CommandPool commandPool,
+               SharedMeshArena vertexArena, SharedMeshArena indexArena,
+               uint64_t bytesPerFrame = SVEL_DEFRAG_BYTES_PER_FRAME);
+
+  /**
+   * @brief Destroy the Defragmenter. Waits for the device, so that every old
+   * resource can be released.
+   */
+  ~Defragmenter();
+
+  /**
+   * @brief Cannot be copied.
+   */
+  Defragmenter(const Defragmenter &) = delete;
+
+  /**
+   * @brief Cannot be copied.
+   *
+   * @return Defragmenter& ~unused~
+   */
+  Defragmenter &operator=(const Defragmenter &) = delete;
+
+  /**
+   * @brief Lets a texture be moved. The texture is not kept alive. Moves only
+   * update the image info of the texture, so textures that descriptor sets
+   * keep across frames must not be registered.
+   *
+   * @param texture The texture.
+   */
+  void Register(SVEL_NAMESPACE::SharedTexture texture);
+
+  /**
+   * @brief Does the work of one frame. Has to be called at the start of a
+   * frame, after the frame that last used its resources completed and before
+   * anything is recorded. Applies completed moves, releases old resources that
+   * no frame in flight can use and records the next moves.
+   */
+  void Step();
+
+  /**
+   * @brief Getter for the current fragmentation. Comparing two results shows
+   * the effect of the compaction in between.
+   *
+   * @return Statistics The statistics.
+   */
+  Statistics GetStatistics();
+};
+SVEL_CLASS(Defragmenter)
+
+} // namespace renderer
+
+#endif /* __RENDERER_DEFRAGMENTER_H__ */
@@ -11,8 +11,10 @@
 // Local
 #include "buffer.h"
 
-// Internal
-#include <core/memory/transfer_buffer.h>
+// STL
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
 
 using namespace renderer;
 using namespace SVEL_NAMESPACE;
@@ -24,20 +26,112 @@ void Buffer::_onCompletion(core::SharedBuffer buffer) {
   _bufferReady = true;
 }
 
-void Buffer::Transfer(core::SharedDevice device, core::Barrier *barrier,
-                      const vk::CommandPool &commandPool,
-                      const ArrayProxy &data, vk::BufferUsageFlagBits usage) {
-  // Use transfer buffer
-  auto transferBuffer = std::make_shared<core::TransferBuffer>(
-      device, commandPool, data, usage,
+void Buffer::_onMoved(MeshArena::Allocation source,
+                      MeshArena::Allocation target) {
+  _moving = false;
+
+  // The data was staged again while it was copied
+  if (_allocation.buffer != source.buffer ||
+      _allocation.offset != source.offset) {
+    _arena->Free(target);
+    return;
+  }
+
+  _arena->Free(_allocation);
+  _allocation = target;
+  _firstElement = (uint32_t)(_allocation.offset / _elementSize);
+  _buffer = _allocation.buffer;
+  _vulkanObj = _buffer->AsVulkanObj();
+}
+
+void Buffer::_allocate(SharedMeshArena arena, size_t dataSize,
+                       size_t elementCount) {
+  if (_arena != nullptr)
+    _arena->Free(_allocation);
+
+  // Aligning to the element size turns the offset into an element index
+  _elementSize =
+      elementCount == 0 ? 1 : std::max<size_t>(dataSize / elementCount, 1);
+  _arena = arena;
+  _allocation = _arena->Allocate(dataSize, _elementSize, weak_from_this());
+  _firstElement = (uint32_t)(_allocation.offset / _elementSize);
+  _elementCount = (unsigned int)elementCount;
+}
+
+Buffer::~Buffer() {
+  if (_arena != nullptr)
+    _arena->Free(_allocation);
+}
+
+void Buffer::Stage(SharedMeshArena arena, const ArrayProxy &data) {
+  Stage(arena, data.dataSize, data.elementCount, [&data](void *destination) {
+    std::memcpy(destination, data.data, data.dataSize);
+  });
+}
+
+void Buffer::Stage(SharedMeshArena arena, size_t dataSize,
+                   size_t elementCount,
+                   const core::TransferBuffer::DataWriter &writer,
+                   const core::TransferBuffer::HostSource &source) {
+  _allocate(arena, dataSize, elementCount);
+  _imported = false;
+
+  // Host visible device local memory is written in place. The range is not
+  // read by any frame in flight and submits make host writes visible.
+  if (_allocation.mappedData != nullptr) {
+    writer(_allocation.mappedData);
+    _stagedTransfer = nullptr;
+    _onCompletion(_allocation.buffer);
+    return;
+  }
+
+  _stagedTransfer = std::make_shared<core::TransferBuffer>(
+      arena->GetDevice(), dataSize, writer, _allocation.buffer,
+      _allocation.offset,
       std::bind(&Buffer::_onCompletion, this->shared_from_this(),
-                std::placeholders::_1));
+                std::placeholders::_1),
+      source);
+  _imported = _stagedTransfer->IsImported();
+}
+
+void Buffer::Submit(core::UploadBatch &batch) {
+  if (_stagedTransfer == nullptr)
+    throw std::runtime_error("No staged data to submit.");
+
+  // The batch keeps the transfer alive until it completed
+  _stagedTransfer->Record(batch);
+  _stagedTransfer = nullptr;
+}
 
-  // Transfer the data
-  transferBuffer->TransferData(barrier);
-  _elementCount = (unsigned int)data.elementCount;
+void Buffer::Transfer(SharedMeshArena arena, core::UploadBatch &batch,
+                      const ArrayProxy &data) {
+  Stage(arena, data);
+  if (IsStaged())
+    Submit(batch);
+}
+
+bool Buffer::Move(core::UploadBatch &batch) {
+  if (!_bufferReady || _stagedTransfer != nullptr || _moving)
+    return false;
+
+  auto target =
+      _arena->AllocateMove(_allocation, _elementSize, weak_from_this());
+  if (target.buffer == nullptr)
+    return false;
+
+  // Both ranges are owned by the graphics family, the batch makes the copy
+  // visible before the next draws
+  batch.GetCommandBuffer().copyBuffer(
+      _allocation.buffer->AsVulkanObj(), target.buffer->AsVulkanObj(),
+      vk::BufferCopy(_allocation.offset, target.offset, _allocation.size));
+  _moving = true;
+  batch.AddNotifier(std::bind(&Buffer::_onMoved, shared_from_this(),
+                              _allocation, target));
+  return true;
 }
 
 const unsigned int &Buffer::GetElementCount() const { return _elementCount; }
 
+bool Buffer::IsStaged() const { return _stagedTransfer != nullptr; }
+
 bool Buffer::IsBufferReady() { return _bufferReady; }
\ No newline at end of file
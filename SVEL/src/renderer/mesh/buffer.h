@@ -15,6 +15,9 @@
 #include <core/barrier.h>
 #include <core/device.h>
 #include <core/memory/buffer.h>
+#include <core/memory/transfer_buffer.h>
+#include <core/memory/upload_batch.h>
+#include <renderer/mesh/mesh_arena.h>
 #include <svel/util/array_proxy.hpp>
 #include <util/vulkan_object.hpp>
 
@@ -28,7 +31,8 @@
 namespace renderer {
 
 /**
- * @brief Allows transfer of local memory to the gpu.
+ * @brief Allows transfer of local memory to the gpu. The data is placed in a
+ * range of a mesh arena, so that many buffers share one Vulkan buffer.
  */
 class Buffer : public util::VulkanAdapter<vk::Buffer>,
                public std::enable_shared_from_this<Buffer> {
@@ -36,18 +40,62 @@ private:
   /**
    * @brief Signals whether the buffer is ready or not to be used.
    */
-  std::atomic<bool> _bufferReady;
+  std::atomic<bool> _bufferReady{false};
+
+  /**
+   * @brief Staged data that still has to be submitted.
+   */
+  std::shared_ptr<core::TransferBuffer> _stagedTransfer;
 
   /**
    * @brief The final buffer.
    */
   core::SharedBuffer _buffer;
 
+  /**
+   * @brief Arena that holds the data.
+   */
+  SharedMeshArena _arena;
+
+  /**
+   * @brief Range of the data inside the arena.
+   */
+  MeshArena::Allocation _allocation;
+
   /**
    * @brief How many elements are in the buffer.
    */
   unsigned int _elementCount;
 
+  /**
+   * @brief Index of the first element inside the Vulkan buffer.
+   */
+  uint32_t _firstElement = 0;
+
+  /**
+   * @brief Size of an element in bytes, the alignment of the range.
+   */
+  size_t _elementSize = 1;
+
+  /**
+   * @brief Is a copy to another range of the arena in flight?
+   */
+  bool _moving = false;
+
+  /**
+   * @brief Was the last staged data imported instead of copied?
+   */
+  bool _imported = false;
+
+  /**
+   * @brief Reserves the range of the data inside the arena.
+   *
+   * @param arena         Arena to use.
+   * @param dataSize      Size of the data in bytes.
+   * @param elementCount  How many elements the data holds.
+   */
+  void _allocate(SharedMeshArena arena, size_t dataSize, size_t elementCount);
+
   /**
    * @brief Handles the completed transfer of the data.
    *
@@ -55,21 +103,77 @@ private:
    */
   void _onCompletion(core::SharedBuffer buffer);
 
+  /**
+   * @brief Switches to the range the data was copied to.
+   *
+   * @param source  The range the data was copied from.
+   * @param target  The range the data was copied to.
+   */
+  void _onMoved(MeshArena::Allocation source, MeshArena::Allocation target);
+
 public:
+  /**
+   * @brief Destroy the Buffer. Its range is released to the arena.
+   */
+  ~Buffer();
+
+  /**
+   * @brief Copies the data into a staging buffer. Does not record or submit
+   * any commands, so it may be called from any thread. If the arena is host
+   * visible, the data is written in place and the buffer is ready at once.
+   *
+   * @param arena Arena that receives the data.
+   * @param data  The data to transfer to the gpu.
+   */
+  void Stage(SharedMeshArena arena, const SVEL_NAMESPACE::ArrayProxy &data);
+
+  /**
+   * @brief Lets the writer fill the staging buffer directly. Does not record
+   * or submit any commands, so it may be called from any thread. If the arena
+   * is host visible, the writer fills the arena and nothing is staged.
+   *
+   * @param arena         Arena that receives the data.
+   * @param dataSize      Size of the data in bytes.
+   * @param elementCount  How many elements the data holds.
+   * @param writer        Writes the data into the staging buffer.
+   * @param source        Data that outlives the transfer, imported instead
+   *                      of staged if the device allows it.
+   */
+  void Stage(SharedMeshArena arena, size_t dataSize, size_t elementCount,
+             const core::TransferBuffer::DataWriter &writer,
+             const core::TransferBuffer::HostSource &source = {});
+
+  /**
+   * @brief Records the transfer of the staged data into the batch. Has to be
+   * called from the thread that owns the batch.
+   *
+   * @param batch The batch whose flush submits the transfer.
+   */
+  void Submit(core::UploadBatch &batch);
+
   /**
    * @brief Transfers the data to the GPU.
    *
-   * @param device      Device to use.
-   * @param barrier     The barrier onto which can be waited for transfer
-   * completion.
-   * @param commandPool The command pool to use for this transfer.
-   * @param data        The data to transfer to the gpu.
-   * @param usage       The usage of the buffer.
+   * @param arena Arena that receives the data.
+   * @param batch The batch whose flush submits the transfer.
+   * @param data  The data to transfer to the gpu.
+   */
+  void Transfer(SharedMeshArena arena, core::UploadBatch &batch,
+                const SVEL_NAMESPACE::ArrayProxy &data);
+
+  /**
+   * @brief Records a copy of the data into another page of the arena, so that
+   * its current page can be released. The buffer switches to the new range
+   * once the batch completed, draws recorded until then keep reading the old
+   * range, which is released after the frames in flight. Has to be called
+   * from the thread that owns the batch and records the draws.
+   *
+   * @param batch   The batch whose flush submits the copy.
+   * @return true   The copy was recorded.
+   * @return false  The buffer is not ready, already moving or no other page
+   *                has room for it.
    */
-  void Transfer(core::SharedDevice device, core::Barrier *barrier,
-                const vk::CommandPool &commandPool,
-                const SVEL_NAMESPACE::ArrayProxy &data,
-                vk::BufferUsageFlagBits usage);
+  bool Move(core::UploadBatch &batch);
 
   /**
    * @brief Getter for the element count.
@@ -78,6 +182,38 @@ public:
    */
   const unsigned int &GetElementCount() const;
 
+  /**
+   * @brief Getter for the index of the first element inside the Vulkan
+   * buffer, which is shared with other buffers of the arena.
+   *
+   * @return uint32_t The index of the first element.
+   */
+  uint32_t GetFirstElement() const { return _firstElement; }
+
+  /**
+   * @brief Getter for the size of the range inside the arena.
+   *
+   * @return uint64_t Size in bytes.
+   */
+  uint64_t GetSize() const { return _allocation.size; }
+
+  /**
+   * @brief Checks whether the last staged data is copied from imported host
+   * memory, skipping the staging copy.
+   *
+   * @return true   The data was imported.
+   * @return false  The data was staged or written in place.
+   */
+  bool IsImported() const { return _imported; }
+
+  /**
+   * @brief Checks if there is staged data that still has to be submitted.
+   *
+   * @return true   Submit() has to be called.
+   * @return false  Nothing was staged or it was already submitted.
+   */
+  bool IsStaged() const;
+
   /**
    * @brief Getter for the buffer status.
    *
@@ -0,0 +1,63 @@
+/**
+ * @file draw_range.hpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Defines the DrawRange and LodLevel of a mesh.
+ * @date 2023-09-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __RENDERER_MESH_DRAW_RANGE_HPP__
+#define __RENDERER_MESH_DRAW_RANGE_HPP__
+
+// STL
+#include <cstdint>
+
+namespace renderer {
+
+/**
+ * @brief A part of an index buffer that is drawn with its own vertex offset.
+ * Allows large meshes to use 16 bit indices.
+ */
+struct DrawRange {
+  /**
+   * @brief First index of the range.
+   */
+  uint32_t firstIndex;
+
+  /**
+   * @brief Amount of indices in the range.
+   */
+  uint32_t indexCount;
+
+  /**
+   * @brief Added to every index of the range.
+   */
+  int32_t vertexOffset;
+};
+
+/**
+ * @brief A level of detail of a mesh. All levels share the vertex and index
+ * buffer of the mesh and are made of consecutive ranges.
+ */
+struct LodLevel {
+  /**
+   * @brief First range of the level.
+   */
+  uint32_t firstRange;
+
+  /**
+   * @brief Amount of ranges of the level.
+   */
+  uint32_t rangeCount;
+
+  /**
+   * @brief Geometric error of the level relative to the extent of the mesh.
+   */
+  float error;
+};
+
+} // namespace renderer
+
+#endif /* __RENDERER_MESH_DRAW_RANGE_HPP__ */
@@ -12,31 +12,140 @@
 #include "mesh.h"
 
 // Internal
-#include <core/barrier.h>
+#include <core/memory/upload_batch.h>
 #include <renderer/mesh/buffer.h>
 
 // Vulkan
 #include <vulkan/vulkan_enums.hpp>
 
+// STL
+#include <stdexcept>
+
 using namespace SVEL_NAMESPACE;
 
-Mesh::Mesh(core::SharedDevice device, const vk::CommandPool &commandPool,
-           const ArrayProxy &nodes, const ArrayProxy &indices,
-           vk::IndexType iboType)
+Mesh::Mesh(renderer::SharedMeshArena vertexArena,
+           renderer::SharedMeshArena indexArena, const ArrayProxy &nodes,
+           const ArrayProxy &indices, vk::IndexType iboType,
+           std::vector<renderer::DrawRange> ranges,
+           std::vector<renderer::LodLevel> lods, float lodPixelError)
+    : _vbo(std::make_shared<renderer::Buffer>()),
+      _ibo(std::make_shared<renderer::Buffer>()), _iboType(iboType),
+      _ranges(std::move(ranges)), _lods(std::move(lods)),
+      _lodPixelError(lodPixelError) {
+  for (const auto &lod : _lods)
+    if ((size_t)lod.firstRange + lod.rangeCount > _ranges.size())
+      throw std::invalid_argument("Level of detail references missing range.");
+
+  _vbo->Stage(vertexArena, nodes);
+  _ibo->Stage(indexArena, indices);
+}
+
+Mesh::Mesh(renderer::SharedMeshArena vertexArena,
+           renderer::SharedMeshArena indexArena, size_t vertexCount,
+           size_t vertexStride,
+           const core::TransferBuffer::DataWriter &writeNodes,
+           size_t indexCount, vk::IndexType iboType,
+           const core::TransferBuffer::DataWriter &writeIndices,
+           std::vector<renderer::DrawRange> ranges,
+           std::vector<renderer::LodLevel> lods, float lodPixelError,
+           const core::TransferBuffer::HostSource &nodeSource,
+           const core::TransferBuffer::HostSource &indexSource)
     : _vbo(std::make_shared<renderer::Buffer>()),
-      _ibo(std::make_shared<renderer::Buffer>()), _iboType(iboType) {
-  // Transfer all of the data and wait for the transfer to complete.
-  // TODO: Allow barrier to be provided in the future.
-  auto barrier = std::make_shared<core::Barrier>(device);
-  _vbo->Transfer(device, barrier.get(), commandPool, nodes,
-                 vk::BufferUsageFlagBits::eVertexBuffer);
-  _ibo->Transfer(device, barrier.get(), commandPool, indices,
-                 vk::BufferUsageFlagBits::eIndexBuffer);
-  barrier->WaitCompletion();
-}
-
-void Mesh::Draw(const vk::CommandBuffer &recordBuffer) {
-  recordBuffer.bindVertexBuffers(0, _vbo->AsVulkanObj(), _bufferOffsets);
-  recordBuffer.bindIndexBuffer(_ibo->AsVulkanObj(), _bufferOffsets, _iboType);
-  recordBuffer.drawIndexed(_ibo->GetElementCount(), 1, 0, 0, 0);
-}
\ No newline at end of file
+      _ibo(std::make_shared<renderer::Buffer>()), _iboType(iboType),
+      _ranges(std::move(ranges)), _lods(std::move(lods)),
+      _lodPixelError(lodPixelError) {
+  for (const auto &lod : _lods)
+    if ((size_t)lod.firstRange + lod.rangeCount > _ranges.size())
+      throw std::invalid_argument("Level of detail references missing range.");
+
+  const size_t indexSize =
+      iboType == vk::IndexType::eUint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+  _vbo->Stage(vertexArena, vertexCount * vertexStride, vertexCount,
+              writeNodes, nodeSource);
+  _ibo->Stage(indexArena, indexCount * indexSize, indexCount, writeIndices,
+              indexSource);
+}
+
+Mesh::Mesh(const Mesh &storage, std::vector<renderer::DrawRange> ranges,
+           std::vector<renderer::LodLevel> lods, float lodPixelError)
+    : _vbo(storage._vbo), _ibo(storage._ibo), _iboType(storage._iboType),
+      _ranges(std::move(ranges)), _lods(std::move(lods)),
+      _lodPixelError(lodPixelError) {
+  // Without ranges the whole shared buffer would be drawn
+  if (_ranges.empty())
+    throw std::invalid_argument("Shared buffers require draw ranges.");
+  for (const auto &lod : _lods)
+    if ((size_t)lod.firstRange + lod.rangeCount > _ranges.size())
+      throw std::invalid_argument("Level of detail references missing range.");
+}
+
+void Mesh::Upload(core::UploadBatch &batch) {
+  if (_vbo->IsStaged())
+    _vbo->Submit(batch);
+  if (_ibo->IsStaged())
+    _ibo->Submit(batch);
+}
+
+bool Mesh::IsReady() {
+  return _vbo->IsBufferReady() && _ibo->IsBufferReady();
+}
+
+size_t Mesh::GetImportedSize() const {
+  return (_vbo->IsImported() ? _vbo->GetSize() : 0) +
+         (_ibo->IsImported() ? _ibo->GetSize() : 0);
+}
+
+void Mesh::_drawRanges(const vk::CommandBuffer &recordBuffer,
+                       Bindings &bindings, size_t firstRange,
+                       size_t rangeCount) {
+  if (bindings.vertexBuffer != _vbo->AsVulkanObj()) {
+    bindings.vertexBuffer = _vbo->AsVulkanObj();
+    recordBuffer.bindVertexBuffers(0, bindings.vertexBuffer, _bufferOffsets);
+  }
+  if (bindings.indexBuffer != _ibo->AsVulkanObj() ||
+      bindings.indexType != _iboType) {
+    bindings.indexBuffer = _ibo->AsVulkanObj();
+    bindings.indexType = _iboType;
+    recordBuffer.bindIndexBuffer(bindings.indexBuffer, _bufferOffsets,
+                                 _iboType);
+  }
+
+  // The buffers are shared, the data of the mesh starts at an offset
+  const uint32_t firstIndex = _ibo->GetFirstElement();
+  const int32_t vertexOffset = (int32_t)_vbo->GetFirstElement();
+  if (_ranges.empty()) {
+    recordBuffer.drawIndexed(_ibo->GetElementCount(), 1, firstIndex,
+                             vertexOffset, 0);
+    return;
+  }
+  for (size_t i = firstRange; i < firstRange + rangeCount; i++)
+    recordBuffer.drawIndexed(_ranges[i].indexCount, 1,
+                             firstIndex + _ranges[i].firstIndex,
+                             vertexOffset + _ranges[i].vertexOffset, 0);
+}
+
+void Mesh::Draw(const vk::CommandBuffer &recordBuffer, Bindings &bindings) {
+  if (!IsReady())
+    return;
+  if (_lods.empty())
+    _drawRanges(recordBuffer, bindings, 0, _ranges.size());
+  else
+    _drawRanges(recordBuffer, bindings, _lods.front().firstRange,
+                _lods.front().rangeCount);
+}
+
+void Mesh::Draw(const vk::CommandBuffer &recordBuffer, Bindings &bindings,
+                float projectedSize) {
+  if (_lods.empty() || !IsReady()) {
+    Draw(recordBuffer, bindings);
+    return;
+  }
+
+  // Errors grow with every level, take the last one that is still accurate
+  size_t selected = 0;
+  while (selected + 1 < _lods.size() &&
+         _lods[selected + 1].error * projectedSize <= _lodPixelError)
+    selected++;
+  _drawRanges(recordBuffer, bindings, _lods[selected].firstRange,
+              _lods[selected].rangeCount);
+}
@@ -13,19 +13,46 @@
 
 // Local
 #include "buffer.h"
+#include "draw_range.hpp"
 
 // Internal
 #include <core/descriptor/group.h>
 #include <svel/detail/mesh.h>
 #include <svel/util/array_proxy.hpp>
 
+// STL
+#include <vector>
+
 namespace SVEL_NAMESPACE {
 
 /**
  * @brief Combines Vertex Buffer Object and Index Buffer Object to form a mesh
- * that can be drawn by the renderer.
+ * that can be drawn by the renderer. The data of both lives in mesh arenas,
+ * so consecutive meshes usually draw from the same Vulkan buffers.
  */
 class Mesh {
+public:
+  /**
+   * @brief Buffers that are bound to a record buffer. Meshes that share their
+   * buffers with the previous draw do not bind them again.
+   */
+  struct Bindings {
+    /**
+     * @brief The bound vertex buffer.
+     */
+    vk::Buffer vertexBuffer;
+
+    /**
+     * @brief The bound index buffer.
+     */
+    vk::Buffer indexBuffer;
+
+    /**
+     * @brief The type of the bound index buffer.
+     */
+    vk::IndexType indexType = vk::IndexType::eUint16;
+  };
+
 private:
   /**
    * @brief Variable that has to be in memory for the draw. Static to preserve
@@ -48,26 +75,154 @@ private:
    */
   vk::IndexType _iboType;
 
+  /**
+   * @brief Ranges to draw. If empty, the whole index buffer is drawn at once.
+   */
+  std::vector<renderer::DrawRange> _ranges;
+
+  /**
+   * @brief Levels of detail, from the finest to the coarsest. If empty, the
+   * mesh only has a single level.
+   */
+  std::vector<renderer::LodLevel> _lods;
+
+  /**
+   * @brief Largest error in pixels that is accepted when selecting a level of
+   * detail.
+   */
+  float _lodPixelError;
+
+  /**
+   * @brief Draws consecutive ranges.
+   *
+   * @param recordBuffer  The record buffer to use for recording the draw.
+   * @param bindings      Buffers bound to the record buffer. Updated if the
+   *                      buffers of the mesh have to be bound.
+   * @param firstRange    First range to draw.
+   * @param rangeCount    Amount of ranges to draw.
+   */
+  void _drawRanges(const vk::CommandBuffer &recordBuffer, Bindings &bindings,
+                   size_t firstRange, size_t rangeCount);
+
 public:
   /**
-   * @brief Construct a Mesh with the given data.
+   * @brief Construct a Mesh with the given data. The data is only staged, it
+   * has to be uploaded before the mesh can be drawn.
    *
-   * @param device      Device to use.
-   * @param commandPool Command pool to use.
-   * @param nodes       The nodes that define the mesh point data.
-   * @param indices     The indices that define the geometry of the mesh.
-   * @param iboType     The data type of the indices.
+   * @param vertexArena   Arena that receives the vertices.
+   * @param indexArena    Arena that receives the indices.
+   * @param nodes         The nodes that define the mesh point data.
+   * @param indices       The indices that define the geometry of the mesh.
+   * @param iboType       The data type of the indices.
+   * @param ranges        Ranges of the index buffer to draw. If empty, the
+   *                      whole index buffer is drawn at once.
+   * @param lods          Levels of detail made of the ranges, from the finest
+   *                      to the coarsest. If empty, all ranges are drawn.
+   * @param lodPixelError Largest error in pixels that is accepted when
+   *                      selecting a level of detail.
    */
-  Mesh(core::SharedDevice device, const vk::CommandPool &commandPool,
+  Mesh(renderer::SharedMeshArena vertexArena,
+       renderer::SharedMeshArena indexArena,
        const SVEL_NAMESPACE::ArrayProxy &nodes,
-       const SVEL_NAMESPACE::ArrayProxy &indices, vk::IndexType iboType);
+       const SVEL_NAMESPACE::ArrayProxy &indices, vk::IndexType iboType,
+       std::vector<renderer::DrawRange> ranges = {},
+       std::vector<renderer::LodLevel> lods = {}, float lodPixelError = 1.0f);
+
+  /**
+   * @brief Construct a Mesh whose data is written directly into the staging
+   * memory. The data is only staged, it has to be uploaded before the mesh can
+   * be drawn.
+   *
+   * @param vertexArena   Arena that receives the vertices.
+   * @param indexArena    Arena that receives the indices.
+   * @param vertexCount   Amount of vertices.
+   * @param vertexStride  Size of a vertex in bytes.
+   * @param writeNodes    Writes all vertices into the staging memory.
+   * @param indexCount    Amount of indices.
+   * @param iboType       The data type of the indices.
+   * @param writeIndices  Writes all indices into the staging memory.
+   * @param ranges        Ranges of the index buffer to draw. If empty, the
+   *                      whole index buffer is drawn at once.
+   * @param lods          Levels of detail made of the ranges, from the finest
+   *                      to the coarsest. If empty, all ranges are drawn.
+   * @param lodPixelError Largest error in pixels that is accepted when
+   *                      selecting a level of detail.
+   * @param nodeSource    Vertices that outlive the upload, imported instead
+   *                      of written if the device allows it.
+   * @param indexSource   Indices that outlive the upload, imported instead
+   *                      of written if the device allows it.
+   */
+  Mesh(renderer::SharedMeshArena vertexArena,
+       renderer::SharedMeshArena indexArena, size_t vertexCount,
+       size_t vertexStride,
+       const core::TransferBuffer::DataWriter &writeNodes, size_t indexCount,
+       vk::IndexType iboType,
+       const core::TransferBuffer::DataWriter &writeIndices,
+       std::vector<renderer::DrawRange> ranges = {},
+       std::vector<renderer::LodLevel> lods = {}, float lodPixelError = 1.0f,
+       const core::TransferBuffer::HostSource &nodeSource = {},
+       const core::TransferBuffer::HostSource &indexSource = {});
+
+  /**
+   * @brief Construct a Mesh that draws ranges of the buffers of another mesh.
+   * Nothing is staged, the buffers are uploaded by whichever of the meshes
+   * is uploaded first.
+   *
+   * @param storage       Mesh whose buffers are shared.
+   * @param ranges        Ranges of the shared index buffer to draw.
+   * @param lods          Levels of detail made of the ranges, from the finest
+   *                      to the coarsest. If empty, all ranges are drawn.
+   * @param lodPixelError Largest error in pixels that is accepted when
+   *                      selecting a level of detail.
+   */
+  Mesh(const Mesh &storage, std::vector<renderer::DrawRange> ranges,
+       std::vector<renderer::LodLevel> lods = {}, float lodPixelError = 1.0f);
+
+  /**
+   * @brief Records the upload of the staged data into the batch. Has to be
+   * called from the thread that owns the batch. Buffers that were already
+   * submitted through another mesh are skipped.
+   *
+   * @param batch The batch whose flush submits the upload.
+   */
+  void Upload(core::UploadBatch &batch);
+
+  /**
+   * @brief Checks if the data of the mesh resides on the GPU.
+   *
+   * @return true   The mesh can be drawn.
+   * @return false  The upload has not completed yet.
+   */
+  bool IsReady();
 
   /**
-   * @brief Draw the mesh using the provided record buffer.
+   * @brief Getter for the bytes that are uploaded from imported host memory
+   * instead of staging memory.
+   *
+   * @return size_t Size in bytes.
+   */
+  size_t GetImportedSize() const;
+
+  /**
+   * @brief Draw the finest level of detail of the mesh using the provided
+   * record buffer. Meshes that are not ready are skipped.
    *
    * @param recordBuffer The record buffer to use for recording the draw.
+   * @param bindings     Buffers bound to the record buffer.
+   */
+  void Draw(const vk::CommandBuffer &recordBuffer, Bindings &bindings);
+
+  /**
+   * @brief Draw the coarsest level of detail whose error stays below the
+   * accepted pixel error at the given size on screen. Meshes that are not
+   * ready are skipped.
+   *
+   * @param recordBuffer  The record buffer to use for recording the draw.
+   * @param bindings      Buffers bound to the record buffer.
+   * @param projectedSize Size of the mesh extent on screen in pixels.
    */
-  void Draw(const vk::CommandBuffer &recordBuffer);
+  void Draw(const vk::CommandBuffer &recordBuffer, Bindings &bindings,
+            float projectedSize);
 };
 
 } // namespace SVEL_NAMESPACE
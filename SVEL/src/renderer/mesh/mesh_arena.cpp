@@ -0,0 +1,215 @@
+/**
+ * @file mesh_arena.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the MeshArena.
+ * @date 2023-10-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "mesh_arena.h"
+
+// STL
+#include <algorithm>
+
+using namespace renderer;
+
+uint8_t *MeshArena::_getMappedData(const Page &page, uint64_t offset) {
+  return page.mappedData == nullptr ? nullptr : page.mappedData + offset;
+}
+
+MeshArena::MeshArena(core::SharedDevice device, vk::BufferUsageFlags usage,
+                     uint64_t pageSize)
+    : _device(device), _usage(usage | vk::BufferUsageFlagBits::eTransferSrc |
+                              vk::BufferUsageFlagBits::eTransferDst),
+      _pageSize(pageSize) {
+  // Buffers of the same usage accept the same memory types, whatever their
+  // size, so a small buffer tells them for every page
+  auto vulkanDevice = _device->AsVulkanObj();
+  auto buffer = vulkanDevice.createBuffer(
+      vk::BufferCreateInfo(vk::BufferCreateFlagBits(), 1, _usage,
+                           vk::SharingMode::eExclusive, 0, nullptr));
+  _memoryTypeBits =
+      vulkanDevice.getBufferMemoryRequirements(buffer).memoryTypeBits;
+  vulkanDevice.destroyBuffer(buffer);
+}
+
+size_t MeshArena::_addPage(uint64_t size) {
+  // Integrated GPUs and resizable BAR skip the staging copy
+  core::SharedBuffer buffer;
+  if (_device->GetMemoryAllocator().CanWriteDirectly(size, _memoryTypeBits))
+    buffer = std::make_shared<core::Buffer>(
+        _device, size, _usage,
+        vk::MemoryPropertyFlagBits::eDeviceLocal |
+            vk::MemoryPropertyFlagBits::eHostVisible |
+            vk::MemoryPropertyFlagBits::eHostCoherent);
+  else
+    buffer = std::make_shared<core::Buffer>(
+        _device, size, _usage, vk::MemoryPropertyFlags(),
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+  auto page = std::make_unique<Page>(
+      Page{buffer, core::FreeList(size), (uint8_t *)buffer->GetMappedData(),
+           {}, 0});
+  for (size_t i = 0; i < _pages.size(); i++) {
+    if (!_pages[i]) {
+      _pages[i] = std::move(page);
+      return i;
+    }
+  }
+  _pages.push_back(std::move(page));
+  return _pages.size() - 1;
+}
+
+MeshArena::Allocation MeshArena::Allocate(uint64_t size, uint64_t alignment,
+                                          std::weak_ptr<Buffer> owner) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (size_t i = 0; i < _pages.size(); i++) {
+    if (!_pages[i])
+      continue;
+    auto &page = *_pages[i];
+    const uint64_t offset = page.freeList.Allocate(size, alignment);
+    if (offset != core::FreeList::INVALID_OFFSET) {
+      page.owners[offset] = {size, std::move(owner)};
+      return {page.buffer, i, offset, size, _getMappedData(page, offset)};
+    }
+  }
+
+  // Every page is full, the new one fits the request at offset 0
+  const size_t index = _addPage(std::max(_pageSize, size));
+  auto &page = *_pages[index];
+  const uint64_t offset = page.freeList.Allocate(size, 1);
+  page.owners[offset] = {size, std::move(owner)};
+  return {page.buffer, index, offset, size, _getMappedData(page, offset)};
+}
+
+MeshArena::Allocation MeshArena::AllocateMove(const Allocation &allocation,
+                                              uint64_t alignment,
+                                              std::weak_ptr<Buffer> owner) {
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  // Filling the fullest pages first keeps the others draining
+  std::vector<size_t> candidates{};
+  for (size_t i = 0; i < _pages.size(); i++)
+    if (_pages[i] && i != allocation.page)
+      candidates.push_back(i);
+  std::sort(candidates.begin(), candidates.end(), [this](size_t a, size_t b) {
+    return _pages[a]->freeList.GetUsedSize() >
+           _pages[b]->freeList.GetUsedSize();
+  });
+
+  for (size_t i : candidates) {
+    auto &page = *_pages[i];
+    const uint64_t offset = page.freeList.Allocate(allocation.size, alignment);
+    if (offset == core::FreeList::INVALID_OFFSET)
+      continue;
+    page.owners[offset] = {allocation.size, std::move(owner)};
+    return {page.buffer, i, offset, allocation.size,
+            _getMappedData(page, offset)};
+  }
+  return {nullptr, 0, 0, 0, nullptr};
+}
+
+std::vector<std::shared_ptr<Buffer>>
+MeshArena::GetMoveCandidates(uint64_t maxSize) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<std::shared_ptr<Buffer>> buffers{};
+
+  // Find the least used page that still holds buffers
+  Page *source = nullptr;
+  uint64_t freeSize = 0;
+  for (const auto &page : _pages) {
+    if (!page)
+      continue;
+    freeSize += page->freeList.GetSize() - page->freeList.GetUsedSize();
+    if (page->owners.empty())
+      continue;
+    if (source == nullptr ||
+        page->freeList.GetUsedSize() < source->freeList.GetUsedSize())
+      source = page.get();
+  }
+  if (source == nullptr)
+    return buffers;
+
+  // Draining only pays off if the other pages can take everything
+  const uint64_t sourceFree =
+      source->freeList.GetSize() - source->freeList.GetUsedSize();
+  if (freeSize - sourceFree < source->freeList.GetUsedSize())
+    return buffers;
+
+  // A buffer larger than the budget is still moved on its own
+  uint64_t size = 0;
+  for (auto it = source->owners.begin();
+       it != source->owners.end() && size < maxSize; it++) {
+    auto buffer = it->second.second.lock();
+    if (!buffer)
+      continue;
+    size += it->second.first;
+    buffers.push_back(std::move(buffer));
+  }
+  return buffers;
+}
+
+void MeshArena::Free(const Allocation &allocation) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto &page = *_pages[allocation.page];
+  page.owners.erase(allocation.offset);
+  page.pendingCount++;
+  _pendingFrees.push_back({allocation, _frame});
+}
+
+void MeshArena::NextFrame() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _frame++;
+
+  // The frame that shares its resources with the current one has completed,
+  // as have all frames before it
+  bool released = false;
+  while (!_pendingFrees.empty() &&
+         _pendingFrees.front().frame + SVEL_MAX_FRAMES_IN_FLIGHT <= _frame) {
+    const auto &allocation = _pendingFrees.front().allocation;
+    auto &page = *_pages[allocation.page];
+    page.freeList.Free(allocation.offset, allocation.size);
+    page.pendingCount--;
+    _pendingFrees.pop_front();
+    released = true;
+  }
+  if (!released)
+    return;
+
+  // Empty pages are returned to the device, one is kept for new meshes
+  size_t pageCount = std::count_if(_pages.begin(), _pages.end(),
+                                   [](const auto &page) { return !!page; });
+  for (auto &page : _pages) {
+    if (pageCount <= 1)
+      break;
+    if (!page || !page->freeList.IsEmpty() || page->pendingCount > 0)
+      continue;
+    page = nullptr;
+    pageCount--;
+  }
+}
+
+MeshArena::Statistics MeshArena::GetStatistics() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  Statistics statistics{};
+  for (const auto &page : _pages) {
+    if (!page)
+      continue;
+    statistics.pageCount++;
+    statistics.allocatedSize += page->freeList.GetSize();
+    statistics.usedSize += page->freeList.GetUsedSize();
+    statistics.largestFreeRange =
+        std::max(statistics.largestFreeRange, page->freeList.GetLargestFree());
+  }
+  for (const auto &pending : _pendingFrees)
+    statistics.pendingSize += pending.allocation.size;
+
+  const uint64_t freeSize = statistics.allocatedSize - statistics.usedSize;
+  if (freeSize > 0)
+    statistics.fragmentation =
+        1.0f - (float)statistics.largestFreeRange / (float)freeSize;
+  return statistics;
+}
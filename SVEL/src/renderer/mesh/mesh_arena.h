@@ -0,0 +1,306 @@
+/**
+ * @file mesh_arena.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declares the arena that holds the buffer data of all meshes.
+ * @date 2023-10-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __RENDERER_MESH_MESH_ARENA_H__
+#define __RENDERER_MESH_MESH_ARENA_H__
+
+// Internal
+#include <core/device.h>
+#include <core/memory/buffer.h>
+#include <core/memory/free_list.h>
+#include <core/memory/staging_ring.h>
+
+// Vulkan
+#include <vulkan/vulkan.hpp>
+
+// STL
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#ifndef SVEL_MESH_ARENA_PAGE_SIZE
+/**
+ * @brief Size of a device local buffer of the mesh arena. Meshes in the same
+ * page are drawn without binding buffers in between.
+ */
+#define SVEL_MESH_ARENA_PAGE_SIZE (64ull * 1024 * 1024)
+#endif /* SVEL_MESH_ARENA_PAGE_SIZE */
+
+namespace renderer {
+
+class Buffer;
+
+/**
+ * @brief Places the buffers of many meshes in a few large device local
+ * buffers, so that meshes only differ by their offsets and drawing them does
+ * not rebind buffers. Pages are added when the existing ones are full. Freed
+ * ranges are only reused after every frame in flight that may still read them
+ * completed. Thread safe.
+ */
+class MeshArena {
+public:
+  /**
+   * @brief A range inside a page of the arena.
+   */
+  struct Allocation {
+    /**
+     * @brief The buffer of the page.
+     */
+    core::SharedBuffer buffer;
+
+    /**
+     * @brief Index of the page.
+     */
+    size_t page = 0;
+
+    /**
+     * @brief Offset in bytes inside the buffer.
+     */
+    uint64_t offset = 0;
+
+    /**
+     * @brief Size in bytes.
+     */
+    uint64_t size = 0;
+
+    /**
+     * @brief Mapped start of the range if the page is host visible device
+     * local memory, which is written without staging. Otherwise nullptr.
+     */
+    uint8_t *mappedData = nullptr;
+  };
+
+private:
+  /**
+   * @brief A buffer with the ranges that are handed out of it.
+   */
+  struct Page {
+    /**
+     * @brief The device local buffer.
+     */
+    core::SharedBuffer buffer;
+
+    /**
+     * @brief Free ranges of the buffer.
+     */
+    core::FreeList freeList;
+
+    /**
+     * @brief Mapped start of the buffer or nullptr if it is not written
+     * directly.
+     */
+    uint8_t *mappedData = nullptr;
+
+    /**
+     * @brief Sizes and owning buffers of the handed out ranges, by offset.
+     */
+    std::map<uint64_t, std::pair<uint64_t, std::weak_ptr<Buffer>>> owners;
+
+    /**
+     * @brief Amount of ranges that wait for frames in flight.
+     */
+    uint32_t pendingCount = 0;
+  };
+
+  /**
+   * @brief A range that is released once the frames that used it completed.
+   */
+  struct PendingFree {
+    /**
+     * @brief The released range.
+     */
+    Allocation allocation;
+
+    /**
+     * @brief Frame in which the range was released.
+     */
+    uint64_t frame;
+  };
+
+  /**
+   * @brief Device to use.
+   */
+  core::SharedDevice _device;
+
+  /**
+   * @brief Usage of the page buffers.
+   */
+  vk::BufferUsageFlags _usage;
+
+  /**
+   * @brief Memory types that the page buffers accept.
+   */
+  uint32_t _memoryTypeBits = 0;
+
+  /**
+   * @brief Size of a page, larger allocations get a page of their own size.
+   */
+  uint64_t _pageSize;
+
+  /**
+   * @brief The pages in order of creation. Released pages leave a null slot,
+   * which the next page reuses so that page indices stay stable.
+   */
+  std::vector<std::unique_ptr<Page>> _pages;
+
+  /**
+   * @brief Ranges whose release waits for frames in flight, oldest first.
+   */
+  std::deque<PendingFree> _pendingFrees;
+
+  /**
+   * @brief Counts the frames that were started.
+   */
+  uint64_t _frame = 0;
+
+  /**
+   * @brief Guards pages and pending frees.
+   */
+  std::mutex _mutex;
+
+  /**
+   * @brief Adds a page to a free slot. Pages are placed in host visible
+   * device local memory where it is plentiful.
+   *
+   * @param size    Size of the page.
+   * @return size_t Index of the page.
+   */
+  size_t _addPage(uint64_t size);
+
+  /**
+   * @brief Getter for the mapped address of a range.
+   *
+   * @param page      The page.
+   * @param offset    Offset of the range.
+   * @return uint8_t* The mapped address or nullptr if the page is not mapped.
+   */
+  static uint8_t *_getMappedData(const Page &page, uint64_t offset);
+
+public:
+  /**
+   * @brief Usage of the arena.
+   */
+  struct Statistics {
+    /**
+     * @brief Amount of pages.
+     */
+    uint32_t pageCount = 0;
+
+    /**
+     * @brief Bytes of all pages.
+     */
+    uint64_t allocatedSize = 0;
+
+    /**
+     * @brief Bytes of all handed out ranges, including pending ones.
+     */
+    uint64_t usedSize = 0;
+
+    /**
+     * @brief Bytes of released ranges that wait for frames in flight.
+     */
+    uint64_t pendingSize = 0;
+
+    /**
+     * @brief Largest range that can be allocated without a new page.
+     */
+    uint64_t largestFreeRange = 0;
+
+    /**
+     * @brief Share of the free bytes that are not part of the largest free
+     * range, from 0 for a single free range to almost 1 for scattered ones.
+     */
+    float fragmentation = 0.0f;
+  };
+
+  /**
+   * @brief Construct an empty Mesh Arena. Pages are created on demand.
+   * Buffers of the arena can be used as transfer source and destination.
+   *
+   * @param device    Device to use.
+   * @param usage     Usage of the data, e.g. vertex or index buffer.
+   * @param pageSize  Size of a page.
+   */
+  MeshArena(core::SharedDevice device, vk::BufferUsageFlags usage,
+            uint64_t pageSize = SVEL_MESH_ARENA_PAGE_SIZE);
+
+  /**
+   * @brief Reserves a range, adding a page if none has enough space.
+   *
+   * @param size        Size in bytes.
+   * @param alignment   Alignment of the offset, any positive value. Element
+   *                    sizes make the offset a whole element index.
+   * @param owner       The buffer that uses the range, so that it can be
+   *                    moved when the arena is compacted.
+   * @return Allocation The range.
+   */
+  Allocation Allocate(uint64_t size, uint64_t alignment,
+                      std::weak_ptr<Buffer> owner);
+
+  /**
+   * @brief Reserves a range to move a buffer to, in the fullest other page
+   * with enough space. No page is added for it.
+   *
+   * @param allocation  The current range of the buffer.
+   * @param alignment   Alignment of the offset.
+   * @param owner       The buffer.
+   * @return Allocation The new range, with a null buffer if nothing fits.
+   */
+  Allocation AllocateMove(const Allocation &allocation, uint64_t alignment,
+                          std::weak_ptr<Buffer> owner);
+
+  /**
+   * @brief Picks the buffers of the least used page, if the other pages have
+   * room for all of them. Moving these releases the page.
+   *
+   * @param maxSize The bytes that may be moved.
+   * @return std::vector<std::shared_ptr<Buffer>> Buffers to move, may be
+   *                                              empty.
+   */
+  std::vector<std::shared_ptr<Buffer>> GetMoveCandidates(uint64_t maxSize);
+
+  /**
+   * @brief Releases a range. The range is reused once every frame in flight
+   * that may still read it completed.
+   *
+   * @param allocation The range.
+   */
+  void Free(const Allocation &allocation);
+
+  /**
+   * @brief Marks the start of a frame, after the frame that last used its
+   * resources completed. Releases ranges that no frame in flight can read and
+   * pages that became empty, except for the last page.
+   */
+  void NextFrame();
+
+  /**
+   * @brief Getter for the usage of the arena.
+   *
+   * @return Statistics The statistics.
+   */
+  Statistics GetStatistics();
+
+  /**
+   * @brief Getter for the device.
+   *
+   * @return core::SharedDevice The device.
+   */
+  core::SharedDevice GetDevice() { return _device; }
+};
+SVEL_CLASS(MeshArena)
+
+} // namespace renderer
+
+#endif /* __RENDERER_MESH_MESH_ARENA_H__ */
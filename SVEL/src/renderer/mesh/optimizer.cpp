@@ -0,0 +1,502 @@
+/**
+ * @file optimizer.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implements optimization passes for indexed triangle meshes.
+ * @date 2023-09-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "optimizer.h"
+
+// GLM
+#include <glm/glm.hpp>
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace renderer;
+
+/**
+ * @brief Makes sure that all indices reference existing vertices.
+ *
+ * @tparam T          Index type.
+ * @param indices     Index data.
+ * @param indexCount  Amount of indices.
+ * @param vertexCount Amount of vertices.
+ */
+template <typename T>
+static void _validateIndices(const T *indices, size_t indexCount,
+                             size_t vertexCount) {
+  for (size_t i = 0; i < indexCount; i++)
+    if ((size_t)indices[i] >= vertexCount)
+      throw std::invalid_argument("Index references a missing vertex.");
+}
+
+template <typename T>
+SVEL_NAMESPACE::VertexCacheStatistics
+renderer::AnalyzeVertexCache(const T *indices, size_t indexCount,
+                             size_t vertexCount, uint32_t cacheSize) {
+  SVEL_NAMESPACE::VertexCacheStatistics statistics{};
+  const size_t triangleCount = indexCount / 3;
+  if (triangleCount == 0)
+    return statistics;
+  _validateIndices(indices, indexCount, vertexCount);
+
+  // A vertex is cached as long as less than cacheSize vertices were
+  // transformed after it
+  std::vector<uint32_t> cacheTime(vertexCount, 0);
+  std::vector<bool> referenced(vertexCount, false);
+  uint32_t timestamp = cacheSize + 1;
+  size_t misses = 0, uniqueVertices = 0;
+  for (size_t i = 0; i < triangleCount * 3; i++) {
+    const auto vertex = (size_t)indices[i];
+    if (!referenced[vertex]) {
+      referenced[vertex] = true;
+      uniqueVertices++;
+    }
+    if (timestamp - cacheTime[vertex] > cacheSize) {
+      cacheTime[vertex] = timestamp++;
+      misses++;
+    }
+  }
+
+  statistics.acmr = (float)misses / (float)triangleCount;
+  statistics.atvr = (float)misses / (float)uniqueVertices;
+  return statistics;
+}
+
+template <typename T>
+void renderer::OptimizeVertexCache(T *indices, size_t indexCount,
+                                   size_t vertexCount, uint32_t cacheSize) {
+  const size_t triangleCount = indexCount / 3;
+  if (triangleCount == 0)
+    return;
+  _validateIndices(indices, indexCount, vertexCount);
+
+  // Triangles that still have to be emitted per vertex
+  std::vector<uint32_t> liveCount(vertexCount, 0);
+  for (size_t i = 0; i < triangleCount * 3; i++)
+    liveCount[indices[i]]++;
+
+  // Vertex to triangle adjacency in a single array
+  std::vector<size_t> adjacencyOffsets(vertexCount + 1, 0);
+  for (size_t v = 0; v < vertexCount; v++)
+    adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveCount[v];
+  std::vector<uint32_t> adjacency(triangleCount * 3);
+  {
+    std::vector<size_t> fill(adjacencyOffsets.begin(),
+                             adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+      adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+  }
+
+  std::vector<uint32_t> cacheTime(vertexCount, 0);
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<size_t> deadEnd{};
+  std::vector<size_t> candidates{};
+  std::vector<T> result{};
+  deadEnd.reserve(triangleCount * 3);
+  result.reserve(triangleCount * 3);
+  uint32_t timestamp = cacheSize + 1;
+  size_t cursor = 0;
+
+  // Finds a vertex to continue with once the local neighbourhood is used up
+  auto skipDeadEnd = [&](size_t &out_vertex) {
+    while (!deadEnd.empty()) {
+      out_vertex = deadEnd.back();
+      deadEnd.pop_back();
+      if (liveCount[out_vertex] > 0)
+        return true;
+    }
+    for (; cursor < vertexCount; cursor++) {
+      if (liveCount[cursor] > 0) {
+        out_vertex = cursor;
+        return true;
+      }
+    }
+    return false;
+  };
+
+  size_t fanning = 0;
+  bool hasFanning = skipDeadEnd(fanning);
+  while (hasFanning) {
+    // Emit all remaining triangles around the fanning vertex
+    candidates.clear();
+    for (size_t a = adjacencyOffsets[fanning];
+         a < adjacencyOffsets[fanning + 1]; a++) {
+      const auto triangle = adjacency[a];
+      if (emitted[triangle])
+        continue;
+      for (size_t c = 0; c < 3; c++) {
+        const auto vertex = indices[(size_t)triangle * 3 + c];
+        result.push_back(vertex);
+        deadEnd.push_back(vertex);
+        candidates.push_back(vertex);
+        liveCount[vertex]--;
+        if (timestamp - cacheTime[vertex] > cacheSize)
+          cacheTime[vertex] = timestamp++;
+      }
+      emitted[triangle] = true;
+    }
+
+    // Prefer the candidate that is oldest in the cache but still survives
+    // its own fan
+    int64_t bestPriority = -1;
+    hasFanning = false;
+    for (const auto vertex : candidates) {
+      if (liveCount[vertex] == 0)
+        continue;
+      int64_t priority = 0;
+      const uint32_t age = timestamp - cacheTime[vertex];
+      if ((uint64_t)age + 2 * (uint64_t)liveCount[vertex] <= cacheSize)
+        priority = age;
+      if (priority > bestPriority) {
+        bestPriority = priority;
+        fanning = vertex;
+        hasFanning = true;
+      }
+    }
+    if (!hasFanning)
+      hasFanning = skipDeadEnd(fanning);
+  }
+
+  std::memcpy(indices, result.data(), result.size() * sizeof(T));
+}
+
+/**
+ * @brief Reads the position of a vertex.
+ *
+ * @param vertices        Vertex data.
+ * @param vertexStride    Size of a vertex in bytes.
+ * @param positionOffset  Offset of the position in a vertex.
+ * @param vertex          Index of the vertex.
+ * @return glm::vec3      The position.
+ */
+static glm::vec3 _getPosition(const void *vertices, size_t vertexStride,
+                              size_t positionOffset, size_t vertex) {
+  glm::vec3 position;
+  std::memcpy(&position,
+              (const uint8_t *)vertices + vertex * vertexStride +
+                  positionOffset,
+              sizeof(glm::vec3));
+  return position;
+}
+
+template <typename T>
+void renderer::OptimizeOverdraw(T *indices, size_t indexCount,
+                                const void *vertices, size_t vertexStride,
+                                size_t positionOffset, size_t vertexCount,
+                                uint32_t cacheSize, float threshold) {
+  const size_t triangleCount = indexCount / 3;
+  if (triangleCount == 0)
+    return;
+  _validateIndices(indices, indexCount, vertexCount);
+
+  // FIFO cache simulation, returns the misses of a triangle
+  std::vector<uint32_t> cacheTime(vertexCount, 0);
+  uint32_t timestamp = cacheSize + 1;
+  auto simulate = [&](size_t triangle) {
+    uint32_t misses = 0;
+    for (size_t c = 0; c < 3; c++) {
+      const auto vertex = indices[triangle * 3 + c];
+      if (timestamp - cacheTime[vertex] > cacheSize) {
+        cacheTime[vertex] = timestamp++;
+        misses++;
+      }
+    }
+    return misses;
+  };
+  auto resetCache = [&]() { timestamp += cacheSize + 1; };
+
+  // Hard boundaries: None of the vertices were cached, so clusters starting
+  // there can be moved without any cost
+  std::vector<size_t> hardBoundaries{};
+  for (size_t t = 0; t < triangleCount; t++)
+    if (simulate(t) == 3 || t == 0)
+      hardBoundaries.push_back(t);
+  hardBoundaries.push_back(triangleCount);
+
+  // Soft boundaries: Split clusters further as long as the cache efficiency
+  // stays within the threshold
+  std::vector<size_t> boundaries{};
+  for (size_t h = 0; h + 1 < hardBoundaries.size(); h++) {
+    const size_t start = hardBoundaries[h], end = hardBoundaries[h + 1];
+    resetCache();
+    uint32_t clusterMisses = 0;
+    for (size_t t = start; t < end; t++)
+      clusterMisses += simulate(t);
+    const float clusterThreshold =
+        threshold * (float)clusterMisses / (float)(end - start);
+
+    boundaries.push_back(start);
+    resetCache();
+    uint32_t runningMisses = 0, runningTriangles = 0;
+    for (size_t t = start; t < end; t++) {
+      runningMisses += simulate(t);
+      runningTriangles++;
+      if (t + 1 < end &&
+          (float)runningMisses / (float)runningTriangles <= clusterThreshold) {
+        boundaries.push_back(t + 1);
+        resetCache();
+        runningMisses = runningTriangles = 0;
+      }
+    }
+  }
+  boundaries.push_back(triangleCount);
+
+  glm::vec3 meshCentroid(0.0f);
+  for (size_t v = 0; v < vertexCount; v++)
+    meshCentroid += _getPosition(vertices, vertexStride, positionOffset, v);
+  meshCentroid = meshCentroid / (float)vertexCount;
+
+  // Clusters facing away from the center occlude the rest of the mesh
+  const size_t clusterCount = boundaries.size() - 1;
+  std::vector<float> occlusion(clusterCount, 0.0f);
+  for (size_t c = 0; c < clusterCount; c++) {
+    glm::vec3 centroid(0.0f), normal(0.0f);
+    float area = 0.0f;
+    for (size_t t = boundaries[c]; t < boundaries[c + 1]; t++) {
+      glm::vec3 p[3];
+      for (size_t i = 0; i < 3; i++)
+        p[i] = _getPosition(vertices, vertexStride, positionOffset,
+                            indices[t * 3 + i]);
+      const auto triangleNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+      const float triangleArea = glm::length(triangleNormal);
+      centroid += (p[0] + p[1] + p[2]) * (triangleArea / 3.0f);
+      normal += triangleNormal;
+      area += triangleArea;
+    }
+
+    const float normalLength = glm::length(normal);
+    if (area > 0.0f && normalLength > 0.0f)
+      occlusion[c] =
+          glm::dot(centroid / area - meshCentroid, normal / normalLength);
+  }
+
+  std::vector<size_t> order(clusterCount);
+  for (size_t c = 0; c < clusterCount; c++)
+    order[c] = c;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return occlusion[a] > occlusion[b];
+  });
+
+  std::vector<T> result{};
+  result.reserve(triangleCount * 3);
+  for (const auto cluster : order)
+    result.insert(result.end(), indices + boundaries[cluster] * 3,
+                  indices + boundaries[cluster + 1] * 3);
+  std::memcpy(indices, result.data(), result.size() * sizeof(T));
+}
+
+template <typename T>
+SVEL_NAMESPACE::OverdrawStatistics
+renderer::AnalyzeOverdraw(const T *indices, size_t indexCount,
+                          const void *vertices, size_t vertexStride,
+                          size_t positionOffset, size_t vertexCount) {
+  SVEL_NAMESPACE::OverdrawStatistics statistics{};
+  const size_t triangleCount = indexCount / 3;
+  if (triangleCount == 0)
+    return statistics;
+  _validateIndices(indices, indexCount, vertexCount);
+
+  // Fit the mesh into the unit cube, keeping its proportions
+  glm::vec3 minimum(INFINITY), maximum(-INFINITY);
+  for (size_t v = 0; v < vertexCount; v++) {
+    const auto position =
+        _getPosition(vertices, vertexStride, positionOffset, v);
+    minimum = glm::min(minimum, position);
+    maximum = glm::max(maximum, position);
+  }
+  const auto size = maximum - minimum;
+  const float extent = std::max(std::max(size.x, size.y), size.z);
+  if (!(extent > 0.0f))
+    return statistics;
+
+  constexpr int resolution = 256;
+  std::vector<float> depth((size_t)resolution * resolution);
+  for (int axis = 0; axis < 3; axis++) {
+    for (int direction = 0; direction < 2; direction++) {
+      std::fill(depth.begin(), depth.end(), INFINITY);
+
+      for (size_t t = 0; t < triangleCount; t++) {
+        // Project onto the plane orthogonal to the view axis
+        glm::vec3 p[3];
+        for (size_t i = 0; i < 3; i++) {
+          const auto position =
+              (_getPosition(vertices, vertexStride, positionOffset,
+                            indices[t * 3 + i]) -
+               minimum) /
+              extent;
+          p[i].x = position[(axis + 1) % 3] * (float)resolution;
+          p[i].y = position[(axis + 2) % 3] * (float)resolution;
+          p[i].z = direction == 0 ? position[axis] : 1.0f - position[axis];
+        }
+
+        // Neither winding is culled
+        float area =
+            (p[1].x - p[0].x) * (p[2].y - p[0].y) -
+            (p[1].y - p[0].y) * (p[2].x - p[0].x);
+        if (area == 0.0f)
+          continue;
+        if (area < 0.0f) {
+          std::swap(p[1], p[2]);
+          area = -area;
+        }
+
+        auto bound = [](float value) {
+          return std::min(std::max((int)value, 0), resolution - 1);
+        };
+        const int minX = bound(std::min({p[0].x, p[1].x, p[2].x}));
+        const int maxX = bound(std::max({p[0].x, p[1].x, p[2].x}));
+        const int minY = bound(std::min({p[0].y, p[1].y, p[2].y}));
+        const int maxY = bound(std::max({p[0].y, p[1].y, p[2].y}));
+        for (int y = minY; y <= maxY; y++) {
+          for (int x = minX; x <= maxX; x++) {
+            // Sample at the pixel center
+            const float px = (float)x + 0.5f, py = (float)y + 0.5f;
+            float weights[3];
+            for (int e = 0; e < 3; e++) {
+              const auto &a = p[(e + 1) % 3], &b = p[(e + 2) % 3];
+              weights[e] = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+            }
+            if (weights[0] < 0.0f || weights[1] < 0.0f || weights[2] < 0.0f)
+              continue;
+
+            const float z = (weights[0] * p[0].z + weights[1] * p[1].z +
+                             weights[2] * p[2].z) /
+                            area;
+            auto &stored = depth[(size_t)y * resolution + (size_t)x];
+            if (z < stored) {
+              stored = z;
+              statistics.pixelsShaded++;
+            }
+          }
+        }
+      }
+
+      for (const auto value : depth)
+        if (value != INFINITY)
+          statistics.pixelsCovered++;
+    }
+  }
+
+  if (statistics.pixelsCovered > 0)
+    statistics.overdraw =
+        (float)statistics.pixelsShaded / (float)statistics.pixelsCovered;
+  return statistics;
+}
+
+template <typename T>
+size_t renderer::OptimizeVertexFetch(void *vertices, size_t vertexStride,
+                                     size_t vertexCount, T *indices,
+                                     size_t indexCount) {
+  _validateIndices(indices, indexCount, vertexCount);
+
+  // Assign new positions in order of first use
+  constexpr uint32_t unused = UINT32_MAX;
+  std::vector<uint32_t> remap(vertexCount, unused);
+  uint32_t next = 0;
+  for (size_t i = 0; i < indexCount; i++) {
+    auto &newIndex = remap[indices[i]];
+    if (newIndex == unused)
+      newIndex = next++;
+    indices[i] = (T)newIndex;
+  }
+
+  auto *bytes = (uint8_t *)vertices;
+  std::vector<uint8_t> original(bytes, bytes + vertexCount * vertexStride);
+  for (size_t v = 0; v < vertexCount; v++)
+    if (remap[v] != unused)
+      std::memcpy(bytes + (size_t)remap[v] * vertexStride,
+                  original.data() + v * vertexStride, vertexStride);
+  return next;
+}
+
+void renderer::SplitIndexRanges(const void *vertices, size_t vertexStride,
+                                size_t vertexCount, const uint32_t *indices,
+                                size_t indexCount,
+                                std::vector<uint8_t> &out_vertices,
+                                std::vector<uint16_t> &out_indices,
+                                std::vector<DrawRange> &out_ranges) {
+  _validateIndices(indices, indexCount, vertexCount);
+  constexpr size_t maxWindow = (size_t)UINT16_MAX + 1;
+  const auto *bytes = (const uint8_t *)vertices;
+
+  out_vertices.clear();
+  out_indices.clear();
+  out_ranges.clear();
+  out_vertices.reserve(vertexCount * vertexStride);
+  out_indices.reserve(indexCount);
+
+  // Stamps tell which vertices are part of the current window without
+  // clearing the local indices for every range
+  std::vector<uint32_t> stamp(vertexCount, 0);
+  std::vector<uint16_t> localIndex(vertexCount, 0);
+  uint32_t currentStamp = 1;
+  size_t windowSize = 0;
+
+  const size_t triangleCount = indexCount / 3;
+  if (triangleCount > 0)
+    out_ranges.push_back({0, 0, 0});
+  for (size_t t = 0; t < triangleCount; t++) {
+    const uint32_t *triangle = indices + t * 3;
+    size_t newVertices = 0;
+    for (size_t c = 0; c < 3; c++)
+      if (stamp[triangle[c]] != currentStamp)
+        newVertices++;
+
+    // Start a new range once the window is full
+    if (windowSize + newVertices > maxWindow) {
+      currentStamp++;
+      windowSize = 0;
+      out_ranges.push_back(
+          {(uint32_t)out_indices.size(), 0,
+           (int32_t)(out_vertices.size() / vertexStride)});
+    }
+
+    for (size_t c = 0; c < 3; c++) {
+      const auto vertex = triangle[c];
+      if (stamp[vertex] != currentStamp) {
+        stamp[vertex] = currentStamp;
+        localIndex[vertex] = (uint16_t)windowSize++;
+        out_vertices.insert(out_vertices.end(), bytes + vertex * vertexStride,
+                            bytes + (vertex + 1) * vertexStride);
+      }
+      out_indices.push_back(localIndex[vertex]);
+    }
+    out_ranges.back().indexCount += 3;
+  }
+}
+
+// Meshes can only be created with these index types
+template SVEL_NAMESPACE::VertexCacheStatistics
+renderer::AnalyzeVertexCache(const uint16_t *, size_t, size_t, uint32_t);
+template SVEL_NAMESPACE::VertexCacheStatistics
+renderer::AnalyzeVertexCache(const uint32_t *, size_t, size_t, uint32_t);
+template void renderer::OptimizeVertexCache(uint16_t *, size_t, size_t,
+                                            uint32_t);
+template void renderer::OptimizeVertexCache(uint32_t *, size_t, size_t,
+                                            uint32_t);
+template void renderer::OptimizeOverdraw(uint16_t *, size_t, const void *,
+                                         size_t, size_t, size_t, uint32_t,
+                                         float);
+template void renderer::OptimizeOverdraw(uint32_t *, size_t, const void *,
+                                         size_t, size_t, size_t, uint32_t,
+                                         float);
+template SVEL_NAMESPACE::OverdrawStatistics
+renderer::AnalyzeOverdraw(const uint16_t *, size_t, const void *, size_t,
+                          size_t, size_t);
+template SVEL_NAMESPACE::OverdrawStatistics
+renderer::AnalyzeOverdraw(const uint32_t *, size_t, const void *, size_t,
+                          size_t, size_t);
+template size_t renderer::OptimizeVertexFetch(void *, size_t, size_t,
+                                              uint16_t *, size_t);
+template size_t renderer::OptimizeVertexFetch(void *, size_t, size_t,
+                                              uint32_t *, size_t);
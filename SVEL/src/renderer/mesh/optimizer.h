@@ -0,0 +1,140 @@
+/**
+ * @file optimizer.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declares optimization passes for indexed triangle meshes.
+ * @date 2023-09-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __RENDERER_MESH_OPTIMIZER_H__
+#define __RENDERER_MESH_OPTIMIZER_H__
+
+// Local
+#include "draw_range.hpp"
+
+// Internal
+#include <svel/detail/mesh.h>
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace renderer {
+
+/**
+ * @brief Simulates a FIFO post-transform vertex cache for a triangle list.
+ *
+ * @tparam T                                    Index type.
+ * @param indices                               Index data.
+ * @param indexCount                            Amount of indices.
+ * @param vertexCount                           Amount of vertices.
+ * @param cacheSize                             Size of the simulated cache.
+ * @return SVEL_NAMESPACE::VertexCacheStatistics Efficiency of the ordering.
+ */
+template <typename T>
+SVEL_NAMESPACE::VertexCacheStatistics
+AnalyzeVertexCache(const T *indices, size_t indexCount, size_t vertexCount,
+                   uint32_t cacheSize);
+
+/**
+ * @brief Reorders the triangles of a triangle list for the post-transform
+ * vertex cache. Uses Tipsify (Sander et al., "Fast Triangle Reordering for
+ * Vertex Locality and Reduced Overdraw"), which runs in linear time.
+ *
+ * @tparam T          Index type.
+ * @param indices     Index data. Reordered in place.
+ * @param indexCount  Amount of indices.
+ * @param vertexCount Amount of vertices.
+ * @param cacheSize   Size of the targeted cache.
+ */
+template <typename T>
+void OptimizeVertexCache(T *indices, size_t indexCount, size_t vertexCount,
+                         uint32_t cacheSize);
+
+/**
+ * @brief Reorders clusters of triangles by their view independent occlusion
+ * potential, so that outward facing triangles at the hull of the mesh are drawn
+ * first (Sander et al.). The triangle order within a cluster is kept, so the
+ * indices should already be optimized for the vertex cache.
+ *
+ * @tparam T              Index type.
+ * @param indices         Index data. Reordered in place.
+ * @param indexCount      Amount of indices.
+ * @param vertices        Vertex data.
+ * @param vertexStride    Size of a vertex in bytes.
+ * @param positionOffset  Offset of the three float position in a vertex.
+ * @param vertexCount     Amount of vertices.
+ * @param cacheSize       Size of the targeted cache.
+ * @param threshold       Allowed vertex cache degradation. Clusters are split
+ *                        wherever the local miss ratio is below the cluster
+ *                        miss ratio times the threshold.
+ */
+template <typename T>
+void OptimizeOverdraw(T *indices, size_t indexCount, const void *vertices,
+                      size_t vertexStride, size_t positionOffset,
+                      size_t vertexCount, uint32_t cacheSize, float threshold);
+
+/**
+ * @brief Estimates the overdraw of a triangle list by rasterizing it with a
+ * depth test from the six axis aligned view directions. Triangles are not
+ * culled, matching the pipelines of the renderer.
+ *
+ * @tparam T                                  Index type.
+ * @param indices                             Index data.
+ * @param indexCount                          Amount of indices.
+ * @param vertices                            Vertex data.
+ * @param vertexStride                        Size of a vertex in bytes.
+ * @param positionOffset                      Offset of the three float
+ *                                            position in a vertex.
+ * @param vertexCount                         Amount of vertices.
+ * @return SVEL_NAMESPACE::OverdrawStatistics The estimated overdraw.
+ */
+template <typename T>
+SVEL_NAMESPACE::OverdrawStatistics
+AnalyzeOverdraw(const T *indices, size_t indexCount, const void *vertices,
+                size_t vertexStride, size_t positionOffset,
+                size_t vertexCount);
+
+/**
+ * @brief Reorders the vertices in order of their first use and remaps the
+ * indices accordingly. Vertices that are not referenced are removed.
+ *
+ * @tparam T            Index type.
+ * @param vertices      Vertex data. Reordered in place.
+ * @param vertexStride  Size of a vertex in bytes.
+ * @param vertexCount   Amount of vertices.
+ * @param indices       Index data. Remapped in place.
+ * @param indexCount    Amount of indices.
+ * @return size_t       Amount of vertices that remain.
+ */
+template <typename T>
+size_t OptimizeVertexFetch(void *vertices, size_t vertexStride,
+                           size_t vertexCount, T *indices, size_t indexCount);
+
+/**
+ * @brief Splits a triangle list into ranges that each reference at most 65536
+ * vertices, so that the mesh can be drawn with 16 bit indices. Every range
+ * gets its own contiguous window of vertices. Vertices that are shared between
+ * ranges are duplicated.
+ *
+ * @param vertices      Vertex data.
+ * @param vertexStride  Size of a vertex in bytes.
+ * @param vertexCount   Amount of vertices.
+ * @param indices       Index data.
+ * @param indexCount    Amount of indices.
+ * @param out_vertices  Vertex data of all ranges.
+ * @param out_indices   16 bit indices relative to the window of their range.
+ * @param out_ranges    The ranges.
+ */
+void SplitIndexRanges(const void *vertices, size_t vertexStride,
+                      size_t vertexCount, const uint32_t *indices,
+                      size_t indexCount, std::vector<uint8_t> &out_vertices,
+                      std::vector<uint16_t> &out_indices,
+                      std::vector<DrawRange> &out_ranges);
+
+} // namespace renderer
+
+#endif /* __RENDERER_MESH_OPTIMIZER_H__ */
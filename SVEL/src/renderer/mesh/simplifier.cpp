@@ -0,0 +1,521 @@
+/**
+ * @file simplifier.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implements the simplification of indexed triangle meshes.
+ * @date 2023-09-09
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "simplifier.h"
+
+// GLM
+#include <glm/glm.hpp>
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+using namespace renderer;
+
+namespace {
+
+/**
+ * @brief Describes how a vertex may be moved by a collapse.
+ */
+enum class VertexKind : uint8_t {
+  eManifold, // Interior vertex, may collapse onto any neighbour
+  eBorder,   // On an open border, may only move along the border
+  eSeam,     // On an attribute seam, may only move along the seam
+  eLocked    // Never moves
+};
+
+/**
+ * @brief Symmetric quadric that measures the squared distance to a set of
+ * weighted planes.
+ */
+struct Quadric {
+  double a00 = 0.0, a11 = 0.0, a22 = 0.0;
+  double a10 = 0.0, a20 = 0.0, a21 = 0.0;
+  double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+  double c = 0.0;
+  double w = 0.0;
+};
+
+/**
+ * @brief Collapse of a vertex onto a neighbour.
+ */
+struct Collapse {
+  uint32_t from;
+  uint32_t to;
+  double cost;
+};
+
+/**
+ * @brief Outgoing half edges of every vertex.
+ */
+struct Adjacency {
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> targets;
+};
+
+/**
+ * @brief Marks that a vertex has no open edge in a direction.
+ */
+constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+/**
+ * @brief Marks that a vertex has several open edges in a direction.
+ */
+constexpr uint32_t MANY_EDGES = NO_EDGE - 1;
+
+/**
+ * @brief Weight of the planes that keep open borders in place, relative to the
+ * planes of the triangles.
+ */
+constexpr double BORDER_WEIGHT = 2.0;
+
+} // namespace
+
+/**
+ * @brief Adds a weighted plane to the quadric.
+ *
+ * @param quadric The quadric to extend.
+ * @param normal  Unit normal of the plane.
+ * @param point   A point on the plane.
+ * @param weight  Weight of the plane.
+ */
+static void _addPlane(Quadric &quadric, const glm::vec3 &normal,
+                      const glm::vec3 &point, double weight) {
+  const double x = normal.x, y = normal.y, z = normal.z;
+  const double d = -(x * point.x + y * point.y + z * point.z);
+  quadric.a00 += weight * x * x;
+  quadric.a11 += weight * y * y;
+  quadric.a22 += weight * z * z;
+  quadric.a10 += weight * y * x;
+  quadric.a20 += weight * z * x;
+  quadric.a21 += weight * z * y;
+  quadric.b0 += weight * x * d;
+  quadric.b1 += weight * y * d;
+  quadric.b2 += weight * z * d;
+  quadric.c += weight * d * d;
+  quadric.w += weight;
+}
+
+/**
+ * @brief Adds one quadric to another.
+ *
+ * @param quadric The quadric to extend.
+ * @param other   The quadric to add.
+ */
+static void _addQuadric(Quadric &quadric, const Quadric &other) {
+  quadric.a00 += other.a00;
+  quadric.a11 += other.a11;
+  quadric.a22 += other.a22;
+  quadric.a10 += other.a10;
+  quadric.a20 += other.a20;
+  quadric.a21 += other.a21;
+  quadric.b0 += other.b0;
+  quadric.b1 += other.b1;
+  quadric.b2 += other.b2;
+  quadric.c += other.c;
+  quadric.w += other.w;
+}
+
+/**
+ * @brief Evaluates the quadric.
+ *
+ * @param quadric The quadric.
+ * @param point   The point to measure.
+ * @return double Weighted mean of the squared distances to the planes.
+ */
+static double _evaluate(const Quadric &quadric, const glm::vec3 &point) {
+  if (quadric.w <= 0.0)
+    return 0.0;
+  const double x = point.x, y = point.y, z = point.z;
+  const double rx = quadric.a00 * x + quadric.a10 * y + quadric.a20 * z;
+  const double ry = quadric.a10 * x + quadric.a11 * y + quadric.a21 * z;
+  const double rz = quadric.a20 * x + quadric.a21 * y + quadric.a22 * z;
+  const double error =
+      rx * x + ry * y + rz * z +
+      2.0 * (quadric.b0 * x + quadric.b1 * y + quadric.b2 * z) + quadric.c;
+  return std::fabs(error) / quadric.w;
+}
+
+/**
+ * @brief Collects the outgoing half edges of every vertex.
+ *
+ * @param indices       Index data of a triangle list.
+ * @param vertexCount   Amount of vertices.
+ * @param out_adjacency The half edges.
+ */
+static void _buildAdjacency(const std::vector<uint32_t> &indices,
+                            size_t vertexCount, Adjacency &out_adjacency) {
+  out_adjacency.offsets.assign(vertexCount + 1, 0);
+  for (const auto index : indices)
+    out_adjacency.offsets[index + 1]++;
+  for (size_t i = 0; i < vertexCount; i++)
+    out_adjacency.offsets[i + 1] += out_adjacency.offsets[i];
+
+  auto fill = out_adjacency.offsets;
+  out_adjacency.targets.resize(indices.size());
+  for (size_t i = 0; i < indices.size(); i += 3)
+    for (size_t k = 0; k < 3; k++)
+      out_adjacency.targets[fill[indices[i + k]]++] =
+          indices[i + (k + 1) % 3];
+}
+
+/**
+ * @brief Checks for a half edge.
+ *
+ * @param adjacency The half edges.
+ * @param from      Start of the edge.
+ * @param to        End of the edge.
+ * @return true     The edge exists.
+ * @return false    The edge does not exist.
+ */
+static bool _hasEdge(const Adjacency &adjacency, uint32_t from, uint32_t to) {
+  for (auto i = adjacency.offsets[from]; i < adjacency.offsets[from + 1]; i++)
+    if (adjacency.targets[i] == to)
+      return true;
+  return false;
+}
+
+/**
+ * @brief Checks for a half edge between two positions, ignoring attributes.
+ *
+ * @param adjacency The half edges.
+ * @param remap     Maps vertices to the first vertex with the same position.
+ * @param wedge     Links vertices with the same position in a cycle.
+ * @param from      Start of the edge.
+ * @param to        End of the edge.
+ * @return true     The edge exists.
+ * @return false    The edge does not exist.
+ */
+static bool _hasPositionEdge(const Adjacency &adjacency,
+                             const std::vector<uint32_t> &remap,
+                             const std::vector<uint32_t> &wedge, uint32_t from,
+                             uint32_t to) {
+  auto vertex = from;
+  do {
+    for (auto i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1];
+         i++)
+      if (remap[adjacency.targets[i]] == remap[to])
+        return true;
+    vertex = wedge[vertex];
+  } while (vertex != from);
+  return false;
+}
+
+/**
+ * @brief Checks if an existing edge belongs to a single triangle only.
+ *
+ * @param adjacency The half edges.
+ * @param a         One end of the edge.
+ * @param b         The other end of the edge.
+ * @return true     The edge is open.
+ * @return false    The edge is shared or missing.
+ */
+static bool _isOpenEdge(const Adjacency &adjacency, uint32_t a, uint32_t b) {
+  return _hasEdge(adjacency, a, b) != _hasEdge(adjacency, b, a);
+}
+
+float renderer::SimplifyMesh(const uint32_t *indices, size_t indexCount,
+                             const void *vertices, size_t vertexStride,
+                             size_t positionOffset, size_t attributeOffset,
+                             size_t attributeCount,
+                             const float *attributeWeights, size_t vertexCount,
+                             size_t targetIndexCount, float targetError,
+                             std::vector<uint32_t> &out_indices) {
+  const size_t triangleCount = indexCount / 3;
+  out_indices.assign(indices, indices + triangleCount * 3);
+  for (const auto index : out_indices)
+    if ((size_t)index >= vertexCount)
+      throw std::invalid_argument("Index references a missing vertex.");
+  if (out_indices.size() <= targetIndexCount)
+    return 0.0f;
+
+  // Errors are measured relative to the extent of the mesh
+  const auto *bytes = (const uint8_t *)vertices;
+  std::vector<glm::vec3> positions(vertexCount);
+  glm::vec3 minimum(std::numeric_limits<float>::max());
+  glm::vec3 maximum(std::numeric_limits<float>::lowest());
+  for (size_t i = 0; i < vertexCount; i++) {
+    std::memcpy(&positions[i], bytes + i * vertexStride + positionOffset,
+                sizeof(glm::vec3));
+    minimum = glm::min(minimum, positions[i]);
+    maximum = glm::max(maximum, positions[i]);
+  }
+  const auto size = maximum - minimum;
+  float extent = std::max(size.x, std::max(size.y, size.z));
+  if (!(extent > 0.0f))
+    extent = 1.0f;
+
+  std::vector<float> attributes(vertexCount * attributeCount);
+  for (size_t i = 0; i < vertexCount; i++) {
+    positions[i] = (positions[i] - minimum) / extent;
+    std::memcpy(attributes.data() + i * attributeCount,
+                bytes + i * vertexStride + attributeOffset,
+                attributeCount * sizeof(float));
+  }
+  for (size_t i = 0; i < attributes.size(); i++)
+    attributes[i] *= attributeWeights[i % attributeCount];
+
+  // Vertices that only differ in their attributes share a position
+  std::vector<uint32_t> order(vertexCount);
+  std::iota(order.begin(), order.end(), 0u);
+  auto lessPosition = [&](uint32_t a, uint32_t b) {
+    const auto &pa = positions[a], &pb = positions[b];
+    if (pa.x != pb.x)
+      return pa.x < pb.x;
+    if (pa.y != pb.y)
+      return pa.y < pb.y;
+    return pa.z < pb.z;
+  };
+  std::sort(order.begin(), order.end(), lessPosition);
+  std::vector<uint32_t> remap(vertexCount), wedge(vertexCount);
+  for (size_t first = 0; first < vertexCount;) {
+    size_t last = first + 1;
+    const auto &position = positions[order[first]];
+    while (last < vertexCount && positions[order[last]] == position)
+      last++;
+    for (size_t i = first; i < last; i++) {
+      remap[order[i]] = order[first];
+      wedge[order[i]] = order[i + 1 < last ? i + 1 : first];
+    }
+    first = last;
+  }
+
+  // Classify by the open edges of the original mesh. Open edges that are
+  // closed when ignoring attributes belong to seams.
+  Adjacency adjacency;
+  _buildAdjacency(out_indices, vertexCount, adjacency);
+  std::vector<uint32_t> openIn(vertexCount, NO_EDGE);
+  std::vector<uint32_t> openOut(vertexCount, NO_EDGE);
+  for (uint32_t from = 0; from < vertexCount; from++) {
+    for (auto i = adjacency.offsets[from]; i < adjacency.offsets[from + 1];
+         i++) {
+      const auto to = adjacency.targets[i];
+      if (_hasEdge(adjacency, to, from))
+        continue;
+      openOut[from] = openOut[from] == NO_EDGE ? to : MANY_EDGES;
+      openIn[to] = openIn[to] == NO_EDGE ? from : MANY_EDGES;
+    }
+  }
+  auto isSingle = [](uint32_t edge) { return edge < MANY_EDGES; };
+  std::vector<VertexKind> kinds(vertexCount, VertexKind::eLocked);
+  for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+    const auto other = wedge[vertex];
+    if (other == vertex) {
+      if (openIn[vertex] == NO_EDGE && openOut[vertex] == NO_EDGE)
+        kinds[vertex] = VertexKind::eManifold;
+      else if (isSingle(openIn[vertex]) && isSingle(openOut[vertex]) &&
+               !_hasPositionEdge(adjacency, remap, wedge, openOut[vertex],
+                                 vertex) &&
+               !_hasPositionEdge(adjacency, remap, wedge, vertex,
+                                 openIn[vertex]))
+        kinds[vertex] = VertexKind::eBorder;
+    } else if (wedge[other] == vertex) {
+      // Both sides of the seam have to continue along the same positions
+      if (isSingle(openIn[vertex]) && isSingle(openOut[vertex]) &&
+          isSingle(openIn[other]) && isSingle(openOut[other]) &&
+          remap[openOut[vertex]] == remap[openIn[other]] &&
+          remap[openIn[vertex]] == remap[openOut[other]])
+        kinds[vertex] = VertexKind::eSeam;
+    }
+  }
+
+  // Accumulate the planes of the triangles and the borders per position
+  std::vector<Quadric> quadrics(vertexCount);
+  for (size_t i = 0; i < out_indices.size(); i += 3) {
+    const uint32_t triangle[3] = {out_indices[i], out_indices[i + 1],
+                                  out_indices[i + 2]};
+    const auto &p0 = positions[triangle[0]];
+    auto normal = glm::cross(positions[triangle[1]] - p0,
+                             positions[triangle[2]] - p0);
+    const auto area = glm::length(normal);
+    if (!(area > 0.0f))
+      continue;
+    normal = normal / area;
+    for (const auto vertex : triangle)
+      _addPlane(quadrics[remap[vertex]], normal, p0, 0.5 * area);
+
+    for (size_t k = 0; k < 3; k++) {
+      const auto a = triangle[k], b = triangle[(k + 1) % 3];
+      if (_hasEdge(adjacency, b, a))
+        continue;
+      const auto edge = positions[b] - positions[a];
+      const auto edgeLength = glm::length(edge);
+      if (!(edgeLength > 0.0f))
+        continue;
+      const auto borderNormal = glm::normalize(glm::cross(edge, normal));
+      const double weight = (double)edgeLength * edgeLength * BORDER_WEIGHT;
+      _addPlane(quadrics[remap[a]], borderNormal, positions[a], weight);
+      _addPlane(quadrics[remap[b]], borderNormal, positions[a], weight);
+    }
+  }
+
+  auto attributeError = [&](uint32_t a, uint32_t b) {
+    double error = 0.0;
+    for (size_t k = 0; k < attributeCount; k++) {
+      const double difference = (double)attributes[a * attributeCount + k] -
+                                attributes[b * attributeCount + k];
+      error += difference * difference;
+    }
+    return error;
+  };
+
+  // Finds the vertex the other wedge of a seam vertex collapses onto
+  auto findSeamTarget = [&](uint32_t from, uint32_t to) {
+    const auto other = wedge[from];
+    for (auto target = wedge[to]; target != to; target = wedge[target])
+      if (_isOpenEdge(adjacency, other, target))
+        return target;
+    return NO_EDGE;
+  };
+
+  auto evaluateCollapse = [&](uint32_t from, uint32_t to) {
+    constexpr double impossible = std::numeric_limits<double>::infinity();
+    const auto kind = kinds[from], targetKind = kinds[to];
+    if (remap[from] == remap[to] || kind == VertexKind::eLocked)
+      return impossible;
+    if (kind != VertexKind::eManifold &&
+        (!_isOpenEdge(adjacency, from, to) ||
+         (targetKind != kind && targetKind != VertexKind::eLocked)))
+      return impossible;
+
+    double cost = _evaluate(quadrics[remap[from]], positions[to]) +
+                  attributeError(from, to);
+    if (kind == VertexKind::eSeam) {
+      const auto seamTarget = findSeamTarget(from, to);
+      if (seamTarget == NO_EDGE)
+        return impossible;
+      cost += attributeError(wedge[from], seamTarget);
+    }
+    return cost;
+  };
+
+  const double errorLimit = (double)targetError * targetError;
+  double resultError = 0.0;
+  std::vector<Collapse> collapses{};
+  std::vector<uint32_t> collapseTarget(vertexCount);
+  std::vector<uint32_t> movedTo(vertexCount);
+  std::vector<uint8_t> touched(vertexCount);
+  std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+  std::vector<uint32_t> triangles{};
+  while (out_indices.size() > targetIndexCount) {
+    // Triangles around every position, used to detect flipped triangles
+    std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0u);
+    for (const auto index : out_indices)
+      triangleOffsets[remap[index] + 1]++;
+    for (size_t i = 0; i < vertexCount; i++)
+      triangleOffsets[i + 1] += triangleOffsets[i];
+    auto fill = triangleOffsets;
+    triangles.resize(out_indices.size());
+    for (size_t i = 0; i < out_indices.size(); i++)
+      triangles[fill[remap[out_indices[i]]]++] = (uint32_t)(i / 3);
+
+    // Every edge is considered in its cheaper direction
+    collapses.clear();
+    for (size_t i = 0; i < out_indices.size(); i += 3) {
+      for (size_t k = 0; k < 3; k++) {
+        const auto a = out_indices[i + k];
+        const auto b = out_indices[i + (k + 1) % 3];
+        const auto costAB = evaluateCollapse(a, b);
+        const auto costBA = evaluateCollapse(b, a);
+        if (std::min(costAB, costBA) <= errorLimit)
+          collapses.push_back(costAB <= costBA ? Collapse{a, b, costAB}
+                                               : Collapse{b, a, costBA});
+      }
+    }
+    if (collapses.empty())
+      break;
+    std::sort(collapses.begin(), collapses.end(),
+              [](const Collapse &a, const Collapse &b) {
+                return a.cost < b.cost;
+              });
+
+    // Collapse the cheapest edges whose end points did not move yet. Flips
+    // are checked against the collapses that are already pending.
+    std::iota(collapseTarget.begin(), collapseTarget.end(), 0u);
+    std::iota(movedTo.begin(), movedTo.end(), 0u);
+    std::fill(touched.begin(), touched.end(), (uint8_t)0);
+    const size_t removeGoal = (out_indices.size() - targetIndexCount) / 3;
+    size_t removed = 0, applied = 0;
+    for (const auto &collapse : collapses) {
+      if (removed >= removeGoal)
+        break;
+      const auto from = remap[collapse.from], to = remap[collapse.to];
+      if (touched[from] || touched[to])
+        continue;
+
+      bool flipped = false;
+      size_t degenerate = 0;
+      for (auto i = triangleOffsets[from]; i < triangleOffsets[from + 1]; i++) {
+        const auto *triangle = out_indices.data() + triangles[i] * 3;
+        uint32_t corners[3];
+        for (size_t k = 0; k < 3; k++)
+          corners[k] = movedTo[remap[triangle[k]]];
+        if (corners[0] == corners[1] || corners[1] == corners[2] ||
+            corners[0] == corners[2])
+          continue;
+        if (corners[0] == to || corners[1] == to || corners[2] == to) {
+          degenerate++;
+          continue;
+        }
+
+        glm::vec3 before[3], after[3];
+        for (size_t k = 0; k < 3; k++) {
+          before[k] = positions[corners[k]];
+          after[k] = corners[k] == from ? positions[to] : before[k];
+        }
+        const auto normalBefore =
+            glm::cross(before[1] - before[0], before[2] - before[0]);
+        const auto normalAfter =
+            glm::cross(after[1] - after[0], after[2] - after[0]);
+        if (glm::dot(normalBefore, normalAfter) <
+            0.25f * glm::length(normalBefore) * glm::length(normalAfter)) {
+          flipped = true;
+          break;
+        }
+      }
+      if (flipped)
+        continue;
+
+      collapseTarget[collapse.from] = collapse.to;
+      if (kinds[collapse.from] == VertexKind::eSeam)
+        collapseTarget[wedge[collapse.from]] =
+            findSeamTarget(collapse.from, collapse.to);
+      _addQuadric(quadrics[to], quadrics[from]);
+      touched[from] = touched[to] = 1;
+      movedTo[from] = to;
+      resultError = std::max(resultError, collapse.cost);
+      removed += degenerate;
+      applied++;
+    }
+    if (applied == 0)
+      break;
+
+    // Apply the collapses and drop the triangles that lost their area
+    size_t write = 0;
+    for (size_t i = 0; i < out_indices.size(); i += 3) {
+      const auto a = collapseTarget[out_indices[i]];
+      const auto b = collapseTarget[out_indices[i + 1]];
+      const auto c = collapseTarget[out_indices[i + 2]];
+      if (remap[a] == remap[b] || remap[b] == remap[c] || remap[a] == remap[c])
+        continue;
+      out_indices[write++] = a;
+      out_indices[write++] = b;
+      out_indices[write++] = c;
+    }
+    out_indices.resize(write);
+    _buildAdjacency(out_indices, vertexCount, adjacency);
+  }
+  return (float)std::sqrt(resultError);
+}
@@ -0,0 +1,57 @@
+/**
+ * @file simplifier.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declares the simplification of indexed triangle meshes.
+ * @date 2023-09-09
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __RENDERER_MESH_SIMPLIFIER_H__
+#define __RENDERER_MESH_SIMPLIFIER_H__
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace renderer {
+
+/**
+ * @brief Simplifies a triangle list by collapsing edges in order of their
+ * quadric error (Garland and Heckbert, "Surface Simplification Using Quadric
+ * Error Metrics"). Edges are collapsed onto one of their vertices, so the
+ * result references a subset of the original vertices and can share their
+ * vertex buffer. Attributes add to the cost of a collapse. Open borders and
+ * attribute seams are only collapsed along themselves, everything else that
+ * is not a manifold surface is kept.
+ *
+ * @param indices           Index data.
+ * @param indexCount        Amount of indices.
+ * @param vertices          Vertex data.
+ * @param vertexStride      Size of a vertex in bytes.
+ * @param positionOffset    Offset of the three float position in a vertex.
+ * @param attributeOffset   Offset of the float attributes in a vertex.
+ * @param attributeCount    Amount of consecutive float attributes.
+ * @param attributeWeights  Weight of every attribute. Attribute differences
+ *                          are compared to distances relative to the extent
+ *                          of the mesh.
+ * @param vertexCount       Amount of vertices.
+ * @param targetIndexCount  Stop once the result has this many indices.
+ * @param targetError       Largest allowed error relative to the extent of the
+ *                          mesh.
+ * @param out_indices       The simplified index data.
+ * @return float            The error of the result relative to the extent of
+ *                          the mesh.
+ */
+float SimplifyMesh(const uint32_t *indices, size_t indexCount,
+                   const void *vertices, size_t vertexStride,
+                   size_t positionOffset, size_t attributeOffset,
+                   size_t attributeCount, const float *attributeWeights,
+                   size_t vertexCount, size_t targetIndexCount,
+                   float targetError, std::vector<uint32_t> &out_indices);
+
+} // namespace renderer
+
+#endif /* __RENDERER_MESH_SIMPLIFIER_H__ */
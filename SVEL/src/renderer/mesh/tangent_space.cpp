@@ -0,0 +1,378 @@
+/**
+ * @file tangent_space.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implements the generation of normals and tangents.
+ * @date 2023-09-24
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "tangent_space.h"
+
+// Internal
+#include <util/simd.hpp>
+
+// STL
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+using namespace renderer;
+using util::Float4;
+
+namespace {
+
+/**
+ * @brief Fewest elements a thread works on. Smaller batches are not worth the
+ * thread.
+ */
+constexpr size_t MIN_BATCH_SIZE = 16384;
+
+/**
+ * @brief Lengths below this are treated as zero.
+ */
+constexpr float EPSILON = 1e-20f;
+
+/**
+ * @brief Three component vectors of four triangles, one per lane.
+ */
+struct Vec3x4 {
+  Float4 x = 0.0f, y = 0.0f, z = 0.0f;
+};
+
+/**
+ * @brief Lane wise vector arithmetic.
+ */
+Vec3x4 operator+(const Vec3x4 &a, const Vec3x4 &b) {
+  return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+Vec3x4 operator-(const Vec3x4 &a, const Vec3x4 &b) {
+  return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+Vec3x4 operator*(const Vec3x4 &a, Float4 b) {
+  return {a.x * b, a.y * b, a.z * b};
+}
+
+Float4 _dot(const Vec3x4 &a, const Vec3x4 &b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+Vec3x4 _cross(const Vec3x4 &a, const Vec3x4 &b) {
+  return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+          a.x * b.y - a.y * b.x};
+}
+
+/**
+ * @brief Normalizes the vectors, zero vectors stay zero.
+ *
+ * @param a       The vectors.
+ * @return Vec3x4 The unit vectors.
+ */
+Vec3x4 _normalize(const Vec3x4 &a) {
+  return a * (1.0f / Max(Sqrt(_dot(a, a)), EPSILON));
+}
+
+/**
+ * @brief Gathers an attribute of four vertices.
+ *
+ * @tparam Components   Amount of float components, 2 or 3. Missing
+ *                      components are 0.
+ * @param vertices      Vertex data.
+ * @param vertexStride  Size of a vertex in bytes.
+ * @param offset        Offset of the attribute in a vertex.
+ * @param indices       The four vertices.
+ * @return Vec3x4       The attributes.
+ */
+template <size_t Components>
+Vec3x4 _gather(const uint8_t *vertices, size_t vertexStride, size_t offset,
+               const uint32_t *indices) {
+  float values[3][4] = {};
+  for (size_t lane = 0; lane < 4; lane++) {
+    float attribute[3] = {};
+    std::memcpy(attribute, vertices + indices[lane] * vertexStride + offset,
+                Components * sizeof(float));
+    for (size_t c = 0; c < 3; c++)
+      values[c][lane] = attribute[c];
+  }
+  return {Float4::Load(values[0]), Float4::Load(values[1]),
+          Float4::Load(values[2])};
+}
+
+/**
+ * @brief Stores a vector per lane to four floats each.
+ *
+ * @param value     The vectors.
+ * @param lanes     Amount of lanes to store.
+ * @param out       Receives the vectors.
+ * @param outStride Distance between the vectors in floats.
+ */
+void _scatter(const Vec3x4 &value, size_t lanes, float *out,
+              size_t outStride) {
+  float values[3][4];
+  value.x.Store(values[0]);
+  value.y.Store(values[1]);
+  value.z.Store(values[2]);
+  for (size_t lane = 0; lane < lanes; lane++)
+    for (size_t c = 0; c < 3; c++)
+      out[lane * outStride + c] = values[c][lane];
+}
+
+/**
+ * @brief Computes the angles at the three corners of four triangles.
+ *
+ * @param p     Corner positions.
+ * @param lanes Amount of triangles to store.
+ * @param out   Receives the angles in radians, three per triangle.
+ */
+void _storeCornerAngles(const Vec3x4 p[3], size_t lanes, float *out) {
+  const Vec3x4 e01 = p[1] - p[0], e02 = p[2] - p[0], e12 = p[2] - p[1];
+  const Float4 l01 = Sqrt(_dot(e01, e01));
+  const Float4 l02 = Sqrt(_dot(e02, e02));
+  const Float4 l12 = Sqrt(_dot(e12, e12));
+  const Float4 a0 = util::Acos(_dot(e01, e02) / Max(l01 * l02, EPSILON));
+  const Float4 a1 =
+      util::Acos((0.0f - _dot(e01, e12)) / Max(l01 * l12, EPSILON));
+  const Float4 a2 = Max(3.14159265f - a0 - a1, 0.0f);
+
+  float angles[3][4];
+  a0.Store(angles[0]);
+  a1.Store(angles[1]);
+  a2.Store(angles[2]);
+  for (size_t lane = 0; lane < lanes; lane++)
+    for (size_t k = 0; k < 3; k++)
+      out[lane * 3 + k] = angles[k][lane];
+}
+
+/**
+ * @brief Runs the body over batches of a range, in parallel if the range is
+ * large enough.
+ *
+ * @tparam F          Type of the body.
+ * @param count       Size of the range.
+ * @param threadCount Amount of threads, 0 uses every core.
+ * @param body        Called with the start and end of every batch.
+ */
+template <typename F>
+void _parallelFor(size_t count, unsigned int threadCount, const F &body) {
+  if (threadCount == 0)
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  const size_t batchCount = std::max<size_t>(
+      1, std::min<size_t>(threadCount, count / MIN_BATCH_SIZE));
+
+  // The calling thread takes the first batch
+  std::vector<std::future<void>> workers{};
+  for (size_t i = 1; i < batchCount; i++)
+    workers.push_back(std::async(std::launch::async, body,
+                                 count * i / batchCount,
+                                 count * (i + 1) / batchCount));
+  body(0, count / batchCount);
+  for (auto &worker : workers)
+    worker.get();
+}
+
+/**
+ * @brief Corners of the triangles, grouped by vertex.
+ */
+struct Adjacency {
+  /**
+   * @brief Corners of vertex v are corners[offsets[v]] until
+   * corners[offsets[v + 1]].
+   */
+  std::vector<uint32_t> offsets;
+
+  /**
+   * @brief Indices into the index data.
+   */
+  std::vector<uint32_t> corners;
+};
+
+/**
+ * @brief Groups the corners by vertex with a counting sort, so that vertices
+ * can gather their contributions without synchronization.
+ *
+ * @param indices     Index data.
+ * @param indexCount  Amount of indices.
+ * @param vertexCount Amount of vertices.
+ * @return Adjacency  The corners of every vertex.
+ */
+Adjacency _buildAdjacency(const uint32_t *indices, size_t indexCount,
+                          size_t vertexCount) {
+  if (indexCount % 3 != 0)
+    throw std::invalid_argument("Only triangle lists are supported.");
+  if (indexCount > UINT32_MAX)
+    throw std::invalid_argument("Too many indices.");
+
+  Adjacency adjacency{};
+  adjacency.offsets.assign(vertexCount + 1, 0);
+  for (size_t i = 0; i < indexCount; i++) {
+    if (indices[i] >= vertexCount)
+      throw std::invalid_argument("Index references missing vertex.");
+    adjacency.offsets[indices[i] + 1]++;
+  }
+  for (size_t v = 0; v < vertexCount; v++)
+    adjacency.offsets[v + 1] += adjacency.offsets[v];
+
+  adjacency.corners.resize(indexCount);
+  std::vector<uint32_t> fill(adjacency.offsets.begin(),
+                             adjacency.offsets.end() - 1);
+  for (size_t i = 0; i < indexCount; i++)
+    adjacency.corners[fill[indices[i]]++] = (uint32_t)i;
+  return adjacency;
+}
+
+/**
+ * @brief Finds the indices of four triangles. The last batch repeats its final
+ * triangle in the unused lanes.
+ *
+ * @param indices       Index data.
+ * @param triangle      First triangle of the batch.
+ * @param end           End of the triangles.
+ * @param out_corners   Receives the indices of every corner per lane.
+ * @return size_t       Amount of valid lanes.
+ */
+size_t _loadTriangles(const uint32_t *indices, size_t triangle, size_t end,
+                      uint32_t out_corners[3][4]) {
+  const size_t lanes = std::min<size_t>(4, end - triangle);
+  for (size_t lane = 0; lane < 4; lane++)
+    for (size_t k = 0; k < 3; k++)
+      out_corners[k][lane] =
+          indices[(triangle + std::min(lane, lanes - 1)) * 3 + k];
+  return lanes;
+}
+
+} // namespace
+
+void renderer::GenerateNormals(const uint32_t *indices, size_t indexCount,
+                               const void *vertices, size_t vertexStride,
+                               size_t positionOffset, size_t vertexCount,
+                               bool angleWeighted,
+                               std::vector<glm::vec3> &out_normals,
+                               unsigned int threadCount) {
+  const auto adjacency = _buildAdjacency(indices, indexCount, vertexCount);
+  const auto *data = (const uint8_t *)vertices;
+
+  // Normal of every triangle padded to four floats and the angle at every
+  // corner. The length of the cross product is twice the area.
+  std::vector<float> normals(indexCount / 3 * 4);
+  std::vector<float> angles(angleWeighted ? indexCount : 0);
+  _parallelFor(indexCount / 3, threadCount, [&](size_t begin, size_t end) {
+    for (size_t triangle = begin; triangle < end; triangle += 4) {
+      uint32_t corners[3][4];
+      const size_t lanes = _loadTriangles(indices, triangle, end, corners);
+      Vec3x4 p[3];
+      for (size_t k = 0; k < 3; k++)
+        p[k] = _gather<3>(data, vertexStride, positionOffset, corners[k]);
+
+      Vec3x4 normal = _cross(p[1] - p[0], p[2] - p[0]);
+      if (angleWeighted) {
+        normal = _normalize(normal);
+        _storeCornerAngles(p, lanes, &angles[triangle * 3]);
+      }
+      _scatter(normal, lanes, &normals[triangle * 4], 4);
+    }
+  });
+
+  // Every vertex sums up its corners
+  out_normals.assign(vertexCount, glm::vec3{0.0f, 0.0f, 0.0f});
+  _parallelFor(vertexCount, threadCount, [&](size_t begin, size_t end) {
+    for (size_t v = begin; v < end; v++) {
+      Float4 sum = 0.0f;
+      for (uint32_t i = adjacency.offsets[v]; i < adjacency.offsets[v + 1];
+           i++) {
+        const uint32_t corner = adjacency.corners[i];
+        const Float4 normal = Float4::Load(&normals[corner / 3 * 4]);
+        sum = sum + (angleWeighted ? normal * angles[corner] : normal);
+      }
+
+      float normal[4];
+      sum.Store(normal);
+      const glm::vec3 direction(normal[0], normal[1], normal[2]);
+      const float length = glm::length(direction);
+      if (length > EPSILON)
+        out_normals[v] = direction / length;
+    }
+  });
+}
+
+void renderer::GenerateTangents(const uint32_t *indices, size_t indexCount,
+                                void *vertices, size_t vertexStride,
+                                size_t positionOffset, size_t texCoordOffset,
+                                size_t normalOffset, size_t tangentOffset,
+                                size_t vertexCount, unsigned int threadCount) {
+  const auto adjacency = _buildAdjacency(indices, indexCount, vertexCount);
+  auto *data = (uint8_t *)vertices;
+
+  // Tangent and bitangent of every triangle, four floats each, and the angle
+  // at every corner
+  std::vector<float> frames(indexCount / 3 * 8);
+  std::vector<float> angles(indexCount);
+  _parallelFor(indexCount / 3, threadCount, [&](size_t begin, size_t end) {
+    for (size_t triangle = begin; triangle < end; triangle += 4) {
+      uint32_t corners[3][4];
+      const size_t lanes = _loadTriangles(indices, triangle, end, corners);
+      Vec3x4 p[3], uv[3];
+      for (size_t k = 0; k < 3; k++) {
+        p[k] = _gather<3>(data, vertexStride, positionOffset, corners[k]);
+        uv[k] = _gather<2>(data, vertexStride, texCoordOffset, corners[k]);
+      }
+
+      // Only the orientation of the texture space matters, its scale is
+      // removed by the normalization at the vertices
+      const Vec3x4 e1 = p[1] - p[0], e2 = p[2] - p[0];
+      const Vec3x4 d1 = uv[1] - uv[0], d2 = uv[2] - uv[0];
+      const Float4 determinant = d1.x * d2.y - d2.x * d1.y;
+      const Float4 sign = determinant / Max(Abs(determinant), EPSILON);
+      _scatter((e1 * d2.y - e2 * d1.y) * sign, lanes, &frames[triangle * 8],
+               8);
+      _scatter((e2 * d1.x - e1 * d2.x) * sign, lanes,
+               &frames[triangle * 8 + 4], 8);
+      _storeCornerAngles(p, lanes, &angles[triangle * 3]);
+    }
+  });
+
+  // Every vertex projects the frames of its corners onto its tangent plane
+  _parallelFor(vertexCount, threadCount, [&](size_t begin, size_t end) {
+    for (size_t v = begin; v < end; v++) {
+      glm::vec3 normal;
+      auto *vertex = data + v * vertexStride;
+      std::memcpy(&normal, vertex + normalOffset, sizeof(normal));
+      auto project = [&normal](const float *direction, float weight) {
+        glm::vec3 projected(direction[0], direction[1], direction[2]);
+        projected -= normal * glm::dot(normal, projected);
+        const float length = glm::length(projected);
+        return length > EPSILON ? projected * (weight / length)
+                                : glm::vec3{0.0f, 0.0f, 0.0f};
+      };
+
+      glm::vec3 tangent{0.0f, 0.0f, 0.0f}, bitangent{0.0f, 0.0f, 0.0f};
+      for (uint32_t i = adjacency.offsets[v]; i < adjacency.offsets[v + 1];
+           i++) {
+        const uint32_t corner = adjacency.corners[i];
+        const float *frame = &frames[corner / 3 * 8];
+        tangent += project(frame, angles[corner]);
+        bitangent += project(frame + 4, angles[corner]);
+      }
+
+      // Fall back to any direction in the tangent plane
+      tangent -= normal * glm::dot(normal, tangent);
+      if (glm::length(tangent) <= EPSILON) {
+        const glm::vec3 axis = std::fabs(normal.x) < 0.9f
+                                   ? glm::vec3{1.0f, 0.0f, 0.0f}
+                                   : glm::vec3{0.0f, 1.0f, 0.0f};
+        tangent = axis - normal * glm::dot(normal, axis);
+      }
+      tangent = glm::normalize(tangent);
+      const float handedness =
+          glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? -1.0f
+                                                                  : 1.0f;
+      const glm::vec4 result(tangent, handedness);
+      std::memcpy(vertex + tangentOffset, &result, sizeof(result));
+    }
+  });
+}
@@ -0,0 +1,76 @@
+/**
+ * @file tangent_space.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declares the generation of normals and tangents for triangle meshes.
+ * @date 2023-09-24
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __RENDERER_MESH_TANGENT_SPACE_H__
+#define __RENDERER_MESH_TANGENT_SPACE_H__
+
+// GLM
+#include <glm/glm.hpp>
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace renderer {
+
+/**
+ * @brief Generates smooth vertex normals for a triangle list. Every triangle
+ * adds its normal to its three vertices, either weighted by its area or by the
+ * angle at the vertex. Triangles are processed four at a time with SIMD and
+ * split over several threads.
+ *
+ * @param indices         Index data.
+ * @param indexCount      Amount of indices.
+ * @param vertices        Vertex data.
+ * @param vertexStride    Size of a vertex in bytes.
+ * @param positionOffset  Offset of the three float position in a vertex.
+ * @param vertexCount     Amount of vertices.
+ * @param angleWeighted   Weight by the corner angle instead of the area.
+ * @param out_normals     Receives a unit normal per vertex. Vertices without
+ *                        triangles of any area get a zero normal.
+ * @param threadCount     Amount of threads to use, 0 uses every core.
+ */
+void GenerateNormals(const uint32_t *indices, size_t indexCount,
+                     const void *vertices, size_t vertexStride,
+                     size_t positionOffset, size_t vertexCount,
+                     bool angleWeighted, std::vector<glm::vec3> &out_normals,
+                     unsigned int threadCount = 0);
+
+/**
+ * @brief Generates per vertex tangents for a triangle list following the
+ * MikkTSpace conventions. Triangle tangents are derived from the texture
+ * coordinates, projected onto the tangent plane of every vertex and
+ * accumulated weighted by the corner angle. The w component holds the
+ * handedness of the bitangent, so that bitangent = cross(normal, tangent) * w.
+ * Vertices are not split at mirrored texture coordinates, such vertices take
+ * the majority handedness. Vertices without usable texture coordinates get an
+ * arbitrary tangent orthogonal to their normal.
+ *
+ * @param indices         Index data.
+ * @param indexCount      Amount of indices.
+ * @param vertices        Vertex data. Receives the tangents.
+ * @param vertexStride    Size of a vertex in bytes.
+ * @param positionOffset  Offset of the three float position in a vertex.
+ * @param texCoordOffset  Offset of the two float texture coordinate.
+ * @param normalOffset    Offset of the three float unit normal.
+ * @param tangentOffset   Offset of the four float tangent that is written.
+ * @param vertexCount     Amount of vertices.
+ * @param threadCount     Amount of threads to use, 0 uses every core.
+ */
+void GenerateTangents(const uint32_t *indices, size_t indexCount,
+                      void *vertices, size_t vertexStride,
+                      size_t positionOffset, size_t texCoordOffset,
+                      size_t normalOffset, size_t tangentOffset,
+                      size_t vertexCount, unsigned int threadCount = 0);
+
+} // namespace renderer
+
+#endif /* __RENDERER_MESH_TANGENT_SPACE_H__ */
@@ -10,6 +10,7 @@
 
 // Local
 #include "pipeline.h"
+#include "vertex_format.h"
 
 // Vulkan
 #include <vulkan/vulkan_enums.hpp>
@@ -22,36 +23,6 @@
 using namespace renderer;
 using namespace SVEL_NAMESPACE;
 
-vk::Format VulkanPipeline::_getAttributeFormat(AttributeType _type,
-                                               unsigned int _count) {
-  // Translate attribute type to vk format
-  switch (_type) {
-  case AttributeType::SIGNED_FLOAT:
-    switch (_count) {
-    case 1:
-      return vk::Format::eR32Sfloat;
-    case 2:
-      return vk::Format::eR32G32Sfloat;
-    case 3:
-      return vk::Format::eR32G32B32Sfloat;
-    case 4:
-      return vk::Format::eR32G32B32A32Sfloat;
-    }
-    break;
-  }
-  return vk::Format::eUndefined;
-}
-
-size_t VulkanPipeline::_getAttributeSize(AttributeType _type,
-                                         unsigned int _count) {
-  // Calculate size of the attribute type
-  switch (_type) {
-  case AttributeType::SIGNED_FLOAT:
-    return sizeof(float) * _count;
-  }
-  return 0;
-}
-
 void VulkanPipeline::_buildVertexInputStateInfo(
     const VertexDescription &_vertexDescription) {
   // Check for the vertex description
@@ -64,18 +35,24 @@ void VulkanPipeline::_buildVertexInputStateInfo(
   // Create vertex attribute description
   _vertexInputSize = 0;
   unsigned int index = 0;
+  const auto &physicalDevice = _device->GetPhysicalDevice();
   for (auto description : _vertexDescription) {
     vk::Format format =
-        _getAttributeFormat(description.first, description.second);
+        GetAttributeFormat(description.first, description.second);
     if (format == vk::Format::eUndefined)
       throw std::runtime_error("Invalid Vertex Description.");
 
+    // Packed formats with three components are optional
+    if (!(physicalDevice.getFormatProperties(format).bufferFeatures &
+          vk::FormatFeatureFlagBits::eVertexBuffer))
+      throw std::runtime_error("Vertex format not supported by the device.");
+
     _vertexInputAttributeDescriptions.push_back(
         vk::VertexInputAttributeDescription(index, 0, format,
                                             _vertexInputSize));
     index++;
     _vertexInputSize +=
-        _getAttributeSize(description.first, description.second);
+        GetAttributeSize(description.first, description.second);
   }
 
   // Create info and description
@@ -111,10 +88,11 @@ VulkanPipeline::_findSupportedFormat(const std::vector<vk::Format> &formats,
 }
 
 void VulkanPipeline::_createFramebuffers(const sv::Extent &extent) {
-
-  _depthBuffer = std::make_shared<core::Image>(
-      _device, vk::Extent2D{extent.width, extent.height}, _depthFormat,
-      vk::ImageUsageFlagBits::eDepthStencilAttachment,
+  // Depth is cleared on load and never stored, so it can be transient
+  _depthBuffer = _renderTargets->Acquire(
+      vk::Extent2D{extent.width, extent.height}, _depthFormat,
+      vk::ImageUsageFlagBits::eDepthStencilAttachment |
+          vk::ImageUsageFlagBits::eTransientAttachment,
       vk::ImageAspectFlagBits::eDepth);
 
   // Create Framebuffers
@@ -139,6 +117,9 @@ void VulkanPipeline::_destroyFramebuffers() {
   for (auto framebuffer : _framebuffers)
     vulkanDevice.destroyFramebuffer(framebuffer);
   _framebuffers.clear();
+
+  // The last pipeline to let go releases the depth buffer
+  _depthBuffer = nullptr;
 }
 
 void VulkanPipeline::_handleSwapchainRecreation(core::Swapchain::Event,
@@ -152,10 +133,11 @@ void VulkanPipeline::_handleSwapchainRecreation(core::Swapchain::Event,
 VulkanPipeline::VulkanPipeline(core::SharedDevice device,
                                core::SharedSurface surface,
                                core::SharedSwapchain swapchain,
+                               SharedRenderTargetPool renderTargets,
                                core::SharedShader vert, core::SharedShader frag,
                                const VertexDescription &vertexDescription)
-    : _device(device), _surface(surface), _swapchain(swapchain), _vert(vert),
-      _frag(frag) {
+    : _device(device), _surface(surface), _swapchain(swapchain),
+      _renderTargets(renderTargets), _vert(vert), _frag(frag) {
   // Setup vertex input state
   _buildVertexInputStateInfo(vertexDescription);
 
@@ -280,13 +262,15 @@ VulkanPipeline::VulkanPipeline(core::SharedDevice device,
       nullptr, // TODO: Later
       1, &colorReference, nullptr, &depthAttachmentRef, 0, nullptr);
 
+  // The depth buffer is shared, so earlier render passes may still write it
   vk::SubpassDependency subpassDependency(
       VK_SUBPASS_EXTERNAL, 0,
       vk::PipelineStageFlagBits::eColorAttachmentOutput |
-          vk::PipelineStageFlagBits::eEarlyFragmentTests,
+          vk::PipelineStageFlagBits::eEarlyFragmentTests |
+          vk::PipelineStageFlagBits::eLateFragmentTests,
       vk::PipelineStageFlagBits::eColorAttachmentOutput |
           vk::PipelineStageFlagBits::eEarlyFragmentTests,
-      vk::AccessFlagBits(),
+      vk::AccessFlagBits::eDepthStencilAttachmentWrite,
       vk::AccessFlagBits::eColorAttachmentRead |
           vk::AccessFlagBits::eColorAttachmentWrite |
           vk::AccessFlagBits::eDepthStencilAttachmentWrite,
@@ -19,6 +19,7 @@
 #include <core/shader.h>
 #include <core/surface.h>
 #include <core/swapchain.h>
+#include <renderer/render_target_pool.h>
 #include <svel/detail/pipeline.h>
 #include <util/downcast_impl.hpp>
 #include <util/vulkan_object.hpp>
@@ -52,6 +53,11 @@ private:
    */
   core::SharedSwapchain _swapchain;
 
+  /**
+   * @brief Provides the depth buffer, shared with other pipelines.
+   */
+  SharedRenderTargetPool _renderTargets;
+
   /**
    * @brief Subscription handle for the swapchain recreation notification.
    */
@@ -106,7 +112,8 @@ private:
   std::shared_ptr<core::descriptor::SetGroup> _setGroup;
 
   /**
-   * @brief The depth buffer image for depth buffering.
+   * @brief The depth buffer image for depth buffering. Its contents are only
+   * used within a render pass, so pipelines of the same extent share it.
    */
   core::SharedImage _depthBuffer;
 
@@ -120,26 +127,6 @@ private:
    */
   vk::Format _depthFormat;
 
-  /**
-   * @brief Returns the vk::Format corresponding to the Attribute Type.
-   *
-   * @param type        The attribute type.
-   * @param count       How many attributes.
-   * @return vk::Format The corresponding format.
-   */
-  vk::Format _getAttributeFormat(SVEL_NAMESPACE::AttributeType type,
-                                 unsigned int count);
-
-  /**
-   * @brief Returns the size of the Attribute.
-   *
-   * @param type    Type of the attribute.
-   * @param count   How many attributes.
-   * @return size_t Size of the composite attribute.
-   */
-  size_t _getAttributeSize(SVEL_NAMESPACE::AttributeType type,
-                           unsigned int count);
-
   /**
    * @brief Build the Vertex Input State Info from a given vertex description.
    *
@@ -189,12 +176,14 @@ public:
    * @param device            Device to use.
    * @param surface           Surface to use.
    * @param swapchain         Swapchain to use.
+   * @param renderTargets     Pool that provides the depth buffer.
    * @param vert              Vertex Shader to use.
    * @param frag              Fragment Shader to use.
    * @param vertexDescription Description of Vertex handled by vertex shader.
    */
   VulkanPipeline(core::SharedDevice device, core::SharedSurface surface,
-                 core::SharedSwapchain swapchain, core::SharedShader vert,
+                 core::SharedSwapchain swapchain,
+                 SharedRenderTargetPool renderTargets, core::SharedShader vert,
                  core::SharedShader frag,
                  const SVEL_NAMESPACE::VertexDescription &vertexDescription);
 
@@ -255,9 +244,12 @@ public:
   /**
    * @brief Getter for the descriptor set group of this pipeline.
    *
-   * @return core::descriptor::SharedSetGroup The set group of this pipeline.
+   * @return const core::descriptor::SharedSetGroup& The set group of this
+   *                                                 pipeline.
    */
-  core::descriptor::SharedSetGroup GetDescriptorGroup() { return _setGroup; }
+  const core::descriptor::SharedSetGroup &GetDescriptorGroup() {
+    return _setGroup;
+  }
 
   /**
    * @brief Notifies the pipeline that a new frame has started. TODO: Do this
@@ -0,0 +1,136 @@
+/**
+ * @file vertex_format.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implements helpers to translate and pack vertex attributes.
+ * @date 2023-09-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "vertex_format.h"
+
+// GLM
+#include <glm/gtc/packing.hpp>
+
+// STL
+#include <cstring>
+
+using namespace SVEL_NAMESPACE;
+
+vk::Format renderer::GetAttributeFormat(AttributeType type,
+                                        unsigned int count) {
+  // Translate attribute type to vk format
+  auto select = [count](vk::Format one, vk::Format two, vk::Format three,
+                        vk::Format four) {
+    switch (count) {
+    case 1:
+      return one;
+    case 2:
+      return two;
+    case 3:
+      return three;
+    case 4:
+      return four;
+    }
+    return vk::Format::eUndefined;
+  };
+
+  switch (type) {
+  case AttributeType::SIGNED_FLOAT:
+    return select(vk::Format::eR32Sfloat, vk::Format::eR32G32Sfloat,
+                  vk::Format::eR32G32B32Sfloat,
+                  vk::Format::eR32G32B32A32Sfloat);
+  case AttributeType::HALF_FLOAT:
+    return select(vk::Format::eR16Sfloat, vk::Format::eR16G16Sfloat,
+                  vk::Format::eR16G16B16Sfloat,
+                  vk::Format::eR16G16B16A16Sfloat);
+  case AttributeType::SIGNED_NORM_8:
+    return select(vk::Format::eR8Snorm, vk::Format::eR8G8Snorm,
+                  vk::Format::eR8G8B8Snorm, vk::Format::eR8G8B8A8Snorm);
+  case AttributeType::SIGNED_NORM_16:
+    return select(vk::Format::eR16Snorm, vk::Format::eR16G16Snorm,
+                  vk::Format::eR16G16B16Snorm,
+                  vk::Format::eR16G16B16A16Snorm);
+  case AttributeType::UNSIGNED_NORM_8:
+    return select(vk::Format::eR8Unorm, vk::Format::eR8G8Unorm,
+                  vk::Format::eR8G8B8Unorm, vk::Format::eR8G8B8A8Unorm);
+  case AttributeType::UNSIGNED_NORM_16:
+    return select(vk::Format::eR16Unorm, vk::Format::eR16G16Unorm,
+                  vk::Format::eR16G16B16Unorm,
+                  vk::Format::eR16G16B16A16Unorm);
+  case AttributeType::SIGNED_NORM_10_10_10_2:
+    return count == 4 ? vk::Format::eA2B10G10R10SnormPack32
+                      : vk::Format::eUndefined;
+  case AttributeType::UNSIGNED_NORM_10_10_10_2:
+    return count == 4 ? vk::Format::eA2B10G10R10UnormPack32
+                      : vk::Format::eUndefined;
+  }
+  return vk::Format::eUndefined;
+}
+
+size_t renderer::GetAttributeSize(AttributeType type, unsigned int count) {
+  // Calculate size of the attribute type
+  if (GetAttributeFormat(type, count) == vk::Format::eUndefined)
+    return 0;
+
+  switch (type) {
+  case AttributeType::SIGNED_FLOAT:
+    return sizeof(float) * count;
+  case AttributeType::HALF_FLOAT:
+  case AttributeType::SIGNED_NORM_16:
+  case AttributeType::UNSIGNED_NORM_16:
+    return sizeof(uint16_t) * count;
+  case AttributeType::SIGNED_NORM_8:
+  case AttributeType::UNSIGNED_NORM_8:
+    return sizeof(uint8_t) * count;
+  case AttributeType::SIGNED_NORM_10_10_10_2:
+  case AttributeType::UNSIGNED_NORM_10_10_10_2:
+    return sizeof(uint32_t);
+  }
+  return 0;
+}
+
+void renderer::PackAttribute(AttributeType type, unsigned int count,
+                             const glm::vec4 &value, uint8_t *out) {
+  // Components are written one by one, the destination may be unaligned
+  auto write = [&out](auto component) {
+    std::memcpy(out, &component, sizeof(component));
+    out += sizeof(component);
+  };
+
+  const auto components = (glm::length_t)count;
+  switch (type) {
+  case AttributeType::SIGNED_FLOAT:
+    for (glm::length_t i = 0; i < components; i++)
+      write(value[i]);
+    break;
+  case AttributeType::HALF_FLOAT:
+    for (glm::length_t i = 0; i < components; i++)
+      write(glm::packHalf1x16(value[i]));
+    break;
+  case AttributeType::SIGNED_NORM_8:
+    for (glm::length_t i = 0; i < components; i++)
+      write(glm::packSnorm1x8(value[i]));
+    break;
+  case AttributeType::SIGNED_NORM_16:
+    for (glm::length_t i = 0; i < components; i++)
+      write(glm::packSnorm1x16(value[i]));
+    break;
+  case AttributeType::UNSIGNED_NORM_8:
+    for (glm::length_t i = 0; i < components; i++)
+      write(glm::packUnorm1x8(value[i]));
+    break;
+  case AttributeType::UNSIGNED_NORM_16:
+    for (glm::length_t i = 0; i < components; i++)
+      write(glm::packUnorm1x16(value[i]));
+    break;
+  case AttributeType::SIGNED_NORM_10_10_10_2:
+    write(glm::packSnorm3x10_1x2(value));
+    break;
+  case AttributeType::UNSIGNED_NORM_10_10_10_2:
+    write(glm::packUnorm3x10_1x2(value));
+    break;
+  }
+}
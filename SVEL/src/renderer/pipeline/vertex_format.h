@@ -0,0 +1,66 @@
+/**
+ * @file vertex_format.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declares helpers to translate and pack vertex attributes.
+ * @date 2023-09-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __RENDERER_PIPELINE_VERTEX_FORMAT_H__
+#define __RENDERER_PIPELINE_VERTEX_FORMAT_H__
+
+// Internal
+#include <svel/detail/pipeline.h>
+
+// Vulkan
+#include <vulkan/vulkan.hpp>
+
+// GLM
+#include <glm/glm.hpp>
+
+// STL
+#include <cstddef>
+#include <cstdint>
+
+namespace renderer {
+
+/**
+ * @brief Returns the vk::Format corresponding to the Attribute Type.
+ *
+ * @param type        The attribute type.
+ * @param count       How many components.
+ * @return vk::Format The corresponding format. eUndefined if the combination
+ *                    is invalid.
+ */
+vk::Format GetAttributeFormat(SVEL_NAMESPACE::AttributeType type,
+                              unsigned int count);
+
+/**
+ * @brief Returns the size of the Attribute.
+ *
+ * @param type    Type of the attribute.
+ * @param count   How many components.
+ * @return size_t Size of the composite attribute in bytes. 0 if the
+ *                combination is invalid.
+ */
+size_t GetAttributeSize(SVEL_NAMESPACE::AttributeType type,
+                        unsigned int count);
+
+/**
+ * @brief Converts the first count components of the value to the attribute
+ * type. Normalized types clamp the value to their range.
+ *
+ * @param type  Type of the attribute.
+ * @param count How many components.
+ * @param value Value to convert.
+ * @param out   Destination, needs GetAttributeSize bytes. Does not have to be
+ *              aligned.
+ */
+void PackAttribute(SVEL_NAMESPACE::AttributeType type, unsigned int count,
+                   const glm::vec4 &value, uint8_t *out);
+
+} // namespace renderer
+
+#endif /* __RENDERER_PIPELINE_VERTEX_FORMAT_H__ */
@@ -0,0 +1,55 @@
+/**
+ * @file render_target_pool.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Implementation of the RenderTargetPool.
+ * @date 2023-10-04
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "render_target_pool.h"
+
+using namespace renderer;
+
+RenderTargetPool::RenderTargetPool(core::SharedDevice device)
+    : _device(device) {}
+
+core::SharedImage RenderTargetPool::Acquire(vk::Extent2D extent,
+                                            vk::Format format,
+                                            vk::ImageUsageFlags usage,
+                                            vk::ImageAspectFlags aspect) {
+  const Key key{extent.width, extent.height, (VkFormat)format,
+                (VkImageUsageFlags)usage, (VkImageAspectFlags)aspect};
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto &target = _targets[key];
+  if (auto image = target.lock())
+    return image;
+
+  // Attachments that are never stored need no backing on tiled devices
+  vk::MemoryPropertyFlags preferred = vk::MemoryPropertyFlagBits::eDeviceLocal;
+  if (usage & vk::ImageUsageFlagBits::eTransientAttachment)
+    preferred |= vk::MemoryPropertyFlagBits::eLazilyAllocated;
+  auto image = std::make_shared<core::Image>(_device, extent, format, usage,
+                                             aspect, preferred);
+  target = image;
+
+  // Attachments of a previous extent are released by now
+  for (auto it = _targets.begin(); it != _targets.end();) {
+    if (it->second.expired())
+      it = _targets.erase(it);
+    else
+      it++;
+  }
+  return image;
+}
+
+size_t RenderTargetPool::GetTargetCount() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  size_t count = 0;
+  for (const auto &target : _targets)
+    if (!target.second.expired())
+      count++;
+  return count;
+}
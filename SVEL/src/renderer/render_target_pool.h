@@ -0,0 +1,94 @@
+/**
+ * @file render_target_pool.h
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Declares the pool of attachments that pipelines share.
+ * @date 2023-10-04
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __RENDERER_RENDER_TARGET_POOL_H__
+#define __RENDERER_RENDER_TARGET_POOL_H__
+
+// Internal
+#include <core/device.h>
+#include <core/memory/image.h>
+
+// Vulkan
+#include <vulkan/vulkan.hpp>
+
+// STL
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace renderer {
+
+/**
+ * @brief Hands out depth and color attachments, keyed by their extent, format,
+ * usage and aspect. Pipelines that ask for the same kind of attachment share a
+ * single image, which is only valid as long as their render passes do not
+ * keep its contents, e.g. a depth buffer that is cleared on load. Attachments
+ * with transient usage are placed in lazily allocated memory where the device
+ * offers it. The pool does not keep attachments alive, an image is released
+ * once the last pipeline drops it. Thread safe.
+ */
+class RenderTargetPool {
+private:
+  /**
+   * @brief Identifies attachments that may be shared.
+   */
+  using Key = std::tuple<uint32_t, uint32_t, VkFormat, VkImageUsageFlags,
+                         VkImageAspectFlags>;
+
+  /**
+   * @brief Device to use.
+   */
+  core::SharedDevice _device;
+
+  /**
+   * @brief The attachments that are in use.
+   */
+  std::map<Key, std::weak_ptr<core::Image>> _targets;
+
+  /**
+   * @brief Guards the attachments.
+   */
+  std::mutex _mutex;
+
+public:
+  /**
+   * @brief Construct an empty Render Target Pool.
+   *
+   * @param device Device to use.
+   */
+  RenderTargetPool(core::SharedDevice device);
+
+  /**
+   * @brief Returns an attachment, creating it if none of its kind is in use.
+   *
+   * @param extent              Extent of the attachment.
+   * @param format              Format of the attachment.
+   * @param usage               Usage of the attachment. Transient attachment
+   *                            usage prefers lazily allocated memory.
+   * @param aspect              Aspect of the image view.
+   * @return core::SharedImage  The shared attachment.
+   */
+  core::SharedImage Acquire(vk::Extent2D extent, vk::Format format,
+                            vk::ImageUsageFlags usage,
+                            vk::ImageAspectFlags aspect);
+
+  /**
+   * @brief Getter for the amount of attachments that are in use.
+   *
+   * @return size_t The amount.
+   */
+  size_t GetTargetCount();
+};
+SVEL_CLASS(RenderTargetPool)
+
+} // namespace renderer
+
+#endif /* __RENDERER_RENDER_TARGET_POOL_H__ */
@@ -14,10 +14,18 @@
 
 // Internal
 #include <core/barrier.h>
+#include <core/memory/upload_batch.h>
+#include <io/gltf/glb_file.h>
+#include <io/mesh_cache.h>
+#include <io/obj/indice_table.h>
 #include <io/obj/parser.h>
 #include <renderer/material/material.h>
 #include <renderer/mesh/mesh.h>
+#include <renderer/mesh/optimizer.h>
+#include <renderer/mesh/simplifier.h>
+#include <renderer/mesh/tangent_space.h>
 #include <renderer/pipeline/pipeline.h>
+#include <renderer/pipeline/vertex_format.h>
 #include <svel/detail/mesh.h>
 #include <svel/detail/pipeline.h>
 #include <texture/animation.h>
@@ -25,7 +33,14 @@
 #include <texture/texture.h>
 
 // STL
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <stdexcept>
 
 using namespace SVEL_NAMESPACE;
 
@@ -34,19 +49,120 @@ VulkanRenderer::VulkanRenderer(core::SharedInstance instance,
     : _surface(surface) {
   _device = std::make_shared<core::Device>(instance, _surface);
   _swapchain = std::make_shared<core::Swapchain>(_device, _surface);
+  _renderTargets = std::make_shared<renderer::RenderTargetPool>(_device);
 
   // Create Persistent Command pool
   vk::CommandPoolCreateInfo persistentCommandPoolInfo(
       vk::CommandPoolCreateFlagBits(), _device->GetGraphicsQueueFamily());
   _persistentCommandPool =
       _device->AsVulkanObj().createCommandPool(persistentCommandPoolInfo);
+
+  // Create Transfer Command pool
+  vk::CommandPoolCreateInfo transferCommandPoolInfo(
+      vk::CommandPoolCreateFlagBits(), _device->GetTransferQueueFamily());
+  _transferCommandPool =
+      _device->AsVulkanObj().createCommandPool(transferCommandPoolInfo);
+
+  // Create Mesh arenas
+  _vertexArena = std::make_shared<renderer::MeshArena>(
+      _device, vk::BufferUsageFlagBits::eVertexBuffer);
+  _indexArena = std::make_shared<renderer::MeshArena>(
+      _device, vk::BufferUsageFlagBits::eIndexBuffer);
+  _defragmenter = std::make_unique<renderer::Defragmenter>(
+      _device, _persistentCommandPool, _vertexArena, _indexArena);
 }
 
 VulkanRenderer::~VulkanRenderer() {
+  // Running tasks use the renderer and may still queue uploads
+  {
+    std::unique_lock<std::mutex> lock(_taskMutex);
+    _taskFinished.wait(lock, [this]() { return _runningTasks == 0; });
+  }
+
+  // Submitted uploads free their command buffers on completion
+  for (auto &barrier : _uploadBarriers)
+    barrier->WaitCompletion();
+  _uploadBarriers.clear();
+  _queuedUploads.clear();
+  _defragmenter = nullptr;
+
+  _device->AsVulkanObj().destroyCommandPool(_transferCommandPool);
   _device->AsVulkanObj().destroyCommandPool(_persistentCommandPool);
   _device->AsVulkanObj().waitIdle();
 }
 
+template <typename Task>
+auto VulkanRenderer::_runAsync(Task task) -> std::future<decltype(task())> {
+  {
+    std::lock_guard<std::mutex> lock(_taskMutex);
+    _runningTasks++;
+  }
+
+  try {
+    return std::async(std::launch::async, [this, task = std::move(task)]() {
+      // Finishes the task even if it throws
+      struct TaskGuard {
+        VulkanRenderer *renderer;
+        ~TaskGuard() { renderer->_finishTask(); }
+      } guard{this};
+      return task();
+    });
+  } catch (...) {
+    _finishTask();
+    throw;
+  }
+}
+
+void VulkanRenderer::_finishTask() {
+  std::lock_guard<std::mutex> lock(_taskMutex);
+  _runningTasks--;
+  _taskFinished.notify_all();
+}
+
+void VulkanRenderer::_uploadMeshes(const std::vector<SharedMesh> &meshes) {
+  core::UploadBatch batch(_device, _transferCommandPool,
+                          _persistentCommandPool);
+  for (const auto &mesh : meshes)
+    mesh->Upload(batch);
+
+  auto barrier = std::make_shared<core::Barrier>(_device);
+  batch.Flush(barrier.get());
+  barrier->WaitCompletion();
+}
+
+void VulkanRenderer::_queueUploads(const std::vector<SharedMesh> &meshes) {
+  std::lock_guard<std::mutex> lock(_uploadMutex);
+  _queuedUploads.insert(_queuedUploads.end(), meshes.begin(), meshes.end());
+}
+
+void VulkanRenderer::_processUploads() {
+  std::vector<SharedMesh> queued{};
+  {
+    std::lock_guard<std::mutex> lock(_uploadMutex);
+    queued.swap(_queuedUploads);
+  }
+
+  // Everything queued since the last frame is submitted at once
+  if (!queued.empty()) {
+    core::UploadBatch batch(_device, _transferCommandPool,
+                            _persistentCommandPool);
+    for (const auto &mesh : queued)
+      mesh->Upload(batch);
+
+    auto barrier = std::make_shared<core::Barrier>(_device);
+    batch.Flush(barrier.get());
+    _uploadBarriers.push_back(barrier);
+  }
+
+  // Completing a barrier marks its meshes as ready
+  _uploadBarriers.erase(
+      std::remove_if(_uploadBarriers.begin(), _uploadBarriers.end(),
+                     [](const core::SharedBarrier &barrier) {
+                       return barrier->IsCompleted();
+                     }),
+      _uploadBarriers.end());
+}
+
 SharedShader VulkanRenderer::LoadShader(const std::string &filepath,
                                         Shader::Type type) const {
   return std::make_shared<VulkanShader>(_device, filepath, type);
@@ -60,8 +176,8 @@ SharedPipeline
 VulkanRenderer::BuildPipeline(SharedShader vert, SharedShader frag,
                               const VertexDescription &description) {
   return std::make_shared<renderer::VulkanPipeline>(
-      _device, _surface, _swapchain, GetImpl(vert)->GetShader(),
-      GetImpl(frag)->GetShader(), description);
+      _device, _surface, _swapchain, _renderTargets,
+      GetImpl(vert)->GetShader(), GetImpl(frag)->GetShader(), description);
 }
 
 void VulkanRenderer::BindPipeline(SharedPipeline pipeline) {
@@ -75,39 +191,227 @@ void VulkanRenderer::BindPipeline(SharedPipeline pipeline) {
 void VulkanRenderer::UnbindPipeline() { _currentFrame->UnbindPipeline(); }
 
 SharedTexture VulkanRenderer::CreateTexture(SharedImage image) {
+  auto texture = CreatePinnedTexture(image);
+  _defragmenter->Register(texture);
+  return texture;
+}
+
+SharedTexture VulkanRenderer::CreatePinnedTexture(SharedImage image) {
   _boundPipeline = nullptr;
   auto texture = std::make_shared<Texture>(_device, image);
-  texture->Dispatch(_persistentCommandPool,
-                    std::make_shared<core::Barrier>(_device));
+  core::UploadBatch batch(_device, _transferCommandPool,
+                          _persistentCommandPool);
+  texture->Dispatch(batch);
+  core::Barrier barrier(_device);
+  batch.Flush(&barrier);
+  barrier.WaitCompletion();
   return texture;
 }
 
 SharedAnimation
 VulkanRenderer::CreateAnimation(const std::vector<SharedImage> &images,
                                 float animationSpeed, bool looping) {
+  // Every frame is recorded into the same batch and submitted at once
+  core::UploadBatch batch(_device, _transferCommandPool,
+                          _persistentCommandPool);
   auto animation = std::make_shared<texture::VulkanAnimation>(
-      _device, _persistentCommandPool, std::make_shared<core::Barrier>(_device),
-      images, animationSpeed, looping);
+      _device, batch, images, animationSpeed, looping);
+  core::Barrier barrier(_device);
+  batch.Flush(&barrier);
+  barrier.WaitCompletion();
+  for (const auto &texture : animation->GetTextures())
+    _defragmenter->Register(texture);
   return animation;
 }
 
 SharedTextureAtlas VulkanRenderer::CreateTextureAtlas(SharedImage image,
                                                       const Extent tileCount) {
-  return std::make_shared<texture::VulkanTextureAtlas>(
-      _device, _persistentCommandPool, std::make_shared<core::Barrier>(_device),
-      image, tileCount.width, tileCount.height);
+  core::UploadBatch batch(_device, _transferCommandPool,
+                          _persistentCommandPool);
+  auto atlas = std::make_shared<texture::VulkanTextureAtlas>(
+      _device, batch, image, tileCount.width, tileCount.height);
+  core::Barrier barrier(_device);
+  batch.Flush(&barrier);
+  barrier.WaitCompletion();
+  _defragmenter->Register(atlas->GetTexture());
+  return atlas;
+}
+
+/**
+ * @brief Accumulates optimization statistics of several meshes. Ratios are
+ * weighted by the triangle and vertex counts of the meshes.
+ */
+struct OptimizationTotals {
+  double acmrBefore = 0.0, acmrAfter = 0.0;
+  double atvrBefore = 0.0, atvrAfter = 0.0;
+  double triangles = 0.0, vertices = 0.0;
+  OverdrawStatistics overdrawBefore{}, overdrawAfter{};
+
+  void Add(const MeshOptimizationStatistics &statistics, size_t triangleCount,
+           size_t vertexCount) {
+    acmrBefore += (double)statistics.before.acmr * (double)triangleCount;
+    acmrAfter += (double)statistics.after.acmr * (double)triangleCount;
+    atvrBefore += (double)statistics.before.atvr * (double)vertexCount;
+    atvrAfter += (double)statistics.after.atvr * (double)vertexCount;
+    triangles += (double)triangleCount;
+    vertices += (double)vertexCount;
+    overdrawBefore.pixelsCovered += statistics.overdrawBefore.pixelsCovered;
+    overdrawBefore.pixelsShaded += statistics.overdrawBefore.pixelsShaded;
+    overdrawAfter.pixelsCovered += statistics.overdrawAfter.pixelsCovered;
+    overdrawAfter.pixelsShaded += statistics.overdrawAfter.pixelsShaded;
+  }
+
+  MeshOptimizationStatistics Get() const {
+    MeshOptimizationStatistics statistics{};
+    if (triangles > 0.0) {
+      statistics.before.acmr = (float)(acmrBefore / triangles);
+      statistics.after.acmr = (float)(acmrAfter / triangles);
+    }
+    if (vertices > 0.0) {
+      statistics.before.atvr = (float)(atvrBefore / vertices);
+      statistics.after.atvr = (float)(atvrAfter / vertices);
+    }
+    statistics.overdrawBefore = overdrawBefore;
+    statistics.overdrawAfter = overdrawAfter;
+    for (auto *overdraw :
+         {&statistics.overdrawBefore, &statistics.overdrawAfter})
+      if (overdraw->pixelsCovered > 0)
+        overdraw->overdraw =
+            (float)overdraw->pixelsShaded / (float)overdraw->pixelsCovered;
+    return statistics;
+  }
+};
+
+/**
+ * @brief Applies the requested optimizations to the mesh data in place.
+ *
+ * @tparam T              Index type.
+ * @param options         Optimizations to apply.
+ * @param vertices        Vertex data.
+ * @param vertexStride    Size of a vertex in bytes.
+ * @param vertexCount     Amount of vertices.
+ * @param indices         Index data.
+ * @param out_statistics  Receives the statistics if not null.
+ * @return size_t         Amount of vertices after the optimization.
+ */
+template <typename T>
+static size_t _optimizeMesh(const MeshOptimizationOptions &options,
+                            void *vertices, size_t vertexStride,
+                            size_t vertexCount, std::vector<T> &indices,
+                            MeshOptimizationStatistics *out_statistics) {
+  const bool overdraw = options.optimizeOverdraw;
+  if (overdraw && options.positionOffset + sizeof(glm::vec3) > vertexStride)
+    throw std::invalid_argument("Vertex position exceeds the vertex.");
+
+  if (out_statistics != nullptr) {
+    out_statistics->before = renderer::AnalyzeVertexCache(
+        indices.data(), indices.size(), vertexCount, options.vertexCacheSize);
+    if (overdraw)
+      out_statistics->overdrawBefore = renderer::AnalyzeOverdraw(
+          indices.data(), indices.size(), vertices, vertexStride,
+          options.positionOffset, vertexCount);
+  }
+
+  if (options.optimizeVertexCache)
+    renderer::OptimizeVertexCache(indices.data(), indices.size(), vertexCount,
+                                  options.vertexCacheSize);
+  if (overdraw)
+    renderer::OptimizeOverdraw(indices.data(), indices.size(), vertices,
+                               vertexStride, options.positionOffset,
+                               vertexCount, options.vertexCacheSize,
+                               options.overdrawThreshold);
+  if (options.optimizeVertexFetch)
+    vertexCount = renderer::OptimizeVertexFetch(
+        vertices, vertexStride, vertexCount, indices.data(), indices.size());
+
+  if (out_statistics != nullptr) {
+    out_statistics->after = renderer::AnalyzeVertexCache(
+        indices.data(), indices.size(), vertexCount, options.vertexCacheSize);
+    if (overdraw)
+      out_statistics->overdrawAfter = renderer::AnalyzeOverdraw(
+          indices.data(), indices.size(), vertices, vertexStride,
+          options.positionOffset, vertexCount);
+  }
+  return vertexCount;
+}
+
+template <typename T>
+SharedMesh
+VulkanRenderer::_createMesh(const ArrayProxy &nodes,
+                            const std::vector<T> &indices,
+                            const MeshOptimizationOptions &options) {
+  const auto indexType =
+      sizeof(T) == sizeof(uint16_t) ? vk::IndexType::eUint16
+                                    : vk::IndexType::eUint32;
+  if (!options.optimizeVertexCache && !options.optimizeOverdraw &&
+      !options.optimizeVertexFetch && options.statistics == nullptr)
+    return std::make_shared<Mesh>(_vertexArena, _indexArena, nodes, indices,
+                                  indexType);
+
+  // Never modify the data of the caller
+  std::vector<T> optimizedIndices = indices;
+  std::vector<uint8_t> optimizedNodes{};
+  ArrayProxy optimizedProxy = nodes;
+  if (options.optimizeVertexFetch) {
+    const auto *bytes = (const uint8_t *)nodes.data;
+    optimizedNodes.assign(bytes, bytes + nodes.dataSize);
+    optimizedProxy.data = optimizedNodes.data();
+  }
+
+  optimizedProxy.elementCount = _optimizeMesh(
+      options, optimizedProxy.data, nodes.elementSize, nodes.elementCount,
+      optimizedIndices, options.statistics);
+  optimizedProxy.dataSize = optimizedProxy.elementCount * nodes.elementSize;
+  return std::make_shared<Mesh>(_vertexArena, _indexArena, optimizedProxy,
+                                optimizedIndices, indexType);
+}
+
+template <typename T>
+std::future<SharedMesh>
+VulkanRenderer::_createMeshAsync(const ArrayProxy &nodes,
+                                 const std::vector<T> &indices,
+                                 const MeshOptimizationOptions &options) {
+  // The caller may release its data once the call returns
+  const auto *bytes = (const uint8_t *)nodes.data;
+  std::vector<uint8_t> nodeData(bytes, bytes + nodes.dataSize);
+  return _runAsync([this, nodes, nodeData = std::move(nodeData), indices,
+                    options]() {
+    auto proxy = nodes;
+    proxy.data = (void *)nodeData.data();
+    auto mesh = _createMesh(proxy, indices, options);
+    _queueUploads({mesh});
+    return mesh;
+  });
 }
 
 SharedMesh VulkanRenderer::CreateMesh(const ArrayProxy &nodes,
-                                      const std::vector<uint16_t> &indices) {
-  return std::make_shared<Mesh>(_device, _persistentCommandPool, nodes, indices,
-                                vk::IndexType::eUint16);
+                                      const std::vector<uint16_t> &indices,
+                                      const MeshOptimizationOptions &options) {
+  auto mesh = _createMesh(nodes, indices, options);
+  _uploadMeshes({mesh});
+  return mesh;
 }
 
 SharedMesh VulkanRenderer::CreateMesh(const ArrayProxy &nodes,
-                                      const std::vector<uint32_t> &indices) {
-  return std::make_shared<Mesh>(_device, _persistentCommandPool, nodes, indices,
-                                vk::IndexType::eUint32);
+                                      const std::vector<uint32_t> &indices,
+                                      const MeshOptimizationOptions &options) {
+  auto mesh = _createMesh(nodes, indices, options);
+  _uploadMeshes({mesh});
+  return mesh;
+}
+
+std::future<SharedMesh>
+VulkanRenderer::CreateMeshAsync(const ArrayProxy &nodes,
+                                const std::vector<uint16_t> &indices,
+                                const MeshOptimizationOptions &options) {
+  return _createMeshAsync(nodes, indices, options);
+}
+
+std::future<SharedMesh>
+VulkanRenderer::CreateMeshAsync(const ArrayProxy &nodes,
+                                const std::vector<uint32_t> &indices,
+                                const MeshOptimizationOptions &options) {
+  return _createMeshAsync(nodes, indices, options);
 }
 
 struct VertexData {
@@ -115,73 +419,954 @@ struct VertexData {
   glm::vec3 color;
   glm::vec2 tex;
   glm::vec3 normal;
+  glm::vec4 tangent{1.0f, 0.0f, 0.0f, 1.0f};
 
   VertexData(const glm::vec3 &c, const glm::vec3 &co, const glm::vec2 &t,
              const glm::vec3 &n)
       : coord(c), color(co), tex(t), normal(n) {}
 };
 
+/**
+ * @brief Faces of an OBJ model that are built into one mesh.
+ */
+struct ObjPart {
+  const io::obj::Model *model;
+  size_t firstFace;
+  size_t endFace;
+
+  /**
+   * @brief Normals generated for the coordinates of the model, nullptr if the
+   * model has its own.
+   */
+  const glm::vec3 *generatedNormals;
+};
+
+/**
+ * @brief Describes how meshes are built from OBJ files. Has to be changed
+ * whenever VertexData or the way it is built changes.
+ */
+static constexpr char OBJ_LAYOUT[] =
+    "obj:first-use-order;octahedral-normals;short-indices;lod-ranges;"
+    "tangents";
+
+/**
+ * @brief Key of the OBJ mesh building within the mesh cache.
+ */
+static const uint64_t OBJ_LAYOUT_KEY =
+    io::MeshCache::Hash(OBJ_LAYOUT, sizeof(OBJ_LAYOUT) - 1);
+
+/**
+ * @brief Meshes with at most this many vertices can use 16 bit indices.
+ */
+static constexpr size_t SHORT_INDEX_VERTICES = (size_t)UINT16_MAX + 1;
+
+/**
+ * @brief Maps a unit vector onto the octahedron and unfolds it into [-1, 1]^2.
+ *
+ * @param normal      Unit vector to encode.
+ * @return glm::vec2  Encoded vector.
+ */
+static glm::vec2 _encodeOctahedral(const glm::vec3 &normal) {
+  const float length =
+      std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+  if (length == 0.0f)
+    return glm::vec2(0.0f, 0.0f);
+
+  glm::vec2 encoded(normal.x / length, normal.y / length);
+  if (normal.z < 0.0f) {
+    // Fold the lower hemisphere over the diagonals
+    const glm::vec2 folded(1.0f - std::fabs(encoded.y),
+                           1.0f - std::fabs(encoded.x));
+    encoded.x = encoded.x >= 0.0f ? folded.x : -folded.x;
+    encoded.y = encoded.y >= 0.0f ? folded.y : -folded.y;
+  }
+  return encoded;
+}
+
+/**
+ * @brief Computes the size of a vertex in the layout.
+ *
+ * @param layout  The layout.
+ * @return size_t Size of a vertex in bytes.
+ */
+static size_t _getVertexStride(const VertexLayout &layout) {
+  size_t vertexStride = 0;
+  for (const auto &attribute : layout) {
+    const auto attributeSize =
+        renderer::GetAttributeSize(attribute.type, attribute.count);
+    if (attributeSize == 0)
+      throw std::invalid_argument("Invalid vertex layout.");
+    vertexStride += attributeSize;
+  }
+  if (vertexStride == 0)
+    throw std::invalid_argument("Vertex layout is empty.");
+  return vertexStride;
+}
+
+/**
+ * @brief Converts a full precision vertex into the requested layout.
+ *
+ * @param vertex    Vertex to convert.
+ * @param layout    Target layout.
+ * @param out       Receives the converted vertex.
+ * @return uint8_t* Behind the converted vertex.
+ */
+static uint8_t *_packVertex(const VertexData &vertex,
+                            const VertexLayout &layout, uint8_t *out) {
+  for (const auto &attribute : layout) {
+    glm::vec4 value;
+    switch (attribute.semantic) {
+    case VertexSemantic::ePosition:
+      value = glm::vec4(vertex.coord, 1.0f);
+      break;
+    case VertexSemantic::eColor:
+      value = glm::vec4(vertex.color, 1.0f);
+      break;
+    case VertexSemantic::eTexCoord:
+      value = glm::vec4(vertex.tex.x, vertex.tex.y, 0.0f, 0.0f);
+      break;
+    case VertexSemantic::eNormal:
+      if (attribute.count == 2) {
+        const auto encoded = _encodeOctahedral(vertex.normal);
+        value = glm::vec4(encoded.x, encoded.y, 0.0f, 0.0f);
+      } else
+        value = glm::vec4(vertex.normal, 0.0f);
+      break;
+    case VertexSemantic::eTangent:
+      value = vertex.tangent;
+      break;
+    }
+    renderer::PackAttribute(attribute.type, attribute.count, value, out);
+    out += renderer::GetAttributeSize(attribute.type, attribute.count);
+  }
+  return out;
+}
+
+/**
+ * @brief Converts full precision vertices into the requested layout.
+ *
+ * @param vertices              Vertices to convert.
+ * @param layout                Target layout.
+ * @param stride                Size of a vertex in the target layout.
+ * @return std::vector<uint8_t> Converted vertices.
+ */
+static std::vector<uint8_t>
+_packVertices(const std::vector<VertexData> &vertices,
+              const VertexLayout &layout, size_t stride) {
+  std::vector<uint8_t> packed(vertices.size() * stride);
+  auto *out = packed.data();
+  for (const auto &vertex : vertices)
+    out = _packVertex(vertex, layout, out);
+  return packed;
+}
+
+/**
+ * @brief Reinterprets a float, so that it can be hashed.
+ *
+ * @param value     The float.
+ * @return uint32_t Bits of the float.
+ */
+static uint32_t _getBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+/**
+ * @brief Weights of the texture coordinate and the normal when simplifying
+ * meshes. Both follow each other in VertexData.
+ */
+static constexpr float LOD_ATTRIBUTE_WEIGHTS[] = {0.25f, 0.25f,
+                                                  0.1f, 0.1f, 0.1f};
+static_assert(offsetof(VertexData, normal) ==
+                  offsetof(VertexData, tex) + sizeof(glm::vec2),
+              "Simplified attributes have to be consecutive.");
+
+/**
+ * @brief Generates simplified levels of detail. Every level simplifies the
+ * previous one, so the errors of the levels add up.
+ *
+ * @param options       Controls the generation.
+ * @param optimization  Optimizations that are applied to every level.
+ * @param vertices      Vertices of the mesh.
+ * @param out_levels    Index data of every level. Has to contain the full
+ *                      detail level.
+ * @param out_errors    Error of every level. Has to contain the error of the
+ *                      full detail level.
+ */
+static void _generateLods(const MeshLodOptions &options,
+                          const MeshOptimizationOptions &optimization,
+                          const std::vector<VertexData> &vertices,
+                          std::vector<std::vector<uint32_t>> &out_levels,
+                          std::vector<float> &out_errors) {
+  for (uint32_t level = 0; level < options.levelCount; level++) {
+    const auto &previous = out_levels.back();
+    const float remainingError = options.maxError - out_errors.back();
+    const auto targetIndexCount =
+        (size_t)((double)(previous.size() / 3) * options.reduction) * 3;
+    if (!(remainingError > 0.0f) || targetIndexCount == 0)
+      break;
+
+    std::vector<uint32_t> simplified{};
+    const auto error = renderer::SimplifyMesh(
+        previous.data(), previous.size(), vertices.data(), sizeof(VertexData),
+        offsetof(VertexData, coord), offsetof(VertexData, tex),
+        std::size(LOD_ATTRIBUTE_WEIGHTS), LOD_ATTRIBUTE_WEIGHTS,
+        vertices.size(), targetIndexCount, remainingError, simplified);
+
+    // Levels that do not save anything are not worth the memory
+    if (simplified.empty() || simplified.size() >= previous.size())
+      break;
+    if (optimization.optimizeVertexCache)
+      renderer::OptimizeVertexCache(simplified.data(), simplified.size(),
+                                    vertices.size(),
+                                    optimization.vertexCacheSize);
+    out_errors.push_back(out_errors.back() + error);
+    out_levels.push_back(std::move(simplified));
+  }
+}
+
+/**
+ * @brief Lays out the index data of all levels of detail in one index buffer.
+ * Uses 16 bit indices if the mesh is small enough or can be split into
+ * ranges that are, as long as splitting saves memory.
+ *
+ * @param vertices          Packed vertices. Replaced if the mesh is split.
+ * @param vertexStride      Size of a packed vertex in bytes.
+ * @param levels            Index data of every level.
+ * @param errors            Error of every level.
+ * @param splitIndexRanges  Allows splitting the mesh into ranges.
+ * @param out_indices       32 bit index data, if 16 bit is not possible.
+ * @param out_shortIndices  16 bit index data, if possible.
+ * @param out_ranges        Ranges of the index data. Empty if the index data
+ *                          is drawn at once.
+ * @param out_lods          Levels made of the ranges. Empty if there is only
+ *                          a single level.
+ */
+static void _layoutIndices(std::vector<uint8_t> &vertices, size_t vertexStride,
+                           const std::vector<std::vector<uint32_t>> &levels,
+                           const std::vector<float> &errors,
+                           bool splitIndexRanges,
+                           std::vector<uint32_t> &out_indices,
+                           std::vector<uint16_t> &out_shortIndices,
+                           std::vector<renderer::DrawRange> &out_ranges,
+                           std::vector<renderer::LodLevel> &out_lods) {
+  const size_t vertexCount = vertices.size() / vertexStride;
+  size_t indexCount = 0;
+  for (const auto &level : levels)
+    indexCount += level.size();
+
+  // Every level is a single range, all referencing the same vertices
+  auto concatenate = [&](bool shortIndices) {
+    out_indices.clear();
+    out_shortIndices.clear();
+    out_ranges.clear();
+    out_lods.clear();
+    uint32_t firstIndex = 0;
+    for (size_t i = 0; i < levels.size(); i++) {
+      for (const auto index : levels[i]) {
+        if (shortIndices)
+          out_shortIndices.push_back((uint16_t)index);
+        else
+          out_indices.push_back(index);
+      }
+      out_ranges.push_back({firstIndex, (uint32_t)levels[i].size(), 0});
+      out_lods.push_back({(uint32_t)i, 1, errors[i]});
+      firstIndex += (uint32_t)levels[i].size();
+    }
+  };
+
+  if (vertexCount <= SHORT_INDEX_VERTICES || !splitIndexRanges)
+    concatenate(vertexCount <= SHORT_INDEX_VERTICES);
+  else {
+    // Split every level on its own, vertices shared by levels are duplicated
+    std::vector<uint8_t> splitVertices{};
+    std::vector<uint8_t> levelVertices{};
+    std::vector<uint16_t> levelIndices{};
+    std::vector<renderer::DrawRange> levelRanges{};
+    for (size_t i = 0; i < levels.size(); i++) {
+      renderer::SplitIndexRanges(vertices.data(), vertexStride, vertexCount,
+                                 levels[i].data(), levels[i].size(),
+                                 levelVertices, levelIndices, levelRanges);
+      const auto firstIndex = (uint32_t)out_shortIndices.size();
+      const auto firstVertex = (int32_t)(splitVertices.size() / vertexStride);
+      out_lods.push_back({(uint32_t)out_ranges.size(),
+                          (uint32_t)levelRanges.size(), errors[i]});
+      for (auto range : levelRanges) {
+        range.firstIndex += firstIndex;
+        range.vertexOffset += firstVertex;
+        out_ranges.push_back(range);
+      }
+      out_shortIndices.insert(out_shortIndices.end(), levelIndices.begin(),
+                              levelIndices.end());
+      splitVertices.insert(splitVertices.end(), levelVertices.begin(),
+                           levelVertices.end());
+    }
+
+    const size_t splitBytes =
+        splitVertices.size() + out_shortIndices.size() * sizeof(uint16_t);
+    const size_t fullBytes = vertices.size() + indexCount * sizeof(uint32_t);
+    if (splitBytes < fullBytes)
+      vertices = std::move(splitVertices);
+    else
+      concatenate(false);
+  }
+
+  // A single level that is drawn at once needs no ranges
+  if (levels.size() == 1) {
+    out_lods.clear();
+    if (out_ranges.size() == 1)
+      out_ranges.clear();
+  }
+}
+
+/**
+ * @brief Packs the data of several meshes into one vertex and index buffer.
+ * The ranges of every mesh are rebased onto the packed data. Indices stay 16
+ * bit if every mesh uses 16 bit indices, vertex offsets keep them valid.
+ *
+ * @param entries               Meshes to pack. Have to share the vertex
+ *                              stride.
+ * @param out_vertices          Vertex data of all meshes.
+ * @param out_indices           32 bit index data, if any mesh requires it.
+ * @param out_shortIndices      16 bit index data otherwise.
+ * @param out_ranges            Ranges of every mesh. Meshes without ranges
+ *                              get a single one.
+ * @return io::MeshCache::Entry Describes the packed data. Has no ranges.
+ */
+static io::MeshCache::Entry
+_packEntries(const std::vector<io::MeshCache::Entry> &entries,
+             std::vector<uint8_t> &out_vertices,
+             std::vector<uint32_t> &out_indices,
+             std::vector<uint16_t> &out_shortIndices,
+             std::vector<std::vector<renderer::DrawRange>> &out_ranges) {
+  io::MeshCache::Entry packed{};
+  bool shortIndices = true;
+  uint64_t vertexCount = 0, indexCount = 0;
+  for (const auto &entry : entries) {
+    shortIndices = shortIndices && entry.indexSize == sizeof(uint16_t);
+    vertexCount += entry.vertexCount;
+    indexCount += entry.indexCount;
+  }
+
+  // Ranges address the packed data with 32 bit offsets
+  if (vertexCount > (uint64_t)INT32_MAX || indexCount > (uint64_t)UINT32_MAX)
+    throw std::runtime_error("Too much mesh data to pack.");
+  if (!entries.empty())
+    packed.vertexStride = entries.front().vertexStride;
+  out_vertices.reserve((size_t)(vertexCount * packed.vertexStride));
+  if (shortIndices)
+    out_shortIndices.reserve((size_t)indexCount);
+  else
+    out_indices.reserve((size_t)indexCount);
+
+  for (const auto &entry : entries) {
+    if (entry.vertexStride != packed.vertexStride)
+      throw std::invalid_argument("Packed meshes need the same vertex stride.");
+
+    const auto *vertices = (const uint8_t *)entry.vertices;
+    out_vertices.insert(out_vertices.end(), vertices,
+                        vertices + (size_t)entry.vertexStride *
+                                       entry.vertexCount);
+    if (entry.indexSize == sizeof(uint16_t)) {
+      const auto *indices = (const uint16_t *)entry.indices;
+      if (shortIndices)
+        out_shortIndices.insert(out_shortIndices.end(), indices,
+                                indices + entry.indexCount);
+      else
+        out_indices.insert(out_indices.end(), indices,
+                           indices + entry.indexCount);
+    } else {
+      const auto *indices = (const uint32_t *)entry.indices;
+      out_indices.insert(out_indices.end(), indices,
+                         indices + entry.indexCount);
+    }
+
+    std::vector<renderer::DrawRange> ranges(entry.ranges,
+                                            entry.ranges + entry.rangeCount);
+    if (ranges.empty())
+      ranges.push_back({0, entry.indexCount, 0});
+    for (auto &range : ranges) {
+      range.firstIndex += packed.indexCount;
+      range.vertexOffset += (int32_t)packed.vertexCount;
+    }
+    out_ranges.push_back(std::move(ranges));
+
+    packed.vertexCount += entry.vertexCount;
+    packed.uniqueVertexCount += entry.uniqueVertexCount;
+    packed.indexCount += entry.indexCount;
+  }
+
+  packed.vertices = out_vertices.data();
+  if (shortIndices) {
+    packed.indices = out_shortIndices.data();
+    packed.indexSize = sizeof(uint16_t);
+  } else {
+    packed.indices = out_indices.data();
+    packed.indexSize = sizeof(uint32_t);
+  }
+  return packed;
+}
+
 std::vector<SharedMesh>
-VulkanRenderer::LoadObjFile(const std::string &objFile) {
+VulkanRenderer::_loadObjFile(const std::string &objFile,
+                             const MeshImportOptions &options) {
+  using Clock = std::chrono::steady_clock;
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  const auto loadStart = Clock::now();
+
+  // Validate the target layout
+  const auto &layout = options.vertexLayout;
+  const size_t vertexStride = _getVertexStride(layout);
+
+  // Optimizations run on the full precision vertices
+  auto optimization = options.optimization;
+  optimization.positionOffset = (uint32_t)offsetof(VertexData, coord);
+
+  // Cached data is only valid for the layout, optimizations and levels of
+  // detail it was built with
+  std::vector<uint32_t> layoutDescription{};
+  for (const auto &attribute : layout)
+    layoutDescription.insert(layoutDescription.end(),
+                             {(uint32_t)attribute.semantic,
+                              (uint32_t)attribute.type, attribute.count});
+  const uint32_t optimizationKey[] = {
+      optimization.optimizeVertexCache,
+      optimization.optimizeOverdraw,
+      optimization.optimizeVertexFetch,
+      optimization.vertexCacheSize,
+      _getBits(optimization.overdrawThreshold),
+      optimization.positionOffset,
+      options.splitIndexRanges,
+      options.packGroups,
+      (uint32_t)options.normalGeneration,
+      options.lod.levelCount,
+      _getBits(options.lod.reduction),
+      _getBits(options.lod.maxError)};
+  const auto layoutKey = io::MeshCache::Hash(
+      optimizationKey, sizeof(optimizationKey),
+      io::MeshCache::Hash(layoutDescription.data(),
+                          layoutDescription.size() * sizeof(uint32_t),
+                          OBJ_LAYOUT_KEY));
+
+  const auto cacheFile =
+      io::MeshCache::GetCachePath(objFile, options.cacheDirectory);
+  io::SharedMeshCache cache = nullptr;
+  if (options.useCache)
+    cache = io::MeshCache::Load(objFile, cacheFile, layoutKey);
+
+  // Entries either point into the cache mapping or into the buffers below
+  std::vector<io::MeshCache::Entry> entries{};
+  std::vector<std::vector<uint8_t>> vertexBuffers{};
+  std::vector<std::vector<uint32_t>> indexBuffers{};
+  std::vector<std::vector<uint16_t>> shortIndexBuffers{};
+  std::vector<std::vector<renderer::DrawRange>> rangeBuffers{};
+  std::vector<std::vector<renderer::LodLevel>> lodBuffers{};
+  std::vector<std::vector<uint8_t>> decodedVertices{};
+  std::vector<std::vector<uint8_t>> decodedIndices{};
+  OptimizationTotals optimizationTotals{};
+  if (cache != nullptr) {
+    entries = cache->GetEntries();
+
+    // Packing and statistics read compressed data on the cpu, everything else
+    // is decoded straight into the staging memory
+    if (options.packGroups || optimization.statistics != nullptr) {
+      decodedVertices.resize(entries.size());
+      decodedIndices.resize(entries.size());
+      for (size_t i = 0; i < entries.size(); i++)
+        entries[i] = io::MeshCache::Decompress(entries[i], decodedVertices[i],
+                                               decodedIndices[i]);
+    }
+  } else {
+    io::obj::Parser parser(objFile);
+    auto data = parser.Parse(io::obj::Parser::Mode::eParallel);
+
+    // Every model becomes a mesh, packed imports build every group on its own
+    std::vector<ObjPart> parts{};
+    std::vector<std::vector<glm::vec3>> generatedNormals{};
+    for (const auto &model : data) {
+      const bool hasNormals =
+          model->faceType == io::obj::FaceDescriptionType::eCoordsNormals ||
+          model->faceType ==
+              io::obj::FaceDescriptionType::eCoordsTexCoordsNormals;
+      if (!hasNormals && options.normalGeneration == NormalGeneration::eNone)
+        continue;
+
+      // Normals are generated per coordinate over the whole model, so that
+      // groups share them along their borders
+      const glm::vec3 *normals = nullptr;
+      if (!hasNormals) {
+        std::vector<uint32_t> coordIndices{};
+        coordIndices.reserve(model->faces.size() * 3);
+        for (const auto &face : model->faces)
+          for (const auto &indice : face)
+            coordIndices.push_back(indice.coordId - 1 -
+                                   model->coordinateOffset);
+
+        // The heap storage of the inner vectors stays in place
+        generatedNormals.emplace_back();
+        renderer::GenerateNormals(
+            coordIndices.data(), coordIndices.size(),
+            model->coordinates.data(), sizeof(glm::vec3), 0,
+            model->coordinates.size(),
+            options.normalGeneration == NormalGeneration::eAngleWeighted,
+            generatedNormals.back());
+        normals = generatedNormals.back().data();
+      }
+
+      size_t firstFace = 0;
+      if (options.packGroups)
+        for (const auto &group : model->groups) {
+          if (group.firstFace > firstFace)
+            parts.push_back(
+                {model.get(), firstFace, group.firstFace, normals});
+          firstFace = group.firstFace;
+        }
+      if (model->faces.size() > firstFace)
+        parts.push_back(
+            {model.get(), firstFace, model->faces.size(), normals});
+    }
+
+    // Models without texture coordinates get tangents orthogonal to the normal
+    const bool generateTangents =
+        std::any_of(layout.begin(), layout.end(), [](const auto &attribute) {
+          return attribute.semantic == VertexSemantic::eTangent;
+        });
+
+    for (const auto &part : parts) {
+      const auto *meshData = part.model;
+      const auto faceBegin =
+          meshData->faces.begin() + (ptrdiff_t)part.firstFace;
+      const auto faceEnd = meshData->faces.begin() + (ptrdiff_t)part.endFace;
+
+      // Deduplicate in a single pass. Vertices are emitted in order of first
+      // use, which keeps them close to the faces that reference them.
+      const size_t indexCount = (part.endFace - part.firstFace) * 3;
+      io::obj::IndiceTable indiceTable(indexCount / 2);
+      std::vector<VertexData> vertexData{};
+      std::vector<uint32_t> indiceData{};
+      vertexData.reserve(indexCount / 2);
+      indiceData.reserve(indexCount);
+      for (auto face = faceBegin; face != faceEnd; face++) {
+        for (const auto &indice : *face) {
+          const auto nextIndex = (uint32_t)vertexData.size();
+          const auto index = indiceTable.Insert(indice, nextIndex);
+          indiceData.push_back(index);
+          if (index != nextIndex)
+            continue;
+
+          // -1 as Ids start with 1. Ids are global to the file.
+          const auto coordIndex =
+              indice.coordId - 1 - meshData->coordinateOffset;
+          const auto &coords = meshData->coordinates.at(coordIndex);
+          const auto texCoords =
+              indice.texId != 0
+                  ? meshData->textureCoords.at(indice.texId - 1 -
+                                               meshData->textureCoordOffset)
+                  : glm::vec2{0.0f, 0.0f};
+          const auto &normals =
+              part.generatedNormals != nullptr
+                  ? part.generatedNormals[coordIndex]
+                  : meshData->normals.at(indice.normalId - 1 -
+                                         meshData->normalOffset);
+          vertexData.emplace_back(coords, glm::vec3{1.0f, 1.0f, 1.0f},
+                                  texCoords, normals);
+        }
+      }
+
+      MeshOptimizationStatistics optimizationStatistics{};
+      const auto vertexCount = _optimizeMesh(
+          optimization, vertexData.data(), sizeof(VertexData),
+          vertexData.size(), indiceData,
+          optimization.statistics != nullptr ? &optimizationStatistics
+                                             : nullptr);
+      vertexData.erase(vertexData.begin() + (ptrdiff_t)vertexCount,
+                       vertexData.end());
+      optimizationTotals.Add(optimizationStatistics, indiceData.size() / 3,
+                             vertexData.size());
+      if (generateTangents)
+        renderer::GenerateTangents(
+            indiceData.data(), indiceData.size(), vertexData.data(),
+            sizeof(VertexData), offsetof(VertexData, coord),
+            offsetof(VertexData, tex), offsetof(VertexData, normal),
+            offsetof(VertexData, tangent), vertexData.size());
+
+      // Levels of detail share the vertices of the full detail mesh
+      std::vector<std::vector<uint32_t>> levels{};
+      std::vector<float> errors{0.0f};
+      levels.push_back(std::move(indiceData));
+      _generateLods(options.lod, optimization, vertexData, levels, errors);
+
+      auto packedVertices = _packVertices(vertexData, layout, vertexStride);
+      std::vector<uint16_t> shortIndices{};
+      std::vector<renderer::DrawRange> ranges{};
+      std::vector<renderer::LodLevel> lods{};
+      _layoutIndices(packedVertices, vertexStride, levels, errors,
+                     options.splitIndexRanges, indiceData, shortIndices,
+                     ranges, lods);
+
+      io::MeshCache::Entry entry;
+      entry.vertices = packedVertices.data();
+      entry.vertexStride = (uint32_t)vertexStride;
+      entry.vertexCount = (uint32_t)(packedVertices.size() / vertexStride);
+      entry.uniqueVertexCount = (uint32_t)vertexData.size();
+      if (!shortIndices.empty()) {
+        entry.indices = shortIndices.data();
+        entry.indexSize = sizeof(uint16_t);
+        entry.indexCount = (uint32_t)shortIndices.size();
+      } else {
+        entry.indices = indiceData.data();
+        entry.indexSize = sizeof(uint32_t);
+        entry.indexCount = (uint32_t)indiceData.size();
+      }
+      entry.ranges = ranges.data();
+      entry.rangeCount = (uint32_t)ranges.size();
+      entry.lods = lods.data();
+      entry.lodCount = (uint32_t)lods.size();
+      entries.push_back(entry);
+
+      // Moving keeps the heap storage, so the entry stays valid
+      vertexBuffers.push_back(std::move(packedVertices));
+      indexBuffers.push_back(std::move(indiceData));
+      shortIndexBuffers.push_back(std::move(shortIndices));
+      rangeBuffers.push_back(std::move(ranges));
+      lodBuffers.push_back(std::move(lods));
+    }
+  }
+  const auto uploadStart = Clock::now();
+
+  // The cache keeps one entry per group, they are packed after loading
+  std::vector<uint8_t> packedVertices{};
+  std::vector<uint32_t> packedIndices{};
+  std::vector<uint16_t> packedShortIndices{};
+  std::vector<std::vector<renderer::DrawRange>> packedRanges{};
+  std::vector<io::MeshCache::Entry> uploadEntries{};
+  if (options.packGroups && !entries.empty())
+    uploadEntries.push_back(_packEntries(entries, packedVertices,
+                                         packedIndices, packedShortIndices,
+                                         packedRanges));
+  else
+    uploadEntries = entries;
+
   std::vector<SharedMesh> result{};
+  MeshImportStatistics statistics{};
+  for (const auto &entry : uploadEntries) {
+    const size_t vertexBytes = (size_t)entry.vertexStride * entry.vertexCount;
+    const size_t indexBytes = (size_t)entry.indexSize * entry.indexCount;
+    auto writeNodes = [&entry](void *destination) {
+      io::MeshCache::ReadVertices(entry, destination);
+    };
+    auto writeIndices = [&entry](void *destination) {
+      io::MeshCache::ReadIndices(entry, destination);
+    };
 
-  io::obj::Parser parser(objFile);
-  auto data = parser.Parse();
-  for (const auto &meshData : data) {
-    // Skip incomplete faces for now
-    if (meshData->faceType !=
-        io::obj::FaceDescriptionType::eCoordsTexCoordsNormals)
-      continue;
+    // Uncompressed cache data stays mapped, the device may copy from it
+    core::TransferBuffer::HostSource nodeSource{}, indexSource{};
+    if (cache != nullptr && options.importCache && !options.packGroups) {
+      if (entry.encodedVertexSize == 0)
+        nodeSource = {entry.vertices, cache};
+      if (entry.encodedIndexSize == 0)
+        indexSource = {entry.indices, cache};
+    }
+    auto mesh = std::make_shared<Mesh>(
+        _vertexArena, _indexArena, entry.vertexCount, entry.vertexStride,
+        writeNodes, entry.indexCount,
+        entry.indexSize == sizeof(uint16_t) ? vk::IndexType::eUint16
+                                            : vk::IndexType::eUint32,
+        writeIndices,
+        std::vector<renderer::DrawRange>(entry.ranges,
+                                         entry.ranges + entry.rangeCount),
+        std::vector<renderer::LodLevel>(entry.lods,
+                                        entry.lods + entry.lodCount),
+        options.lod.pixelError, nodeSource, indexSource);
+
+    // Groups only reference ranges of the packed buffers
+    if (options.packGroups)
+      for (size_t i = 0; i < entries.size(); i++)
+        result.push_back(std::make_shared<Mesh>(
+            *mesh, std::move(packedRanges[i]),
+            std::vector<renderer::LodLevel>(
+                entries[i].lods, entries[i].lods + entries[i].lodCount),
+            options.lod.pixelError));
+    else
+      result.push_back(mesh);
+    statistics.vertexBytes += vertexBytes;
+    statistics.indexBytes += indexBytes;
+    statistics.importedBytes += mesh->GetImportedSize();
+
+    const size_t duplicatedBytes =
+        (size_t)(entry.vertexCount - entry.uniqueVertexCount) *
+        entry.vertexStride;
+    const size_t savedBytes =
+        (size_t)entry.indexCount * sizeof(uint32_t) - indexBytes;
+    statistics.duplicatedVertexBytes += duplicatedBytes;
+
+    // Packed entries may keep 32 bit indices although a group was split
+    if (savedBytes > duplicatedBytes)
+      statistics.indexBytesSaved += savedBytes - duplicatedBytes;
+  }
+  const auto uploadEnd = Clock::now();
+
+  // Failing to write the cache only costs time on the next start
+  if (options.useCache && cache == nullptr)
+    io::MeshCache::Write(objFile, cacheFile, layoutKey, entries,
+                         options.compressCache);
+
+  // Cached meshes are already optimized, only their final state is known
+  if (optimization.statistics != nullptr) {
+    if (cache != nullptr) {
+      for (const auto &entry : entries) {
+        // Only the full detail level was optimized, it comes first
+        size_t indexCount = entry.indexCount;
+        if (entry.lodCount > 0) {
+          const auto &lod = entry.lods[0];
+          indexCount = 0;
+          for (uint32_t i = 0; i < lod.rangeCount; i++)
+            indexCount += entry.ranges[lod.firstRange + i].indexCount;
+        }
+
+        MeshOptimizationStatistics cached{};
+        cached.after =
+            entry.indexSize == sizeof(uint16_t)
+                ? renderer::AnalyzeVertexCache(
+                      (const uint16_t *)entry.indices, indexCount,
+                      entry.vertexCount, optimization.vertexCacheSize)
+                : renderer::AnalyzeVertexCache(
+                      (const uint32_t *)entry.indices, indexCount,
+                      entry.vertexCount, optimization.vertexCacheSize);
+        cached.before = cached.after;
+        optimizationTotals.Add(cached, indexCount / 3, entry.vertexCount);
+      }
+    }
+    *optimization.statistics = optimizationTotals.Get();
+  }
+
+  if (options.statistics != nullptr) {
+    statistics.cacheHit = cache != nullptr;
+    statistics.loadTime = Milliseconds(uploadStart - loadStart).count();
+    statistics.uploadTime = Milliseconds(uploadEnd - uploadStart).count();
+    *options.statistics = statistics;
+  }
+  return result;
+}
+
+std::vector<SharedMesh>
+VulkanRenderer::LoadObjFile(const std::string &objFile,
+                            const MeshImportOptions &options) {
+  using Clock = std::chrono::steady_clock;
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  auto meshes = _loadObjFile(objFile, options);
+
+  const auto uploadStart = Clock::now();
+  _uploadMeshes(meshes);
+  if (options.statistics != nullptr)
+    options.statistics->uploadTime +=
+        Milliseconds(Clock::now() - uploadStart).count();
+  return meshes;
+}
+
+std::future<std::vector<SharedMesh>>
+VulkanRenderer::LoadObjFileAsync(const std::string &objFile,
+                                 const MeshImportOptions &options) {
+  return _runAsync([this, objFile, options]() {
+    auto meshes = _loadObjFile(objFile, options);
+    _queueUploads(meshes);
+    return meshes;
+  });
+}
+
+std::vector<std::future<std::vector<SharedMesh>>>
+VulkanRenderer::LoadObjFilesAsync(const std::vector<std::string> &objFiles,
+                                  const MeshImportOptions &options) {
+  // Concurrent imports must not share statistics
+  auto fileOptions = options;
+  fileOptions.statistics = nullptr;
+  fileOptions.optimization.statistics = nullptr;
+
+  std::vector<std::future<std::vector<SharedMesh>>> result{};
+  result.reserve(objFiles.size());
+  for (const auto &objFile : objFiles)
+    result.push_back(LoadObjFileAsync(objFile, fileOptions));
+  return result;
+}
+
+/**
+ * @brief Reads a vertex of a glTF primitive in full precision. Missing
+ * attributes get the same defaults as OBJ vertices.
+ *
+ * @param primitive   The primitive.
+ * @param index       Index of the vertex.
+ * @return VertexData The vertex.
+ */
+static VertexData _readGlbVertex(const io::gltf::Primitive &primitive,
+                                 size_t index) {
+  VertexData vertex(glm::vec3(primitive.positions.Get(index)),
+                    glm::vec3{1.0f, 1.0f, 1.0f}, glm::vec2{0.0f, 0.0f},
+                    glm::vec3{0.0f, 0.0f, 0.0f});
+  if (primitive.colors.data != nullptr)
+    vertex.color = glm::vec3(primitive.colors.Get(index));
+  if (primitive.texCoords.data != nullptr)
+    vertex.tex = glm::vec2(primitive.texCoords.Get(index));
+  if (primitive.normals.data != nullptr)
+    vertex.normal = glm::vec3(primitive.normals.Get(index));
+  return vertex;
+}
+
+std::vector<SharedMesh>
+VulkanRenderer::_loadGlbFile(const std::string &glbFile,
+                             const MeshImportOptions &options) {
+  using Clock = std::chrono::steady_clock;
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  const auto loadStart = Clock::now();
+
+  const auto &layout = options.vertexLayout;
+  const size_t vertexStride = _getVertexStride(layout);
+  io::gltf::GlbFile file(glbFile);
+  const auto uploadStart = Clock::now();
+
+  std::vector<SharedMesh> result{};
+  std::vector<SharedImage> textures{};
+  std::vector<SharedImage> images(file.GetImages().size());
+  MeshImportStatistics statistics{};
+  for (const auto &primitive : file.GetPrimitives()) {
+    const size_t vertexCount = primitive.positions.count;
+    const auto &indexView = primitive.indices;
+    const size_t indexCount =
+        indexView.data != nullptr ? indexView.count : vertexCount;
+    const bool shortIndices = vertexCount <= SHORT_INDEX_VERTICES;
 
-    std::vector<io::obj::Model::Indice> vertices(meshData->vertices.begin(),
-                                                 meshData->vertices.end());
-
-    // Build vertices
-    std::unordered_map<io::obj::Model::Indice, uint32_t,
-                       io::obj::Model::Indice::HashFunction>
-        indiceMap{};
-    std::vector<VertexData> vertexData{};
-    uint32_t index = 0;
-    for (const auto &vertex : vertices) {
-      const auto &coords = meshData->coordinates.at(
-          vertex.coordId - 1); // -1 as Ids start with 1
-      const auto &texCoords = meshData->textureCoords.at(vertex.texId - 1);
-      const auto &normals = meshData->normals.at(vertex.normalId - 1);
-      vertexData.push_back(
-          VertexData(coords, glm::vec3{1.0f, 1.0f, 1.0f}, texCoords, normals));
-      indiceMap.emplace(vertex, index);
-      index++;
+    // Tightly packed indices are copied from the mapping into the staging
+    // buffer, everything else has to be converted first
+    std::vector<uint16_t> shortIndexData{};
+    std::vector<uint32_t> indexData{};
+    ArrayProxy indices(nullptr, 0, 0, 0);
+    if (indexView.data != nullptr && indexView.IsTight() &&
+        indexView.componentType == io::gltf::ComponentType::eUnsignedShort)
+      indices = ArrayProxy((void *)indexView.data, indexCount * 2, 2,
+                           indexCount);
+    else if (indexView.data != nullptr && indexView.IsTight() &&
+             indexView.componentType ==
+                 io::gltf::ComponentType::eUnsignedInt)
+      indices = ArrayProxy((void *)indexView.data, indexCount * 4, 4,
+                           indexCount);
+    else {
+      for (size_t i = 0; i < indexCount; i++) {
+        const uint32_t index =
+            indexView.data != nullptr ? indexView.GetIndex(i) : (uint32_t)i;
+        if (shortIndices)
+          shortIndexData.push_back((uint16_t)index);
+        else
+          indexData.push_back(index);
+      }
+      indices = shortIndices ? ArrayProxy(shortIndexData)
+                             : ArrayProxy(indexData);
     }
 
-    // Build indices list
-    std::vector<uint32_t> indiceData{};
-    for (const auto &face : meshData->faces)
-      for (const auto &indice : face)
-        indiceData.push_back(indiceMap[indice]);
+    // Vertices are interleaved straight into the staging memory
+    auto writeNodes = [&primitive, &layout, vertexCount](void *destination) {
+      auto *out = (uint8_t *)destination;
+      for (size_t i = 0; i < vertexCount; i++)
+        out = _packVertex(_readGlbVertex(primitive, i), layout, out);
+    };
+    auto writeIndices = [&indices](void *destination) {
+      std::memcpy(destination, indices.data, indices.dataSize);
+    };
+    result.push_back(std::make_shared<Mesh>(
+        _vertexArena, _indexArena, vertexCount, vertexStride, writeNodes,
+        indexCount,
+        indices.elementSize == sizeof(uint16_t) ? vk::IndexType::eUint16
+                                                : vk::IndexType::eUint32,
+        writeIndices));
+    statistics.vertexBytes += vertexCount * vertexStride;
+    statistics.indexBytes += indices.dataSize;
+    statistics.indexBytesSaved += indexCount * sizeof(uint32_t) -
+                                  indices.dataSize;
 
-    result.push_back(CreateMesh(vertexData, indiceData));
+    // Images are decoded once, no matter how many meshes use them
+    if (options.baseColorTextures == nullptr)
+      continue;
+    SharedImage texture = nullptr;
+    if (primitive.material >= 0) {
+      const auto &material = file.GetMaterials()[(size_t)primitive.material];
+      if (material.baseColorImage >= 0) {
+        const auto imageIndex = (size_t)material.baseColorImage;
+        const auto &image = file.GetImages()[imageIndex];
+        if (images[imageIndex] == nullptr && image.data != nullptr)
+          images[imageIndex] = std::make_shared<Image>(
+              (const unsigned char *)image.data, image.size);
+        else if (images[imageIndex] == nullptr && !image.path.empty())
+          images[imageIndex] = std::make_shared<Image>(image.path.string());
+        texture = images[imageIndex];
+      }
+    }
+    textures.push_back(texture);
+  }
+  const auto uploadEnd = Clock::now();
+
+  if (options.baseColorTextures != nullptr)
+    *options.baseColorTextures = std::move(textures);
+  if (options.statistics != nullptr) {
+    statistics.loadTime = Milliseconds(uploadStart - loadStart).count();
+    statistics.uploadTime = Milliseconds(uploadEnd - uploadStart).count();
+    *options.statistics = statistics;
   }
   return result;
 }
 
+std::vector<SharedMesh>
+VulkanRenderer::LoadGlbFile(const std::string &glbFile,
+                            const MeshImportOptions &options) {
+  using Clock = std::chrono::steady_clock;
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  auto meshes = _loadGlbFile(glbFile, options);
+
+  const auto uploadStart = Clock::now();
+  _uploadMeshes(meshes);
+  if (options.statistics != nullptr)
+    options.statistics->uploadTime +=
+        Milliseconds(Clock::now() - uploadStart).count();
+  return meshes;
+}
+
+bool VulkanRenderer::IsMeshReady(SharedMesh mesh) { return mesh->IsReady(); }
+
 void VulkanRenderer::SetSceneMaterial(SharedISceneMaterial material) {
   _sceneMaterial = material;
 }
 
-void VulkanRenderer::Draw(SharedMesh mesh) {
-  mesh->Draw(*_currentRecordBuffer);
+void VulkanRenderer::Draw(const SharedMesh &mesh) {
+  mesh->Draw(*_currentRecordBuffer, _meshBindings);
+}
+
+void VulkanRenderer::Draw(const SharedMesh &mesh,
+                          const SharedIMaterial &material) {
+  material->__getImpl()->WriteAttributes();
+  _boundPipeline->GetDescriptorGroup()->Bind(
+      *_currentRecordBuffer, _currentFrame->GetPipelineLayout());
+  mesh->Draw(*_currentRecordBuffer, _meshBindings);
+}
+
+void VulkanRenderer::Draw(const SharedMesh &mesh, float projectedSize) {
+  mesh->Draw(*_currentRecordBuffer, _meshBindings, projectedSize);
 }
 
-void VulkanRenderer::Draw(SharedMesh mesh, SharedIMaterial material) {
+void VulkanRenderer::Draw(const SharedMesh &mesh,
+                          const SharedIMaterial &material,
+                          float projectedSize) {
   material->__getImpl()->WriteAttributes();
   _boundPipeline->GetDescriptorGroup()->Bind(
       *_currentRecordBuffer, _currentFrame->GetPipelineLayout());
-  mesh->Draw(*_currentRecordBuffer);
+  mesh->Draw(*_currentRecordBuffer, _meshBindings, projectedSize);
 }
 
 void VulkanRenderer::SelectFrame(renderer::SharedFrame frame) {
   _currentFrame = frame;
   _currentRecordBuffer = _currentFrame->GetCommandBuffer();
+  _meshBindings = {};
+  _vertexArena->NextFrame();
+  _indexArena->NextFrame();
+  _defragmenter->Step();
+  _processUploads();
 }
 
 void VulkanRenderer::RecreateSwapchain() {
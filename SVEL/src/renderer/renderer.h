@@ -15,14 +15,26 @@
 #include "frame.h"
 
 // Internal
+#include <core/barrier.h>
 #include <core/device.h>
 #include <core/surface.h>
 #include <core/swapchain.h>
+#include <renderer/defragmenter.h>
+#include <renderer/render_target_pool.h>
+#include <renderer/mesh/mesh.h>
+#include <renderer/mesh/mesh_arena.h>
 #include <renderer/pipeline/pipeline.h>
 #include <svel/detail/renderer.h>
 #include <svel/util/array_proxy.hpp>
 #include <util/downcast_impl.hpp>
 
+// STL
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
 /**
  * @brief Concrete implementation of the Renderer Interface for Vulkan.
  */
@@ -58,6 +70,31 @@ private:
    */
   vk::CommandPool _persistentCommandPool;
 
+  /**
+   * @brief A command pool of the transfer queue family for uploads.
+   */
+  vk::CommandPool _transferCommandPool;
+
+  /**
+   * @brief Holds the vertices of all meshes.
+   */
+  renderer::SharedMeshArena _vertexArena;
+
+  /**
+   * @brief Holds the indices of all meshes.
+   */
+  renderer::SharedMeshArena _indexArena;
+
+  /**
+   * @brief Attachments that pipelines share.
+   */
+  renderer::SharedRenderTargetPool _renderTargets;
+
+  /**
+   * @brief Compacts the arenas and the texture memory over time.
+   */
+  renderer::UniqueDefragmenter _defragmenter;
+
   /**
    * @brief The currently used scene material.
    */
@@ -68,6 +105,132 @@ private:
    */
   renderer::SharedVulkanPipeline _boundPipeline;
 
+  /**
+   * @brief Mesh buffers bound to the current command buffer.
+   */
+  SVEL_NAMESPACE::Mesh::Bindings _meshBindings;
+
+  /**
+   * @brief Optimizes a copy of the mesh data if requested and creates the mesh.
+   *
+   * @tparam T                          Index type.
+   * @param nodes                       Point data.
+   * @param indices                     Indices of the mesh.
+   * @param options                     Optimizations to apply.
+   * @return SVEL_NAMESPACE::SharedMesh Created Mesh.
+   */
+  template <typename T>
+  SVEL_NAMESPACE::SharedMesh
+  _createMesh(const SVEL_NAMESPACE::ArrayProxy &nodes,
+              const std::vector<T> &indices,
+              const SVEL_NAMESPACE::MeshOptimizationOptions &options);
+
+  /**
+   * @brief Copies the mesh data and creates the mesh on a worker thread.
+   *
+   * @tparam T                                        Index type.
+   * @param nodes                                     Point data.
+   * @param indices                                   Indices of the mesh.
+   * @param options                                   Optimizations to apply.
+   * @return std::future<SVEL_NAMESPACE::SharedMesh>  The staged Mesh.
+   */
+  template <typename T>
+  std::future<SVEL_NAMESPACE::SharedMesh>
+  _createMeshAsync(const SVEL_NAMESPACE::ArrayProxy &nodes,
+                   const std::vector<T> &indices,
+                   const SVEL_NAMESPACE::MeshOptimizationOptions &options);
+
+  /**
+   * @brief Loads an OBJ file and stages its meshes without uploading them.
+   *
+   * @param objFile                                   File to load.
+   * @param options                                   Options for the import.
+   * @return std::vector<SVEL_NAMESPACE::SharedMesh>  Staged Meshes.
+   */
+  std::vector<SVEL_NAMESPACE::SharedMesh>
+  _loadObjFile(const std::string &objFile,
+               const SVEL_NAMESPACE::MeshImportOptions &options);
+
+  /**
+   * @brief Loads a binary glTF file and stages its meshes without uploading
+   * them.
+   *
+   * @param glbFile                                   File to load.
+   * @param options                                   Options for the import.
+   * @return std::vector<SVEL_NAMESPACE::SharedMesh>  Staged Meshes.
+   */
+  std::vector<SVEL_NAMESPACE::SharedMesh>
+  _loadGlbFile(const std::string &glbFile,
+               const SVEL_NAMESPACE::MeshImportOptions &options);
+
+  /**
+   * @brief Guards the meshes that wait for the submission of their upload.
+   */
+  std::mutex _uploadMutex;
+
+  /**
+   * @brief Staged meshes whose upload has not been submitted yet.
+   */
+  std::vector<SVEL_NAMESPACE::SharedMesh> _queuedUploads;
+
+  /**
+   * @brief Barriers of submitted uploads that did not complete yet. Only used
+   * by the render thread.
+   */
+  std::vector<core::SharedBarrier> _uploadBarriers;
+
+  /**
+   * @brief Guards the count of running tasks.
+   */
+  std::mutex _taskMutex;
+
+  /**
+   * @brief Signals that a task finished.
+   */
+  std::condition_variable _taskFinished;
+
+  /**
+   * @brief Amount of worker tasks that are still running.
+   */
+  size_t _runningTasks = 0;
+
+  /**
+   * @brief Runs a task on a worker thread. The renderer is not destroyed
+   * before the task finished.
+   *
+   * @tparam Task                          Callable without parameters.
+   * @param task                           The task.
+   * @return std::future<decltype(task())> Result of the task.
+   */
+  template <typename Task>
+  auto _runAsync(Task task) -> std::future<decltype(task())>;
+
+  /**
+   * @brief Marks a worker task as finished.
+   */
+  void _finishTask();
+
+  /**
+   * @brief Uploads staged meshes and waits for the upload to complete.
+   *
+   * @param meshes Meshes to upload.
+   */
+  void _uploadMeshes(const std::vector<SVEL_NAMESPACE::SharedMesh> &meshes);
+
+  /**
+   * @brief Queues staged meshes for upload by the render thread. May be called
+   * from any thread.
+   *
+   * @param meshes Meshes to upload.
+   */
+  void _queueUploads(const std::vector<SVEL_NAMESPACE::SharedMesh> &meshes);
+
+  /**
+   * @brief Submits queued uploads and releases completed ones, without
+   * waiting.
+   */
+  void _processUploads();
+
 public:
   /**
    * @brief Construct a Vulkan Renderer.
@@ -141,6 +304,17 @@ public:
   SVEL_NAMESPACE::SharedTexture
   CreateTexture(SVEL_NAMESPACE::SharedImage image) override;
 
+  /**
+   * @brief Creates a texture that is never moved by the defragmenter. Needed
+   * for textures that descriptor sets reference for their whole lifetime, as
+   * the sets keep the image of the texture when it is created.
+   *
+   * @param image                           Image used for texture.
+   * @return SVEL_NAMESPACE::SharedTexture  Created texture.
+   */
+  SVEL_NAMESPACE::SharedTexture
+  CreatePinnedTexture(SVEL_NAMESPACE::SharedImage image);
+
   /**
    * @brief Implementation of the CreateAnimation Interface.
    *
@@ -169,31 +343,107 @@ public:
    *
    * @param nodes                       Point data.
    * @param indices                     Indices of the mesh.
+   * @param options                     Optimizations to apply.
    * @return SVEL_NAMESPACE::SharedMesh Created Mesh.
    */
   SVEL_NAMESPACE::SharedMesh
   CreateMesh(const SVEL_NAMESPACE::ArrayProxy &nodes,
-             const std::vector<uint16_t> &indices) override;
+             const std::vector<uint16_t> &indices,
+             const SVEL_NAMESPACE::MeshOptimizationOptions &options) override;
 
   /**
    * @brief Implementation of the CreateMesh Interface.
    *
    * @param nodes                       Point data.
    * @param indices                     Indices of the mesh.
+   * @param options                     Optimizations to apply.
    * @return SVEL_NAMESPACE::SharedMesh Created Mesh.
    */
   SVEL_NAMESPACE::SharedMesh
   CreateMesh(const SVEL_NAMESPACE::ArrayProxy &nodes,
-             const std::vector<uint32_t> &indices) override;
+             const std::vector<uint32_t> &indices,
+             const SVEL_NAMESPACE::MeshOptimizationOptions &options) override;
+
+  /**
+   * @brief Implementation of the CreateMeshAsync Interface.
+   *
+   * @param nodes                                     Point data.
+   * @param indices                                   Indices of the mesh.
+   * @param options                                   Optimizations to apply.
+   * @return std::future<SVEL_NAMESPACE::SharedMesh>  The staged Mesh.
+   */
+  std::future<SVEL_NAMESPACE::SharedMesh> CreateMeshAsync(
+      const SVEL_NAMESPACE::ArrayProxy &nodes,
+      const std::vector<uint16_t> &indices,
+      const SVEL_NAMESPACE::MeshOptimizationOptions &options) override;
+
+  /**
+   * @brief Implementation of the CreateMeshAsync Interface.
+   *
+   * @param nodes                                     Point data.
+   * @param indices                                   Indices of the mesh.
+   * @param options                                   Optimizations to apply.
+   * @return std::future<SVEL_NAMESPACE::SharedMesh>  The staged Mesh.
+   */
+  std::future<SVEL_NAMESPACE::SharedMesh> CreateMeshAsync(
+      const SVEL_NAMESPACE::ArrayProxy &nodes,
+      const std::vector<uint32_t> &indices,
+      const SVEL_NAMESPACE::MeshOptimizationOptions &options) override;
 
   /**
    * @brief Implementation of the LoadObjFile Interface.
    *
    * @param objFile                                   File to load.
+   * @param options                                   Options for the import.
+   * @return std::vector<SVEL_NAMESPACE::SharedMesh>  Loaded Meshes.
+   */
+  std::vector<SVEL_NAMESPACE::SharedMesh>
+  LoadObjFile(const std::string &objFile,
+              const SVEL_NAMESPACE::MeshImportOptions &options) override;
+
+  /**
+   * @brief Implementation of the LoadGlbFile Interface.
+   *
+   * @param glbFile                                   File to load.
+   * @param options                                   Options for the import.
    * @return std::vector<SVEL_NAMESPACE::SharedMesh>  Loaded Meshes.
    */
   std::vector<SVEL_NAMESPACE::SharedMesh>
-  LoadObjFile(const std::string &objFile) override;
+  LoadGlbFile(const std::string &glbFile,
+              const SVEL_NAMESPACE::MeshImportOptions &options) override;
+
+  /**
+   * @brief Implementation of the LoadObjFileAsync Interface.
+   *
+   * @param objFile File to load.
+   * @param options Options for the import.
+   * @return std::future<std::vector<SVEL_NAMESPACE::SharedMesh>> Staged
+   *                Meshes.
+   */
+  std::future<std::vector<SVEL_NAMESPACE::SharedMesh>>
+  LoadObjFileAsync(const std::string &objFile,
+                   const SVEL_NAMESPACE::MeshImportOptions &options) override;
+
+  /**
+   * @brief Implementation of the LoadObjFilesAsync Interface.
+   *
+   * @param objFiles  Files to load.
+   * @param options   Options for every import.
+   * @return std::vector<std::future<std::vector<SVEL_NAMESPACE::SharedMesh>>>
+   *                  Staged Meshes of every file.
+   */
+  std::vector<std::future<std::vector<SVEL_NAMESPACE::SharedMesh>>>
+  LoadObjFilesAsync(const std::vector<std::string> &objFiles,
+                    const SVEL_NAMESPACE::MeshImportOptions &options) override;
+
+  /**
+   * @brief Implementation of the IsMeshReady Interface.
+   *
+   * @param mesh    Mesh to check.
+   * @return true   Mesh is uploaded.
+   * @return false  Mesh is still uploading.
+   */
+  bool IsMeshReady(SVEL_NAMESPACE::SharedMesh mesh) override;
 
   /**
    * @brief Implementation of the SetSceneMaterial Interface.
@@ -207,7 +457,7 @@ public:
    *
    * @param mesh Mesh to draw.
    */
-  void Draw(SVEL_NAMESPACE::SharedMesh mesh) override;
+  void Draw(const SVEL_NAMESPACE::SharedMesh &mesh) override;
 
   /**
    * @brief Implementation of the Draw Interface.
@@ -215,16 +465,47 @@ public:
    * @param mesh      Mesh to draw.
    * @param material  Material to use.
    */
-  void Draw(SVEL_NAMESPACE::SharedMesh mesh,
-            SVEL_NAMESPACE::SharedIMaterial material) override;
+  void Draw(const SVEL_NAMESPACE::SharedMesh &mesh,
+            const SVEL_NAMESPACE::SharedIMaterial &material) override;
+
+  /**
+   * @brief Implementation of the Draw Interface.
+   *
+   * @param mesh          Mesh to draw.
+   * @param projectedSize Size of the mesh on screen in pixels.
+   */
+  void Draw(const SVEL_NAMESPACE::SharedMesh &mesh,
+            float projectedSize) override;
 
   /**
-   * @brief Switch out the frame to which the renderer draws to.
+   * @brief Implementation of the Draw Interface.
+   *
+   * @param mesh          Mesh to draw.
+   * @param material      Material to use.
+   * @param projectedSize Size of the mesh on screen in pixels.
+   */
+  void Draw(const SVEL_NAMESPACE::SharedMesh &mesh,
+            const SVEL_NAMESPACE::SharedIMaterial &material,
+            float projectedSize) override;
+
+  /**
+   * @brief Switch out the frame to which the renderer draws to. Also submits
+   * queued uploads, finishes completed ones and compacts memory a little.
    *
    * @param frame The new frame to draw to.
    */
   void SelectFrame(renderer::SharedFrame frame);
 
+  /**
+   * @brief Getter for the fragmentation of the device memory and the progress
+   * of its compaction.
+   *
+   * @return renderer::Defragmenter::Statistics The statistics.
+   */
+  renderer::Defragmenter::Statistics GetDefragmenterStatistics() {
+    return _defragmenter->GetStatistics();
+  }
+
   /**
    * @brief Lets the renderer recreate the swapchain.
    */
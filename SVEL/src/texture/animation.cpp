@@ -18,8 +18,7 @@ using namespace texture;
 using namespace SVEL_NAMESPACE;
 
 VulkanAnimation::VulkanAnimation(core::SharedDevice device,
-                                 vk::CommandPool &commandPool,
-                                 core::SharedBarrier barrier,
+                                 core::UploadBatch &batch,
                                  const std::vector<SharedImage> &images,
                                  float animationSpeed, bool looping)
     : _isLooping(looping), _speed((unsigned int)(animationSpeed * 1000000)) {
@@ -31,7 +30,7 @@ VulkanAnimation::VulkanAnimation(core::SharedDevice device,
   // Create a texture for every frame of the animation
   for (auto image : images) {
     auto texture = std::make_shared<Texture>(device, image);
-    texture->Dispatch(commandPool, barrier);
+    texture->Dispatch(batch);
     _textures.push_back(texture);
   }
 
@@ -70,6 +69,11 @@ void VulkanAnimation::Update(float frametime) {
   _imageInfo = _textures.at(_microSecondsPassed / _speed)->GetImageInfo();
 }
 
+vk::DescriptorImageInfo &VulkanAnimation::GetImageInfo() {
+  _imageInfo = _textures.at(_microSecondsPassed / _speed)->GetImageInfo();
+  return _imageInfo;
+}
+
 SVEL_NAMESPACE::SharedTexture VulkanAnimation::GetTexture() const {
   return _textures.at(_microSecondsPassed / _speed);
 }
@@ -66,14 +66,12 @@ public:
    * @brief Construct a Vulkan Animation.
    *
    * @param device          Device to use.
-   * @param commandPool     Command pool to use for transfering data.
-   * @param barrier         Barrier to use.
+   * @param batch           Batch into which the frames are recorded.
    * @param images          Images that the animation should contain.
    * @param animationSpeed  Playback speed in frames per second.
    * @param looping         Is the animation looping?
    */
-  VulkanAnimation(core::SharedDevice device, vk::CommandPool &commandPool,
-                  core::SharedBarrier barrier,
+  VulkanAnimation(core::SharedDevice device, core::UploadBatch &batch,
                   const std::vector<SVEL_NAMESPACE::SharedImage> &images,
                   float animationSpeed, bool looping);
 
@@ -108,6 +106,25 @@ public:
    * @return SVEL_NAMESPACE::SharedTexture The current texture.
    */
   SVEL_NAMESPACE::SharedTexture GetTexture() const override;
+
+  /**
+   * @brief Getter for the image info of the current frame. Read from its
+   * texture on every call, because textures may move to other memory.
+   *
+   * @return vk::DescriptorImageInfo& The image info.
+   */
+  vk::DescriptorImageInfo &GetImageInfo() override;
+
+  /**
+   * @brief Getter for the textures of all frames.
+   *
+   * @return const std::vector<std::shared_ptr<SVEL_NAMESPACE::Texture>>&
+   * The textures in playback order.
+   */
+  const std::vector<std::shared_ptr<SVEL_NAMESPACE::Texture>> &
+  GetTextures() const {
+    return _textures;
+  }
 };
 } // namespace texture
 
@@ -17,8 +17,7 @@
 using namespace texture;
 
 VulkanTextureAtlas::VulkanTextureAtlas(core::SharedDevice device,
-                                       vk::CommandPool &commandPool,
-                                       core::SharedBarrier barrier,
+                                       core::UploadBatch &batch,
                                        SVEL_NAMESPACE::SharedImage img,
                                        unsigned int tileCountX,
                                        unsigned int tileCountY)
@@ -29,7 +28,7 @@ VulkanTextureAtlas::VulkanTextureAtlas(core::SharedDevice device,
       _tileCountY(tileCountY) {
 
   _texture = std::make_shared<SVEL_NAMESPACE::Texture>(device, img);
-  _texture->Dispatch(commandPool, barrier);
+  _texture->Dispatch(batch);
   _imageInfo = _texture->GetImageInfo();
 }
 
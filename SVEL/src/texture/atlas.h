@@ -68,14 +68,12 @@ public:
    * @brief Construct a Vulkan Texture Atlas.
    *
    * @param device      Device to use.
-   * @param commandPool Command pool to use for texture dispatching.
-   * @param barrier     Barrier for the texture dispatch.
+   * @param batch       Batch into which the texture is recorded.
    * @param img         Image to use.
    * @param tileCountX  How many tiles in x dimension.
    * @param tileCountY  How many tiles in y dimension.
    */
-  VulkanTextureAtlas(core::SharedDevice device, vk::CommandPool &commandPool,
-                     core::SharedBarrier barrier,
+  VulkanTextureAtlas(core::SharedDevice device, core::UploadBatch &batch,
                      SVEL_NAMESPACE::SharedImage img, unsigned int tileCountX,
                      unsigned int tileCountY);
 
@@ -98,6 +96,16 @@ public:
    * @return SVEL_NAMESPACE::SharedTexture The atlas texture.
    */
   SVEL_NAMESPACE::SharedTexture GetTexture() const override;
+
+  /**
+   * @brief Getter for the image info of the atlas texture, which changes when
+   * the texture moves to other memory.
+   *
+   * @return vk::DescriptorImageInfo& The image info.
+   */
+  vk::DescriptorImageInfo &GetImageInfo() override {
+    return _texture->GetImageInfo();
+  }
 };
 
 } // namespace texture
@@ -28,11 +28,7 @@ Image::Image(const Extent &size, int channels, int dataChannels,
     : _size(size), _channels(channels), _dataChannels(dataChannels),
       _data(data), _dataSize(dataSize) {}
 
-Image::Image(const std::string &_path) {
-  // Load using stb
-  int width, height;
-  _data = stbi_load(_path.c_str(), &width, &height, &_channels, STBI_rgb_alpha);
-
+void Image::_handleLoad(int width, int height) {
   // Validate return value
   if (_data == nullptr)
     throw std::runtime_error(
@@ -50,6 +46,24 @@ Image::Image(const std::string &_path) {
   _loadedFromFile = true;
 }
 
+Image::Image(const std::string &_path) {
+  // Load using stb
+  int width, height;
+  _data = stbi_load(_path.c_str(), &width, &height, &_channels, STBI_rgb_alpha);
+  _handleLoad(width, height);
+}
+
+Image::Image(const unsigned char *encoded, size_t encodedSize) {
+  if (encodedSize > (size_t)INT32_MAX)
+    throw std::invalid_argument("Encoded image is too large.");
+
+  // Load using stb
+  int width, height;
+  _data = stbi_load_from_memory(encoded, (int)encodedSize, &width, &height,
+                                &_channels, STBI_rgb_alpha);
+  _handleLoad(width, height);
+}
+
 Image::~Image() {
   // Check which deleter to use. TODO: automate this?
   if (_loadedFromFile)
@@ -22,53 +22,48 @@
 #include <vulkan/vulkan_structs.hpp>
 
 // STL
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <memory>
 #include <stdexcept>
 
 using namespace SVEL_NAMESPACE;
 
-core::SharedBuffer Texture::_createStagingBuffer(SharedImage img) {
-  // Create Staging Buffer
+core::UniqueStagingMemory Texture::_createStagingMemory(SharedImage img) {
+  // Take Staging Memory, copies start at a multiple of the texel size
   auto imgSize = img->GetSize();
-  auto stagingBuffer = std::make_shared<core::Buffer>(
-      _device, imgSize, vk::BufferUsageFlagBits::eTransferSrc,
-      vk::MemoryPropertyFlagBits::eHostVisible |
-          vk::MemoryPropertyFlagBits::eHostCoherent);
-
-  // Copy Data into stagingBuffer
-  auto vulkanDevice = _device->AsVulkanObj();
-  auto dst = vulkanDevice.mapMemory(stagingBuffer->GetMemory(), 0, imgSize,
-                                    vk::MemoryMapFlags());
-  std::memcpy(dst, img->GetData(), imgSize);
-  vulkanDevice.unmapMemory(stagingBuffer->GetMemory());
-  return stagingBuffer;
+  const auto alignment = std::max<vk::DeviceSize>(
+      16, _device->GetPhysicalDevice()
+              .getProperties()
+              .limits.optimalBufferCopyOffsetAlignment);
+  auto staging =
+      std::make_unique<core::StagingMemory>(_device, imgSize, alignment);
+
+  // Copy Data into the staging memory
+  std::memcpy(staging->GetData(), img->GetData(), imgSize);
+  return staging;
 }
 
-void Texture::_createImage(SharedImage _img) {
-  auto vulkanDevice = _device->AsVulkanObj();
-
-  // Create Vulkan Image
+vk::Image Texture::_createImage() {
+  // Transfer source allows the image to be moved to other memory
   auto imageCreateInfo = vk::ImageCreateInfo(
       vk::ImageCreateFlags(), vk::ImageType::e2D, vk::Format::eR8G8B8A8Srgb,
-      {_img->GetExtent().width, _img->GetExtent().height, 1}, 1, 1,
-      vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
-      vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+      {_dim.width, _dim.height, 1}, 1, 1, vk::SampleCountFlagBits::e1,
+      vk::ImageTiling::eOptimal,
+      vk::ImageUsageFlagBits::eTransferSrc |
+          vk::ImageUsageFlagBits::eTransferDst |
+          vk::ImageUsageFlagBits::eSampled,
       vk::SharingMode::eExclusive, {}, vk::ImageLayout::ePreinitialized);
-  _image = vulkanDevice.createImage(imageCreateInfo);
-
-  // Allocate Image Memory
-  auto memRequirements = vulkanDevice.getImageMemoryRequirements(_image);
-  _imageMemory = std::make_unique<core::DeviceMemory>(
-      _device, memRequirements, vk::MemoryPropertyFlagBits::eDeviceLocal);
-  vulkanDevice.bindImageMemory(_image, _imageMemory->AsVulkanObj(), 0);
+  return _device->AsVulkanObj().createImage(imageCreateInfo);
+}
 
-  // Create Image View
+vk::ImageView Texture::_createImageView(vk::Image image) {
   auto imageViewInfo = vk::ImageViewCreateInfo(
-      vk::ImageViewCreateFlagBits(), _image, vk::ImageViewType::e2D,
+      vk::ImageViewCreateFlagBits(), image, vk::ImageViewType::e2D,
       vk::Format::eR8G8B8A8Srgb, vk::ComponentMapping(),
       vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
-  _imageView = vulkanDevice.createImageView(imageViewInfo);
+  return _device->AsVulkanObj().createImageView(imageViewInfo);
 }
 
 void Texture::_createSampler() {
@@ -92,28 +87,26 @@ Texture::Texture(core::SharedDevice device, SharedImage img) : _device(device) {
     throw std::runtime_error("Image has no data");
 
   // Create Buffers/Structs
-  _stagingBuffer = _createStagingBuffer(img);
+  _staging = _createStagingMemory(img);
   _dim = img->GetExtent();
-  _createImage(img);
+  auto vulkanDevice = _device->AsVulkanObj();
+  _image = _createImage();
+
+  // Allocate Image Memory
+  auto memRequirements = vulkanDevice.getImageMemoryRequirements(_image);
+  _imageMemory = std::make_shared<core::DeviceMemory>(
+      _device, memRequirements, vk::MemoryPropertyFlags(),
+      vk::MemoryPropertyFlagBits::eDeviceLocal, false);
+  vulkanDevice.bindImageMemory(_image, _imageMemory->AsVulkanObj(),
+                               _imageMemory->GetOffset());
+
+  _imageView = _createImageView(_image);
   _createSampler();
   _updateImageInfo();
 }
 
-void Texture::Dispatch(vk::CommandPool &_commandPool,
-                       core::SharedBarrier _barrier) {
-  auto vulkanDevice = _device->AsVulkanObj();
-  // Create Fence
-  auto fence = std::make_shared<core::Fence>(_device);
-
-  // Create CommandBuffer
-  auto commandBufferAllocateInfo = vk::CommandBufferAllocateInfo(
-      _commandPool, vk::CommandBufferLevel::ePrimary, 1);
-  _commandBuffer =
-      vulkanDevice.allocateCommandBuffers(commandBufferAllocateInfo).front();
-
-  auto commandBufferBeginInfo = vk::CommandBufferBeginInfo(
-      vk::CommandBufferUsageFlagBits::eOneTimeSubmit, nullptr);
-  _commandBuffer.begin(commandBufferBeginInfo);
+void Texture::Dispatch(core::UploadBatch &batch) {
+  auto commandBuffer = batch.GetCommandBuffer();
 
   // Create Pre copy barrier
   auto layoutBarrier = vk::ImageMemoryBarrier(
@@ -121,39 +114,111 @@ void Texture::Dispatch(vk::CommandPool &_commandPool,
       vk::ImageLayout::ePreinitialized, vk::ImageLayout::eTransferDstOptimal,
       {}, {}, _image,
       vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
-  _commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eHost,
-                                 vk::PipelineStageFlagBits::eTransfer,
-                                 vk::DependencyFlags(), {}, {}, layoutBarrier);
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eHost,
+                                vk::PipelineStageFlagBits::eTransfer,
+                                vk::DependencyFlags(), {}, {}, layoutBarrier);
 
   // Copy Data into Image
   auto bufferImageCopy = vk::BufferImageCopy(
-      0, 0, 0,
+      _staging->GetOffset(), 0, 0,
       vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1),
       {0, 0, 0}, {_dim.width, _dim.height, 1});
-  _commandBuffer.copyBufferToImage(_stagingBuffer->AsVulkanObj(), _image,
-                                   vk::ImageLayout::eTransferDstOptimal,
-                                   bufferImageCopy);
+  commandBuffer.copyBufferToImage(_staging->GetBuffer(), _image,
+                                  vk::ImageLayout::eTransferDstOptimal,
+                                  bufferImageCopy);
 
-  // Post Copy Barrier
+  // Post Copy Barrier, recorded by the batch after all copies
   layoutBarrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
   layoutBarrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
   layoutBarrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal);
   layoutBarrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
-  _commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
-                                 vk::PipelineStageFlagBits::eAllCommands,
-                                 vk::DependencyFlags(), {}, {}, layoutBarrier);
-  _commandBuffer.end();
-
-  // Submit CommandBuffer
-  auto queue = vulkanDevice.getQueue(_device->GetGraphicsQueueFamily(), 0);
-  auto submitInfo =
-      vk::SubmitInfo(0, nullptr, nullptr, 1, &_commandBuffer, 0, nullptr);
-  queue.submit(submitInfo, fence->AsVulkanObj());
-
-  // Add Resource to Barrier
-  _barrier->AddResource(
-      fence,
-      std::bind(&Texture::_onUpload, this->shared_from_this(), _commandPool));
+  batch.HandOver(layoutBarrier);
+
+  // The batch keeps the texture alive until the upload completed
+  batch.AddNotifier(std::bind(&Texture::_onUpload, this->shared_from_this()));
+}
+
+void Texture::_onMoved(vk::Image image, core::SharedDeviceMemory memory,
+                       vk::ImageView view,
+                       std::function<void(core::Barrier::Notifier)> retire) {
+  // Frames in flight may still sample the old image
+  auto device = _device;
+  retire([device, oldImage = _image, oldMemory = _imageMemory,
+          oldView = _imageView]() {
+    auto vulkanDevice = device->AsVulkanObj();
+    vulkanDevice.destroyImageView(oldView);
+    vulkanDevice.destroyImage(oldImage);
+  });
+
+  _image = image;
+  _imageMemory = memory;
+  _imageView = view;
+  _updateImageInfo();
+  _moving = false;
+}
+
+bool Texture::Move(core::UploadBatch &batch,
+                   std::function<void(core::Barrier::Notifier)> retire) {
+  if (!_imageReady || _moving)
+    return false;
+
+  auto memory = _imageMemory->AllocateMoveTarget();
+  if (memory == nullptr)
+    return false;
+
+  // The image is created like the current one, so the memory fits
+  auto vulkanDevice = _device->AsVulkanObj();
+  auto image = _createImage();
+  vulkanDevice.bindImageMemory(image, memory->AsVulkanObj(),
+                               memory->GetOffset());
+  auto view = _createImageView(image);
+
+  // Draws of earlier frames may still sample the current image
+  auto range =
+      vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+  std::array<vk::ImageMemoryBarrier, 2> preCopyBarriers = {
+      vk::ImageMemoryBarrier(vk::AccessFlagBits::eShaderRead,
+                             vk::AccessFlagBits::eTransferRead,
+                             vk::ImageLayout::eShaderReadOnlyOptimal,
+                             vk::ImageLayout::eTransferSrcOptimal,
+                             VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                             _image, range),
+      vk::ImageMemoryBarrier({}, vk::AccessFlagBits::eTransferWrite,
+                             vk::ImageLayout::eUndefined,
+                             vk::ImageLayout::eTransferDstOptimal,
+                             VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                             image, range)};
+  auto commandBuffer = batch.GetCommandBuffer();
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands,
+                                vk::PipelineStageFlagBits::eTransfer,
+                                vk::DependencyFlags(), {}, {},
+                                preCopyBarriers);
+
+  auto imageCopy = vk::ImageCopy(
+      vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1),
+      {0, 0, 0},
+      vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1),
+      {0, 0, 0}, {_dim.width, _dim.height, 1});
+  commandBuffer.copyImage(_image, vk::ImageLayout::eTransferSrcOptimal, image,
+                          vk::ImageLayout::eTransferDstOptimal, imageCopy);
+
+  // Both images are sampled again after the batch
+  auto postCopyBarrier = preCopyBarriers[0];
+  postCopyBarrier.setSrcAccessMask(vk::AccessFlagBits::eTransferRead);
+  postCopyBarrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+  postCopyBarrier.setOldLayout(vk::ImageLayout::eTransferSrcOptimal);
+  postCopyBarrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+  batch.HandOver(postCopyBarrier);
+  postCopyBarrier.setImage(image);
+  postCopyBarrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+  postCopyBarrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal);
+  batch.HandOver(postCopyBarrier);
+
+  _moving = true;
+  core::SharedDeviceMemory target = std::move(memory);
+  batch.AddNotifier(std::bind(&Texture::_onMoved, this->shared_from_this(),
+                              image, target, view, std::move(retire)));
+  return true;
 }
 
 Texture::~Texture() {
@@ -17,6 +17,8 @@
 #include <core/device.h>
 #include <core/memory/buffer.h>
 #include <core/memory/device_memory.h>
+#include <core/memory/staging_memory.h>
+#include <core/memory/upload_batch.h>
 #include <svel/detail/image.h>
 
 // Vulkan
@@ -24,6 +26,7 @@
 
 // STL
 #include <atomic>
+#include <functional>
 #include <memory>
 
 namespace SVEL_NAMESPACE {
@@ -52,7 +55,7 @@ private:
   /**
    * @brief Memory of the Vulkan image.
    */
-  core::UniqueDeviceMemory _imageMemory;
+  core::SharedDeviceMemory _imageMemory;
 
   /**
    * @brief The image view of the texture.
@@ -60,15 +63,14 @@ private:
   vk::ImageView _imageView;
 
   /**
-   * @brief Command buffer? TODO: why is this here?
-   *
+   * @brief Is the image ready?
    */
-  vk::CommandBuffer _commandBuffer;
+  std::atomic<bool> _imageReady = false;
 
   /**
-   * @brief Is the image ready?
+   * @brief Is a copy to other memory in flight?
    */
-  std::atomic<bool> _imageReady = false;
+  bool _moving = false;
 
   /**
    * @brief Dimension of the image.
@@ -76,24 +78,32 @@ private:
   Extent _dim;
 
   /**
-   * @brief The staging buffer for the image.
+   * @brief The staging memory for the image.
    */
-  core::SharedBuffer _stagingBuffer;
+  core::UniqueStagingMemory _staging;
 
   /**
-   * @brief Create a Staging Buffer.
+   * @brief Create the staging memory.
    *
-   * @param _img                Image to create the staging buffer for.
-   * @return core::SharedBuffer The created buffer.
+   * @param _img                        Image to create the staging memory for.
+   * @return core::UniqueStagingMemory  The staging memory.
    */
-  core::SharedBuffer _createStagingBuffer(SharedImage _img);
+  core::UniqueStagingMemory _createStagingMemory(SharedImage _img);
 
   /**
-   * @brief Create the image from the user defined image.
+   * @brief Create a Vulkan image of the dimension of the texture.
    *
-   * @param _img The user image.
+   * @return vk::Image The image without memory.
    */
-  void _createImage(SharedImage _img);
+  vk::Image _createImage();
+
+  /**
+   * @brief Create a view of an image of the texture.
+   *
+   * @param image             The image.
+   * @return vk::ImageView    The view.
+   */
+  vk::ImageView _createImageView(vk::Image image);
 
   /**
    * @brief Creates the sampler.
@@ -107,15 +117,24 @@ private:
 
   /**
    * @brief Handles the completed upload to the Graphics Unit.
-   *
-   * @param _commandPool The used command pool.
    */
-  void _onUpload(vk::CommandPool &_commandPool) {
-    _device->AsVulkanObj().freeCommandBuffers(_commandPool, _commandBuffer);
+  void _onUpload() {
     _imageReady = true;
-    _stagingBuffer.reset();
+    _staging.reset();
   }
 
+  /**
+   * @brief Switches to the image the texture was copied to.
+   *
+   * @param image   The new image.
+   * @param memory  Memory of the new image.
+   * @param view    View of the new image.
+   * @param retire  Receives the deleter of the old image.
+   */
+  void _onMoved(vk::Image image, core::SharedDeviceMemory memory,
+                vk::ImageView view,
+                std::function<void(core::Barrier::Notifier)> retire);
+
 public:
   /**
    * @brief Construct a Texture.
@@ -131,13 +150,37 @@ public:
   ~Texture();
 
   /**
-   * @brief Dispatches the Texture to the Graphics Unit. Must be called once
-   * after initialization and before any usage occurs.
+   * @brief Records the dispatch of the Texture to the Graphics Unit into the
+   * batch. Must be called once after initialization and the batch has to be
+   * flushed before any usage occurs.
+   *
+   * @param batch Batch to record into.
+   */
+  void Dispatch(core::UploadBatch &batch);
+
+  /**
+   * @brief Records a copy of the image into memory that lets a fragmented
+   * block be released. The texture switches to the new image once the batch
+   * completed, which updates its image info. Draws recorded until then keep
+   * reading the old image, so its deleter is handed to the caller, who has to
+   * run it after the frames in flight completed. The batch has to record into
+   * the graphics queue.
+   *
+   * @param batch   The batch whose flush submits the copy.
+   * @param retire  Receives the deleter of the old image on completion.
+   * @return true   The copy was recorded.
+   * @return false  The texture is not ready, already moving or its memory
+   *                should stay where it is.
+   */
+  bool Move(core::UploadBatch &batch,
+            std::function<void(core::Barrier::Notifier)> retire);
+
+  /**
+   * @brief Getter for the size of the image memory.
    *
-   * @param _commandPool  Command pool to use.
-   * @param _barrier      Barrier to use.
+   * @return vk::DeviceSize Size in bytes.
    */
-  void Dispatch(vk::CommandPool &_commandPool, core::SharedBarrier _barrier);
+  vk::DeviceSize GetMemorySize() const { return _imageMemory->GetSize(); }
 };
 
 } // namespace SVEL_NAMESPACE
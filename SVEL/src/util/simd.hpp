@@ -0,0 +1,209 @@
+/**
+ * @file simd.hpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Detects SIMD support and defines a portable four lane float type.
+ * @date 2023-09-24
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __UTIL_SIMD_HPP__
+#define __UTIL_SIMD_HPP__
+
+/**
+ * @brief SVEL_SSE2 is defined if SSE2 intrinsics may be used. Defining
+ * SVEL_NO_SIMD forces the scalar code paths.
+ */
+#if !defined(SVEL_NO_SIMD) &&                                                  \
+    (defined(__SSE2__) || defined(_M_X64) ||                                   \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SVEL_SSE2
+#include <emmintrin.h>
+#endif
+
+// STL
+#include <cmath>
+
+namespace util {
+
+/**
+ * @brief Four floats that are processed at once. Maps to an SSE register if
+ * available and to a plain array otherwise, so algorithms are written once.
+ */
+struct Float4 {
+#ifdef SVEL_SSE2
+  /**
+   * @brief The lanes.
+   */
+  __m128 lanes;
+
+  /**
+   * @brief Construct Float4 from a register.
+   *
+   * @param value The register.
+   */
+  explicit Float4(__m128 value) : lanes(value) {}
+
+  /**
+   * @brief Construct Float4 with all lanes set to the value.
+   *
+   * @param value The value.
+   */
+  Float4(float value) : lanes(_mm_set1_ps(value)) {}
+
+  /**
+   * @brief Construct Float4 from four values.
+   *
+   * @param a First lane.
+   * @param b Second lane.
+   * @param c Third lane.
+   * @param d Fourth lane.
+   */
+  Float4(float a, float b, float c, float d) : lanes(_mm_setr_ps(a, b, c, d)) {}
+
+  /**
+   * @brief Loads four consecutive floats.
+   *
+   * @param data    The floats, no alignment required.
+   * @return Float4 The lanes.
+   */
+  static Float4 Load(const float *data) { return Float4(_mm_loadu_ps(data)); }
+
+  /**
+   * @brief Stores the lanes to four consecutive floats.
+   *
+   * @param data Receives the floats, no alignment required.
+   */
+  void Store(float *data) const { _mm_storeu_ps(data, lanes); }
+#else
+  /**
+   * @brief The lanes.
+   */
+  float lanes[4];
+
+  /**
+   * @brief Construct Float4 with all lanes set to the value.
+   *
+   * @param value The value.
+   */
+  Float4(float value) : lanes{value, value, value, value} {}
+
+  /**
+   * @brief Construct Float4 from four values.
+   *
+   * @param a First lane.
+   * @param b Second lane.
+   * @param c Third lane.
+   * @param d Fourth lane.
+   */
+  Float4(float a, float b, float c, float d) : lanes{a, b, c, d} {}
+
+  /**
+   * @brief Loads four consecutive floats.
+   *
+   * @param data    The floats.
+   * @return Float4 The lanes.
+   */
+  static Float4 Load(const float *data) {
+    return Float4(data[0], data[1], data[2], data[3]);
+  }
+
+  /**
+   * @brief Stores the lanes to four consecutive floats.
+   *
+   * @param data Receives the floats.
+   */
+  void Store(float *data) const {
+    for (int i = 0; i < 4; i++)
+      data[i] = lanes[i];
+  }
+#endif
+};
+
+#ifdef SVEL_SSE2
+inline Float4 operator+(Float4 a, Float4 b) {
+  return Float4(_mm_add_ps(a.lanes, b.lanes));
+}
+inline Float4 operator-(Float4 a, Float4 b) {
+  return Float4(_mm_sub_ps(a.lanes, b.lanes));
+}
+inline Float4 operator*(Float4 a, Float4 b) {
+  return Float4(_mm_mul_ps(a.lanes, b.lanes));
+}
+inline Float4 operator/(Float4 a, Float4 b) {
+  return Float4(_mm_div_ps(a.lanes, b.lanes));
+}
+inline Float4 Min(Float4 a, Float4 b) {
+  return Float4(_mm_min_ps(a.lanes, b.lanes));
+}
+inline Float4 Max(Float4 a, Float4 b) {
+  return Float4(_mm_max_ps(a.lanes, b.lanes));
+}
+inline Float4 Sqrt(Float4 a) { return Float4(_mm_sqrt_ps(a.lanes)); }
+inline Float4 Abs(Float4 a) {
+  return Float4(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.lanes));
+}
+#else
+/**
+ * @brief Applies an operation to every lane.
+ *
+ * @tparam F      Type of the operation.
+ * @param a       First operand.
+ * @param b       Second operand.
+ * @param op      The operation.
+ * @return Float4 The results.
+ */
+template <typename F> inline Float4 _perLane(Float4 a, Float4 b, F op) {
+  return Float4(op(a.lanes[0], b.lanes[0]), op(a.lanes[1], b.lanes[1]),
+                op(a.lanes[2], b.lanes[2]), op(a.lanes[3], b.lanes[3]));
+}
+inline Float4 operator+(Float4 a, Float4 b) {
+  return _perLane(a, b, [](float x, float y) { return x + y; });
+}
+inline Float4 operator-(Float4 a, Float4 b) {
+  return _perLane(a, b, [](float x, float y) { return x - y; });
+}
+inline Float4 operator*(Float4 a, Float4 b) {
+  return _perLane(a, b, [](float x, float y) { return x * y; });
+}
+inline Float4 operator/(Float4 a, Float4 b) {
+  return _perLane(a, b, [](float x, float y) { return x / y; });
+}
+inline Float4 Min(Float4 a, Float4 b) {
+  return _perLane(a, b, [](float x, float y) { return y < x ? y : x; });
+}
+inline Float4 Max(Float4 a, Float4 b) {
+  return _perLane(a, b, [](float x, float y) { return x < y ? y : x; });
+}
+inline Float4 Sqrt(Float4 a) {
+  return _perLane(a, a, [](float x, float) { return std::sqrt(x); });
+}
+inline Float4 Abs(Float4 a) {
+  return _perLane(a, a, [](float x, float) { return std::fabs(x); });
+}
+#endif
+
+/**
+ * @brief Approximates the arc cosine (Abramowitz and Stegun 4.4.45). The
+ * absolute error is below 1e-4 radians.
+ *
+ * @param x       Cosines, clamped to [-1, 1].
+ * @return Float4 Angles in radians.
+ */
+inline Float4 Acos(Float4 x) {
+  x = Max(Min(x, 1.0f), -1.0f);
+  const Float4 a = Abs(x);
+  const Float4 polynomial =
+      ((-0.0187293f * a + 0.0742610f) * a - 0.2121144f) * a + 1.5707288f;
+  const Float4 angle = Sqrt(1.0f - a) * polynomial;
+
+  // acos(-x) = pi - acos(x), blended without branches: x - |x| is -2|x| for
+  // negative x and 0 otherwise
+  const Float4 negative = (a - x) / Max(2.0f * a, 1e-30f);
+  return angle + negative * (3.14159265f - 2.0f * angle);
+}
+
+} // namespace util
+
+#endif /* __UTIL_SIMD_HPP__ */
@@ -63,13 +63,13 @@ IWindow::Impl::Impl(core::SharedInstance instance, const std::string &title,
   // Create Renderer
   _renderer = std::make_shared<VulkanRenderer>(_instance, _surface);
 
-  // Set default texture
+  // Set default texture, the base sets of all descriptor sets keep its image
   auto imgData = new unsigned char[4];
   imgData[0] = imgData[2] = 255;
   imgData[1] = 0;
   imgData[3] = 255;
   auto defaultImage = std::make_shared<Image>(Extent{1, 1}, 4, 4, imgData, 4);
-  _defaultTexture = _renderer->CreateTexture(defaultImage);
+  _defaultTexture = _renderer->CreatePinnedTexture(defaultImage);
   core::descriptor::Set::SetDefaultTexture(_defaultTexture);
 
   // Add this window to the table
@@ -107,8 +107,12 @@ SharedRenderer IWindow::GetRenderer() const { return __pImpl->GetRenderer(); }
 
 Extent IWindow::GetWindowSize() const { return __pImpl->GetWindowSize(); }
 
+void IWindow::Close() {
+  glfwSetWindowShouldClose(__pImpl->GetWindow()->Get(), GLFW_TRUE);
+}
+
 void IWindow::StartRenderLoop() {
-  const unsigned int maxInFlightFrameCount = 2;
+  const unsigned int maxInFlightFrameCount = SVEL_MAX_FRAMES_IN_FLIGHT;
   unsigned int currentFrame = 0;
   auto renderer = __pImpl->GetRenderer();
   auto window = __pImpl->GetWindow();
@@ -0,0 +1,82 @@
+/**
+ * @file app.hpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Application and window for benchmarks that need a renderer.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __BENCH_APP_HPP__
+#define __BENCH_APP_HPP__
+
+// SVEL
+#include <svel/svel.h>
+
+// STL
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief Window that runs a callback every frame.
+ */
+class Window : public SVEL_NAMESPACE::IWindow {
+private:
+  /**
+   * @brief Called by Draw.
+   */
+  std::function<void(Window &)> _draw;
+
+public:
+  /**
+   * @brief Construct a Window.
+   *
+   * @param parent  The application.
+   * @param title   Title of the window.
+   * @param draw    Called for every frame.
+   */
+  Window(SVEL_NAMESPACE::SharedIApplication parent, const std::string &title,
+         std::function<void(Window &)> draw = {})
+      : IWindow(parent, title, {1280, 720}), _draw(std::move(draw)) {}
+
+  /**
+   * @brief Implementation of the Draw Interface.
+   */
+  void Draw() override {
+    if (_draw)
+      _draw(*this);
+  }
+};
+
+/**
+ * @brief Base of the applications of the benchmarks. The library provides the
+ * entrypoint, which runs the application that SVEL_MAKE_APP declares.
+ */
+class Application : public SVEL_NAMESPACE::IApplication,
+                    public std::enable_shared_from_this<Application> {
+protected:
+  /**
+   * @brief The command line arguments without the program name.
+   */
+  std::vector<std::string> _arguments;
+
+public:
+  /**
+   * @brief Construct an Application.
+   *
+   * @param name  Name of the benchmark.
+   * @param argc  Argument count.
+   * @param argv  Arguments.
+   */
+  Application(const std::string &name, int argc, char *argv[])
+      : IApplication(name), _arguments(argv + 1, argv + argc) {}
+};
+
+} // namespace bench
+
+#endif /* __BENCH_APP_HPP__ */
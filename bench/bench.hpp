@@ -0,0 +1,390 @@
+/**
+ * @file bench.hpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Helpers shared by the benchmarks.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __BENCH_BENCH_HPP__
+#define __BENCH_BENCH_HPP__
+
+// Internal
+#include <io/obj/model.hpp>
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief Clock used for every measurement.
+ */
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Duration in milliseconds.
+ */
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+/**
+ * @brief Runs the function several times and keeps the fastest run, which is
+ * the least disturbed by other processes.
+ *
+ * @tparam Func     Callable without parameters.
+ * @param func      The function to measure.
+ * @param repeats   How often to run it.
+ * @return double   Fastest run in milliseconds.
+ */
+template <typename Func> inline double Measure(Func &&func, int repeats = 3) {
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < repeats; i++) {
+    const auto start = Clock::now();
+    func();
+    best = std::min(best, Milliseconds(Clock::now() - start).count());
+  }
+  return best;
+}
+
+/**
+ * @brief Reads a count from the command line. Counts may use the suffixes k
+ * and M, e.g. 10M.
+ *
+ * @param argument  The argument.
+ * @return size_t   The count.
+ */
+inline size_t ParseCount(const std::string &argument) {
+  size_t end = 0;
+  const double value = std::stod(argument, &end);
+  double scale = 1.0;
+  if (end < argument.size() && argument[end] == 'k')
+    scale = 1e3;
+  else if (end < argument.size() && argument[end] == 'M')
+    scale = 1e6;
+  return (size_t)(value * scale);
+}
+
+/**
+ * @brief Directory for generated files, removed when the benchmark ends.
+ */
+class TempDirectory {
+private:
+  /**
+   * @brief The directory.
+   */
+  std::filesystem::path _path;
+
+public:
+  /**
+   * @brief Creates a fresh directory in the temporary directory of the
+   * system.
+   *
+   * @param name  Name of the directory.
+   */
+  TempDirectory(const std::string &name)
+      : _path(std::filesystem::temp_directory_path() / name) {
+    std::filesystem::remove_all(_path);
+    std::filesystem::create_directories(_path);
+  }
+
+  TempDirectory(const TempDirectory &) = delete;
+
+  /**
+   * @brief Removes the directory and everything in it.
+   */
+  ~TempDirectory() {
+    std::error_code error;
+    std::filesystem::remove_all(_path, error);
+  }
+
+  /**
+   * @brief Getter for a path within the directory.
+   *
+   * @param name                    Name of the file.
+   * @return std::filesystem::path  Path of the file.
+   */
+  std::filesystem::path operator/(const std::string &name) const {
+    return _path / name;
+  }
+};
+
+/**
+ * @brief Writes an OBJ file of a grid that is split into objects and groups.
+ * Every cell is two triangles with coordinates, texture coordinates and
+ * normals, like exported scans or terrain.
+ *
+ * @param file        Path of the file.
+ * @param faceCount   Amount of triangles, rounded to whole grid rows.
+ * @param objectCount Amount of objects the rows are split into.
+ * @param relative    Whether faces use negative indices.
+ * @return size_t     Amount of triangles written.
+ */
+inline size_t WriteGridObj(const std::filesystem::path &file,
+                           size_t faceCount, size_t objectCount = 1,
+                           bool relative = false) {
+  std::ofstream stream(file, std::ios::binary);
+  if (!stream)
+    throw std::runtime_error("Could not create " + file.string());
+
+  // Square grid per object, the rows of every object are separate
+  const size_t facesPerObject = std::max<size_t>(2, faceCount / objectCount);
+  const auto columns =
+      std::max<size_t>(1, (size_t)std::sqrt((double)facesPerObject / 2.0));
+  const size_t rows = std::max<size_t>(1, facesPerObject / (2 * columns));
+
+  size_t written = 0;
+  size_t base = 1;
+  char line[128];
+  for (size_t object = 0; object < objectCount; object++) {
+    stream << "o grid" << object << "\n";
+    for (size_t y = 0; y <= rows; y++)
+      for (size_t x = 0; x <= columns; x++) {
+        const float u = (float)x / (float)columns;
+        const float v = (float)y / (float)rows;
+        std::snprintf(line, sizeof(line),
+                      "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn 0.0 1.0 0.0\n",
+                      (double)u + (double)object, 0.0, (double)v, (double)u,
+                      (double)v);
+        stream << line;
+      }
+
+    // Faces reference the vertices of the current object only
+    const size_t vertexCount = (rows + 1) * (columns + 1);
+    for (size_t y = 0; y < rows; y++) {
+      if (y % 64 == 0)
+        stream << "g rows" << y << "\nusemtl material" << (y / 64) % 4
+               << "\n";
+      for (size_t x = 0; x < columns; x++) {
+        const size_t corners[4] = {
+            y * (columns + 1) + x, y * (columns + 1) + x + 1,
+            (y + 1) * (columns + 1) + x, (y + 1) * (columns + 1) + x + 1};
+        const size_t triangles[2][3] = {{corners[0], corners[2], corners[1]},
+                                        {corners[1], corners[2], corners[3]}};
+        for (const auto &triangle : triangles) {
+          stream << "f";
+          for (size_t corner : triangle) {
+            const long long index =
+                relative ? (long long)corner - (long long)vertexCount
+                         : (long long)(base + corner);
+            stream << " " << index << "/" << index << "/" << index;
+          }
+          stream << "\n";
+        }
+        written += 2;
+      }
+    }
+    base += vertexCount;
+  }
+  return written;
+}
+
+/**
+ * @brief Triangle mesh with separate attribute arrays, as glTF stores it.
+ */
+struct Sphere {
+  /**
+   * @brief Vertex positions, three floats each.
+   */
+  std::vector<float> positions;
+
+  /**
+   * @brief Vertex normals, three floats each.
+   */
+  std::vector<float> normals;
+
+  /**
+   * @brief Texture coordinates, two floats each.
+   */
+  std::vector<float> texCoords;
+
+  /**
+   * @brief Triangle list.
+   */
+  std::vector<uint32_t> indices;
+};
+
+/**
+ * @brief Creates a UV sphere. Seams and poles keep their own vertices, so
+ * there are (rings + 1) * (segments + 1) vertices.
+ *
+ * @param rings     Subdivisions from pole to pole.
+ * @param segments  Subdivisions around the axis.
+ * @return Sphere   The sphere.
+ */
+inline Sphere MakeSphere(uint32_t rings, uint32_t segments) {
+  const float pi = 3.14159265358979f;
+  Sphere sphere{};
+  for (uint32_t ring = 0; ring <= rings; ring++)
+    for (uint32_t segment = 0; segment <= segments; segment++) {
+      const float u = (float)segment / (float)segments;
+      const float v = (float)ring / (float)rings;
+      const float x = std::sin(v * pi) * std::cos(u * 2.0f * pi);
+      const float y = std::cos(v * pi);
+      const float z = std::sin(v * pi) * std::sin(u * 2.0f * pi);
+      sphere.positions.insert(sphere.positions.end(), {x, y, z});
+      sphere.normals.insert(sphere.normals.end(), {x, y, z});
+      sphere.texCoords.insert(sphere.texCoords.end(), {u, v});
+    }
+
+  for (uint32_t ring = 0; ring < rings; ring++)
+    for (uint32_t segment = 0; segment < segments; segment++) {
+      const uint32_t a = ring * (segments + 1) + segment;
+      const uint32_t b = a + segments + 1;
+      sphere.indices.insert(sphere.indices.end(),
+                            {a, b, a + 1, a + 1, b, b + 1});
+    }
+  return sphere;
+}
+
+/**
+ * @brief Writes a mesh as an OBJ file.
+ *
+ * @param file    Path of the file.
+ * @param sphere  The mesh.
+ */
+inline void WriteObj(const std::filesystem::path &file, const Sphere &sphere) {
+  std::ofstream stream(file, std::ios::binary);
+  if (!stream)
+    throw std::runtime_error("Could not create " + file.string());
+
+  char line[160];
+  stream << "o sphere\n";
+  for (size_t i = 0; i < sphere.positions.size() / 3; i++) {
+    const auto *p = &sphere.positions[i * 3];
+    const auto *n = &sphere.normals[i * 3];
+    const auto *t = &sphere.texCoords[i * 2];
+    std::snprintf(line, sizeof(line),
+                  "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+                  (double)p[0], (double)p[1], (double)p[2], (double)t[0],
+                  (double)t[1], (double)n[0], (double)n[1], (double)n[2]);
+    stream << line;
+  }
+  for (size_t i = 0; i < sphere.indices.size(); i += 3) {
+    stream << "f";
+    for (size_t c = 0; c < 3; c++) {
+      const auto index = sphere.indices[i + c] + 1;
+      stream << " " << index << "/" << index << "/" << index;
+    }
+    stream << "\n";
+  }
+}
+
+/**
+ * @brief Writes a mesh as a binary glTF file. Every attribute is stored in a
+ * buffer view of its own, like most exporters do.
+ *
+ * @param file    Path of the file.
+ * @param sphere  The mesh.
+ */
+inline void WriteGlb(const std::filesystem::path &file, const Sphere &sphere) {
+  // Binary chunk: positions, normals, texture coordinates, indices
+  std::vector<char> binary{};
+  std::vector<std::pair<size_t, size_t>> views{};
+  auto append = [&](const void *data, size_t size) {
+    views.emplace_back(binary.size(), size);
+    binary.insert(binary.end(), (const char *)data, (const char *)data + size);
+  };
+  append(sphere.positions.data(), sphere.positions.size() * sizeof(float));
+  append(sphere.normals.data(), sphere.normals.size() * sizeof(float));
+  append(sphere.texCoords.data(), sphere.texCoords.size() * sizeof(float));
+  append(sphere.indices.data(), sphere.indices.size() * sizeof(uint32_t));
+  binary.resize((binary.size() + 3) & ~(size_t)3, 0);
+
+  const size_t vertexCount = sphere.positions.size() / 3;
+  std::string json = "{\"asset\":{\"version\":\"2.0\"},\"buffers\":[{"
+                     "\"byteLength\":" +
+                     std::to_string(binary.size()) + "}],\"bufferViews\":[";
+  for (size_t i = 0; i < views.size(); i++)
+    json += std::string(i > 0 ? "," : "") + "{\"buffer\":0,\"byteOffset\":" +
+            std::to_string(views[i].first) +
+            ",\"byteLength\":" + std::to_string(views[i].second) + "}";
+  const char *types[] = {"VEC3", "VEC3", "VEC2"};
+  json += "],\"accessors\":[";
+  for (size_t i = 0; i < 3; i++)
+    json += "{\"bufferView\":" + std::to_string(i) +
+            ",\"componentType\":5126,\"count\":" +
+            std::to_string(vertexCount) + ",\"type\":\"" + types[i] +
+            "\"" + (i == 0 ? ",\"min\":[-1,-1,-1],\"max\":[1,1,1]" : "") +
+            "},";
+  json += "{\"bufferView\":3,\"componentType\":5125,\"count\":" +
+          std::to_string(sphere.indices.size()) +
+          ",\"type\":\"SCALAR\"}],\"meshes\":[{\"name\":\"sphere\","
+          "\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,"
+          "\"TEXCOORD_0\":2},\"indices\":3}]}]}";
+  json.resize((json.size() + 3) & ~(size_t)3, ' ');
+
+  // Header and chunks, all words are little endian
+  std::ofstream stream(file, std::ios::binary);
+  if (!stream)
+    throw std::runtime_error("Could not create " + file.string());
+  auto writeWord = [&stream](size_t value) {
+    const char bytes[4] = {(char)(value & 0xFF), (char)(value >> 8 & 0xFF),
+                           (char)(value >> 16 & 0xFF),
+                           (char)(value >> 24 & 0xFF)};
+    stream.write(bytes, 4);
+  };
+  writeWord(0x46546C67);
+  writeWord(2);
+  writeWord(12 + 8 + json.size() + 8 + binary.size());
+  writeWord(json.size());
+  writeWord(0x4E4F534A);
+  stream.write(json.data(), (std::streamsize)json.size());
+  writeWord(binary.size());
+  writeWord(0x004E4942);
+  stream.write(binary.data(), (std::streamsize)binary.size());
+}
+
+/**
+ * @brief Compares the models of two parses.
+ *
+ * @param a             Models of the first parse.
+ * @param b             Models of the second parse.
+ * @param compareNames  Whether object names are compared. The stream mode
+ *                      does not read them.
+ * @return true         Both contain the same data.
+ * @return false        The models differ.
+ */
+inline bool
+SameModels(const std::vector<std::shared_ptr<io::obj::Model>> &a,
+           const std::vector<std::shared_ptr<io::obj::Model>> &b,
+           bool compareNames = true) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    const auto &x = *a[i];
+    const auto &y = *b[i];
+    if ((compareNames && x.name != y.name) || x.coordinates != y.coordinates ||
+        x.textureCoords != y.textureCoords || x.normals != y.normals ||
+        x.faces != y.faces || x.coordinateOffset != y.coordinateOffset ||
+        x.textureCoordOffset != y.textureCoordOffset ||
+        x.normalOffset != y.normalOffset || x.groups.size() != y.groups.size())
+      return false;
+    for (size_t g = 0; g < x.groups.size(); g++)
+      if (x.groups[g].name != y.groups[g].name ||
+          x.groups[g].material != y.groups[g].material ||
+          x.groups[g].firstFace != y.groups[g].firstFace)
+        return false;
+  }
+  return true;
+}
+
+} // namespace bench
+
+#endif /* __BENCH_BENCH_HPP__ */
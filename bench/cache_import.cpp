@@ -0,0 +1,75 @@
+/**
+ * @file cache_import.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Compares uploading mesh cache data by host import and by staging.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "app.hpp"
+#include "bench.hpp"
+
+// STL
+#include <iostream>
+#include <string>
+
+using namespace bench;
+
+/**
+ * @brief Writes the uncompressed mesh cache of a generated OBJ file, then
+ * imports it from the cache several times, alternating between importing the
+ * mapped cache file and staging it. Usage: svel_bench_cache_import
+ * [faceCount], defaults to 1M.
+ */
+class CacheImportBench : public Application {
+public:
+  /**
+   * @brief Construct the benchmark.
+   *
+   * @param argc  Argument count.
+   * @param argv  Arguments.
+   */
+  CacheImportBench(int argc, char *argv[])
+      : Application("svel_bench_cache_import", argc, argv) {}
+
+  /**
+   * @brief Runs the benchmark.
+   */
+  void Run() override {
+    const size_t requested =
+        _arguments.empty() ? 1000000 : ParseCount(_arguments[0]);
+    TempDirectory directory("svel_bench_cache_import");
+    const auto file = (directory / "grid.obj").string();
+    const size_t faceCount = WriteGridObj(file, requested, 4);
+    std::cout << faceCount << " faces" << std::endl;
+
+    auto window = std::make_shared<Window>(shared_from_this(),
+                                           "svel_bench_cache_import");
+    auto renderer = window->GetRenderer();
+
+    // The first import writes the cache
+    SVEL_NAMESPACE::MeshImportOptions options{};
+    options.useCache = true;
+    options.cacheDirectory = (directory / "cache").string();
+    options.compressCache = false;
+    renderer->LoadObjFile(file, options);
+
+    for (int run = 0; run < 3; run++)
+      for (bool importCache : {true, false}) {
+        SVEL_NAMESPACE::MeshImportStatistics statistics{};
+        options.importCache = importCache;
+        options.statistics = &statistics;
+        renderer->LoadObjFile(file, options);
+        std::cout << (importCache ? "import" : "staging") << ": load "
+                  << statistics.loadTime << " ms, upload "
+                  << statistics.uploadTime << " ms, "
+                  << statistics.importedBytes << " of "
+                  << statistics.vertexBytes + statistics.indexBytes
+                  << " bytes imported" << std::endl;
+      }
+  }
+};
+SVEL_MAKE_APP(CacheImportBench)
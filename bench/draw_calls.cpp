@@ -0,0 +1,181 @@
+/**
+ * @file draw_calls.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Measures the CPU time of recording draws in a large scene.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "app.hpp"
+#include "bench.hpp"
+
+// STL
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+/**
+ * @brief Uniform data of a draw, matches shaders/draw.vert.
+ */
+struct DrawData {
+  /**
+   * @brief Offset of the triangle in clip space.
+   */
+  float offset[4];
+};
+
+/**
+ * @brief Material that writes the offset of every draw.
+ */
+class DrawMaterial : public SVEL_NAMESPACE::IMaterial {
+public:
+  /**
+   * @brief Written by the material on every draw.
+   */
+  DrawData data{};
+
+  /**
+   * @brief Construct a DrawMaterial.
+   *
+   * @param pipeline  Pipeline of shaders/draw.vert and shaders/draw.frag.
+   */
+  DrawMaterial(SVEL_NAMESPACE::SharedPipeline pipeline) : IMaterial(pipeline) {
+    AddAttribute(0, 0, &data);
+  }
+};
+
+/**
+ * @brief Draws small triangles that are spread over 64 meshes, so meshes
+ * change on every draw as in a real scene. Frames alternate between drawing
+ * with the material, which writes and binds the uniform data, and drawing
+ * only the meshes. Usage: svel_bench_draw_calls [drawCount] [frameCount],
+ * defaults to 50k draws and 200 frames.
+ */
+class DrawCallsBench : public Application {
+private:
+  /**
+   * @brief CPU time of recording the draws of a kind of frame.
+   */
+  struct Timing {
+    /**
+     * @brief Total time in milliseconds.
+     */
+    double time = 0.0;
+
+    /**
+     * @brief Amount of measured frames.
+     */
+    size_t frames = 0;
+  };
+
+  /**
+   * @brief Frames that are not measured, to fill the caches and buffers.
+   */
+  static const size_t WARM_UP_FRAMES = 10;
+
+  /**
+   * @brief Prints the time per draw.
+   *
+   * @param label     Kind of frame.
+   * @param timing    Its measurements.
+   * @param drawCount Draws per frame.
+   */
+  static void _print(const std::string &label, const Timing &timing,
+                     size_t drawCount) {
+    if (timing.frames == 0)
+      return;
+    const double frameTime = timing.time / (double)timing.frames;
+    std::cout << label << ": " << frameTime * 1e6 / (double)drawCount
+              << " ns per draw, " << frameTime << " ms per frame of "
+              << drawCount << " draws" << std::endl;
+  }
+
+public:
+  /**
+   * @brief Construct the benchmark.
+   *
+   * @param argc  Argument count.
+   * @param argv  Arguments.
+   */
+  DrawCallsBench(int argc, char *argv[])
+      : Application("svel_bench_draw_calls", argc, argv) {}
+
+  /**
+   * @brief Runs the benchmark.
+   */
+  void Run() override {
+    const size_t drawCount =
+        _arguments.size() < 1 ? 50000 : ParseCount(_arguments[0]);
+    const size_t frameCount =
+        _arguments.size() < 2 ? 200 : ParseCount(_arguments[1]);
+
+    SVEL_NAMESPACE::SharedRenderer renderer = nullptr;
+    SVEL_NAMESPACE::SharedPipeline pipeline = nullptr;
+    std::shared_ptr<DrawMaterial> material = nullptr;
+    std::vector<SVEL_NAMESPACE::SharedMesh> meshes{};
+    Timing withMaterial{}, meshOnly{};
+    size_t frame = 0;
+
+    auto draw = [&](Window &window) {
+      const bool useMaterial = frame % 2 == 0;
+      renderer->BindPipeline(pipeline);
+      const auto start = Clock::now();
+      for (size_t i = 0; i < drawCount; i++) {
+        // Frames without the material still bind its data once
+        const auto &mesh = meshes[i % meshes.size()];
+        if (useMaterial || i == 0) {
+          material->data.offset[0] = (float)(i % 256) / 128.0f - 1.0f;
+          material->data.offset[1] = (float)(i / 256 % 256) / 128.0f - 1.0f;
+          renderer->Draw(mesh, material);
+        } else
+          renderer->Draw(mesh);
+      }
+      const double time = Milliseconds(Clock::now() - start).count();
+      renderer->UnbindPipeline();
+
+      if (++frame <= WARM_UP_FRAMES)
+        return;
+      auto &timing = useMaterial ? withMaterial : meshOnly;
+      timing.time += time;
+      timing.frames++;
+      if (frame >= WARM_UP_FRAMES + frameCount)
+        window.Close();
+    };
+    auto window = std::make_shared<Window>(shared_from_this(),
+                                           "svel_bench_draw_calls", draw);
+    renderer = window->GetRenderer();
+
+    using SVEL_NAMESPACE::Shader;
+    auto vert = renderer->LoadShader(SVEL_SHADER_DIR "/draw.vert.spv",
+                                     Shader::Type::eVertex);
+    vert->AddSetLayout(
+        0, SVEL_NAMESPACE::SetLayout().Add(
+               0, {SVEL_NAMESPACE::BindingType::eUniformBufferDynamic,
+                   sizeof(DrawData)}));
+    auto frag = renderer->LoadShader(SVEL_SHADER_DIR "/draw.frag.spv",
+                                     Shader::Type::eFragment);
+    pipeline = renderer->BuildPipeline(
+        vert, frag, {{SVEL_NAMESPACE::AttributeType::SIGNED_FLOAT, 3}});
+    material = std::make_shared<DrawMaterial>(pipeline);
+
+    // Triangles of slightly different sizes
+    for (int i = 0; i < 64; i++) {
+      const float size = 0.002f + 0.0001f * (float)i;
+      std::vector<float> nodes{0.0f, 0.0f, 0.5f, size, 0.0f,
+                               0.5f, 0.0f, size, 0.5f};
+      meshes.push_back(renderer->CreateMesh(
+          SVEL_NAMESPACE::ArrayProxy(nodes.data(), nodes.size() * 4, 12, 3),
+          std::vector<uint16_t>{0, 1, 2}));
+    }
+
+    window->StartRenderLoop();
+    _print("material", withMaterial, drawCount);
+    _print("mesh only", meshOnly, drawCount);
+  }
+};
+SVEL_MAKE_APP(DrawCallsBench)
@@ -0,0 +1,89 @@
+/**
+ * @file glb_load.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Compares importing the same mesh from glTF and OBJ.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "app.hpp"
+#include "bench.hpp"
+
+// STL
+#include <iostream>
+#include <string>
+
+using namespace bench;
+
+/**
+ * @brief Imports a UV sphere from a .glb and an .obj file. The OBJ import
+ * skips the mesh cache, so both parse their file. Usage:
+ * svel_bench_glb_load [rings], defaults to 300 rings and segments, which are
+ * 90601 vertices and 180000 triangles.
+ */
+class GlbLoadBench : public Application {
+private:
+  /**
+   * @brief Prints the statistics of an import.
+   *
+   * @param label       Name of the run.
+   * @param total       Time of the whole call in milliseconds.
+   * @param statistics  Statistics of the import.
+   */
+  static void _print(const std::string &label, double total,
+                     const SVEL_NAMESPACE::MeshImportStatistics &statistics) {
+    std::cout << label << ": " << total << " ms total, load "
+              << statistics.loadTime << " ms, upload " << statistics.uploadTime
+              << " ms" << std::endl;
+  }
+
+public:
+  /**
+   * @brief Construct the benchmark.
+   *
+   * @param argc  Argument count.
+   * @param argv  Arguments.
+   */
+  GlbLoadBench(int argc, char *argv[])
+      : Application("svel_bench_glb_load", argc, argv) {}
+
+  /**
+   * @brief Runs the benchmark.
+   */
+  void Run() override {
+    const auto rings =
+        _arguments.empty() ? 300u : (uint32_t)std::stoul(_arguments[0]);
+    TempDirectory directory("svel_bench_glb_load");
+    const auto sphere = MakeSphere(rings, rings);
+    const auto glbFile = (directory / "sphere.glb").string();
+    const auto objFile = (directory / "sphere.obj").string();
+    WriteGlb(glbFile, sphere);
+    WriteObj(objFile, sphere);
+    std::cout << sphere.positions.size() / 3 << " vertices, "
+              << sphere.indices.size() / 3 << " triangles" << std::endl;
+
+    auto window =
+        std::make_shared<Window>(shared_from_this(), "svel_bench_glb_load");
+    auto renderer = window->GetRenderer();
+
+    // Several runs, the first one also warms up the file cache
+    for (int run = 0; run < 3; run++) {
+      SVEL_NAMESPACE::MeshImportStatistics statistics{};
+      SVEL_NAMESPACE::MeshImportOptions options{};
+      options.useCache = false;
+      options.statistics = &statistics;
+
+      auto start = Clock::now();
+      renderer->LoadGlbFile(glbFile, options);
+      _print("glb", Milliseconds(Clock::now() - start).count(), statistics);
+
+      start = Clock::now();
+      renderer->LoadObjFile(objFile, options);
+      _print("obj", Milliseconds(Clock::now() - start).count(), statistics);
+    }
+  }
+};
+SVEL_MAKE_APP(GlbLoadBench)
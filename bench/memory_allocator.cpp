@@ -0,0 +1,160 @@
+/**
+ * @file memory_allocator.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Measures how many device allocations mesh sized buffers need.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "bench.hpp"
+
+// Internal
+#include <core/memory/buddy_block.h>
+#include <core/memory/memory_allocator.h>
+
+// Vulkan
+#include <vulkan/vulkan.hpp>
+
+// STL
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+/**
+ * @brief Creates random buffer sizes of 4 to 260 KB, like the vertex and
+ * index buffers of typical meshes.
+ *
+ * @param count                         Amount of sizes.
+ * @return std::vector<vk::DeviceSize>  The sizes.
+ */
+static std::vector<vk::DeviceSize> _makeSizes(size_t count) {
+  std::mt19937 random(42);
+  std::uniform_int_distribution<vk::DeviceSize> distribution(4 * 1024,
+                                                             260 * 1024);
+  std::vector<vk::DeviceSize> sizes(count);
+  for (auto &size : sizes)
+    size = distribution(random);
+  return sizes;
+}
+
+/**
+ * @brief Times allocate and free pairs of a single BuddyBlock.
+ *
+ * @param sizes The sizes to allocate.
+ */
+static void _benchBuddyBlock(const std::vector<vk::DeviceSize> &sizes) {
+  core::BuddyBlock block(SVEL_MEMORY_BLOCK_SIZE, 256);
+  std::vector<std::pair<uint64_t, uint64_t>> ranges{};
+  ranges.reserve(sizes.size());
+  const double time = Measure([&]() {
+    for (auto size : sizes) {
+      auto offset = block.Allocate(size, 256);
+      // Free the oldest half once the block is full
+      if (offset == core::BuddyBlock::INVALID_OFFSET) {
+        for (size_t i = 0; i < ranges.size() / 2; i++)
+          block.Free(ranges[i].first, ranges[i].second, 256);
+        ranges.erase(ranges.begin(), ranges.begin() + ranges.size() / 2);
+        offset = block.Allocate(size, 256);
+      }
+      ranges.push_back({offset, size});
+    }
+    for (const auto &range : ranges)
+      block.Free(range.first, range.second, 256);
+    ranges.clear();
+  });
+  std::cout << "BuddyBlock: " << time * 1e6 / (double)sizes.size()
+            << " ns per allocate and free" << std::endl;
+  if (!block.IsEmpty())
+    throw std::runtime_error("BuddyBlock leaked ranges.");
+}
+
+/**
+ * @brief Allocates the sizes through a MemoryAllocator of the first physical
+ * device and prints its statistics.
+ *
+ * @param sizes The sizes to allocate.
+ */
+static void _benchAllocator(const std::vector<vk::DeviceSize> &sizes) {
+  vk::ApplicationInfo appInfo("svel_bench_memory_allocator", 1, "SVEL", 1,
+                              VK_API_VERSION_1_1);
+  vk::InstanceCreateInfo instanceInfo(vk::InstanceCreateFlags(), &appInfo);
+  vk::UniqueInstance instance = vk::createInstanceUnique(instanceInfo);
+  const auto physicalDevice = instance->enumeratePhysicalDevices().at(0);
+  const auto properties = physicalDevice.getProperties();
+  std::cout << &properties.deviceName[0] << std::endl;
+
+  const float priority = 1.0f;
+  vk::DeviceQueueCreateInfo queueInfo(vk::DeviceQueueCreateFlags(), 0, 1,
+                                      &priority);
+  vk::UniqueDevice device = physicalDevice.createDeviceUnique(
+      vk::DeviceCreateInfo(vk::DeviceCreateFlags(), queueInfo));
+
+  // The memory types of mesh buffers
+  auto buffer = device->createBufferUnique(vk::BufferCreateInfo(
+      vk::BufferCreateFlags(), 4096,
+      vk::BufferUsageFlagBits::eVertexBuffer |
+          vk::BufferUsageFlagBits::eIndexBuffer |
+          vk::BufferUsageFlagBits::eTransferDst));
+  auto requirements = device->getBufferMemoryRequirements(*buffer);
+
+  core::MemoryAllocator allocator(*device, physicalDevice, false);
+  std::vector<core::MemoryAllocator::Allocation> allocations{};
+  allocations.reserve(sizes.size());
+  auto start = Clock::now();
+  for (auto size : sizes) {
+    requirements.size = size;
+    allocations.push_back(allocator.Allocate(
+        requirements, vk::MemoryPropertyFlags(),
+        vk::MemoryPropertyFlagBits::eDeviceLocal, true));
+  }
+  const double allocateTime = Milliseconds(Clock::now() - start).count();
+
+  const auto statistics = allocator.GetStatistics();
+  const auto usedSize = statistics.allocatedSize - statistics.freeSize;
+  std::cout << sizes.size() << " buffers: " << statistics.deviceAllocationCount
+            << " vkAllocateMemory (" << statistics.blockCount << " blocks, "
+            << statistics.dedicatedCount << " dedicated)\n  rounding "
+            << 100.0 * (double)(usedSize - statistics.requestedSize) /
+                   (double)statistics.requestedSize
+            << "% over the requested bytes, "
+            << 100.0 * (double)statistics.freeSize /
+                   (double)statistics.allocatedSize
+            << "% of the blocks free\n  allocate "
+            << allocateTime * 1e6 / (double)sizes.size() << " ns each";
+
+  start = Clock::now();
+  for (const auto &allocation : allocations)
+    allocator.Free(allocation);
+  std::cout << ", free "
+            << Milliseconds(Clock::now() - start).count() * 1e6 /
+                   (double)sizes.size()
+            << " ns each" << std::endl;
+}
+
+/**
+ * @brief Runs the benchmark. Usage: svel_bench_memory_allocator [count],
+ * defaults to 10000 buffers.
+ *
+ * @param argc  Argument count.
+ * @param argv  Arguments.
+ * @return int  EXIT_FAILURE if vulkan failed.
+ */
+int main(int argc, char *argv[]) {
+  const auto sizes = _makeSizes(argc > 1 ? ParseCount(argv[1]) : 10000);
+  try {
+    _benchBuddyBlock(sizes);
+    _benchAllocator(sizes);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file mesh_codec.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Measures the compression ratio and decode speed of the mesh codec.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "bench.hpp"
+
+// Internal
+#include <io/mesh_codec.h>
+#include <io/obj/indice_table.h>
+#include <io/obj/parser.h>
+
+// STL
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+/**
+ * @brief Interleaved mesh like the OBJ import produces it.
+ */
+struct Mesh {
+  /**
+   * @brief Position, texture coordinate and normal floats, 32 bytes each.
+   */
+  std::vector<float> vertices;
+
+  /**
+   * @brief Triangle list.
+   */
+  std::vector<uint32_t> indices;
+};
+
+/**
+ * @brief Size of a vertex in bytes.
+ */
+static const size_t VERTEX_STRIDE = 8 * sizeof(float);
+
+/**
+ * @brief Interleaves the generated sphere.
+ *
+ * @param sphere  The sphere.
+ * @return Mesh   Interleaved mesh.
+ */
+static Mesh _interleave(const Sphere &sphere) {
+  Mesh mesh{};
+  for (size_t i = 0; i < sphere.positions.size() / 3; i++) {
+    const auto *p = &sphere.positions[i * 3];
+    const auto *t = &sphere.texCoords[i * 2];
+    const auto *n = &sphere.normals[i * 3];
+    mesh.vertices.insert(mesh.vertices.end(),
+                         {p[0], p[1], p[2], t[0], t[1], n[0], n[1], n[2]});
+  }
+  mesh.indices = sphere.indices;
+  return mesh;
+}
+
+/**
+ * @brief Loads an OBJ file and deduplicates its vertices in order of first
+ * use, like LoadObjFile does before the cache is written.
+ *
+ * @param file  The OBJ file.
+ * @return Mesh Interleaved mesh of all models.
+ */
+static Mesh _loadObj(const std::string &file) {
+  Mesh mesh{};
+  io::obj::Parser parser(file);
+  for (const auto &model : parser.Parse(io::obj::Parser::Mode::eParallel)) {
+    io::obj::IndiceTable table(model->faces.size() * 3 / 2);
+    const auto base = (uint32_t)(mesh.vertices.size() / 8);
+    uint32_t vertexCount = 0;
+    for (const auto &face : model->faces)
+      for (const auto &indice : face) {
+        const auto index = table.Insert(indice, vertexCount);
+        mesh.indices.push_back(base + index);
+        if (index != vertexCount)
+          continue;
+        vertexCount++;
+
+        glm::vec3 coords = model->coordinates.at(indice.coordId - 1 -
+                                                 model->coordinateOffset);
+        glm::vec2 texCoords{0.0f, 0.0f};
+        glm::vec3 normal{0.0f, 0.0f, 0.0f};
+        if (indice.texId != 0)
+          texCoords = model->textureCoords.at(indice.texId - 1 -
+                                              model->textureCoordOffset);
+        if (indice.normalId != 0)
+          normal = model->normals.at(indice.normalId - 1 -
+                                     model->normalOffset);
+        mesh.vertices.insert(mesh.vertices.end(),
+                             {coords.x, coords.y, coords.z, texCoords.x,
+                              texCoords.y, normal.x, normal.y, normal.z});
+      }
+  }
+  return mesh;
+}
+
+/**
+ * @brief Encodes the mesh, checks the round trip and prints ratio and speed.
+ *
+ * @param label Name of the mesh.
+ * @param mesh  The mesh.
+ * @return true The round trip succeeded.
+ */
+static bool _run(const std::string &label, const Mesh &mesh) {
+  const size_t vertexCount = mesh.vertices.size() / 8;
+  const size_t vertexBytes = vertexCount * VERTEX_STRIDE;
+  const size_t indexBytes = mesh.indices.size() * sizeof(uint32_t);
+
+  std::vector<uint8_t> encodedVertices, encodedIndices;
+  const double encodeTime = Measure([&]() {
+    encodedVertices =
+        io::EncodeVertexBuffer(mesh.vertices.data(), vertexCount,
+                               VERTEX_STRIDE);
+    encodedIndices = io::EncodeIndexBuffer(
+        mesh.indices.data(), mesh.indices.size(), sizeof(uint32_t));
+  });
+
+  std::vector<uint8_t> vertices(vertexBytes), indices(indexBytes);
+  bool decoded = true;
+  const double vertexTime = Measure(
+      [&]() {
+        decoded &= io::DecodeVertexBuffer(vertices.data(), vertexCount,
+                                          VERTEX_STRIDE,
+                                          encodedVertices.data(),
+                                          encodedVertices.size());
+      },
+      10);
+  const double indexTime = Measure(
+      [&]() {
+        decoded &= io::DecodeIndexBuffer(indices.data(), mesh.indices.size(),
+                                         sizeof(uint32_t),
+                                         encodedIndices.data(),
+                                         encodedIndices.size());
+      },
+      10);
+  const bool same =
+      decoded &&
+      std::memcmp(vertices.data(), mesh.vertices.data(), vertexBytes) == 0 &&
+      std::memcmp(indices.data(), mesh.indices.data(), indexBytes) == 0;
+
+  // Throughput in decoded bytes per second
+  auto gigabytes = [](size_t bytes, double milliseconds) {
+    return (double)bytes / (milliseconds * 1e6);
+  };
+  std::cout << label << ": " << vertexCount << " vertices, "
+            << mesh.indices.size() << " indices\n  vertices "
+            << 100.0 * (double)encodedVertices.size() / (double)vertexBytes
+            << "% of raw, decode " << gigabytes(vertexBytes, vertexTime)
+            << " GB/s\n  indices "
+            << 100.0 * (double)encodedIndices.size() / (double)indexBytes
+            << "% of raw, decode " << gigabytes(indexBytes, indexTime)
+            << " GB/s\n  encode " << encodeTime << " ms"
+            << (same ? "" : "\n  ROUND TRIP FAILED") << std::endl;
+  return same;
+}
+
+/**
+ * @brief Runs the codec over generated spheres and the given OBJ files.
+ * Usage: svel_bench_mesh_codec [objFile...]
+ *
+ * @param argc  Argument count.
+ * @param argv  OBJ files.
+ * @return int  EXIT_FAILURE if a round trip failed.
+ */
+int main(int argc, char *argv[]) {
+#ifdef SVEL_NO_SIMD
+  std::cout << "scalar decode (SVEL_NO_SIMD)" << std::endl;
+#endif
+  bool success = _run("sphere 20x20", _interleave(MakeSphere(20, 20)));
+  success &= _run("sphere 706x706", _interleave(MakeSphere(706, 706)));
+  for (int i = 1; i < argc; i++)
+    success &= _run(argv[i], _loadObj(argv[i]));
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file obj_cache.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Compares cold and warm OBJ imports through the mesh cache.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "app.hpp"
+#include "bench.hpp"
+
+// STL
+#include <iostream>
+#include <string>
+
+using namespace bench;
+
+/**
+ * @brief Imports a generated OBJ file without the cache, then twice with the
+ * cache. The first cached import parses the file and writes the cache, the
+ * second one maps it. Usage: svel_bench_obj_cache [faceCount], defaults to 1M.
+ */
+class ObjCacheBench : public Application {
+private:
+  /**
+   * @brief Imports the file and prints the statistics.
+   *
+   * @param renderer  Renderer to import with.
+   * @param file      The OBJ file.
+   * @param options   Import options, statistics are set here.
+   * @param label     Name of the run.
+   */
+  static void _import(const SVEL_NAMESPACE::SharedRenderer &renderer,
+                      const std::string &file,
+                      SVEL_NAMESPACE::MeshImportOptions options,
+                      const std::string &label) {
+    SVEL_NAMESPACE::MeshImportStatistics statistics{};
+    options.statistics = &statistics;
+    const auto start = Clock::now();
+    auto meshes = renderer->LoadObjFile(file, options);
+    const double total = Milliseconds(Clock::now() - start).count();
+    std::cout << label << ": " << total << " ms total, load "
+              << statistics.loadTime << " ms, upload " << statistics.uploadTime
+              << " ms, cache hit " << (statistics.cacheHit ? "yes" : "no")
+              << ", " << meshes.size() << " meshes" << std::endl;
+  }
+
+public:
+  /**
+   * @brief Construct the benchmark.
+   *
+   * @param argc  Argument count.
+   * @param argv  Arguments.
+   */
+  ObjCacheBench(int argc, char *argv[])
+      : Application("svel_bench_obj_cache", argc, argv) {}
+
+  /**
+   * @brief Runs the benchmark.
+   */
+  void Run() override {
+    const size_t requested =
+        _arguments.empty() ? 1000000 : ParseCount(_arguments[0]);
+    TempDirectory directory("svel_bench_obj_cache");
+    const auto file = (directory / "grid.obj").string();
+    const size_t faceCount = WriteGridObj(file, requested, 4);
+    std::cout << faceCount << " faces" << std::endl;
+
+    auto window = std::make_shared<Window>(shared_from_this(),
+                                           "svel_bench_obj_cache");
+    auto renderer = window->GetRenderer();
+
+    SVEL_NAMESPACE::MeshImportOptions options{};
+    options.cacheDirectory = (directory / "cache").string();
+    options.useCache = false;
+    _import(renderer, file, options, "no cache");
+    options.useCache = true;
+    _import(renderer, file, options, "cold cache");
+    _import(renderer, file, options, "warm cache");
+  }
+};
+SVEL_MAKE_APP(ObjCacheBench)
@@ -0,0 +1,63 @@
+/**
+ * @file obj_parse.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Compares the stream and the mapped mode of the OBJ parser.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "bench.hpp"
+
+// Internal
+#include <io/obj/parser.h>
+
+// STL
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+/**
+ * @brief Parses generated files of the given face counts in both modes.
+ * Usage: svel_bench_obj_parse [faceCount...], defaults to 1M and 10M.
+ *
+ * @param argc  Argument count.
+ * @param argv  Face counts, e.g. 1M.
+ * @return int  EXIT_FAILURE if the modes disagree.
+ */
+int main(int argc, char *argv[]) {
+  std::vector<size_t> faceCounts{1000000, 10000000};
+  if (argc > 1) {
+    faceCounts.clear();
+    for (int i = 1; i < argc; i++)
+      faceCounts.push_back(ParseCount(argv[i]));
+  }
+
+  TempDirectory directory("svel_bench_obj_parse");
+  for (auto faceCount : faceCounts) {
+    const auto file = directory / "grid.obj";
+    faceCount = WriteGridObj(file, faceCount, 4);
+    io::obj::Parser parser(file);
+
+    // A parse of each mode is kept for the comparison
+    std::vector<std::shared_ptr<io::obj::Model>> stream, mapped;
+    const double streamTime = Measure(
+        [&]() { stream = parser.Parse(io::obj::Parser::Mode::eStream); }, 1);
+    const double mappedTime = Measure(
+        [&]() { mapped = parser.Parse(io::obj::Parser::Mode::eMapped); });
+
+    const bool same = SameModels(stream, mapped, false);
+    std::cout << faceCount << " faces: eStream " << streamTime
+              << " ms, eMapped " << mappedTime << " ms ("
+              << streamTime / mappedTime << "x)"
+              << (same ? "" : ", RESULTS DIFFER") << std::endl;
+    if (!same)
+      return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
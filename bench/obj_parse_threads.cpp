@@ -0,0 +1,68 @@
+/**
+ * @file obj_parse_threads.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Measures how the parallel OBJ parser scales with threads.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "bench.hpp"
+
+// Internal
+#include <io/obj/parser.h>
+
+// STL
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace bench;
+
+/**
+ * @brief Parses a generated file with 1 to N threads and checks every result
+ * against the single threaded parse. The file uses negative indices and
+ * several objects, so chunks have to be stitched and rebased.
+ * Usage: svel_bench_obj_parse_threads [faceCount] [maxThreads], defaults to
+ * 10M faces and all hardware threads.
+ *
+ * @param argc  Argument count.
+ * @param argv  Face count and thread limit.
+ * @return int  EXIT_FAILURE if a parallel parse differs.
+ */
+int main(int argc, char *argv[]) {
+  size_t faceCount = argc > 1 ? ParseCount(argv[1]) : 10000000;
+  unsigned int maxThreads =
+      argc > 2 ? (unsigned int)std::stoul(argv[2])
+               : std::max(1u, std::thread::hardware_concurrency());
+
+  TempDirectory directory("svel_bench_obj_parse_threads");
+  const auto file = directory / "grid.obj";
+  faceCount = WriteGridObj(file, faceCount, 16, true);
+  io::obj::Parser parser(file);
+
+  std::vector<std::shared_ptr<io::obj::Model>> reference;
+  const double singleTime = Measure(
+      [&]() { reference = parser.Parse(io::obj::Parser::Mode::eMapped); });
+  std::cout << faceCount << " faces, eMapped: " << singleTime << " ms"
+            << std::endl;
+
+  for (unsigned int threads = 1; threads <= maxThreads; threads++) {
+    std::vector<std::shared_ptr<io::obj::Model>> models;
+    const double time = Measure([&]() {
+      models = parser.Parse(io::obj::Parser::Mode::eParallel, threads);
+    });
+
+    const bool same = SameModels(reference, models);
+    std::cout << threads << " threads: " << time << " ms ("
+              << singleTime / time << "x)"
+              << (same ? "" : ", RESULT DIFFERS") << std::endl;
+    if (!same)
+      return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,8 @@
+#version 450
+
+// Offset of the current draw, written through a material
+layout(set = 0, binding = 0) uniform Draw { vec4 offset; } draw;
+
+layout(location = 0) in vec3 position;
+
+void main() { gl_Position = vec4(position + draw.offset.xyz, 1.0); }
@@ -0,0 +1,199 @@
+/**
+ * @file draw_allocations.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Checks that recording draws does not allocate once warmed up.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "test.hpp"
+
+// SVEL
+#include <svel/svel.h>
+
+// STL
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+/**
+ * @brief Amount of calls to operator new of any thread.
+ */
+static std::atomic<size_t> _allocationCount{0};
+
+/**
+ * @brief Counting replacements of the global allocation functions. The other
+ * forms of new end up in these.
+ */
+void *operator new(size_t size) {
+  _allocationCount++;
+  if (void *memory = std::malloc(size == 0 ? 1 : size))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+
+void operator delete[](void *memory) noexcept { std::free(memory); }
+
+void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+
+void operator delete[](void *memory, size_t) noexcept { std::free(memory); }
+
+/**
+ * @brief Uniform data of a draw, matches shaders/draw.vert.
+ */
+struct DrawData {
+  /**
+   * @brief Offset of the triangle in clip space.
+   */
+  float offset[4];
+};
+
+/**
+ * @brief Material that writes the offset of every draw.
+ */
+class DrawMaterial : public SVEL_NAMESPACE::IMaterial {
+public:
+  /**
+   * @brief Written by the material on every draw.
+   */
+  DrawData data{};
+
+  /**
+   * @brief Construct a DrawMaterial.
+   *
+   * @param pipeline  Pipeline of shaders/draw.vert and shaders/draw.frag.
+   */
+  DrawMaterial(SVEL_NAMESPACE::SharedPipeline pipeline) : IMaterial(pipeline) {
+    AddAttribute(0, 0, &data);
+  }
+};
+
+/**
+ * @brief Window that records the same draws every frame and counts the
+ * allocations while doing so.
+ */
+class DrawWindow : public SVEL_NAMESPACE::IWindow {
+private:
+  /**
+   * @brief Frames that may allocate, while buffers and caches grow.
+   */
+  static const size_t WARM_UP_FRAMES = 8;
+
+  /**
+   * @brief Frames that have to record without allocating.
+   */
+  static const size_t CHECKED_FRAMES = 32;
+
+  /**
+   * @brief Draws per frame, enough to need several dynamic buffers.
+   */
+  static const size_t DRAW_COUNT = 4096;
+
+  /**
+   * @brief The pipeline.
+   */
+  SVEL_NAMESPACE::SharedPipeline _pipeline;
+
+  /**
+   * @brief The material of every draw.
+   */
+  std::shared_ptr<DrawMaterial> _material;
+
+  /**
+   * @brief Meshes that are drawn in turns.
+   */
+  std::vector<SVEL_NAMESPACE::SharedMesh> _meshes;
+
+  /**
+   * @brief Amount of finished frames.
+   */
+  size_t _frame = 0;
+
+public:
+  /**
+   * @brief Construct a DrawWindow.
+   *
+   * @param parent  The application.
+   */
+  DrawWindow(SVEL_NAMESPACE::SharedIApplication parent)
+      : IWindow(parent, "svel_test_draw_allocations", {640, 480}) {
+    using namespace SVEL_NAMESPACE;
+    auto renderer = GetRenderer();
+    auto vert = renderer->LoadShader(SVEL_SHADER_DIR "/draw.vert.spv",
+                                     Shader::Type::eVertex);
+    vert->AddSetLayout(0, SetLayout().Add(
+                              0, {BindingType::eUniformBufferDynamic,
+                                  sizeof(DrawData)}));
+    auto frag = renderer->LoadShader(SVEL_SHADER_DIR "/draw.frag.spv",
+                                     Shader::Type::eFragment);
+    _pipeline = renderer->BuildPipeline(vert, frag,
+                                        {{AttributeType::SIGNED_FLOAT, 3}});
+    _material = std::make_shared<DrawMaterial>(_pipeline);
+
+    for (int i = 0; i < 4; i++) {
+      const float size = 0.01f * (float)(i + 1);
+      std::vector<float> nodes{0.0f, 0.0f, 0.5f, size, 0.0f,
+                               0.5f, 0.0f, size, 0.5f};
+      _meshes.push_back(renderer->CreateMesh(
+          ArrayProxy(nodes.data(), nodes.size() * 4, 12, 3),
+          std::vector<uint16_t>{0, 1, 2}));
+    }
+  }
+
+  /**
+   * @brief Records the draws, checks the allocation count after the warm up.
+   */
+  void Draw() override {
+    const auto &renderer = GetRenderer();
+    renderer->BindPipeline(_pipeline);
+    const size_t allocationCount = _allocationCount;
+    for (size_t i = 0; i < DRAW_COUNT; i++) {
+      _material->data.offset[0] = (float)(i % 64) / 32.0f - 1.0f;
+      _material->data.offset[1] = (float)(i / 64) / 32.0f - 1.0f;
+      renderer->Draw(_meshes[i % _meshes.size()], _material);
+    }
+    const size_t allocations = _allocationCount - allocationCount;
+    renderer->UnbindPipeline();
+
+    if (++_frame <= WARM_UP_FRAMES)
+      return;
+    SVEL_CHECK(allocations == 0);
+    if (_frame >= WARM_UP_FRAMES + CHECKED_FRAMES)
+      Close();
+  }
+};
+
+/**
+ * @brief Runs the window. The entrypoint of the library reports exceptions
+ * but always succeeds, so the test passes by printing its result.
+ */
+class DrawAllocationsTest
+    : public SVEL_NAMESPACE::IApplication,
+      public std::enable_shared_from_this<DrawAllocationsTest> {
+public:
+  /**
+   * @brief Construct the test.
+   */
+  DrawAllocationsTest(int, char *[])
+      : IApplication("svel_test_draw_allocations") {}
+
+  /**
+   * @brief Runs the test.
+   */
+  void Run() override {
+    std::make_shared<DrawWindow>(shared_from_this())->StartRenderLoop();
+    if (test::Result() == EXIT_SUCCESS)
+      std::cout << "No allocations while recording draws." << std::endl;
+  }
+};
+SVEL_MAKE_APP(DrawAllocationsTest)
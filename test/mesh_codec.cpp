@@ -0,0 +1,148 @@
+/**
+ * @file mesh_codec.cpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Round trips of the mesh codec.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Local
+#include "test.hpp"
+
+// Internal
+#include <io/mesh_codec.h>
+
+// STL
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Vertices that change smoothly, like positions of a grid.
+ *
+ * @param vertexCount           Amount of vertices.
+ * @param vertexStride          Size of a vertex in bytes.
+ * @return std::vector<uint8_t> The vertex data.
+ */
+static std::vector<uint8_t> _makeSmoothVertices(size_t vertexCount,
+                                                size_t vertexStride) {
+  std::vector<uint8_t> vertices(vertexCount * vertexStride);
+  for (size_t v = 0; v < vertexCount; v++)
+    for (size_t i = 0; i + sizeof(float) <= vertexStride; i += sizeof(float)) {
+      const float value = (float)v * 0.01f + (float)i;
+      std::memcpy(&vertices[v * vertexStride + i], &value, sizeof(float));
+    }
+  return vertices;
+}
+
+/**
+ * @brief Vertices of random bytes, which do not compress.
+ *
+ * @param vertexCount           Amount of vertices.
+ * @param vertexStride          Size of a vertex in bytes.
+ * @param random                Random generator.
+ * @return std::vector<uint8_t> The vertex data.
+ */
+static std::vector<uint8_t> _makeRandomVertices(size_t vertexCount,
+                                                size_t vertexStride,
+                                                std::mt19937 &random) {
+  std::vector<uint8_t> vertices(vertexCount * vertexStride);
+  for (auto &byte : vertices)
+    byte = (uint8_t)(random() & 0xFF);
+  return vertices;
+}
+
+/**
+ * @brief Encodes and decodes vertices and checks the result. Truncated data
+ * has to be rejected.
+ *
+ * @param vertices      The vertex data.
+ * @param vertexCount   Amount of vertices.
+ * @param vertexStride  Size of a vertex in bytes.
+ */
+static void _checkVertices(const std::vector<uint8_t> &vertices,
+                           size_t vertexCount, size_t vertexStride) {
+  const auto encoded =
+      io::EncodeVertexBuffer(vertices.data(), vertexCount, vertexStride);
+  std::vector<uint8_t> decoded(vertices.size() + 1, 0xCD);
+  SVEL_CHECK(io::DecodeVertexBuffer(decoded.data(), vertexCount, vertexStride,
+                                    encoded.data(), encoded.size()));
+  SVEL_CHECK(std::equal(vertices.begin(), vertices.end(), decoded.begin()));
+  SVEL_CHECK(decoded.back() == 0xCD);
+
+  if (!encoded.empty())
+    SVEL_CHECK(!io::DecodeVertexBuffer(decoded.data(), vertexCount,
+                                       vertexStride, encoded.data(),
+                                       encoded.size() - 1));
+}
+
+/**
+ * @brief Encodes and decodes indices and checks the result. Truncated data
+ * has to be rejected.
+ *
+ * @param indices   The indices.
+ * @param indexSize Size of an index in bytes.
+ */
+static void _checkIndices(const std::vector<uint32_t> &indices,
+                          size_t indexSize) {
+  std::vector<uint8_t> raw(indices.size() * indexSize);
+  for (size_t i = 0; i < indices.size(); i++)
+    if (indexSize == sizeof(uint16_t)) {
+      const auto index = (uint16_t)indices[i];
+      std::memcpy(&raw[i * indexSize], &index, indexSize);
+    } else
+      std::memcpy(&raw[i * indexSize], &indices[i], indexSize);
+
+  const auto encoded =
+      io::EncodeIndexBuffer(raw.data(), indices.size(), indexSize);
+  std::vector<uint8_t> decoded(raw.size());
+  SVEL_CHECK(io::DecodeIndexBuffer(decoded.data(), indices.size(), indexSize,
+                                   encoded.data(), encoded.size()));
+  SVEL_CHECK(decoded == raw);
+
+  if (!encoded.empty())
+    SVEL_CHECK(!io::DecodeIndexBuffer(decoded.data(), indices.size(),
+                                      indexSize, encoded.data(),
+                                      encoded.size() - 1));
+}
+
+/**
+ * @brief Runs the round trips.
+ *
+ * @return int EXIT_FAILURE if a check failed.
+ */
+int main() {
+  std::mt19937 random(42);
+
+  // Every stride with counts around the block size of 16 vertices
+  const size_t vertexCounts[] = {0, 1, 15, 16, 17, 1000};
+  for (size_t stride = 1; stride <= io::MAX_ENCODED_VERTEX_STRIDE; stride++)
+    for (auto count : vertexCounts) {
+      _checkVertices(_makeSmoothVertices(count, stride), count, stride);
+      _checkVertices(_makeRandomVertices(count, stride, random), count,
+                     stride);
+    }
+
+  // Grid triangles in order of first use and random triangles
+  std::vector<uint32_t> grid{}, scattered{};
+  for (uint32_t y = 0; y < 100; y++)
+    for (uint32_t x = 0; x < 100; x++) {
+      const uint32_t a = y * 101 + x;
+      grid.insert(grid.end(), {a, a + 101, a + 1, a + 1, a + 101, a + 102});
+    }
+  for (size_t i = 0; i < 3000; i++)
+    scattered.push_back((uint32_t)(random() & 0xFFFF));
+  for (size_t indexSize : {sizeof(uint16_t), sizeof(uint32_t)}) {
+    _checkIndices({}, indexSize);
+    _checkIndices({0, 1, 2}, indexSize);
+    _checkIndices(grid, indexSize);
+    _checkIndices(scattered, indexSize);
+  }
+  _checkIndices({0, 0xFFFFFFFF, 7, 0x80000000, 1, 2}, sizeof(uint32_t));
+
+  return test::Result();
+}
@@ -0,0 +1,62 @@
+/**
+ * @file test.hpp
+ * @author René Pascal Becker (rene.becker2@gmx.de)
+ * @brief Minimal checks for the tests.
+ * @date 2023-10-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __TEST_TEST_HPP__
+#define __TEST_TEST_HPP__
+
+// STL
+#include <cstdlib>
+#include <iostream>
+
+namespace test {
+
+/**
+ * @brief Amount of failed checks of the test.
+ */
+inline int failedChecks = 0;
+
+/**
+ * @brief Records a failed check.
+ *
+ * @param expression  Text of the check.
+ * @param file        File of the check.
+ * @param line        Line of the check.
+ */
+inline void Fail(const char *expression, const char *file, int line) {
+  // Only the first failures are printed, loops may fail thousands of times
+  if (failedChecks++ < 16)
+    std::cerr << file << ":" << line << ": check failed: " << expression
+              << std::endl;
+}
+
+/**
+ * @brief Exit code of the test.
+ *
+ * @return int EXIT_SUCCESS if every check passed.
+ */
+inline int Result() {
+  if (failedChecks == 0)
+    return EXIT_SUCCESS;
+  std::cerr << failedChecks << " checks failed" << std::endl;
+  return EXIT_FAILURE;
+}
+
+} // namespace test
+
+/**
+ * @brief Checks a condition and records a failure, the test continues.
+ */
+#define SVEL_CHECK(expression)                                                 \
+  do {                                                                         \
+    if (!(expression))                                                         \
+      test::Fail(#expression, __FILE__, __LINE__);                             \
+  } while (false)
+
+#endif /* __TEST_TEST_HPP__ */